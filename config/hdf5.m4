@@ -58,7 +58,8 @@ HAVE_ZLIB=no
 if test "x$WITH_ZLIB" != "xno"; then
   old_LDFLAGS="$LDFLAGS"
   LDFLAGS="$LDFLAGS $HDF5_LDFLAGS"
-  AC_CHECK_LIB([z],[deflate],[HAVE_ZLIB=yes; HDF5_LIBS="$HDF5_LIBS -lz"],
+  AC_CHECK_LIB([z],[deflate],[HAVE_ZLIB=yes; HDF5_LIBS="$HDF5_LIBS -lz"
+    AC_DEFINE([HAVE_ZLIB],[1],[Define if configured with zlib support.])],
     [if test "x$WITH_ZLIB" != "x"; then AC_MSG_ERROR([Could not find zlib]); fi])
   LDFLAGS="$old_LDFLAGS"
 fi
@@ -23,6 +23,7 @@
 #include "moab/CN.hpp"
 #include "moab/MeshTopoUtil.hpp"
 #include "EntitySequence.hpp"
+#include "ElementSequence.hpp"
 #include "SequenceData.hpp"
 #include "SequenceManager.hpp"
 #include "RangeSeqIntersectIter.hpp"
@@ -69,6 +70,7 @@ AEntityFactory::~AEntityFactory()
     TypeSequenceManager::iterator i;
     TypeSequenceManager& seqman = thisMB->sequence_manager()->entity_map( ent_type );
     for (i = seqman.begin(); i != seqman.end(); ++i) {
+      (*i)->data()->set_compact_adjacency( 0, 0 );
       std::vector<EntityHandle>** adj_list = (*i)->data()->get_adjacency_data();
       if (!adj_list)
         continue;
@@ -484,38 +486,185 @@ ErrorCode AEntityFactory::remove_all_adjacencies(EntityHandle base_entity,
   return MB_SUCCESS;
 }
 
-ErrorCode AEntityFactory::create_vert_elem_adjacencies()
+//! A block of vertex handles sharing one adjacency array, with the
+//! position of its first vertex in the flat per-vertex work arrays
+struct VertAdjBlock {
+  EntityHandle start, end;
+  AdjacencyVector** adj;
+  size_t offset;
+};
+
+//! Find the block containing a vertex handle, or return blocks.size()
+//! if the handle is not in any block.
+static inline size_t vert_adj_block( const std::vector<VertAdjBlock>& blocks,
+                                     EntityHandle h )
 {
+  size_t lo = 0, hi = blocks.size();
+  while (lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    if (blocks[mid].end < h)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < blocks.size() && blocks[lo].start > h)
+    return blocks.size();
+  return lo;
+}
 
+ErrorCode AEntityFactory::create_vert_elem_adjacencies()
+{
   mVertElemAdj = true;
 
-  EntityType ent_type;
-  Range::iterator i_range;
-  const EntityHandle *connectivity;
-  std::vector<EntityHandle> aux_connect;
-  int number_nodes;
   ErrorCode result;
-  Range handle_range;
-  
-  // 1. over all element types, for each element, create vertex-element adjacencies
-  for (ent_type = MBEDGE; ent_type != MBENTITYSET; ent_type++) 
-  {
-    handle_range.clear();
+  SequenceManager* seq_man = thisMB->sequence_manager();
+
+    // Elements with explicit connectivity arrays are handled in bulk
+    // with a count pass, an allocation pass and a fill pass, each of which
+    // is thread-parallel when built with OpenMP.  Structured and polyhedral
+    // sequences have no vertex connectivity array and go through add_adjacency.
+  std::vector<const ElementSequence*> bulk_seqs;
+  std::vector<EntitySequence*> other_seqs;
+  for (EntityType t = MBEDGE; t != MBENTITYSET; ++t) {
+    TypeSequenceManager& seqs = seq_man->entity_map( t );
+    for (TypeSequenceManager::iterator i = seqs.begin(); i != seqs.end(); ++i) {
+      const ElementSequence* eseq = static_cast<const ElementSequence*>(*i);
+      if (MBPOLYHEDRON != t && eseq->get_connectivity_array())
+        bulk_seqs.push_back( eseq );
+      else
+        other_seqs.push_back( *i );
+    }
+  }
 
-    // get this type of entity
-    result = thisMB->get_entities_by_type(0, ent_type, handle_range);
-    if (result != MB_SUCCESS)
-      return result;
+  std::vector<VertAdjBlock> blocks;
+  size_t num_verts = 0;
+  if (!bulk_seqs.empty()) {
+    TypeSequenceManager& verts = seq_man->entity_map( MBVERTEX );
+    for (TypeSequenceManager::iterator i = verts.begin(); i != verts.end(); ++i) {
+      SequenceData* data = (*i)->data();
+      result = expand_compact_adjacencies( data );
+      if (MB_SUCCESS != result)
+        return result;
+      if (!data->get_adjacency_data() && !data->allocate_adjacency_data())
+        return MB_MEMORY_ALLOCATION_FAILED;
+      VertAdjBlock block;
+      block.start = (*i)->start_handle();
+      block.end = (*i)->end_handle();
+      block.adj = data->get_adjacency_data() + (block.start - data->start_handle());
+      block.offset = num_verts;
+      blocks.push_back( block );
+      num_verts += block.end - block.start + 1;
+    }
+  }
+  
+    // count pass: number of new adjacencies for each vertex
+  std::vector<unsigned> counts( num_verts, 0 );
+  bool all_found = true;
+  for (size_t s = 0; s < bulk_seqs.size(); ++s) {
+    const EntityHandle* conn = bulk_seqs[s]->get_connectivity_array();
+    const long len = bulk_seqs[s]->size() * bulk_seqs[s]->nodes_per_element();
+#ifdef _OPENMP
+#pragma omp parallel for reduction(&&:all_found)
+#endif
+    for (long j = 0; j < len; ++j) {
+      const size_t b = vert_adj_block( blocks, conn[j] );
+      if (b < blocks.size()) {
+        const size_t idx = blocks[b].offset + (conn[j] - blocks[b].start);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++counts[idx];
+      }
+      else
+        all_found = false;
+    }
+  }
 
-    for (i_range = handle_range.begin(); i_range != handle_range.end(); ++i_range) 
-    {
-      result = get_vertices( *i_range, connectivity, number_nodes, aux_connect );
+    // Connectivity referencing something other than an existing vertex
+    // is left to add_adjacency, which will report the error.
+  if (!all_found) {
+    bulk_seqs.clear();
+    other_seqs.clear();
+    for (EntityType t = MBEDGE; t != MBENTITYSET; ++t) {
+      TypeSequenceManager& seqs = seq_man->entity_map( t );
+      other_seqs.insert( other_seqs.end(), seqs.begin(), seqs.end() );
+    }
+  }
+  else if (!bulk_seqs.empty()) {
+      // allocation pass: grow each vertex list by its count, and turn the
+      // count into a cursor pointing one past the last free slot
+    const long nblocks = blocks.size();
+    for (long b = 0; b < nblocks; ++b) {
+      AdjacencyVector** adj = blocks[b].adj;
+      unsigned* cursor = &counts[blocks[b].offset];
+      const long n = blocks[b].end - blocks[b].start + 1;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (long j = 0; j < n; ++j) {
+        if (!cursor[j])
+          continue;
+        if (!adj[j])
+          adj[j] = new AdjacencyVector;
+        adj[j]->resize( adj[j]->size() + cursor[j] );
+        cursor[j] = adj[j]->size();
+      }
+    }
+    
+      // fill pass
+    for (size_t s = 0; s < bulk_seqs.size(); ++s) {
+      const EntityHandle* conn = bulk_seqs[s]->get_connectivity_array();
+      const EntityHandle start = bulk_seqs[s]->start_handle();
+      const long nodes = bulk_seqs[s]->nodes_per_element();
+      const long count = bulk_seqs[s]->size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (long e = 0; e < count; ++e) {
+        for (long k = 0; k < nodes; ++k) {
+          const EntityHandle vtx = conn[e*nodes + k];
+          const size_t b = vert_adj_block( blocks, vtx );
+          const EntityHandle offset = vtx - blocks[b].start;
+          unsigned slot;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+          slot = --counts[blocks[b].offset + offset];
+          (*blocks[b].adj[offset])[slot] = start + e;
+        }
+      }
+    }
+    
+      // Slots are filled in arbitrary order by concurrent threads, and an
+      // element may list the same vertex more than once.  Restore the sorted,
+      // unique lists add_adjacency would have produced.
+    for (long b = 0; b < nblocks; ++b) {
+      AdjacencyVector** adj = blocks[b].adj;
+      const long n = blocks[b].end - blocks[b].start + 1;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1024)
+#endif
+      for (long j = 0; j < n; ++j) {
+        if (!adj[j] || adj[j]->size() < 2)
+          continue;
+        std::sort( adj[j]->begin(), adj[j]->end() );
+        adj[j]->erase( std::unique( adj[j]->begin(), adj[j]->end() ), adj[j]->end() );
+      }
+    }
+  }
+  
+  const EntityHandle* connectivity;
+  std::vector<EntityHandle> aux_connect;
+  int number_nodes;
+  for (size_t s = 0; s < other_seqs.size(); ++s) {
+    for (EntityHandle h = other_seqs[s]->start_handle(); h <= other_seqs[s]->end_handle(); ++h) {
+      result = get_vertices( h, connectivity, number_nodes, aux_connect );
       if (MB_SUCCESS != result)
         return result;
       
         // add the adjacency
       for( int k=0; k<number_nodes; k++)
-        if ((result = add_adjacency(connectivity[k], *i_range)) != MB_SUCCESS)
+        if ((result = add_adjacency(connectivity[k], h)) != MB_SUCCESS)
           return result;
     }
   }
@@ -524,35 +673,56 @@ ErrorCode AEntityFactory::create_vert_elem_adjacencies()
 }
 
 
+//! Get the compact adjacency list for the entity at the passed index
+//! in a SequenceData, or NULL if it has no compact adjacencies.
+static inline const EntityHandle* compact_adjacency_list( const SequenceData* data,
+                                                          EntityID index,
+                                                          int& count )
+{
+  const EntityID* offsets = data->get_compact_adjacency_offsets();
+  if (!offsets || offsets[index] == offsets[index+1])
+    return 0;
+    // a zero first handle marks a list moved back to per-entity storage
+  const EntityHandle* list = data->get_compact_adjacency_list() + offsets[index];
+  if (!*list)
+    return 0;
+  count = offsets[index+1] - offsets[index];
+  return list;
+}
+
 ErrorCode AEntityFactory::get_adjacencies(EntityHandle entity,
                                             const EntityHandle *&adjacent_entities,
                                             int &num_entities) const
 {
-  AdjacencyVector const* vec_ptr = 0;
-  ErrorCode result = get_adjacency_ptr( entity, vec_ptr );
-  if (MB_SUCCESS != result || !vec_ptr) {
-    adjacent_entities = 0;
-    num_entities = 0;
+  adjacent_entities = 0;
+  num_entities = 0;
+  
+  EntitySequence* seq;
+  ErrorCode result = thisMB->sequence_manager()->find( entity, seq );
+  if (MB_SUCCESS != result)
     return result;
-  }
   
-  num_entities = vec_ptr->size();
-  adjacent_entities = (vec_ptr->empty())?NULL:&((*vec_ptr)[0]);
+  const SequenceData* data = seq->data();
+  const EntityID index = entity - data->start_handle();
+  AdjacencyVector const* const* array = data->get_adjacency_data();
+  if (array && array[index]) {
+    num_entities = array[index]->size();
+    adjacent_entities = (array[index]->empty())?NULL:&((*array[index])[0]);
+  }
+  else {
+    adjacent_entities = compact_adjacency_list( data, index, num_entities );
+  }
   return MB_SUCCESS;
 }
 
 ErrorCode AEntityFactory::get_adjacencies(EntityHandle entity,
                                             std::vector<EntityHandle>& adjacent_entities) const
 {
-  AdjacencyVector const* vec_ptr = 0;
-  ErrorCode result = get_adjacency_ptr( entity, vec_ptr );
-  if (MB_SUCCESS != result || !vec_ptr) {
-    adjacent_entities.clear();
-    return result;
-  }
-  
-  adjacent_entities = *vec_ptr;
-  return MB_SUCCESS;
+  const EntityHandle* adj;
+  int num_adj;
+  ErrorCode result = get_adjacencies( entity, adj, num_adj );
+  adjacent_entities.assign( adj, adj + num_adj );
+  return result;
 }
 
 ErrorCode AEntityFactory::get_adjacencies( EntityHandle entity,
@@ -663,36 +833,42 @@ ErrorCode AEntityFactory::get_zero_to_n_elements(EntityHandle source_entity,
                             const bool create_if_missing,
                             const int /*create_adjacency_option = -1*/)
 {
-  AdjacencyVector::iterator start_ent, end_ent;
+  const EntityHandle *start_ent, *end_ent;
 
-  // get the adjacency vector
-  AdjacencyVector *adj_vec = NULL;
-  ErrorCode result = get_adjacencies( source_entity, adj_vec );
+  // get the adjacency list
+  const EntityHandle *adj_vec = NULL;
+  int num_adj = 0;
+  ErrorCode result = get_adjacencies( source_entity, adj_vec, num_adj );
   if(result != MB_SUCCESS || adj_vec == NULL)
     return result;
   
   if (target_dimension < 3 && create_if_missing) {
       std::vector<EntityHandle> tmp_ents;
       
-      start_ent = std::lower_bound(adj_vec->begin(), adj_vec->end(), 
+      start_ent = std::lower_bound(adj_vec, adj_vec+num_adj, 
                          FIRST_HANDLE(CN::TypeDimensionMap[target_dimension+1].first));
 
-      end_ent = std::lower_bound(start_ent, adj_vec->end(), 
+      end_ent = std::lower_bound(start_ent, adj_vec+num_adj, 
                          LAST_HANDLE(CN::TypeDimensionMap[3].second));
       
       std::vector<EntityHandle> elems(start_ent, end_ent);
  
       // make target_dimension elements from all adjacient higher-dimension elements
-      for(start_ent = elems.begin(); start_ent != elems.end(); ++start_ent)
+      for(std::vector<EntityHandle>::iterator it = elems.begin(); it != elems.end(); ++it)
       {
         tmp_ents.clear();
-        get_down_adjacency_elements(*start_ent, target_dimension, tmp_ents, create_if_missing, 0);
+        get_down_adjacency_elements(*it, target_dimension, tmp_ents, create_if_missing, 0);
       }
+      
+        // creating entities may have modified the list
+      result = get_adjacencies( source_entity, adj_vec, num_adj );
+      if(result != MB_SUCCESS || adj_vec == NULL)
+        return result;
   }
     
   DimensionPair dim_pair = CN::TypeDimensionMap[target_dimension];
-  start_ent = std::lower_bound(adj_vec->begin(), adj_vec->end(), FIRST_HANDLE(dim_pair.first ));
-  end_ent   = std::lower_bound(start_ent,        adj_vec->end(), LAST_HANDLE (dim_pair.second));
+  start_ent = std::lower_bound(adj_vec,   adj_vec+num_adj, FIRST_HANDLE(dim_pair.first ));
+  end_ent   = std::lower_bound(start_ent, adj_vec+num_adj, LAST_HANDLE (dim_pair.second));
   target_entities.insert( target_entities.end(), start_ent, end_ent );
   return MB_SUCCESS;  
 }
@@ -1176,9 +1352,10 @@ ErrorCode AEntityFactory::get_up_adjacency_elements(EntityHandle source_entity,
   else {
       // else get up-adjacencies directly; code copied from get_zero_to_n_elements
 
-      // get the adjacency vector
-    AdjacencyVector *adj_vec = NULL;
-    result = get_adjacencies( source_entity, adj_vec );
+      // get the adjacency list
+    const EntityHandle *adj_vec = NULL;
+    int num_adj = 0;
+    result = get_adjacencies( source_entity, adj_vec, num_adj );
                     
     if(result != MB_SUCCESS)
       return result;
@@ -1193,15 +1370,15 @@ ErrorCode AEntityFactory::get_up_adjacency_elements(EntityHandle source_entity,
 
       // get iterators for start handle of source_dim+1 and target_dim, and end handle
       // of target_dim
-    AdjacencyVector::iterator 
-      start_ent_dp1 = std::lower_bound(adj_vec->begin(), adj_vec->end(), 
-                                       CREATE_HANDLE(dim_pair_dp1.first, MB_START_ID, dum)),
+    const EntityHandle
+      *start_ent_dp1 = std::lower_bound(adj_vec, adj_vec+num_adj, 
+                                        CREATE_HANDLE(dim_pair_dp1.first, MB_START_ID, dum)),
        
-      start_ent_td = std::lower_bound(adj_vec->begin(), adj_vec->end(), 
-                                      CREATE_HANDLE(dim_pair_td.first, MB_START_ID, dum)),
+      *start_ent_td = std::lower_bound(adj_vec, adj_vec+num_adj, 
+                                       CREATE_HANDLE(dim_pair_td.first, MB_START_ID, dum)),
        
-      end_ent_td = std::lower_bound(adj_vec->begin(), adj_vec->end(), 
-                                    CREATE_HANDLE(dim_pair_td.second, MB_END_ID, dum));
+      *end_ent_td = std::lower_bound(adj_vec, adj_vec+num_adj, 
+                                     CREATE_HANDLE(dim_pair_td.second, MB_END_ID, dum));
 
       // get the adjacencies for source_dim+1 to target_dim-1, and the adjacencies from
       // those to target_dim
@@ -1431,10 +1608,26 @@ ErrorCode AEntityFactory::get_adjacency_ptr( EntityHandle entity,
   
   EntitySequence* seq;
   ErrorCode rval = thisMB->sequence_manager()->find( entity, seq );
-  if (MB_SUCCESS != rval || !seq->data()->get_adjacency_data())
+  if (MB_SUCCESS != rval)
     return rval;
   
-  ptr = seq->data()->get_adjacency_data()[entity - seq->data()->start_handle()];
+  SequenceData* data = seq->data();
+  const EntityID index = entity - data->start_handle();
+  if (data->get_adjacency_data())
+    ptr = data->get_adjacency_data()[index];
+  if (ptr)
+    return MB_SUCCESS;
+  
+    // caller may modify the list, so move it out of compact storage
+  int count;
+  const EntityHandle* list = compact_adjacency_list( data, index, count );
+  if (!list)
+    return MB_SUCCESS;
+  if (!data->get_adjacency_data() && !data->allocate_adjacency_data())
+    return MB_MEMORY_ALLOCATION_FAILED;
+  ptr = new AdjacencyVector( list, list + count );
+  data->get_adjacency_data()[index] = ptr;
+  data->get_compact_adjacency_list()[data->get_compact_adjacency_offsets()[index]] = 0;
   return MB_SUCCESS;
 }
 
@@ -1468,6 +1661,110 @@ ErrorCode AEntityFactory::set_adjacency_ptr( EntityHandle entity,
   std::vector<EntityHandle>*& ref = seq->data()->get_adjacency_data()[index];
   delete ref;
   ref = ptr;
+  
+    // discard any compact list for the entity
+  int count;
+  if (compact_adjacency_list( seq->data(), index, count ))
+    seq->data()->get_compact_adjacency_list()[seq->data()->get_compact_adjacency_offsets()[index]] = 0;
+  return MB_SUCCESS;
+}
+
+ErrorCode AEntityFactory::compact_adjacencies()
+{
+  if (!mVertElemAdj) {
+    ErrorCode rval = create_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  
+  for (EntityType t = MBVERTEX; t != MBENTITYSET; ++t) {
+    SequenceData* prev_data = 0;
+    TypeSequenceManager& seqman = thisMB->sequence_manager()->entity_map( t );
+    for (TypeSequenceManager::iterator i = seqman.begin(); i != seqman.end(); ++i) {
+      SequenceData* data = (*i)->data();
+      if (data == prev_data)
+        continue;
+      prev_data = data;
+      
+      AdjacencyVector** array = data->get_adjacency_data();
+      if (!array)
+        continue;
+      
+        // count pass
+      const long n = data->size();
+      EntityID* offsets = (EntityID*)malloc( sizeof(EntityID) * (n + 1) );
+      if (!offsets)
+        return MB_MEMORY_ALLOCATION_FAILED;
+      offsets[0] = 0;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (long j = 0; j < n; ++j) {
+        int count = 0;
+        if (array[j])
+          count = array[j]->size();
+        else
+          compact_adjacency_list( data, j, count );
+        offsets[j+1] = count;
+      }
+      
+        // prefix sum
+      for (long j = 0; j < n; ++j)
+        offsets[j+1] += offsets[j];
+      
+        // fill pass
+      EntityHandle* list = 0;
+      if (offsets[n]) {
+        list = (EntityHandle*)malloc( sizeof(EntityHandle) * offsets[n] );
+        if (!list) {
+          free( offsets );
+          return MB_MEMORY_ALLOCATION_FAILED;
+        }
+      }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1024)
+#endif
+      for (long j = 0; j < n; ++j) {
+        int count = 0;
+        const EntityHandle* old_list;
+        if (array[j])
+          old_list = array[j]->empty() ? 0 : &(*array[j])[0];
+        else
+          old_list = compact_adjacency_list( data, j, count );
+        if (old_list)
+          memcpy( list + offsets[j], old_list, sizeof(EntityHandle) * (offsets[j+1] - offsets[j]) );
+        delete array[j];
+      }
+      
+      data->release_adjacency_data();
+      data->set_compact_adjacency( offsets, list );
+    }
+  }
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode AEntityFactory::expand_compact_adjacencies( SequenceData* data )
+{
+  const EntityID* offsets = data->get_compact_adjacency_offsets();
+  if (!offsets)
+    return MB_SUCCESS;
+  
+  if (!data->get_adjacency_data() && !data->allocate_adjacency_data())
+    return MB_MEMORY_ALLOCATION_FAILED;
+  AdjacencyVector** array = data->get_adjacency_data();
+  const long n = data->size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1024)
+#endif
+  for (long j = 0; j < n; ++j) {
+    int count;
+    const EntityHandle* list = compact_adjacency_list( data, j, count );
+    if (list && !array[j])
+      array[j] = new AdjacencyVector( list, list + count );
+  }
+  
+  data->set_compact_adjacency( 0, 0 );
   return MB_SUCCESS;
 }
 
@@ -1483,12 +1780,17 @@ void AEntityFactory::get_memory_use( unsigned long long& entity_total,
     TypeSequenceManager::iterator i;
     TypeSequenceManager& seqman = thisMB->sequence_manager()->entity_map( t );
     for (i = seqman.begin(); i != seqman.end(); ++i) {
-      if (!(*i)->data()->get_adjacency_data())
+      SequenceData* data = (*i)->data();
+      const EntityID* offsets = data->get_compact_adjacency_offsets();
+      if (!data->get_adjacency_data() && !offsets)
         continue;
       
-      if (prev_data != (*i)->data()) {
-        prev_data = (*i)->data();
-        memory_total += prev_data->size() * sizeof(AdjacencyVector*);
+      if (prev_data != data) {
+        prev_data = data;
+        if (data->get_adjacency_data())
+          memory_total += data->size() * sizeof(AdjacencyVector*);
+        if (offsets)
+          memory_total += (data->size() + 1) * sizeof(EntityID);
       }
       
       const AdjacencyVector* vec;
@@ -1497,6 +1799,11 @@ void AEntityFactory::get_memory_use( unsigned long long& entity_total,
         if (vec) 
           entity_total += vec->capacity() * sizeof(EntityHandle) + sizeof(AdjacencyVector);
       }
+      if (offsets) {
+        const EntityID first = (*i)->start_handle() - data->start_handle();
+        const EntityID last = (*i)->end_handle() - data->start_handle() + 1;
+        entity_total += (offsets[last] - offsets[first]) * sizeof(EntityHandle);
+      }
     }
   }
  
@@ -1516,27 +1823,35 @@ ErrorCode AEntityFactory::get_memory_use( const Range& ents_in,
     return rval;
   
   do {
-    AdjacencyVector** array = iter.get_sequence()->data()->get_adjacency_data();
-    if (!array)
+    SequenceData* data = iter.get_sequence()->data();
+    AdjacencyVector** array = data->get_adjacency_data();
+    const EntityID* offsets = data->get_compact_adjacency_offsets();
+    if (!array && !offsets)
       continue;
 
     EntityID count = iter.get_end_handle() - iter.get_start_handle() + 1;
     EntityID data_occ = thisMB->sequence_manager()
                                 ->entity_map( iter.get_sequence()->type() )
-                                 .get_occupied_size( iter.get_sequence()->data() );
+                                 .get_occupied_size( data );
     
-    if (iter.get_sequence()->data() != prev_data) {
-      prev_data = iter.get_sequence()->data();
-      amortized += sizeof(AdjacencyVector*) 
-                   * iter.get_sequence()->data()->size()
-                   * count / data_occ;
+    if (data != prev_data) {
+      prev_data = data;
+      if (array)
+        amortized += sizeof(AdjacencyVector*) * data->size() * count / data_occ;
+      if (offsets)
+        amortized += sizeof(EntityID) * (data->size() + 1) * count / data_occ;
     }
-            
-    array += iter.get_start_handle() - iter.get_sequence()->data()->start_handle();
-    for (EntityID i = 0; i < count; ++i) {
-      if (array[i]) 
-        min_per_ent += sizeof(EntityHandle) * array[i]->capacity() + sizeof(AdjacencyVector);
+    
+    const EntityID first = iter.get_start_handle() - data->start_handle();
+    if (array) {
+      array += first;
+      for (EntityID i = 0; i < count; ++i) {
+        if (array[i]) 
+          min_per_ent += sizeof(EntityHandle) * array[i]->capacity() + sizeof(AdjacencyVector);
+      }
     }
+    if (offsets)
+      min_per_ent += sizeof(EntityHandle) * (offsets[first+count] - offsets[first]);
   } while (MB_SUCCESS == (rval = iter.step()));
   
   amortized += min_per_ent;
@@ -27,6 +27,7 @@ namespace moab {
 
 typedef std::vector<EntityHandle> AdjacencyVector;
 class Core;
+class SequenceData;
 
 //! class AEntityFactory
 class AEntityFactory 
@@ -139,6 +140,16 @@ public:
   //! returns whether vertex to element adjacencies are being stored
   bool vert_elem_adjacencies() const { return mVertElemAdj; }
 
+  //! Move all adjacency lists into compact, read-optimized storage 
+  //! (one offset array and one handle array per SequenceData), creating
+  //! vertex to element adjacencies first if necessary.  Lists for entities 
+  //! modified afterwards are moved back to per-entity vectors individually.
+  ErrorCode compact_adjacencies();
+
+  //! Move all compact adjacency lists for a SequenceData back into
+  //! per-entity vectors
+  ErrorCode expand_compact_adjacencies( SequenceData* data );
+
   //! calling code notifying this that an entity is getting deleted
   ErrorCode notify_delete_entity(EntityHandle entity);
 
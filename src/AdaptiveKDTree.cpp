@@ -3,6 +3,7 @@
 
 #include "moab/AdaptiveKDTree.hpp"
 #include "moab/Interface.hpp"
+#include "moab/Core.hpp"
 #include "moab/GeomUtil.hpp"
 #include "moab/Range.hpp"
 #include "moab/ElemEvaluator.hpp"
@@ -13,6 +14,7 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <deque>
 #include <limits>
 #include <iostream>
 #include <cstdio>
@@ -102,6 +104,21 @@ namespace moab {
       if (MB_SUCCESS != rval)
         return rval;
   
+        // an instance frozen by the caller may be queried by other threads, so
+        // leave its frozen state alone and build serially
+      Core* core = dynamic_cast<Core*>(moab());
+      if (numThreads > 1 && planeSet != VERTEX_SAMPLE && core && !core->is_frozen()) {
+        rval = parallel_build_tree( *tree_root_set, entities, box );
+        if (MB_SUCCESS != rval) {
+          reset_tree();
+          treeStats.reset();
+          return rval;
+        }
+        rval = treeStats.compute_stats(mbImpl, myRoot);
+        treeStats.initTime = cp.time_elapsed();
+        return rval;
+      }
+
       AdaptiveKDTreeIter iter;
       iter.initialize( this, *tree_root_set, box.bMin.array(), box.bMax.array(), AdaptiveKDTreeIter::LEFT );
   
@@ -118,51 +135,21 @@ namespace moab {
         Range best_left, best_right, best_both;
         Plane best_plane = { HUGE_VAL, -1 };
         if ((int)p_count > maxPerLeaf && (int)iter.depth() < maxDepth) {
-          switch (planeSet) {
-            case AdaptiveKDTree::SUBDIVISION:
-                rval = best_subdivision_plane( splitsPerDir, 
-                                               iter, 
-                                               best_left, 
-                                               best_right, 
-                                               best_both, 
-                                               best_plane, 
-                                               minWidth );
-                break;
-            case AdaptiveKDTree::SUBDIVISION_SNAP:
-                rval = best_subdivision_snap_plane( splitsPerDir, 
-                                                    iter, 
-                                                    best_left, 
-                                                    best_right, 
-                                                    best_both, 
-                                                    best_plane, 
-                                                    tmp_data, 
-                                                    minWidth );
-                break;
-            case AdaptiveKDTree::VERTEX_MEDIAN:
-                rval = best_vertex_median_plane( splitsPerDir, 
-                                                 iter, 
-                                                 best_left, 
-                                                 best_right, 
-                                                 best_both, 
-                                                 best_plane, 
-                                                 tmp_data, 
-                                                 minWidth );
-                break;
-            case AdaptiveKDTree::VERTEX_SAMPLE:
-                rval = best_vertex_sample_plane( splitsPerDir, 
-                                                 iter, 
-                                                 best_left, 
-                                                 best_right, 
-                                                 best_both, 
-                                                 best_plane, 
-                                                 tmp_data, 
-                                                 tmp_data2,
-                                                 minWidth );
-                break;
-            default:
-                rval = MB_FAILURE;
-          }
-    
+          Range node_entities;
+          rval = moab()->get_entities_by_handle( iter.handle(), node_entities );
+          if (MB_SUCCESS != rval)
+            return rval;
+          rval = choose_split_plane( node_entities,
+                                     CartVect(iter.box_min()),
+                                     CartVect(iter.box_max()),
+                                     best_left,
+                                     best_right,
+                                     best_both,
+                                     best_plane,
+                                     tmp_data,
+                                     tmp_data2,
+                                     treeStats,
+                                     1 );
           if (MB_SUCCESS != rval)
             return rval;
         }
@@ -815,7 +802,8 @@ namespace moab {
         Range& left_tris,
         Range& right_tris,
         Range& both_tris,
-        double& metric_value )
+        double& metric_value,
+        TreeStats& stats )
     {
       left_tris.clear();
       right_tris.clear();
@@ -850,7 +838,7 @@ namespace moab {
   
         // vertices
       for (i = elems.begin(); i != elem_begin; ++i) {
-        tree_stats().constructLeafObjectTests++;
+        stats.constructLeafObjectTests++;
         rval = moab()->get_coords( &*i, 1, coords[0].array() );
         if (MB_SUCCESS != rval)
           return rval;
@@ -872,7 +860,7 @@ namespace moab {
         // non-polyhedron elements
       std::vector<EntityHandle> dum_vector;
       for (i = elem_begin; i != poly_begin; ++i) {
-        tree_stats().constructLeafObjectTests++;
+        stats.constructLeafObjectTests++;
         rval = moab()->get_connectivity( *i, conn, count, true, &dum_vector);
         if (MB_SUCCESS != rval) 
           return rval;
@@ -899,7 +887,7 @@ namespace moab {
           double tol = eps;
           lo = ro = false;
           while (!lo && !ro && tol <= max_tol) {
-            tree_stats().boxElemTests+= 2;
+            stats.boxElemTests+= 2;
             lo = GeomUtil::box_elem_overlap( coords, TYPE_FROM_HANDLE(*i), left_cen, left_dim+CartVect(tol));
             ro = GeomUtil::box_elem_overlap( coords, TYPE_FROM_HANDLE(*i), right_cen, right_dim+CartVect(tol));
             
@@ -916,7 +904,7 @@ namespace moab {
   
         // polyhedra
       for (i = poly_begin; i != set_begin; ++i) {
-        tree_stats().constructLeafObjectTests++;
+        stats.constructLeafObjectTests++;
         rval = moab()->get_connectivity( *i, conn, count, true );
         if (MB_SUCCESS != rval) 
           return rval;
@@ -950,7 +938,7 @@ namespace moab {
         // sets
       BoundBox tbox;
       for (i = set_begin; i != elems.end(); ++i) {
-        tree_stats().constructLeafObjectTests++;
+        stats.constructLeafObjectTests++;
         rval = tbox.update(*moab(), *i);
         if (MB_SUCCESS != rval)
           return rval;
@@ -978,27 +966,172 @@ namespace moab {
       return MB_SUCCESS;
     }
 
+    ErrorCode AdaptiveKDTree::best_candidate_plane( const std::vector<Plane>& candidates,
+                                                    const Range& entities,
+                                                    const CartVect& box_min,
+                                                    const CartVect& box_max,
+                                                    double eps,
+                                                    Range& best_left,
+                                                    Range& best_right,
+                                                    Range& best_both,
+                                                    AdaptiveKDTree::Plane& best_plane,
+                                                    TreeStats& stats,
+                                                    int num_threads )
+    {
+      double metric_val = std::numeric_limits<unsigned>::max();
+      const size_t p_count = entities.size();
+      const int num_cand = candidates.size();
+
+        // with several threads, test all candidates first, then choose in the same
+        // order as the serial loop
+      const bool parallel = num_threads > 1 && num_cand > 1;
+      std::vector<Range> lefts, rights, boths;
+      std::vector<double> vals;
+      if (parallel) {
+        lefts.resize( num_cand );
+        rights.resize( num_cand );
+        boths.resize( num_cand );
+        vals.resize( num_cand );
+        std::vector<TreeStats> cand_stats( num_cand );
+        std::vector<ErrorCode> rvals( num_cand, MB_SUCCESS );
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(num_threads)
+#endif
+        for (int c = 0; c < num_cand; ++c)
+          if (candidates[c].norm >= 0)
+            rvals[c] = intersect_children_with_elems( entities, candidates[c], eps,
+                                                      box_min, box_max,
+                                                      lefts[c], rights[c], boths[c],
+                                                      vals[c], cand_stats[c] );
+        for (int c = 0; c < num_cand; ++c) {
+          if (MB_SUCCESS != rvals[c])
+            return rvals[c];
+          stats.constructLeafObjectTests += cand_stats[c].constructLeafObjectTests;
+          stats.boxElemTests += cand_stats[c].boxElemTests;
+        }
+      }
+
+      for (int c = 0; c < num_cand; ++c) {
+        if (candidates[c].norm < 0)
+          continue;
+
+        Range left, right, both;
+        double val;
+        if (parallel) {
+          left.swap(lefts[c]);
+          right.swap(rights[c]);
+          both.swap(boths[c]);
+          val = vals[c];
+        }
+        else {
+          ErrorCode r = intersect_children_with_elems( entities, candidates[c], eps,
+                                                       box_min, box_max,
+                                                       left, right, both, 
+                                                       val, stats );
+          if (MB_SUCCESS != r)
+            return r;
+        }
+        const size_t d = p_count - both.size();
+        if (left.size() == d || right.size() == d)
+          continue;
+      
+        if (val >= metric_val)
+          continue;
+      
+        metric_val = val;
+        best_plane = candidates[c];
+        best_left.swap(left);
+        best_right.swap(right);
+        best_both.swap(both);
+      }
+
+      return MB_SUCCESS;
+    }
+
+    ErrorCode AdaptiveKDTree::choose_split_plane( const Range& entities,
+                                                  const CartVect& box_min,
+                                                  const CartVect& box_max,
+                                                  Range& best_left,
+                                                  Range& best_right,
+                                                  Range& best_both,
+                                                  AdaptiveKDTree::Plane& best_plane,
+                                                  std::vector<double>& tmp_data,
+                                                  std::vector<EntityHandle>& tmp_data2,
+                                                  TreeStats& stats,
+                                                  int num_threads )
+    {
+      switch (planeSet) {
+        case AdaptiveKDTree::SUBDIVISION:
+            return best_subdivision_plane( splitsPerDir, 
+                                           entities, 
+                                           box_min, 
+                                           box_max, 
+                                           best_left, 
+                                           best_right, 
+                                           best_both, 
+                                           best_plane, 
+                                           minWidth,
+                                           stats,
+                                           num_threads );
+        case AdaptiveKDTree::SUBDIVISION_SNAP:
+            return best_subdivision_snap_plane( splitsPerDir, 
+                                                entities, 
+                                                box_min, 
+                                                box_max, 
+                                                best_left, 
+                                                best_right, 
+                                                best_both, 
+                                                best_plane, 
+                                                tmp_data, 
+                                                minWidth,
+                                                stats,
+                                                num_threads );
+        case AdaptiveKDTree::VERTEX_MEDIAN:
+            return best_vertex_median_plane( splitsPerDir, 
+                                             entities, 
+                                             box_min, 
+                                             box_max, 
+                                             best_left, 
+                                             best_right, 
+                                             best_both, 
+                                             best_plane, 
+                                             tmp_data, 
+                                             minWidth,
+                                             stats,
+                                             num_threads );
+        case AdaptiveKDTree::VERTEX_SAMPLE:
+            return best_vertex_sample_plane( splitsPerDir, 
+                                             entities, 
+                                             box_min, 
+                                             box_max, 
+                                             best_left, 
+                                             best_right, 
+                                             best_both, 
+                                             best_plane, 
+                                             tmp_data, 
+                                             tmp_data2,
+                                             minWidth,
+                                             stats );
+        default:
+            return MB_FAILURE;
+      }
+    }
+
     ErrorCode AdaptiveKDTree::best_subdivision_plane( int num_planes,
-                                                             const AdaptiveKDTreeIter& iter,
+                                                             const Range& entities,
+                                                             const CartVect& box_min,
+                                                             const CartVect& box_max,
                                                              Range& best_left,
                                                              Range& best_right,
                                                              Range& best_both,
                                                              AdaptiveKDTree::Plane& best_plane,
-                                                             double eps )
+                                                             double eps,
+                                                             TreeStats& stats,
+                                                             int num_threads )
     {
-      double metric_val = std::numeric_limits<unsigned>::max();
-  
-      ErrorCode r;
-      const CartVect box_min(iter.box_min());
-      const CartVect box_max(iter.box_max());
       const CartVect diff(box_max - box_min);
   
-      Range entities;
-      r = iter.tool()->moab()->get_entities_by_handle( iter.handle(), entities );
-      if (MB_SUCCESS != r)
-        return r;
-      const size_t p_count = entities.size();
-  
+      std::vector<AdaptiveKDTree::Plane> candidates;
       for (int axis = 0; axis < 3; ++axis) {
         int plane_count = num_planes;
         if ((num_planes+1)*eps >= diff[axis])
@@ -1006,65 +1139,45 @@ namespace moab {
   
         for (int p = 1; p <= plane_count; ++p) {
           AdaptiveKDTree::Plane plane = { box_min[axis] + (p/(1.0+plane_count)) * diff[axis], axis };
-          Range left, right, both;
-          double val;
-          r = intersect_children_with_elems( entities, plane, eps,
-                                             box_min, box_max,
-                                             left, right, both, 
-                                             val );
-          if (MB_SUCCESS != r)
-            return r;
-          const size_t sdiff = p_count - both.size();
-          if (left.size() == sdiff || right.size() == sdiff)
-            continue;
-      
-          if (val >= metric_val)
-            continue;
-      
-          metric_val = val;
-          best_plane = plane;
-          best_left.swap(left);
-          best_right.swap(right);
-          best_both.swap(both);
+          candidates.push_back( plane );
         }
       }
       
-      return MB_SUCCESS;
+      return best_candidate_plane( candidates, entities, box_min, box_max, eps,
+                                   best_left, best_right, best_both, best_plane,
+                                   stats, num_threads );
     }
 
 
     ErrorCode AdaptiveKDTree::best_subdivision_snap_plane( int num_planes,
-                                                  const AdaptiveKDTreeIter& iter,
+                                                  const Range& entities,
+                                                  const CartVect& box_min,
+                                                  const CartVect& box_max,
                                                   Range& best_left,
                                                   Range& best_right,
                                                   Range& best_both,
                                                   AdaptiveKDTree::Plane& best_plane,
                                                   std::vector<double>& tmp_data,
-                                                  double eps )
+                                                  double eps,
+                                                  TreeStats& stats,
+                                                  int num_threads )
     {
-      double metric_val = std::numeric_limits<unsigned>::max();
-  
       ErrorCode r;
-      const CartVect box_min(iter.box_min());
-      const CartVect box_max(iter.box_max());
       const CartVect diff(box_max - box_min);
         //const CartVect tol(eps*diff);
   
-      Range entities, vertices;
-      r = iter.tool()->moab()->get_entities_by_handle( iter.handle(), entities );
-      if (MB_SUCCESS != r)
-        return r;
-      const size_t p_count = entities.size();
-      r = iter.tool()->moab()->get_adjacencies( entities, 0, false, vertices, Interface::UNION );
+      Range vertices;
+      r = moab()->get_adjacencies( entities, 0, false, vertices, Interface::UNION );
       if (MB_SUCCESS != r)
         return r;
 
       unsigned int nverts = vertices.size();
       tmp_data.resize( 3*nverts);
-      r = iter.tool()->moab()->get_coords( vertices, &tmp_data[0], &tmp_data[nverts], &tmp_data[2*nverts] );
+      r = moab()->get_coords( vertices, &tmp_data[0], &tmp_data[nverts], &tmp_data[2*nverts] );
       if (MB_SUCCESS != r)
         return r;
   
+      std::vector<AdaptiveKDTree::Plane> candidates;
       for (int axis = 0; axis < 3; ++axis) {
         int plane_count = num_planes;
 
@@ -1073,71 +1186,56 @@ namespace moab {
           plane_count = (int)(diff[axis] / eps) - 1;
 
         for (int p = 1; p <= plane_count; ++p) {
-
             // coord of this plane on axis
-          double coord = box_min[axis] + (p/(1.0+plane_count)) * diff[axis];
-
-            // find closest vertex coordinate to this plane position
-          unsigned int istrt = axis*nverts;
-          double closest_coord = tmp_data[istrt];
-          for (unsigned i = 1; i < nverts; ++i) 
-            if (fabs(coord-tmp_data[istrt+i]) < fabs(coord-closest_coord))
-              closest_coord = tmp_data[istrt+i];
-          if (closest_coord - box_min[axis] <= eps || box_max[axis] - closest_coord <= eps)
-            continue;
-          
-            // seprate elems into left/right/both, and compute separating metric
-          AdaptiveKDTree::Plane plane = { closest_coord, axis };
-          Range left, right, both;
-          double val;
-          r = intersect_children_with_elems( entities, plane, eps,
-                                             box_min, box_max,
-                                             left, right, both, 
-                                             val );
-          if (MB_SUCCESS != r)
-            return r;
-          const size_t d = p_count - both.size();
-          if (left.size() == d || right.size() == d)
-            continue;
-      
-          if (val >= metric_val)
-            continue;
-      
-          metric_val = val;
-          best_plane = plane;
-          best_left.swap(left);
-          best_right.swap(right);
-          best_both.swap(both);
+          AdaptiveKDTree::Plane plane = { box_min[axis] + (p/(1.0+plane_count)) * diff[axis], axis };
+          candidates.push_back( plane );
         }
       }
+
+      const int num_cand = candidates.size();
+#ifdef _OPENMP
+#pragma omp parallel for if(num_threads > 1) num_threads(num_threads)
+#endif
+      for (int c = 0; c < num_cand; ++c) {
+        AdaptiveKDTree::Plane& plane = candidates[c];
+        const int axis = plane.norm;
+
+          // find closest vertex coordinate to this plane position
+        unsigned int istrt = axis*nverts;
+        double closest_coord = tmp_data[istrt];
+        for (unsigned i = 1; i < nverts; ++i) 
+          if (fabs(plane.coord-tmp_data[istrt+i]) < fabs(plane.coord-closest_coord))
+            closest_coord = tmp_data[istrt+i];
+        plane.coord = closest_coord;
+        if (closest_coord - box_min[axis] <= eps || box_max[axis] - closest_coord <= eps)
+          plane.norm = -1;
+      }
      
-      return MB_SUCCESS;
+      return best_candidate_plane( candidates, entities, box_min, box_max, eps,
+                                   best_left, best_right, best_both, best_plane,
+                                   stats, num_threads );
     }
 
     ErrorCode AdaptiveKDTree::best_vertex_median_plane( int num_planes,
-                                               const AdaptiveKDTreeIter& iter,
+                                               const Range& entities,
+                                               const CartVect& box_min,
+                                               const CartVect& box_max,
                                                Range& best_left,
                                                Range& best_right,
                                                Range& best_both,
                                                AdaptiveKDTree::Plane& best_plane,
                                                std::vector<double>& coords,
-                                               double eps)
+                                               double eps,
+                                               TreeStats& stats,
+                                               int num_threads )
     {
-      double metric_val = std::numeric_limits<unsigned>::max();
-  
       ErrorCode r;
-      const CartVect box_min(iter.box_min());
-      const CartVect box_max(iter.box_max());
-  
-      Range entities, vertices;
-      r = iter.tool()->moab()->get_entities_by_handle( iter.handle(), entities );
-      if (MB_SUCCESS != r)
-        return r;
-      const size_t p_count = entities.size();
-      r = iter.tool()->moab()->get_adjacencies( entities, 0, false, vertices, Interface::UNION );
+      Range vertices;
+      r = moab()->get_adjacencies( entities, 0, false, vertices, Interface::UNION );
       if (MB_SUCCESS != r)
         return r;
 
+      std::vector<AdaptiveKDTree::Plane> candidates;
       coords.resize( vertices.size() );
       for (int axis = 0; axis < 3; ++axis) {
         if (box_max[axis] - box_min[axis] <= 2*eps)
@@ -1145,7 +1243,7 @@ namespace moab {
   
         double *ptrs[] = { 0, 0, 0 };
         ptrs[axis] = &coords[0];
-        r = iter.tool()->moab()->get_coords( vertices, ptrs[0], ptrs[1], ptrs[2] );
+        r = moab()->get_coords( vertices, ptrs[0], ptrs[1], ptrs[2] );
         if (MB_SUCCESS != r)
           return r;
   
@@ -1166,61 +1264,40 @@ namespace moab {
       
           citer += step;
           AdaptiveKDTree::Plane plane = { *citer, axis };
-          Range left, right, both;
-          double val;
-          r = intersect_children_with_elems( entities, plane, eps,
-                                             box_min, box_max,
-                                             left, right, both, 
-                                             val );
-          if (MB_SUCCESS != r)
-            return r;
-          const size_t diff = p_count - both.size();
-          if (left.size() == diff || right.size() == diff)
-            continue;
-      
-          if (val >= metric_val)
-            continue;
-      
-          metric_val = val;
-          best_plane = plane;
-          best_left.swap(left);
-          best_right.swap(right);
-          best_both.swap(both);
+          candidates.push_back( plane );
         }
       }
       
-      return MB_SUCCESS;
+      return best_candidate_plane( candidates, entities, box_min, box_max, eps,
+                                   best_left, best_right, best_both, best_plane,
+                                   stats, num_threads );
     }
 
 
     ErrorCode AdaptiveKDTree::best_vertex_sample_plane( int num_planes,
-                                               const AdaptiveKDTreeIter& iter,
+                                               const Range& entities,
+                                               const CartVect& box_min,
+                                               const CartVect& box_max,
                                                Range& best_left,
                                                Range& best_right,
                                                Range& best_both,
                                                AdaptiveKDTree::Plane& best_plane,
                                                std::vector<double>& coords,
                                                std::vector<EntityHandle>& indices,
-                                               double eps )
+                                               double eps,
+                                               TreeStats& stats )
     {
       const size_t random_elem_threshold = 20*num_planes;
-      double metric_val = std::numeric_limits<unsigned>::max();
   
       ErrorCode r;
-      const CartVect box_min(iter.box_min());
-      const CartVect box_max(iter.box_max());
-  
-      Range entities, vertices;
-      r = iter.tool()->moab()->get_entities_by_handle( iter.handle(), entities );
-      if (MB_SUCCESS != r)
-        return r;
+      Range vertices;
     
         // We are selecting random vertex coordinates to use for candidate split
         // planes.  So if element list is large, begin by selecting random elements.
       const size_t p_count = entities.size();
       coords.resize( 3*num_planes );
       if (p_count < random_elem_threshold) {
-        r = iter.tool()->moab()->get_adjacencies( entities, 0, false, vertices, Interface::UNION );
+        r = moab()->get_adjacencies( entities, 0, false, vertices, Interface::UNION );
         if (MB_SUCCESS != r)
           return r;
       }
@@ -1234,11 +1311,12 @@ namespace moab {
           rnd %= p_count;
           indices[j] = entities[rnd];
         }
-        r = iter.tool()->moab()->get_adjacencies( &indices[0], random_elem_threshold, 0, false, vertices, Interface::UNION );
+        r = moab()->get_adjacencies( &indices[0], random_elem_threshold, 0, false, vertices, Interface::UNION );
         if (MB_SUCCESS != r)
           return r;
       }
 
+      std::vector<AdaptiveKDTree::Plane> candidates;
       coords.resize( vertices.size() );
       for (int axis = 0; axis < 3; ++axis) {
         if (box_max[axis] - box_min[axis] <= 2*eps)
@@ -1246,7 +1324,7 @@ namespace moab {
   
         double *ptrs[] = { 0, 0, 0 };
         ptrs[axis] = &coords[0];
-        r = iter.tool()->moab()->get_coords( vertices, ptrs[0], ptrs[1], ptrs[2] );
+        r = moab()->get_coords( vertices, ptrs[0], ptrs[1], ptrs[2] );
         if (MB_SUCCESS != r)
           return r;
       
@@ -1279,34 +1357,168 @@ namespace moab {
         }
   
         for (unsigned p = 0; p < indices.size(); ++p) {
-      
           AdaptiveKDTree::Plane plane = { coords[indices[p]], axis };
-          Range left, right, both;
-          double val;
-          r = intersect_children_with_elems( entities, plane, eps,
-                                             box_min, box_max,
-                                             left, right, both, 
-                                             val );
-          if (MB_SUCCESS != r)
-            return r;
-          const size_t diff = p_count - both.size();
-          if (left.size() == diff || right.size() == diff)
-            continue;
-      
-          if (val >= metric_val)
-            continue;
-      
-          metric_val = val;
-          best_plane = plane;
-          best_left.swap(left);
-          best_right.swap(right);
-          best_both.swap(both);
+          candidates.push_back( plane );
         }
       }
       
+        // candidates are drawn from rand(), so are always tested serially
+      return best_candidate_plane( candidates, entities, box_min, box_max, eps,
+                                   best_left, best_right, best_both, best_plane,
+                                   stats, 1 );
+    }
+
+    struct AdaptiveKDTree::BuildNode {
+      BuildNode() : depth(0), child(0) { plane.coord = HUGE_VAL; plane.norm = -1; }
+      Range entities;       //!< entities of a leaf, empty once split
+      CartVect boxMin, boxMax;
+      Plane plane;          //!< split plane, norm is -1 for leaves
+      unsigned depth;       //!< root is at depth of 1
+      size_t child;         //!< index of left child, right child is at child+1
+    };
+
+    ErrorCode AdaptiveKDTree::split_build_node( std::deque<BuildNode>& nodes,
+                                                size_t index,
+                                                std::vector<double>& tmp_data,
+                                                std::vector<EntityHandle>& tmp_data2,
+                                                TreeStats& stats,
+                                                int num_threads )
+    {
+      Range best_left, best_right, best_both;
+      Plane best_plane = { HUGE_VAL, -1 };
+      BuildNode& node = nodes[index];
+      if ((int)node.entities.size() > maxPerLeaf && (int)node.depth < maxDepth) {
+        ErrorCode rval = choose_split_plane( node.entities, node.boxMin, node.boxMax,
+                                             best_left, best_right, best_both, best_plane,
+                                             tmp_data, tmp_data2, stats, num_threads );
+        if (MB_SUCCESS != rval)
+          return rval;
+      }
+      node.plane = best_plane;
+      if (best_plane.norm < 0)
+        return MB_SUCCESS;
+
+        // nodes is a deque, so node stays valid as the children are appended
+      best_left.merge( best_both );
+      best_right.merge( best_both );
+      node.child = nodes.size();
+      nodes.resize( node.child + 2 );
+      BuildNode &left = nodes[node.child], &right = nodes[node.child + 1];
+      left.depth = right.depth = node.depth + 1;
+      left.boxMin = right.boxMin = node.boxMin;
+      left.boxMax = right.boxMax = node.boxMax;
+      left.boxMax[best_plane.norm] = right.boxMin[best_plane.norm] = best_plane.coord;
+      left.entities.swap( best_left );
+      right.entities.swap( best_right );
+      node.entities.clear();
       return MB_SUCCESS;
     }
 
+    ErrorCode AdaptiveKDTree::parallel_build_tree( EntityHandle root,
+                                                   const Range& entities,
+                                                   const BoundBox& box )
+    {
+        // choose all split planes with the instance frozen, so that it may be queried
+        // from several threads
+      Core* core = dynamic_cast<Core*>(moab());
+      if (!core || core->is_frozen())
+        MB_SET_ERR(MB_FAILURE, "Parallel build requires a Core instance that is not frozen");
+      ErrorCode rval = core->freeze();
+      if (MB_SUCCESS != rval)
+        return rval;
+
+      std::deque<BuildNode> top_nodes(1);
+      top_nodes[0].entities = entities;
+      top_nodes[0].boxMin = box.bMin;
+      top_nodes[0].boxMax = box.bMax;
+      top_nodes[0].depth = 1;
+
+        // split the top levels breadth-first, testing the candidate planes of each
+        // node in parallel, until there are about 4 unsplit nodes per thread
+      std::vector<double> tmp_data;
+      std::vector<EntityHandle> tmp_data2;
+      size_t next = 0;
+      while (MB_SUCCESS == rval && next < top_nodes.size() &&
+             top_nodes.size() - next < 4 * (size_t)numThreads)
+        rval = split_build_node( top_nodes, next++, tmp_data, tmp_data2, treeStats, numThreads );
+
+        // split the remaining nodes as independent subtrees
+      const int num_subtrees = MB_SUCCESS == rval ? top_nodes.size() - next : 0;
+      std::vector< std::deque<BuildNode> > subtrees( num_subtrees );
+      std::vector<TreeStats> sub_stats( num_subtrees );
+      std::vector<ErrorCode> sub_rvals( num_subtrees, MB_SUCCESS );
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(numThreads)
+#endif
+      for (int i = 0; i < num_subtrees; ++i) {
+        std::deque<BuildNode>& nodes = subtrees[i];
+        nodes.resize( 1 );
+        BuildNode& top = top_nodes[next + i];
+        nodes[0].entities.swap( top.entities );
+        nodes[0].boxMin = top.boxMin;
+        nodes[0].boxMax = top.boxMax;
+        nodes[0].depth = top.depth;
+        std::vector<double> sub_tmp_data;
+        std::vector<EntityHandle> sub_tmp_data2;
+        for (size_t j = 0; j < nodes.size() && MB_SUCCESS == sub_rvals[i]; ++j)
+          sub_rvals[i] = split_build_node( nodes, j, sub_tmp_data, sub_tmp_data2, sub_stats[i], 1 );
+      }
+
+      core->unfreeze();
+      if (MB_SUCCESS != rval)
+        return rval;
+      for (int i = 0; i < num_subtrees; ++i) {
+        if (MB_SUCCESS != sub_rvals[i])
+          return sub_rvals[i];
+        treeStats.constructLeafObjectTests += sub_stats[i].constructLeafObjectTests;
+        treeStats.boxElemTests += sub_stats[i].boxElemTests;
+      }
+
+        // create the tree sets in the order the serial build creates them
+      std::vector<int> subtree_of( top_nodes.size(), -1 );
+      for (int i = 0; i < num_subtrees; ++i)
+        subtree_of[next + i] = i;
+      rval = moab()->clear_meshset( &root, 1 );
+      if (MB_SUCCESS != rval)
+        return rval;
+      return create_build_sets( top_nodes, 0, root, &subtrees, &subtree_of );
+    }
+
+    ErrorCode AdaptiveKDTree::create_build_sets( std::deque<BuildNode>& nodes,
+                                                 size_t index,
+                                                 EntityHandle handle,
+                                                 std::vector< std::deque<BuildNode> >* subtrees,
+                                                 const std::vector<int>* subtree_of )
+    {
+      if (subtree_of && (*subtree_of)[index] >= 0) {
+        std::deque<BuildNode>& sub = (*subtrees)[(*subtree_of)[index]];
+        ErrorCode rval = create_build_sets( sub, 0, handle );
+        std::deque<BuildNode>().swap( sub );
+        return rval;
+      }
+
+      const BuildNode& node = nodes[index];
+      if (node.plane.norm < 0)
+        return moab()->add_entities( handle, node.entities );
+
+      EntityHandle left, right;
+      ErrorCode rval = moab()->create_meshset( meshsetFlags, left );
+      if (MB_SUCCESS != rval)
+        return rval;
+      rval = moab()->create_meshset( meshsetFlags, right );
+      if (MB_SUCCESS != rval)
+        return rval;
+      if (MB_SUCCESS != set_split_plane( handle, node.plane ) ||
+          MB_SUCCESS != moab()->add_child_meshset( handle, left ) ||
+          MB_SUCCESS != moab()->add_child_meshset( handle, right ))
+        return MB_FAILURE;
+
+      rval = create_build_sets( nodes, node.child, left, subtrees, subtree_of );
+      if (MB_SUCCESS != rval)
+        return rval;
+      return create_build_sets( nodes, node.child + 1, right, subtrees, subtree_of );
+    }
+
     ErrorCode AdaptiveKDTree::point_search(const double *point,
                                            EntityHandle& leaf_out,
                                            const double iter_tol,
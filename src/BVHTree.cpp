@@ -4,6 +4,8 @@
 #include "moab/ReadUtilIface.hpp"
 #include "moab/CpuTimer.hpp"
 
+#include <cmath>
+
 namespace moab 
 {
     const char *BVHTree::treeName = "BVHTree";
@@ -57,8 +59,13 @@ namespace moab
         //We only build nonempty trees
       if(!handle_data_vec.empty()){ 
           //initially all bits are set
-        tree_nodes.push_back(Node());
-        const int depth = local_build_tree(tree_nodes, handle_data_vec.begin(), handle_data_vec.end(), 0, boundBox);
+        int depth;
+        if (numThreads > 1)
+          depth = parallel_build_tree(tree_nodes, handle_data_vec, boundBox);
+        else {
+          tree_nodes.push_back(Node());
+          depth = local_build_tree(tree_nodes, handle_data_vec.begin(), handle_data_vec.end(), 0, boundBox);
+        }
 #ifndef NDEBUG
         std::set<EntityHandle> entity_handles;
         for(std::vector<Node>::iterator n = tree_nodes.begin(); n != tree_nodes.end(); ++n) {
@@ -142,9 +149,9 @@ namespace moab
       return MB_SUCCESS;
     }
     
-    void BVHTree::establish_buckets(HandleDataVec::const_iterator begin, 
-                                    HandleDataVec::const_iterator end, 
-                                    const BoundBox &interval, std::vector<std::vector<Bucket> > &buckets) const 
+    void BVHTree::bin_elements(HandleDataVec::const_iterator begin, 
+                               HandleDataVec::const_iterator end, 
+                               const BoundBox &interval, std::vector<std::vector<Bucket> > &buckets) const 
     {
         //put each element into its bucket
       for(HandleDataVec::const_iterator i = begin; i != end; ++i){
@@ -160,6 +167,40 @@ namespace moab
           bucket.mySize++;
         }
       }
+    }
+
+    void BVHTree::establish_buckets(HandleDataVec::const_iterator begin, 
+                                    HandleDataVec::const_iterator end, 
+                                    const BoundBox &interval, std::vector<std::vector<Bucket> > &buckets,
+                                    int num_threads) const 
+    {
+      if (num_threads > 1) {
+          // bin one chunk of the elements per thread, then merge the buckets; bucket
+          // boxes are unions, so the result does not depend on the number of chunks
+        const long count = std::distance(begin, end);
+        std::vector<std::vector<std::vector<Bucket> > > chunk_buckets(num_threads, buckets);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+        for (int t = 0; t < num_threads; ++t)
+          bin_elements(begin + count*t/num_threads, begin + count*(t+1)/num_threads,
+                       interval, chunk_buckets[t]);
+        for (int t = 0; t < num_threads; ++t)
+          for (unsigned int dim = 0; dim < 3; ++dim)
+            for (unsigned int j = 0; j < buckets[dim].size(); ++j) {
+              const Bucket &from = chunk_buckets[t][dim][j];
+              Bucket &bucket = buckets[dim][j];
+              if (0 == from.mySize)
+                continue;
+              if (bucket.mySize > 0)
+                bucket.boundingBox.update(from.boundingBox);
+              else
+                bucket.boundingBox = from.boundingBox;
+              bucket.mySize += from.mySize;
+            }
+      }
+      else
+        bin_elements(begin, end, interval, buckets);
 
 #ifndef NDEBUG
       BoundBox elt_union = begin->myBox;
@@ -256,6 +297,24 @@ namespace moab
       }
     }
 
+    void BVHTree::order_elements(HandleDataVec::iterator &begin, 
+                                 HandleDataVec::iterator &end, 
+                                 SplitData &data,
+                                 int num_threads) const  
+    {
+      const long count = std::distance(begin, end);
+#ifdef _OPENMP
+#pragma omp parallel for if(num_threads > 1) num_threads(num_threads)
+#endif
+      for(long j = 0; j < count; ++j) 
+      {
+        HandleDataVec::iterator i = begin + j;
+        const int index = Bucket::bucket_index(splitsPerDir, i->myBox, data.boundingBox, data.dim);
+        i->myDim = (index<=data.split)?0:1;
+      }
+      std::sort(begin, end, HandleData_comparator());
+    }
+
     void BVHTree::median_order(HandleDataVec::iterator &begin, 
                                HandleDataVec::iterator &end, 
                                SplitData &data) const
@@ -299,18 +358,19 @@ namespace moab
 
     void BVHTree::find_split(HandleDataVec::iterator &begin, 
                              HandleDataVec::iterator &end,
-                             SplitData &data) const
+                             SplitData &data,
+                             int num_threads) const
     {
       std::vector<std::vector<Bucket> > buckets(3, std::vector<Bucket>(splitsPerDir+1) );
       std::vector<std::vector<SplitData> > splits(3, std::vector<SplitData>(splitsPerDir, data));
 	
       const BoundBox interval = data.boundingBox;
-      establish_buckets(begin, end, interval, buckets);
+      establish_buckets(begin, end, interval, buckets, num_threads);
       initialize_splits(splits, buckets, data);
       choose_best_split(splits, data);
       const bool use_median = (0 == data.nl) || (data.nr == 0);
       if (!use_median)
-        order_elements(begin, end, data);
+        order_elements(begin, end, data, num_threads);
       else
         median_order(begin, end, data);
 
@@ -397,8 +457,14 @@ namespace moab
     int BVHTree::local_build_tree(std::vector<Node> &tree_nodes,
                                   HandleDataVec::iterator begin, 
                                   HandleDataVec::iterator end,
-                                  const int index, const BoundBox &box, const int depth)
+                                  const int index, const BoundBox &box, const int depth,
+                                  std::vector<Subtree> *subtrees, const int subtree_depth)
     {
+      if (subtrees && depth == subtree_depth) {
+        subtrees->push_back(Subtree(begin, end, index, box, depth));
+        return depth;
+      }
+
 #ifndef NDEBUG
       for(HandleDataVec::const_iterator i = begin; i != end; ++i) {
         if(!box.intersects_box(i->myBox, 0)) {
@@ -416,16 +482,16 @@ namespace moab
       if((int)total_num_elements > maxPerLeaf && depth < maxDepth){
         SplitData data;
         data.boundingBox = box;
-        find_split(begin, end, data);
+        find_split(begin, end, data, subtrees ? numThreads : 1);
           //assign data to node
         tree_nodes[index].Lmax = data.Lmax; tree_nodes[index].Rmin = data.Rmin;
         tree_nodes[index].dim = data.dim; tree_nodes[index].child = tree_nodes.size();
           //insert left, right children;
         tree_nodes.push_back(Node()); tree_nodes.push_back(Node());
         const int left_depth = local_build_tree(tree_nodes, begin, begin+data.nl, tree_nodes[index].child, 
-                                                data.leftBox, depth+1);
+                                                data.leftBox, depth+1, subtrees, subtree_depth);
         const int right_depth = local_build_tree(tree_nodes, begin+data.nl, end, tree_nodes[index].child+1, 
-                                                 data.rightBox, depth+1);
+                                                 data.rightBox, depth+1, subtrees, subtree_depth);
         return std::max(left_depth, right_depth);
       }
 
@@ -434,6 +500,67 @@ namespace moab
       return depth;
     }
 
+    int BVHTree::parallel_build_tree(std::vector<Node> &tree_nodes,
+                                     HandleDataVec &handle_data_vec,
+                                     const BoundBox &box)
+    {
+        // split the top levels with all threads binning the elements, down to the depth
+        // with about 4 subtrees per thread, so that dynamic scheduling balances the load
+      const int subtree_depth = (int)std::ceil(std::log(4.0*numThreads)/std::log(2.0));
+      std::vector<Node> top_nodes(1);
+      std::vector<Subtree> subtrees;
+      int depth = local_build_tree(top_nodes, handle_data_vec.begin(), handle_data_vec.end(), 0, box,
+                                   0, &subtrees, subtree_depth);
+
+        // build the subtrees independently, each in its own node list
+      const int num_subtrees = subtrees.size();
+      std::vector<int> subtree_depths(num_subtrees);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(numThreads)
+#endif
+      for (int i = 0; i < num_subtrees; ++i) {
+        Subtree &sub = subtrees[i];
+        sub.nodes.push_back(Node());
+        subtree_depths[i] = local_build_tree(sub.nodes, sub.begin, sub.end, 0, sub.box, sub.depth);
+      }
+
+        // renumber the nodes in the order local_build_tree would have created them
+      std::vector<int> subtree_of(top_nodes.size(), -1);
+      for (int i = 0; i < num_subtrees; ++i) {
+        subtree_of[subtrees[i].node] = i;
+        depth = std::max(depth, subtree_depths[i]);
+      }
+      tree_nodes.push_back(Node());
+      move_subtree(top_nodes, 0, tree_nodes, 0, &subtrees, &subtree_of);
+      return depth;
+    }
+
+    void BVHTree::move_subtree(std::vector<Node> &src, unsigned int src_index,
+                               std::vector<Node> &dest, unsigned int dest_index,
+                               std::vector<Subtree> *subtrees,
+                               const std::vector<int> *subtree_of)
+    {
+      if (subtree_of && (*subtree_of)[src_index] >= 0) {
+        Subtree &sub = (*subtrees)[(*subtree_of)[src_index]];
+        move_subtree(sub.nodes, 0, dest, dest_index);
+        std::vector<Node>().swap(sub.nodes);
+        return;
+      }
+
+      Node &node = src[src_index];
+      dest[dest_index].dim = node.dim;
+      dest[dest_index].Lmax = node.Lmax; dest[dest_index].Rmin = node.Rmin;
+      dest[dest_index].box = node.box;
+      dest[dest_index].entities.swap(node.entities);
+      if (node.dim != 3) {
+        const unsigned int child = dest.size();
+        dest[dest_index].child = child;
+        dest.push_back(Node()); dest.push_back(Node());
+        move_subtree(src, node.child, dest, child, subtrees, subtree_of);
+        move_subtree(src, node.child+1, dest, child+1, subtrees, subtree_of);
+      }
+    }
+
     ErrorCode BVHTree::find_point(const std::vector<double> &point, 
                                   const unsigned int &index,
                                   const double iter_tol,
@@ -0,0 +1,197 @@
+/**
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include "moab/BackgroundWriter.hpp"
+#include "moab/Interface.hpp"
+#include "moab/FileOptions.hpp"
+#include "moab/Range.hpp"
+#include "moab/Error.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdio.h>
+
+#ifdef MOAB_HAVE_HDF5
+#include "WriteHDF5.hpp"
+#endif
+
+#if defined(MOAB_HAVE_HDF5) && defined(MOAB_HAVE_PTHREAD)
+#include <pthread.h>
+#define MOAB_BACKGROUND_WRITE
+#endif
+
+namespace moab {
+
+struct BackgroundWriter::Job
+{
+  std::string fileName;
+  std::vector<char> image;
+  ErrorCode result;
+#ifdef MOAB_BACKGROUND_WRITE
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  bool done;
+#endif
+};
+
+BackgroundWriter::BackgroundWriter( Interface* iface )
+  : mbImpl(iface), pendingJob(0), lastResult(MB_SUCCESS)
+{}
+
+BackgroundWriter::~BackgroundWriter()
+{
+  wait();
+}
+
+void* BackgroundWriter::write_job( void* ptr )
+{
+  Job* job = reinterpret_cast<Job*>(ptr);
+  ErrorCode rval = MB_SUCCESS;
+  FILE* file = fopen( job->fileName.c_str(), "wb" );
+  if (!file)
+    rval = MB_FILE_WRITE_ERROR;
+  else {
+    if (!job->image.empty() &&
+        fwrite( &job->image[0], 1, job->image.size(), file ) != job->image.size())
+      rval = MB_FILE_WRITE_ERROR;
+    if (fclose( file ))
+      rval = MB_FILE_WRITE_ERROR;
+    if (MB_SUCCESS != rval)
+      remove( job->fileName.c_str() );
+  }
+
+    // release image memory as soon as possible
+  std::vector<char> empty;
+  job->image.swap( empty );
+
+#ifdef MOAB_BACKGROUND_WRITE
+  pthread_mutex_lock( &job->mutex );
+  job->result = rval;
+  job->done = true;
+  pthread_mutex_unlock( &job->mutex );
+#else
+  job->result = rval;
+#endif
+  return 0;
+}
+
+ErrorCode BackgroundWriter::write_file( const char* file_name,
+                                        const char* options,
+                                        const EntityHandle* output_sets,
+                                        int num_output_sets,
+                                        const Tag* tag_list,
+                                        int num_tags )
+{
+  wait();
+  lastResult = MB_SUCCESS;
+
+  FileOptions opts( options );
+  std::string junk;
+  if (MB_ENTITY_NOT_FOUND != opts.get_option( "PARALLEL", junk )) {
+    MB_SET_ERR(MB_NOT_IMPLEMENTED, "Parallel writes are not supported by BackgroundWriter");
+  }
+
+#ifndef MOAB_BACKGROUND_WRITE
+    // synchronous write, result is reported both here and from wait()
+  lastResult = mbImpl->write_file( file_name, "MOAB", options, output_sets,
+                                   num_output_sets, tag_list, num_tags );
+  return lastResult;
+#else
+  ErrorCode rval = opts.get_null_option( "CREATE" );
+  if (MB_TYPE_OUT_OF_RANGE == rval) {
+    MB_SET_ERR(MB_FAILURE, "Unexpected value for CREATE option");
+  }
+  const bool overwrite = (MB_ENTITY_NOT_FOUND == rval);
+  if (!overwrite) {
+    FILE* file = fopen( file_name, "r" );
+    if (file) {
+      fclose( file );
+      MB_SET_ERR(MB_FILE_WRITE_ERROR, "File \"" << file_name << "\" exists");
+    }
+  }
+
+    // sort and remove duplicate sets, as Interface::write_file does
+  Range set_range;
+  std::copy( output_sets, output_sets+num_output_sets, range_inserter(set_range) );
+  std::vector<EntityHandle> set_list( set_range.begin(), set_range.end() );
+
+  Job* job = new Job;
+  job->fileName = file_name;
+  job->result = MB_SUCCESS;
+  job->done = false;
+
+    // write file image in this thread
+  WriteHDF5 writer( mbImpl );
+  writer.set_file_image( &job->image );
+  std::vector<std::string> qa_records;
+  rval = writer.write_file( file_name, overwrite, opts,
+                            set_list.empty() ? 0 : &set_list[0], set_list.size(),
+                            qa_records, tag_list, num_tags );
+  if (MB_SUCCESS == rval && !opts.all_seen()) {
+    std::string bad_opt;
+    opts.get_unseen_option( bad_opt );
+    delete job;
+    MB_SET_ERR(MB_UNHANDLED_OPTION, "Unrecognized option: \"" << bad_opt << "\"");
+  }
+  if (MB_SUCCESS != rval) {
+    delete job;
+    MB_SET_ERR(rval, "Failed to write file image for \"" << file_name << "\"");
+  }
+
+    // write image to disk in background thread
+  pthread_mutex_init( &job->mutex, 0 );
+  if (pthread_create( &job->thread, 0, &BackgroundWriter::write_job, job )) {
+      // could not start thread: write image now
+    write_job( job );
+    lastResult = job->result;
+    pthread_mutex_destroy( &job->mutex );
+    delete job;
+    return lastResult;
+  }
+  pendingJob = job;
+#endif
+
+  return MB_SUCCESS;
+}
+
+bool BackgroundWriter::is_done()
+{
+  if (!pendingJob)
+    return true;
+#ifdef MOAB_BACKGROUND_WRITE
+  pthread_mutex_lock( &pendingJob->mutex );
+  bool result = pendingJob->done;
+  pthread_mutex_unlock( &pendingJob->mutex );
+  return result;
+#else
+  return true;
+#endif
+}
+
+ErrorCode BackgroundWriter::wait()
+{
+  if (!pendingJob)
+    return lastResult;
+#ifdef MOAB_BACKGROUND_WRITE
+  pthread_join( pendingJob->thread, 0 );
+  pthread_mutex_destroy( &pendingJob->mutex );
+#endif
+  lastResult = pendingJob->result;
+  delete pendingJob;
+  pendingJob = 0;
+  return lastResult;
+}
+
+} // namespace moab
@@ -256,6 +256,7 @@ ErrorCode Core::initialize()
   dirichletBCTag   = 0;
   geomDimensionTag = 0;
   globalIdTag      = 0;
+  meshFrozen       = false;
 
   sequenceManager = new (std::nothrow) SequenceManager;
   if (!sequenceManager)
@@ -1010,6 +1011,114 @@ ErrorCode Core::get_coords( const Range& entities,
   return rval;
 }
 
+  // Find vertex sequence containing handle and get coordinate arrays for it
+static inline ErrorCode get_vertex_arrays( const SequenceManager* seq_man,
+                                           EntityHandle vertex,
+                                           EntityHandle& start,
+                                           EntityHandle& end,
+                                           const double*& x,
+                                           const double*& y,
+                                           const double*& z )
+{
+  const EntitySequence* seq;
+  if (TYPE_FROM_HANDLE(vertex) != MBVERTEX || MB_SUCCESS != seq_man->find( vertex, seq ))
+    return MB_ENTITY_NOT_FOUND;
+  start = seq->start_handle();
+  end = seq->end_handle();
+  return static_cast<const VertexSequence*>(seq)->get_coordinate_arrays( x, y, z );
+}
+
+ErrorCode Core::get_element_coords( const Range& elements,
+                                    int nodes_per_elem,
+                                    double* x_coords,
+                                    double* y_coords,
+                                    double* z_coords,
+                                    EntityHandle* connect ) const
+{
+  const size_t num_elem = elements.size();
+  const double *vx = 0, *vy = 0, *vz = 0;
+  EntityHandle vstart = 1, vend = 0; // current vertex sequence
+  std::vector<EntityHandle> storage;
+  ErrorCode rval;
+
+  size_t j = 0; // position of element in 'elements'
+  for (Range::const_pair_iterator p = elements.const_pair_begin(); p != elements.const_pair_end(); ++p) {
+    EntityHandle h = p->first;
+    while (h <= p->second) {
+      const EntityType type = TYPE_FROM_HANDLE(h);
+      if (MBVERTEX == type || type >= MBPOLYHEDRON)
+        MB_SET_ERR(MB_TYPE_OUT_OF_RANGE, "Cannot get element coordinates for " << CN::EntityTypeName(type));
+      const EntitySequence* seq;
+      rval = sequence_manager()->find( h, seq );
+      if (MB_SUCCESS != rval)
+        return MB_ENTITY_NOT_FOUND;
+      const ElementSequence* eseq = static_cast<const ElementSequence*>(seq);
+      const int conn_len = eseq->nodes_per_element();
+      if (conn_len < nodes_per_elem)
+        MB_SET_ERR(MB_INDEX_OUT_OF_RANGE, "Element has fewer than " << nodes_per_elem << " vertices");
+      const EntityHandle last = std::min( p->second, seq->end_handle() );
+      const size_t count = last - h + 1;
+
+        // If the connectivity of the block of elements is stored 
+        // explicitly and all vertices are in one sequence, do a plain
+        // gather with no further checks or lookups.
+      const EntityHandle* conn = eseq->get_connectivity_array();
+      if (conn) {
+        conn += conn_len * (h - seq->start_handle());
+        EntityHandle min_vtx = conn[0], max_vtx = conn[0];
+        for (size_t k = 0; k < count; ++k) {
+          for (int i = 0; i < nodes_per_elem; ++i) {
+            min_vtx = std::min( min_vtx, conn[k*conn_len + i] );
+            max_vtx = std::max( max_vtx, conn[k*conn_len + i] );
+          }
+        }
+        if (min_vtx < vstart || max_vtx > vend) {
+          rval = get_vertex_arrays( sequence_manager(), min_vtx, vstart, vend, vx, vy, vz );MB_CHK_ERR(rval);
+        }
+        if (max_vtx <= vend) {
+          for (int i = 0; i < nodes_per_elem; ++i) {
+            const EntityHandle* col = conn + i;
+            const size_t out = i*num_elem + j;
+            for (size_t k = 0; k < count; ++k) {
+              const EntityID offset = col[k*conn_len] - vstart;
+              x_coords[out + k] = vx[offset];
+              y_coords[out + k] = vy[offset];
+              z_coords[out + k] = vz[offset];
+            }
+            if (connect)
+              for (size_t k = 0; k < count; ++k)
+                connect[out + k] = col[k*conn_len];
+          }
+          j += count;
+          h = last + 1;
+          continue;
+        }
+      }
+
+        // Otherwise check the vertex sequence for every vertex
+      for (; h <= last; ++h, ++j) {
+        const EntityHandle* elem_conn;
+        int len;
+        rval = eseq->get_connectivity( h, elem_conn, len, false, &storage );MB_CHK_ERR(rval);
+        for (int i = 0; i < nodes_per_elem; ++i) {
+          const EntityHandle v = elem_conn[i];
+          if (v < vstart || v > vend) {
+            rval = get_vertex_arrays( sequence_manager(), v, vstart, vend, vx, vy, vz );MB_CHK_ERR(rval);
+          }
+          const size_t out = i*num_elem + j;
+          x_coords[out] = vx[v - vstart];
+          y_coords[out] = vy[v - vstart];
+          z_coords[out] = vz[v - vstart];
+          if (connect)
+            connect[out] = v;
+        }
+      }
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
 ErrorCode  Core::get_coords(const EntityHandle* entities,
                                   const int num_entities,
                                   double *coords) const
@@ -1019,6 +1128,8 @@ ErrorCode  Core::get_coords(const EntityHandle* entities,
   const EntityHandle* const end = entities + num_entities;
   const EntityHandle* iter = entities;
   ErrorCode status = MB_SUCCESS;
+  std::vector<EntityHandle> dum_conn;
+  std::vector<double> dum_pos;
 
   while (iter != end) {
     if (TYPE_FROM_HANDLE(*iter) == MBVERTEX) {
@@ -1035,11 +1146,10 @@ ErrorCode  Core::get_coords(const EntityHandle* entities,
       vseq->get_coordinates( *iter, coords );
     }
     else {
-      static std::vector<EntityHandle> dum_conn(CN::MAX_NODES_PER_ELEMENT);
-      static std::vector<double> dum_pos(3*CN::MAX_NODES_PER_ELEMENT);
-      static const EntityHandle *conn;
-      static int num_conn;
+      const EntityHandle *conn;
+      int num_conn;
       status = get_connectivity(*iter, conn, num_conn, false, &dum_conn);MB_CHK_ERR(status);
+      dum_pos.resize(3*num_conn);
       status = get_coords(conn, num_conn, &dum_pos[0]);MB_CHK_ERR(status);
       coords[0] = coords[1] = coords[2] = 0.0;
       for (int i = 0; i < num_conn; i++) {
@@ -1086,6 +1196,8 @@ ErrorCode  Core::set_coords( const EntityHandle *entity_handles,
                                  const int num_entities,
                                  const double *coords)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
 
   ErrorCode status = MB_SUCCESS;
 
@@ -1114,6 +1226,8 @@ ErrorCode  Core::set_coords( const EntityHandle *entity_handles,
 //! otherwise, return an error
 ErrorCode  Core::set_coords(Range entity_handles, const double *coords)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
 
   ErrorCode status = MB_SUCCESS;
 
@@ -1246,6 +1360,9 @@ ErrorCode  Core::set_connectivity(const EntityHandle entity_handle,
                                       EntityHandle *connect,
                                       const int num_connect)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   ErrorCode status = MB_FAILURE;
 
     // Make sure the entity should have a connectivity.
@@ -1526,6 +1643,8 @@ ErrorCode Core::get_adjacencies( const EntityHandle *from_entities,
                                      std::vector<EntityHandle> &adj_entities,
                                      const int operation_type)
 {
+  if (create_if_missing && meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot create adjacent entities in frozen mesh");
 
 #ifdef MOAB_HAVE_AHF
     bool can_handle = true;
@@ -1621,6 +1740,8 @@ ErrorCode Core::get_adjacencies( const EntityHandle *from_entities,
                                      Range &adj_entities,
                                      const int operation_type )
 {
+    if (create_if_missing && meshFrozen)
+      MB_SET_ERR(MB_FAILURE, "Cannot create adjacent entities in frozen mesh");
     if (operation_type == Interface::INTERSECT)
         return get_adjacencies_intersection( this, from_entities, from_entities + num_entities,
                                              to_dimension, create_if_missing, adj_entities );
@@ -1754,6 +1875,8 @@ ErrorCode Core::get_adjacencies(const Range &from_entities,
                                       Range &adj_entities,
                                       const int operation_type)
 {
+  if (create_if_missing && meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot create adjacent entities in frozen mesh");
   if (operation_type == Interface::INTERSECT)
     return get_adjacencies_intersection( this, from_entities.begin(), from_entities.end(),
                                          to_dimension, create_if_missing, adj_entities );
@@ -1772,6 +1895,9 @@ ErrorCode Core::add_adjacencies(const EntityHandle entity_handle,
                                     const int num_handles,
                                     bool both_ways)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   ErrorCode result = MB_SUCCESS;
 
   for (const EntityHandle *it = adjacencies;
@@ -1786,6 +1912,9 @@ ErrorCode Core::add_adjacencies(const EntityHandle entity_handle,
                                     Range &adjacencies,
                                     bool both_ways)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   ErrorCode result = MB_SUCCESS;
 
   for (Range::iterator rit = adjacencies.begin(); rit != adjacencies.end(); ++rit) {
@@ -1799,6 +1928,9 @@ ErrorCode Core::remove_adjacencies(const EntityHandle entity_handle,
                                        const EntityHandle *adjacencies,
                                        const int num_handles)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   ErrorCode result = MB_SUCCESS;
 
   for (const EntityHandle *it = adjacencies;
@@ -1830,6 +1962,9 @@ ErrorCode Core::adjacencies_iterate(Range::const_iterator iter,
   if (!seq || rval != MB_SUCCESS)
     return MB_ENTITY_NOT_FOUND;
 
+  if (meshFrozen && seq->data()->get_compact_adjacency_offsets())
+    MB_SET_ERR(MB_FAILURE, "Cannot expand compact adjacencies in frozen mesh");
+  rval = aEntityFactory->expand_compact_adjacencies( seq->data() );MB_CHK_ERR(rval);
   adjs_ptr = const_cast<const std::vector<EntityHandle>**>(seq->data()->get_adjacency_data());
   if (!adjs_ptr)
     return rval;
@@ -1843,6 +1978,38 @@ ErrorCode Core::adjacencies_iterate(Range::const_iterator iter,
   return MB_SUCCESS;
 }
 
+ErrorCode Core::compact_adjacencies()
+{
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+  ErrorCode rval = aEntityFactory->compact_adjacencies();MB_CHK_ERR(rval);
+  return MB_SUCCESS;
+}
+
+ErrorCode Core::freeze()
+{
+  if (meshFrozen)
+    return MB_SUCCESS;
+
+    // create anything queries would otherwise create on demand
+  if (!aEntityFactory->vert_elem_adjacencies()) {
+    ErrorCode rval = aEntityFactory->create_vert_elem_adjacencies();MB_CHK_ERR(rval);
+  }
+#ifdef MOAB_HAVE_AHF
+  ahfRep->check_mixed_entity_type();
+#endif
+
+  sequenceManager->freeze( true );
+  meshFrozen = true;
+  return MB_SUCCESS;
+}
+
+void Core::unfreeze()
+{
+  sequenceManager->freeze( false );
+  meshFrozen = false;
+}
+
 ErrorCode Core::get_entities_by_dimension(const EntityHandle meshset,
                                                 const int dimension,
                                                 Range &entities,
@@ -2661,6 +2828,9 @@ ErrorCode Core::create_element(const EntityType type,
                                    const int num_nodes,
                                    EntityHandle &handle)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
     // make sure we have enough vertices for this entity type
   if(num_nodes < CN::VerticesPerEntity(type))
     return MB_FAILURE;
@@ -2680,6 +2850,8 @@ ErrorCode Core::create_element(const EntityType type,
 //! creates a vertex based on coordinates, returns a handle and error code
 ErrorCode Core::create_vertex(const double coords[3], EntityHandle &handle )
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
     // get an available vertex handle
   return sequence_manager()->create_vertex( coords, handle );
 }
@@ -2688,6 +2860,9 @@ ErrorCode Core::create_vertices(const double *coordinates,
                                     const int nverts,
                                     Range &entity_handles )
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
     // Create vertices
   ReadUtilIface *read_iface;
   ErrorCode result = Interface::query_interface(read_iface);MB_CHK_ERR(result);
@@ -2717,6 +2892,9 @@ ErrorCode Core::merge_entities( EntityHandle entity_to_keep,
                                       bool auto_merge,
                                       bool delete_removed_entity)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   if (auto_merge) return MB_FAILURE;
 
     // The two entities to merge must not be the same entity.
@@ -2769,6 +2947,8 @@ ErrorCode Core::merge_entities( EntityHandle entity_to_keep,
 //! deletes an entity range
 ErrorCode Core::delete_entities(const Range &range)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
   ErrorCode result = MB_SUCCESS, temp_result;
   Range failed_ents;
 
@@ -2821,6 +3001,9 @@ ErrorCode Core::delete_entities(const Range &range)
 ErrorCode Core::delete_entities(const EntityHandle *entities,
                                     const int num_entities)
 {
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   ErrorCode result = MB_SUCCESS, temp_result;
   Range failed_ents;
 
@@ -3029,7 +3212,7 @@ ErrorCode Core::side_number(const EntityHandle parent,
   int num_parent_vertices = 0, num_child_vertices = 0;
   ErrorCode result = get_connectivity(parent, parent_conn, num_parent_vertices, true);
   if (MB_NOT_IMPLEMENTED == result) {
-    static std::vector<EntityHandle> tmp_connect(CN::MAX_NODES_PER_ELEMENT);
+    std::vector<EntityHandle> tmp_connect;
     result = get_connectivity(parent, parent_conn, num_parent_vertices, true, &tmp_connect);
   }
   if (MB_SUCCESS != result) return result;
@@ -4260,6 +4443,9 @@ ErrorCode Core::create_scd_sequence(const HomCoord & coord_min,
   //the sequence manager instead of using the same from the ScdInterface which
   //creates the associated scd bounding box after element sequence creation.
 
+  if (meshFrozen)
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   if(!scdInterface)
     scdInterface = new ScdInterface(this);
   ScdBox * newBox = NULL;
@@ -0,0 +1,1321 @@
+/*
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+/**\file FlatOBBTree.cpp
+ */
+
+#include "moab/FlatOBBTree.hpp"
+#include "moab/Interface.hpp"
+#include "Internals.hpp"
+#include "OrientedBox.hpp"
+#include "moab/Range.hpp"
+#include "moab/GeomUtil.hpp"
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <assert.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace moab {
+
+  // Offsets of the box components in boxData, in units of nodeCount
+enum { BOX_CENTER = 0, BOX_AXIS = 3, BOX_LENGTH = 12, BOX_RADIUS = 15, BOX_SIZE = 16 };
+
+FlatOBBTree::FlatOBBTree()
+  : nodeCount(0), haveSenses(false)
+{}
+
+void FlatOBBTree::clear()
+{
+  nodeCount = 0;
+  boxData.clear();
+  nodeChildren.clear();
+  nodeSurf.clear();
+  leafTris.clear();
+  triHandles.clear();
+  triConn.clear();
+  triCoords.clear();
+  surfSets.clear();
+  surfSenses.clear();
+  haveSenses = false;
+}
+
+unsigned long FlatOBBTree::memory_use() const
+{
+  return boxData.capacity() * sizeof(double)
+       + nodeChildren.capacity() * sizeof(int)
+       + nodeSurf.capacity() * sizeof(int)
+       + leafTris.capacity() * sizeof(unsigned)
+       + (triHandles.capacity() + triConn.capacity()) * sizeof(EntityHandle)
+       + triCoords.capacity() * sizeof(double)
+       + (surfSets.capacity() + surfSenses.capacity()) * sizeof(EntityHandle);
+}
+
+void FlatOBBTree::get_box( unsigned node, OrientedBox& box ) const
+{
+  const double* d = &boxData[node];
+  const unsigned n = nodeCount;
+  box.center = CartVect( d[BOX_CENTER*n], d[(BOX_CENTER+1)*n], d[(BOX_CENTER+2)*n] );
+  for (int i = 0; i < 3; ++i)
+    box.axis[i] = CartVect( d[(BOX_AXIS+3*i)*n], d[(BOX_AXIS+3*i+1)*n], d[(BOX_AXIS+3*i+2)*n] );
+#if MB_ORIENTED_BOX_UNIT_VECTORS
+  box.length = CartVect( d[BOX_LENGTH*n], d[(BOX_LENGTH+1)*n], d[(BOX_LENGTH+2)*n] );
+#endif
+#if MB_ORIENTED_BOX_OUTER_RADIUS
+  box.radius = d[BOX_RADIUS*n];
+#endif
+}
+
+/********************** Tree Compilation ****************************/
+
+struct FlatOBBBuildFrame { EntityHandle set; int parent, child; };
+
+ErrorCode FlatOBBTree::build( OrientedBoxTreeTool* tool,
+                              EntityHandle root_set,
+                              const Tag* sense_tag )
+{
+  clear();
+  Interface* moab = tool->get_moab_instance();
+  ErrorCode rval;
+
+    // Number nodes in the order the query traversals visit them, so
+    // that the second child of a node immediately follows it.
+  std::vector<OrientedBox> boxes;
+  std::vector<EntityHandle> children;
+  std::map<EntityHandle,int> surf_map;
+  std::vector<FlatOBBBuildFrame> stack;
+  FlatOBBBuildFrame frame = { root_set, -1, 0 };
+  stack.push_back( frame );
+  leafTris.push_back( 0 );
+  while (!stack.empty()) {
+    frame = stack.back();
+    stack.pop_back();
+
+    const int node = boxes.size();
+    if (frame.parent >= 0)
+      nodeChildren[2*frame.parent + frame.child] = node;
+    boxes.resize( node + 1 );
+    rval = tool->box( frame.set, boxes.back() );
+    if (MB_SUCCESS != rval)
+      return rval;
+    nodeChildren.push_back( -1 );
+    nodeChildren.push_back( -1 );
+
+      // surface set contained in node, if any
+    Range sets;
+    rval = moab->get_entities_by_type( frame.set, MBENTITYSET, sets );
+    if (MB_SUCCESS != rval)
+      return rval;
+    if (sets.size() > 1)
+      return MB_MULTIPLE_ENTITIES_FOUND;
+    if (sets.empty())
+      nodeSurf.push_back( -1 );
+    else {
+      std::map<EntityHandle,int>::iterator s = surf_map.find( sets.front() );
+      if (s == surf_map.end()) {
+        s = surf_map.insert( std::make_pair( sets.front(), (int)surfSets.size() ) ).first;
+        surfSets.push_back( sets.front() );
+        EntityHandle vols[2] = { 0, 0 };
+        if (sense_tag) {
+            // surfaces without senses are an error only if queried
+          rval = moab->tag_get_data( *sense_tag, &sets.front(), 1, vols );
+          if (MB_SUCCESS != rval && MB_TAG_NOT_FOUND != rval)
+            return rval;
+        }
+        surfSenses.push_back( vols[0] );
+        surfSenses.push_back( vols[1] );
+      }
+      nodeSurf.push_back( s->second );
+    }
+
+    children.clear();
+    rval = moab->get_child_meshsets( frame.set, children );
+    if (MB_SUCCESS != rval)
+      return rval;
+    if (children.size() == 2) {
+      FlatOBBBuildFrame child = { children[0], node, 0 };
+      stack.push_back( child );
+      child.set = children[1];
+      child.child = 1;
+      stack.push_back( child );
+    }
+    else if (!children.empty())
+      return MB_MULTIPLE_ENTITIES_FOUND;
+    else {
+        // leaf: copy triangles, in the order the tree tool visits them
+      Range tris;
+      rval = moab->get_entities_by_type( frame.set, MBTRI, tris );
+      if (MB_SUCCESS != rval)
+        return rval;
+      for (Range::iterator t = tris.begin(); t != tris.end(); ++t) {
+        const EntityHandle* conn;
+        int len;
+        rval = moab->get_connectivity( *t, conn, len, true );
+        if (MB_SUCCESS != rval)
+          return rval;
+        if (3 != len)
+          return MB_FAILURE;
+        triHandles.push_back( *t );
+        triConn.insert( triConn.end(), conn, conn + 3 );
+        triCoords.resize( triCoords.size() + 9 );
+        rval = moab->get_coords( conn, 3, &triCoords[triCoords.size() - 9] );
+        if (MB_SUCCESS != rval)
+          return rval;
+      }
+    }
+    leafTris.push_back( triHandles.size() );
+  }
+
+    // scatter boxes into component arrays
+  nodeCount = boxes.size();
+  const unsigned n = nodeCount;
+  boxData.resize( BOX_SIZE * n );
+  for (unsigned i = 0; i < n; ++i) {
+    const OrientedBox& b = boxes[i];
+    for (int j = 0; j < 3; ++j) {
+      boxData[(BOX_CENTER+j)*n + i] = b.center[j];
+      for (int k = 0; k < 3; ++k)
+        boxData[(BOX_AXIS+3*j+k)*n + i] = b.axis[j][k];
+#if MB_ORIENTED_BOX_UNIT_VECTORS
+      boxData[(BOX_LENGTH+j)*n + i] = b.length[j];
+#endif
+    }
+#if MB_ORIENTED_BOX_OUTER_RADIUS
+    boxData[BOX_RADIUS*n + i] = b.radius;
+#endif
+  }
+
+  haveSenses = (0 != sense_tag);
+  return MB_SUCCESS;
+}
+
+/********************** Sphere/Triangle Intersection ****************************/
+
+struct FlatOBBSITFrame { unsigned node; int surf; int depth; };
+
+ErrorCode FlatOBBTree::sphere_intersect_tris( const double* center_v,
+                                              double radius,
+                                              std::vector<unsigned>& tris_out,
+                                              std::vector<int>* surfs_out,
+                                              OrientedBoxTreeTool::TrvStats* accum ) const
+{
+  if (empty())
+    return MB_ENTITY_NOT_FOUND;
+
+  const double radsqr = radius * radius;
+  const CartVect center(center_v);
+  OrientedBox b;
+  CartVect closest, coords[3];
+
+  std::vector<FlatOBBSITFrame> stack;
+  stack.reserve(30);
+  FlatOBBSITFrame frame = { 0, -1, 0 };
+  stack.push_back( frame );
+  int max_depth = -1;
+
+  while (!stack.empty()) {
+    frame = stack.back();
+    stack.pop_back();
+
+    if (accum) {
+      accum->increment( frame.depth );
+      max_depth = std::max( max_depth, frame.depth );
+    }
+
+    if (frame.surf < 0 && surfs_out)
+      frame.surf = nodeSurf[frame.node];
+
+      // check if sphere intersects box
+    get_box( frame.node, b );
+    b.closest_location_in_box( center, closest );
+    closest -= center;
+    if ((closest % closest) > radsqr)
+      continue;
+
+    const int* children = &nodeChildren[2*frame.node];
+    if (children[0] >= 0) {
+      FlatOBBSITFrame child = { (unsigned)children[0], frame.surf, frame.depth + 1 };
+      stack.push_back( child );
+      child.node = children[1];
+      stack.push_back( child );
+      continue;
+    }
+
+    if (accum) { accum->increment_leaf( frame.depth ); }
+      // if leaf, intersect sphere with triangles
+    for (unsigned t = leafTris[frame.node]; t < leafTris[frame.node+1]; ++t) {
+      const double* c = &triCoords[9*t];
+      coords[0] = CartVect( c );
+      coords[1] = CartVect( c + 3 );
+      coords[2] = CartVect( c + 6 );
+      GeomUtil::closest_location_on_tri( center, coords, closest );
+      closest -= center;
+      if ((closest % closest) <= radsqr &&
+          std::find( tris_out.begin(), tris_out.end(), t ) == tris_out.end()) {
+        tris_out.push_back( t );
+        if (surfs_out)
+          surfs_out->push_back( frame.surf );
+      }
+    }
+  }
+
+  if (accum) {
+    accum->end_traversal( max_depth );
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode FlatOBBTree::sphere_intersect_triangles( const double* center,
+                                                   double radius,
+                                                   std::vector<EntityHandle>& facets_out,
+                                                   std::vector<EntityHandle>* sets_out,
+                                                   OrientedBoxTreeTool::TrvStats* accum ) const
+{
+  std::vector<unsigned> tris;
+  std::vector<int> surfs;
+  ErrorCode rval = sphere_intersect_tris( center, radius, tris,
+                                          sets_out ? &surfs : 0, accum );
+  if (MB_SUCCESS != rval)
+    return rval;
+  for (size_t i = 0; i < tris.size(); ++i) {
+    if (std::find( facets_out.begin(), facets_out.end(), triHandles[tris[i]] ) != facets_out.end())
+      continue;
+    facets_out.push_back( triHandles[tris[i]] );
+    if (sets_out)
+      sets_out->push_back( surfs[i] < 0 ? 0 : surfSets[surfs[i]] );
+  }
+  return MB_SUCCESS;
+}
+
+/********************** Closest Point ****************************/
+
+struct FlatOBBCPFrame { double dist_sqr; unsigned node; int surf; int depth; };
+
+ErrorCode FlatOBBTree::closest_to_location( const double* point,
+                                            double* point_out,
+                                            EntityHandle& facet_out,
+                                            EntityHandle* set_out,
+                                            OrientedBoxTreeTool::TrvStats* accum ) const
+{
+  if (empty())
+    return MB_ENTITY_NOT_FOUND;
+
+  const CartVect loc( point );
+  double smallest_dist_sqr = std::numeric_limits<double>::max();
+  OrientedBox b;
+  CartVect pt1, pt2, tmp, coords[3];
+
+  std::vector<FlatOBBCPFrame> stack;
+  stack.reserve(30);
+  FlatOBBCPFrame frame = { 0.0, 0, -1, 0 };
+  stack.push_back( frame );
+  int max_depth = -1;
+
+  while (!stack.empty()) {
+    frame = stack.back();
+    stack.pop_back();
+
+      // If current best result is closer than the box, skip this tree node.
+    if (frame.dist_sqr > smallest_dist_sqr)
+      continue;
+
+    if (accum) {
+      accum->increment( frame.depth );
+      max_depth = std::max( max_depth, frame.depth );
+    }
+
+    if (frame.surf < 0)
+      frame.surf = nodeSurf[frame.node];
+
+    const int* children = &nodeChildren[2*frame.node];
+    if (children[0] >= 0) {
+        // get distance from each box
+      get_box( children[0], b );
+      b.closest_location_in_box( loc, pt1 );
+      get_box( children[1], b );
+      b.closest_location_in_box( loc, pt2 );
+      pt1 -= loc;
+      pt2 -= loc;
+      const double dsqr1 = pt1 % pt1;
+      const double dsqr2 = pt2 % pt2;
+
+        // push children on stack such that closer one is on top
+      FlatOBBCPFrame c1 = { dsqr1, (unsigned)children[0], frame.surf, frame.depth + 1 };
+      FlatOBBCPFrame c2 = { dsqr2, (unsigned)children[1], frame.surf, frame.depth + 1 };
+      if (dsqr1 < dsqr2) {
+        stack.push_back( c2 );
+        stack.push_back( c1 );
+      }
+      else {
+        stack.push_back( c1 );
+        stack.push_back( c2 );
+      }
+      continue;
+    }
+
+    if (accum) { accum->increment_leaf( frame.depth ); }
+    for (unsigned t = leafTris[frame.node]; t < leafTris[frame.node+1]; ++t) {
+      const double* c = &triCoords[9*t];
+      coords[0] = CartVect( c );
+      coords[1] = CartVect( c + 3 );
+      coords[2] = CartVect( c + 6 );
+      GeomUtil::closest_location_on_tri( loc, coords, tmp );
+      pt1 = tmp - loc;
+      const double dist_sqr = pt1 % pt1;
+      if (dist_sqr < smallest_dist_sqr) {
+        smallest_dist_sqr = dist_sqr;
+        facet_out = triHandles[t];
+        tmp.get( point_out );
+        if (set_out)
+          *set_out = frame.surf < 0 ? 0 : surfSets[frame.surf];
+      }
+    }
+  }
+
+  if (accum) {
+    accum->end_traversal( max_depth );
+  }
+
+  return MB_SUCCESS;
+}
+
+/********************** Ray/Set Intersection ****************************/
+
+/* Same algorithm as RayIntersectSets in OrientedBoxTreeTool.cpp, working
+ * on the compiled tree.  Triangles are referred to by their index in the
+ * compiled tree, surfaces by their index in surfSets.  Holds no pointers
+ * to itself, so that the packet traversal can keep an array of them. */
+class FlatRayIntersectSets
+{
+  private:
+    // Input
+    const FlatOBBTree&   tree;
+    const CartVect       ray_origin;
+    const CartVect       ray_direction;
+    const double*        nonneg_ray_len;
+    const double*        neg_ray_len;
+    const double&        tol;
+    const int            minTolInt;
+
+    // Output
+    std::vector<double>&       intersections;
+    std::vector<EntityHandle>& sets;
+    std::vector<EntityHandle>& facets;
+
+    // Optional Input
+    const EntityHandle*  geomVol;
+    const int*           desiredOrient;
+    int                  surfTriOrient;
+    const std::vector<EntityHandle>* prevFacets;
+
+    // Other Variables
+    unsigned int*        raytri_test_count;
+    int                  lastSurf;
+    int                  lastSetDepth;
+    std::vector< std::vector<EntityHandle> > neighborhoods;
+    std::vector<EntityHandle> neighborhood;
+
+    ErrorCode sense( int surf, int& result ) const;
+    bool edge_node_intersect( unsigned tri,
+                              GeomUtil::intersection_type int_type,
+                              const std::vector<unsigned>& close_tris,
+                              const std::vector<int>& close_senses );
+    void add_intersection( double t, EntityHandle facet );
+
+  public:
+    FlatRayIntersectSets( const FlatOBBTree&         flat_tree,
+                          const double*              ray_point,
+                          const double*              unit_ray_dir,
+                          const double*              nonneg_ray_length,
+                          const double*              neg_ray_length,
+                          const double&              tolerance,
+                          int                        min_tol_intersections,
+                          std::vector<double>&       inters,
+                          std::vector<EntityHandle>& surfaces,
+                          std::vector<EntityHandle>& facts,
+                          const EntityHandle*        geom_volume,
+                          const int*                 desired_orient,
+                          const std::vector<EntityHandle>* prev_facets,
+                          unsigned int*              tmp_count )
+      : tree(flat_tree),
+        ray_origin(ray_point), ray_direction(unit_ray_dir),
+        nonneg_ray_len(nonneg_ray_length), neg_ray_len(neg_ray_length),
+        tol(tolerance), minTolInt(min_tol_intersections),
+        intersections(inters), sets(surfaces), facets(facts),
+        geomVol(geom_volume), desiredOrient(desired_orient),
+        surfTriOrient(0), prevFacets(prev_facets),
+        raytri_test_count(tmp_count), lastSurf(-1), lastSetDepth(0)
+      {
+        assert(!desiredOrient || 1==*desiredOrient || -1==*desiredOrient);
+        if (nonneg_ray_len) {
+          assert(0 <= *nonneg_ray_len);
+        }
+        if (neg_ray_len) {
+          assert(0 > *neg_ray_len);
+        }
+      }
+
+    ErrorCode visit( unsigned node, int depth, bool& descend );
+    ErrorCode leaf( unsigned node );
+
+      // Traverse the subtree rooted at a node, in the same order as
+      // OrientedBoxTreeTool::preorder_traverse
+    ErrorCode traverse( unsigned node, int depth,
+                        OrientedBoxTreeTool::TrvStats* accum, int& max_depth );
+
+      // Parts of leaf(), for the packet traversal: check that a leaf may
+      // be processed, then test each of its triangles in order.
+    ErrorCode begin_leaf() const
+      { assert(lastSurf >= 0); return lastSurf < 0 ? MB_FAILURE : MB_SUCCESS; }
+    ErrorCode test_triangle( unsigned tri );
+
+      // Current state, for the packet screening tests
+    const double* nonneg_len() const { return nonneg_ray_len; }
+    const double* neg_len() const { return neg_ray_len; }
+    double tolerance() const { return tol; }
+    const int* orientation() const { return desiredOrient ? &surfTriOrient : 0; }
+};
+
+  // Sense of a surface wrt geomVol: 1 forward, -1 reverse
+ErrorCode FlatRayIntersectSets::sense( int surf, int& result ) const
+{
+  const EntityHandle* vols = &tree.surfSenses[2*surf];
+  if (vols[0] == vols[1]) {
+    std::cerr << "error: surface has positive and negative sense wrt same volume"
+              << std::endl;
+    return MB_FAILURE;
+  }
+  if (*geomVol == vols[0])
+    result = 1;
+  else if (*geomVol == vols[1])
+    result = -1;
+  else
+    return MB_FAILURE;
+  return MB_SUCCESS;
+}
+
+ErrorCode FlatRayIntersectSets::visit( unsigned node, int depth, bool& descend )
+{
+  OrientedBox box;
+  tree.get_box( node, box );
+  descend = box.intersect_ray( ray_origin, ray_direction, tol, nonneg_ray_len,
+                               neg_ray_len );
+
+  if (lastSurf >= 0 && depth <= lastSetDepth)
+    lastSurf = -1;
+
+  if (descend && lastSurf < 0 && tree.nodeSurf[node] >= 0) {
+    lastSurf = tree.nodeSurf[node];
+    lastSetDepth = depth;
+      // Get desired orientation of surface wrt volume. Use this to return only
+      // exit or entrance intersections.
+    if (geomVol && tree.haveSenses && desiredOrient) {
+      int s;
+      ErrorCode rval = sense( lastSurf, s );
+      assert(MB_SUCCESS == rval);
+      if (MB_SUCCESS != rval)
+        return rval;
+      surfTriOrient = *desiredOrient * s;
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode FlatRayIntersectSets::leaf( unsigned node )
+{
+  ErrorCode rval = begin_leaf();
+  if (MB_SUCCESS != rval) // if no surface has been visited yet, something's messed up.
+    return rval;
+
+  for (unsigned t = tree.leafTris[node]; t < tree.leafTris[node+1]; ++t) {
+    rval = test_triangle( t );
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode FlatRayIntersectSets::test_triangle( unsigned t )
+{
+  CartVect coords[3];
+  const double* c = &tree.triCoords[9*t];
+  coords[0] = CartVect( c );
+  coords[1] = CartVect( c + 3 );
+  coords[2] = CartVect( c + 6 );
+
+  if (raytri_test_count) *raytri_test_count += 1;
+
+  double int_dist;
+  GeomUtil::intersection_type int_type = GeomUtil::NONE;
+  if (!GeomUtil::plucker_ray_tri_intersect( coords, ray_origin, ray_direction, tol, int_dist,
+                                            nonneg_ray_len, neg_ray_len,
+                                            desiredOrient ? &surfTriOrient : NULL, &int_type ))
+    return MB_SUCCESS;
+
+  const EntityHandle handle = tree.triHandles[t];
+    // Do not accept intersections on previously intersected facets
+  if (prevFacets &&
+      prevFacets->end() != std::find( prevFacets->begin(), prevFacets->end(), handle ))
+    return MB_SUCCESS;
+
+    // Do not accept intersections in the neighborhood of previous intersections
+  for (unsigned i = 0; i < neighborhoods.size(); ++i)
+    if (neighborhoods[i].end() != std::find( neighborhoods[i].begin(),
+                                             neighborhoods[i].end(), handle ))
+      return MB_SUCCESS;
+
+    // Handle special case of edge/node intersection. Accept piercing
+    // intersections and reject glancing intersections.
+  if (GeomUtil::INTERIOR != int_type && geomVol && tree.haveSenses) {
+    CartVect int_pt = ray_origin + int_dist*ray_direction;
+    std::vector<unsigned> close_tris;
+    std::vector<int> close_surfs;
+    ErrorCode rval = tree.sphere_intersect_tris( int_pt.array(), tol, close_tris,
+                                                 &close_surfs, 0 );
+    assert(MB_SUCCESS == rval);
+    if (MB_SUCCESS != rval) return rval;
+
+      // As in RayIntersectSets, the sense of the current surface is used
+      // for all close triangles
+    std::vector<int> close_senses(close_surfs.size());
+    for (unsigned i = 0; i < close_surfs.size(); ++i) {
+      rval = sense( lastSurf, close_senses[i] );
+      if (MB_SUCCESS != rval) return rval;
+    }
+
+    neighborhood.clear();
+    if (!edge_node_intersect( t, int_type, close_tris, close_senses ))
+      return MB_SUCCESS;
+  }
+  else {
+    neighborhood.clear();
+    neighborhood.push_back( handle );
+  }
+
+    // NOTE: add_intersection may modify the 'neg_ray_len' and 'nonneg_ray_len'
+    //       members, which will affect subsequent ray-triangle tests.
+  add_intersection( int_dist, handle );
+  return MB_SUCCESS;
+}
+
+  // Same as edge_node_intersect in OrientedBoxTreeTool.cpp, using the
+  // stored triangle connectivity.  Returns true if piercing.
+bool FlatRayIntersectSets::edge_node_intersect( unsigned tri,
+                                                GeomUtil::intersection_type int_type,
+                                                const std::vector<unsigned>& close_tris,
+                                                const std::vector<int>& close_senses )
+{
+  const EntityHandle* conn = &tree.triConn[3*tri];
+  std::vector<unsigned> adj_tris;
+  std::vector<int> adj_senses;
+
+  if (GeomUtil::NODE0==int_type || GeomUtil::NODE1==int_type || GeomUtil::NODE2==int_type) {
+    EntityHandle node;
+    if      (GeomUtil::NODE0==int_type) node = conn[0];
+    else if (GeomUtil::NODE1==int_type) node = conn[1];
+    else                                node = conn[2];
+
+    for (unsigned i = 0; i < close_tris.size(); ++i) {
+      const EntityHandle* con = &tree.triConn[3*close_tris[i]];
+      if (node==con[0] || node==con[1] || node==con[2]) {
+        adj_tris.push_back(   close_tris[i]   );
+        adj_senses.push_back( close_senses[i] );
+      }
+    }
+    if (adj_tris.empty()) {
+      std::cerr << "error: no tris are adjacent to the node" << std::endl;
+      return true;
+    }
+  }
+  else if (GeomUtil::EDGE0==int_type || GeomUtil::EDGE1==int_type || GeomUtil::EDGE2==int_type) {
+    EntityHandle endpts[2];
+    if (GeomUtil::EDGE0==int_type) {
+      endpts[0] = conn[0];
+      endpts[1] = conn[1];
+    } else if (GeomUtil::EDGE1==int_type) {
+      endpts[0] = conn[1];
+      endpts[1] = conn[2];
+    } else {
+      endpts[0] = conn[2];
+      endpts[1] = conn[0];
+    }
+
+    for (unsigned i = 0; i < close_tris.size(); ++i) {
+      const EntityHandle* con = &tree.triConn[3*close_tris[i]];
+      if ( (endpts[0]==con[0] && endpts[1]==con[1]) ||
+           (endpts[0]==con[1] && endpts[1]==con[0]) ||
+           (endpts[0]==con[1] && endpts[1]==con[2]) ||
+           (endpts[0]==con[2] && endpts[1]==con[1]) ||
+           (endpts[0]==con[2] && endpts[1]==con[0]) ||
+           (endpts[0]==con[0] && endpts[1]==con[2]) ) {
+        adj_tris.push_back(   close_tris[i]   );
+        adj_senses.push_back( close_senses[i] );
+      }
+    }
+    if (2 != adj_tris.size()) {
+      std::cerr << "error: edge of a manifold must be topologically adjacent to exactly 2 tris"
+                << " (vertices " << ID_FROM_HANDLE(endpts[0]) << ", "
+                << ID_FROM_HANDLE(endpts[1]) << ")" << std::endl;
+      return true;
+    }
+  }
+  else {
+    std::cerr << "error: special case not an node/edge intersection" << std::endl;
+    return true;
+  }
+
+  for (unsigned i = 0; i < adj_tris.size(); ++i)
+    neighborhood.push_back( tree.triHandles[adj_tris[i]] );
+
+    // For a piercing intersection, the normal of all tris must have the
+    // same orientation.
+  int sign = 0;
+  for (unsigned i = 0; i < adj_tris.size(); ++i) {
+    const double* c = &tree.triCoords[9*adj_tris[i]];
+    const CartVect c0( c ), c1( c + 3 ), c2( c + 6 );
+    CartVect v0 = c1 - c0;
+    CartVect v1 = c2 - c0;
+    CartVect norm = adj_senses[i]*(v0*v1);
+    double dot_prod = norm%ray_direction;
+
+    if (0==sign && 0!=dot_prod) {
+      if (0<dot_prod) sign = 1;
+      else            sign = -1;
+    }
+    if (0!=sign && 0>sign*dot_prod) return false;
+  }
+  return true;
+}
+
+  // Same as RayIntersectSets::add_intersection; see there for the two modes.
+void FlatRayIntersectSets::add_intersection( double t, EntityHandle facet )
+{
+  const EntityHandle lastSet = tree.surfSets[lastSurf];
+
+  // Mode 1: keep the closest nonneg intersection and one negative
+  // intersection, if closer
+  if (neg_ray_len && nonneg_ray_len) {
+    if (2 != intersections.size()) {
+      intersections.resize(2,0);
+      sets.resize(2,0);
+      facets.resize(2,0);
+      intersections[0] = -std::numeric_limits<double>::max();
+    }
+
+    if (0.0>t) {
+      intersections[0] = t;
+      sets[0]          = lastSet;
+      facets[0]        = facet;
+      neg_ray_len      = &intersections[0];
+    } else {
+      intersections[1] = t;
+      sets[1]          = lastSet;
+      facets[1]        = facet;
+      nonneg_ray_len   = &intersections[1];
+      if (t < -(*neg_ray_len)) {
+        intersections[0] = -intersections[1];
+        sets[0]          = 0;
+        facets[0]        = 0;
+        neg_ray_len      = &intersections[0];
+      }
+    }
+    return;
+  }
+
+  // Mode 2
+  if (minTolInt < 0 && t > -tol) {
+    intersections.push_back(t);
+    sets.push_back(lastSet);
+    facets.push_back(facet);
+    neighborhoods.push_back(neighborhood);
+    return;
+  }
+
+  int len_idx = -1;
+  if (nonneg_ray_len && nonneg_ray_len >= &intersections[0] &&
+      nonneg_ray_len < &intersections[0] + intersections.size())
+    len_idx = nonneg_ray_len - &intersections[0];
+
+  if (t <= tol) {
+    if (len_idx >= 0) {
+      if ((int)intersections.size() >= minTolInt) {
+        intersections[len_idx] = t;
+        sets[len_idx] = lastSet;
+        facets[len_idx] = facet;
+        nonneg_ray_len = &tol;
+      }
+      else {
+        intersections.push_back(t);
+        sets.push_back(lastSet);
+        facets.push_back(facet);
+        nonneg_ray_len = &intersections[len_idx];
+      }
+    }
+    else {
+      intersections.push_back(t);
+      sets.push_back(lastSet);
+      facets.push_back(facet);
+      if ((int)intersections.size() >= minTolInt)
+        nonneg_ray_len = &tol;
+    }
+  }
+  else if (len_idx >= 0) {
+    if (t <= *nonneg_ray_len) {
+      intersections[len_idx] = t;
+      sets[len_idx] = lastSet;
+      facets[len_idx] = facet;
+    }
+  }
+  else if ((int)intersections.size() < minTolInt) {
+    intersections.push_back( t );
+    sets.push_back( lastSet );
+    facets.push_back(facet);
+    nonneg_ray_len = &intersections.back();
+  }
+}
+
+struct FlatOBBTrvFrame { unsigned node; int depth; };
+
+ErrorCode FlatRayIntersectSets::traverse( unsigned node, int depth,
+                                          OrientedBoxTreeTool::TrvStats* accum,
+                                          int& max_depth )
+{
+  std::vector<FlatOBBTrvFrame> stack;
+  stack.reserve(64);
+  FlatOBBTrvFrame frame = { node, depth };
+  stack.push_back( frame );
+  ErrorCode rval;
+
+  while (!stack.empty()) {
+    frame = stack.back();
+    stack.pop_back();
+
+    if (accum) {
+      accum->increment( frame.depth );
+      max_depth = std::max( max_depth, frame.depth );
+    }
+
+    bool descend = true;
+    rval = visit( frame.node, frame.depth, descend );
+    if (MB_SUCCESS != rval)
+      return rval;
+    if (!descend)
+      continue;
+
+    const int* children = &tree.nodeChildren[2*frame.node];
+    if (children[0] < 0) {
+      if (accum) { accum->increment_leaf( frame.depth ); }
+      rval = leaf( frame.node );
+      if (MB_SUCCESS != rval)
+        return rval;
+    }
+    else {
+      FlatOBBTrvFrame child = { (unsigned)children[0], frame.depth + 1 };
+      stack.push_back( child );
+      child.node = children[1];
+      stack.push_back( child );
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode FlatOBBTree::ray_intersect_sets( std::vector<double>&       distances_out,
+                                           std::vector<EntityHandle>& sets_out,
+                                           std::vector<EntityHandle>& facets_out,
+                                           double                     tolerance,
+                                           int                        min_tolerance_intersections,
+                                           const double               ray_point[3],
+                                           const double               unit_ray_dir[3],
+                                           const double*              nonneg_ray_len,
+                                           OrientedBoxTreeTool::TrvStats* accum,
+                                           const double*              neg_ray_len,
+                                           const EntityHandle*        geom_vol,
+                                           const int*                 desired_orient,
+                                           const std::vector<EntityHandle>* prev_facets ) const
+{
+  if (empty())
+    return MB_ENTITY_NOT_FOUND;
+
+  FlatRayIntersectSets op( *this, ray_point, unit_ray_dir, nonneg_ray_len, neg_ray_len,
+                           tolerance, min_tolerance_intersections,
+                           distances_out, sets_out, facets_out,
+                           geom_vol, desired_orient, prev_facets,
+                           accum ? &(accum->ray_tri_tests_count) : NULL );
+
+  int max_depth = -1;
+  ErrorCode rval = op.traverse( 0, 0, accum, max_depth );
+  if (MB_SUCCESS != rval)
+    return rval;
+
+  if (accum) {
+    accum->end_traversal( max_depth );
+  }
+
+  return MB_SUCCESS;
+}
+
+/********************** Ray Packets ****************************/
+
+/* Lanes of doubles for the packet screening tests: AVX (4 lanes), SSE2 (2)
+ * or plain scalar code.  Comparisons return lanes with all bits set where
+ * true, and lanes_mask packs them into the low bits of an integer. */
+#if defined(__AVX__)
+typedef __m256d FlatOBBLanes;
+enum { FLAT_OBB_LANES = 4 };
+static inline FlatOBBLanes lanes_set( double v ) { return _mm256_set1_pd( v ); }
+static inline FlatOBBLanes lanes_load( const double* p ) { return _mm256_loadu_pd( p ); }
+static inline FlatOBBLanes lanes_add( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_add_pd( a, b ); }
+static inline FlatOBBLanes lanes_sub( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_sub_pd( a, b ); }
+static inline FlatOBBLanes lanes_mul( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_mul_pd( a, b ); }
+static inline FlatOBBLanes lanes_div( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_div_pd( a, b ); }
+static inline FlatOBBLanes lanes_min( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_min_pd( a, b ); }
+static inline FlatOBBLanes lanes_max( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_max_pd( a, b ); }
+static inline FlatOBBLanes lanes_abs( FlatOBBLanes a ) { return _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), a ); }
+static inline FlatOBBLanes lanes_gt( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_cmp_pd( a, b, _CMP_GT_OQ ); }
+static inline FlatOBBLanes lanes_and( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_and_pd( a, b ); }
+static inline FlatOBBLanes lanes_or( FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_or_pd( a, b ); }
+static inline FlatOBBLanes lanes_select( FlatOBBLanes m, FlatOBBLanes a, FlatOBBLanes b ) { return _mm256_blendv_pd( b, a, m ); }
+static inline unsigned lanes_mask( FlatOBBLanes a ) { return _mm256_movemask_pd( a ); }
+#elif defined(__SSE2__)
+typedef __m128d FlatOBBLanes;
+enum { FLAT_OBB_LANES = 2 };
+static inline FlatOBBLanes lanes_set( double v ) { return _mm_set1_pd( v ); }
+static inline FlatOBBLanes lanes_load( const double* p ) { return _mm_loadu_pd( p ); }
+static inline FlatOBBLanes lanes_add( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_add_pd( a, b ); }
+static inline FlatOBBLanes lanes_sub( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_sub_pd( a, b ); }
+static inline FlatOBBLanes lanes_mul( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_mul_pd( a, b ); }
+static inline FlatOBBLanes lanes_div( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_div_pd( a, b ); }
+static inline FlatOBBLanes lanes_min( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_min_pd( a, b ); }
+static inline FlatOBBLanes lanes_max( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_max_pd( a, b ); }
+static inline FlatOBBLanes lanes_abs( FlatOBBLanes a ) { return _mm_andnot_pd( _mm_set1_pd( -0.0 ), a ); }
+static inline FlatOBBLanes lanes_gt( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_cmpgt_pd( a, b ); }
+static inline FlatOBBLanes lanes_and( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_and_pd( a, b ); }
+static inline FlatOBBLanes lanes_or( FlatOBBLanes a, FlatOBBLanes b ) { return _mm_or_pd( a, b ); }
+static inline FlatOBBLanes lanes_select( FlatOBBLanes m, FlatOBBLanes a, FlatOBBLanes b )
+  { return _mm_or_pd( _mm_and_pd( m, a ), _mm_andnot_pd( m, b ) ); }
+static inline unsigned lanes_mask( FlatOBBLanes a ) { return _mm_movemask_pd( a ); }
+#else
+struct FlatOBBLanes { double v; bool b; };
+enum { FLAT_OBB_LANES = 1 };
+static inline FlatOBBLanes lanes_make( double v, bool b = false ) { FlatOBBLanes r = { v, b }; return r; }
+static inline FlatOBBLanes lanes_set( double v ) { return lanes_make( v ); }
+static inline FlatOBBLanes lanes_load( const double* p ) { return lanes_make( *p ); }
+static inline FlatOBBLanes lanes_add( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( a.v + b.v ); }
+static inline FlatOBBLanes lanes_sub( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( a.v - b.v ); }
+static inline FlatOBBLanes lanes_mul( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( a.v * b.v ); }
+static inline FlatOBBLanes lanes_div( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( a.v / b.v ); }
+static inline FlatOBBLanes lanes_min( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( a.v < b.v ? a.v : b.v ); }
+static inline FlatOBBLanes lanes_max( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( a.v > b.v ? a.v : b.v ); }
+static inline FlatOBBLanes lanes_abs( FlatOBBLanes a ) { return lanes_make( fabs( a.v ) ); }
+static inline FlatOBBLanes lanes_gt( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( 0, a.v > b.v ); }
+static inline FlatOBBLanes lanes_and( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( 0, a.b && b.b ); }
+static inline FlatOBBLanes lanes_or( FlatOBBLanes a, FlatOBBLanes b ) { return lanes_make( 0, a.b || b.b ); }
+static inline FlatOBBLanes lanes_select( FlatOBBLanes m, FlatOBBLanes a, FlatOBBLanes b ) { return m.b ? a : b; }
+static inline unsigned lanes_mask( FlatOBBLanes a ) { return a.b; }
+#endif
+
+static inline FlatOBBLanes lanes_dot( FlatOBBLanes ax, FlatOBBLanes ay, FlatOBBLanes az,
+                                      FlatOBBLanes bx, FlatOBBLanes by, FlatOBBLanes bz )
+{
+  return lanes_add( lanes_add( lanes_mul( ax, bx ), lanes_mul( ay, by ) ), lanes_mul( az, bz ) );
+}
+
+  // Index of the lowest set bit of a non-zero mask
+static inline unsigned first_lane( unsigned long long mask )
+{
+#ifdef __GNUC__
+  return __builtin_ctzll( mask );
+#else
+  unsigned i = 0;
+  while (!(mask & 1)) { mask >>= 1; ++i; }
+  return i;
+#endif
+}
+
+  // Number of set bits in a mask
+static inline unsigned count_lanes( unsigned long long mask )
+{
+#ifdef __GNUC__
+  return __builtin_popcountll( mask );
+#else
+  unsigned n = 0;
+  for (; mask; mask &= mask - 1)
+    ++n;
+  return n;
+#endif
+}
+
+/* The screening tests only reject a ray where the corresponding exact test
+ * would reject it whatever the rounding, so that the exact tests, applied
+ * to the remaining rays, decide the result.  The box test enlarges the
+ * box and the line intervals by a slack that covers the rounding of the
+ * box coordinates of the ray and of the face tests; the Plucker test compares each
+ * edge product with a bound on its rounding error, which also covers the
+ * reversed edge direction used by GeomUtil for some edges. */
+static const double FLAT_OBB_BOX_SLACK = 1e-10;
+static const double FLAT_OBB_PIP_SLACK = 1e-12;
+
+  // A packet of at most PACKET_SIZE rays traced together
+class FlatOBBPacket
+{
+  public:
+    enum { PACKET_SIZE = 64 };
+      //! Subtrees reached by fewer rays are traversed one ray at a time
+    enum { MIN_PACKET_RAYS = 8 };
+    typedef unsigned long long Mask;
+
+    FlatOBBPacket( const FlatOBBTree& flat_tree, std::vector<FlatRayIntersectSets>& ray_ops )
+      : tree(flat_tree), ops(ray_ops), numRays(ray_ops.size())
+    {
+      assert(numRays > 0 && numRays <= PACKET_SIZE);
+      std::fill( rays[0], rays[0] + RAY_SIZE*PACKET_SIZE, 0.0 );
+    }
+
+      //! Set the origin and direction of a ray
+    void set_ray( unsigned i, const double* point, const double* dir );
+
+    ErrorCode traverse();
+
+  private:
+      // Per-ray data, as arrays of PACKET_SIZE values
+    enum { RAY_OX, RAY_OY, RAY_OZ, RAY_DX, RAY_DY, RAY_DZ,
+           RAY_BX, RAY_BY, RAY_BZ,   // Plucker moment, direction x origin
+           RAY_BNORM,                // L1 norm of the moment
+           RAY_TMIN, RAY_TMAX,       // current length limits
+           RAY_SIZE };
+
+    const FlatOBBTree& tree;
+    std::vector<FlatRayIntersectSets>& ops;
+    const unsigned numRays;
+    double rays[RAY_SIZE][PACKET_SIZE];
+
+    Mask all_rays() const
+      { return numRays == PACKET_SIZE ? ~(Mask)0 : ((Mask)1 << numRays) - 1; }
+    Mask group( Mask mask, unsigned first ) const
+      { return (mask >> first) & (((Mask)1 << FLAT_OBB_LANES) - 1); }
+
+    Mask screen_box( unsigned node, Mask active );
+    Mask screen_triangle( unsigned tri, Mask active,
+                          Mask no_pos, Mask no_neg, Mask no_mixed ) const;
+    ErrorCode leaf( unsigned node, Mask active );
+};
+
+void FlatOBBPacket::set_ray( unsigned i, const double* point, const double* dir )
+{
+  const CartVect o( point ), d( dir );
+  const CartVect b = d * o;
+  rays[RAY_OX][i] = o[0]; rays[RAY_OY][i] = o[1]; rays[RAY_OZ][i] = o[2];
+  rays[RAY_DX][i] = d[0]; rays[RAY_DY][i] = d[1]; rays[RAY_DZ][i] = d[2];
+  rays[RAY_BX][i] = b[0]; rays[RAY_BY][i] = b[1]; rays[RAY_BZ][i] = b[2];
+  rays[RAY_BNORM][i] = fabs(b[0]) + fabs(b[1]) + fabs(b[2]);
+}
+
+  // Screening version of OrientedBox::intersect_ray.  That test accepts a
+  // ray only if the part of it within the length limits meets the box,
+  // enlarged by the tolerance; this one rejects a ray if that part of the
+  // line misses the box by more than the rounding slack, using the
+  // interval of the line between each pair of box faces.  Returns the
+  // rays rejected.
+FlatOBBPacket::Mask FlatOBBPacket::screen_box( unsigned node, Mask active )
+{
+  Mask reject = 0;
+#if MB_ORIENTED_BOX_UNIT_VECTORS && MB_ORIENTED_BOX_OUTER_RADIUS
+  const unsigned n = tree.nodeCount;
+  const double* box = &tree.boxData[node];
+  const double tol = ops[0].tolerance();
+  const FlatOBBLanes cx = lanes_set( box[BOX_CENTER*n] ),
+                     cy = lanes_set( box[(BOX_CENTER+1)*n] ),
+                     cz = lanes_set( box[(BOX_CENTER+2)*n] );
+  const FlatOBBLanes rad = lanes_set( box[BOX_RADIUS*n] + tol );
+  const FlatOBBLanes slack = lanes_set( FLAT_OBB_BOX_SLACK );
+  const FlatOBBLanes dir_slack = lanes_set( FLAT_OBB_PIP_SLACK );
+  const FlatOBBLanes inf = lanes_set( std::numeric_limits<double>::infinity() );
+  const FlatOBBLanes neg_inf = lanes_set( -std::numeric_limits<double>::infinity() );
+
+  for (unsigned i = 0; i < numRays; i += FLAT_OBB_LANES) {
+    const Mask lanes = group( active, i );
+    if (!lanes)
+      continue;
+
+      // current length limits of the rays
+    for (unsigned j = i; j < i + FLAT_OBB_LANES && j < numRays; ++j) {
+      const double* nonneg = ops[j].nonneg_len();
+      const double* neg = ops[j].neg_len();
+      rays[RAY_TMIN][j] = neg ? *neg : 0.0;
+      rays[RAY_TMAX][j] = nonneg ? *nonneg : std::numeric_limits<double>::infinity();
+    }
+
+    const FlatOBBLanes dx = lanes_load( rays[RAY_DX] + i ),
+                       dy = lanes_load( rays[RAY_DY] + i ),
+                       dz = lanes_load( rays[RAY_DZ] + i );
+    const FlatOBBLanes vx = lanes_sub( cx, lanes_load( rays[RAY_OX] + i ) ),
+                       vy = lanes_sub( cy, lanes_load( rays[RAY_OY] + i ) ),
+                       vz = lanes_sub( cz, lanes_load( rays[RAY_OZ] + i ) );
+    const FlatOBBLanes v_norm = lanes_add( lanes_add( lanes_abs( vx ), lanes_abs( vy ) ),
+                                           lanes_abs( vz ) );
+    const FlatOBBLanes grow = lanes_mul( slack, lanes_add( v_norm, rad ) );
+
+      // parameter interval of the line within each slab of the box
+    FlatOBBLanes entry = neg_inf, exit = inf;
+    for (int k = 0; k < 3; ++k) {
+      const double* axis = box + (BOX_AXIS + 3*k)*n;
+      const FlatOBBLanes ax = lanes_set( axis[0] ), ay = lanes_set( axis[n] ),
+                         az = lanes_set( axis[2*n] );
+      const FlatOBBLanes half = lanes_add( lanes_set( box[(BOX_LENGTH+k)*n] + tol ), grow );
+        // the negative of the ray origin in box coordinates
+      const FlatOBBLanes neg_pos = lanes_dot( ax, ay, az, vx, vy, vz );
+      const FlatOBBLanes par_dir = lanes_dot( ax, ay, az, dx, dy, dz );
+      const FlatOBBLanes t1 = lanes_div( lanes_sub( neg_pos, half ), par_dir );
+      const FlatOBBLanes t2 = lanes_div( lanes_add( neg_pos, half ), par_dir );
+        // no limit for rays (nearly) parallel to the slab
+      const FlatOBBLanes parallel = lanes_gt( dir_slack, lanes_abs( par_dir ) );
+      entry = lanes_max( entry, lanes_select( parallel, neg_inf, lanes_min( t1, t2 ) ) );
+      exit  = lanes_min( exit,  lanes_select( parallel, inf,     lanes_max( t1, t2 ) ) );
+    }
+
+    const FlatOBBLanes t_min = lanes_load( rays[RAY_TMIN] + i );
+    const FlatOBBLanes t_max = lanes_load( rays[RAY_TMAX] + i );
+    const FlatOBBLanes abs_entry = lanes_abs( entry ), abs_exit = lanes_abs( exit );
+    FlatOBBLanes out = lanes_gt( lanes_sub( entry, exit ),
+                                 lanes_mul( slack, lanes_add( abs_entry, abs_exit ) ) );
+    out = lanes_or( out, lanes_gt( lanes_sub( t_min, exit ),
+                                   lanes_mul( slack, lanes_add( abs_exit, lanes_abs( t_min ) ) ) ) );
+    out = lanes_or( out, lanes_gt( lanes_sub( entry, t_max ),
+                                   lanes_mul( slack, lanes_add( abs_entry, t_max ) ) ) );
+
+    reject |= ((Mask)lanes_mask( out ) & lanes) << i;
+  }
+#endif
+  return reject;
+}
+
+  // Screening version of the Plucker sign tests in
+  // GeomUtil::plucker_ray_tri_intersect.  Returns the rays rejected.
+FlatOBBPacket::Mask FlatOBBPacket::screen_triangle( unsigned tri, Mask active,
+                                                    Mask no_pos, Mask no_neg,
+                                                    Mask no_mixed ) const
+{
+  const double* v = &tree.triCoords[9*tri];
+  FlatOBBLanes ea[3][3], eb[3][3], err_a[3], err_b[3];
+  for (int k = 0; k < 3; ++k) {
+    const CartVect v0( v + 3*k ), v1( v + 3*((k+1)%3) );
+    const CartVect a = v1 - v0;
+    const CartVect b = a * v0;
+    const double a_norm = fabs(a[0]) + fabs(a[1]) + fabs(a[2]);
+    for (int j = 0; j < 3; ++j) {
+      ea[k][j] = lanes_set( a[j] );
+      eb[k][j] = lanes_set( b[j] );
+    }
+    err_a[k] = lanes_set( FLAT_OBB_PIP_SLACK * a_norm );
+    err_b[k] = lanes_set( fabs(v0[0]) + fabs(v0[1]) + fabs(v0[2])
+                        + fabs(v1[0]) + fabs(v1[1]) + fabs(v1[2]) );
+  }
+  const FlatOBBLanes zero = lanes_set( 0.0 );
+
+  Mask reject = 0;
+  for (unsigned i = 0; i < numRays; i += FLAT_OBB_LANES) {
+    const Mask lanes = group( active, i );
+    if (!lanes)
+      continue;
+
+    const FlatOBBLanes dx = lanes_load( rays[RAY_DX] + i ),
+                       dy = lanes_load( rays[RAY_DY] + i ),
+                       dz = lanes_load( rays[RAY_DZ] + i );
+    const FlatOBBLanes bx = lanes_load( rays[RAY_BX] + i ),
+                       by = lanes_load( rays[RAY_BY] + i ),
+                       bz = lanes_load( rays[RAY_BZ] + i );
+    const FlatOBBLanes b_norm = lanes_load( rays[RAY_BNORM] + i );
+    FlatOBBLanes pos = lanes_gt( zero, zero ), neg = pos;
+    for (int k = 0; k < 3; ++k) {
+      const FlatOBBLanes pip = lanes_add( lanes_dot( dx, dy, dz, eb[k][0], eb[k][1], eb[k][2] ),
+                                          lanes_dot( bx, by, bz, ea[k][0], ea[k][1], ea[k][2] ) );
+      const FlatOBBLanes err = lanes_mul( err_a[k], lanes_add( err_b[k], b_norm ) );
+      pos = lanes_or( pos, lanes_gt( pip, err ) );
+      neg = lanes_or( neg, lanes_gt( lanes_sub( zero, err ), pip ) );
+    }
+
+    const Mask p = lanes_mask( pos ), q = lanes_mask( neg );
+    const Mask rej = (p & group( no_pos, i )) | (q & group( no_neg, i ))
+                   | (p & q & group( no_mixed, i ));
+    reject |= (rej & lanes) << i;
+  }
+  return reject;
+}
+
+ErrorCode FlatOBBPacket::leaf( unsigned node, Mask active )
+{
+    // sign constraints on the Plucker products from the orientation of
+    // each ray's current surface
+  Mask no_pos = 0, no_neg = 0, no_mixed = 0;
+  for (Mask m = active; m; m &= m - 1) {
+    const unsigned i = first_lane( m );
+    ErrorCode rval = ops[i].begin_leaf();
+    if (MB_SUCCESS != rval)
+      return rval;
+    const int* orient = ops[i].orientation();
+    if (!orient)
+      no_mixed |= (Mask)1 << i;
+    else if (*orient > 0)
+      no_pos |= (Mask)1 << i;
+    else if (*orient < 0)
+      no_neg |= (Mask)1 << i;
+  }
+
+  for (unsigned t = tree.leafTris[node]; t < tree.leafTris[node+1]; ++t) {
+    Mask test = active & ~screen_triangle( t, active, no_pos, no_neg, no_mixed );
+    for (; test; test &= test - 1) {
+      ErrorCode rval = ops[first_lane( test )].test_triangle( t );
+      if (MB_SUCCESS != rval)
+        return rval;
+    }
+  }
+  return MB_SUCCESS;
+}
+
+  // Morton code of a unit direction, quantized to 10 bits per component
+static unsigned direction_key( const double* dir )
+{
+  unsigned key = 0;
+  unsigned q[3];
+  for (int k = 0; k < 3; ++k) {
+    const double c = std::min( std::max( dir[k], -1.0 ), 1.0 );
+    q[k] = std::min( (unsigned)((c + 1.0) * 512.0), 1023u );
+  }
+  for (int b = 9; b >= 0; --b)
+    for (int k = 0; k < 3; ++k)
+      key = (key << 1) | ((q[k] >> b) & 1);
+  return key;
+}
+
+struct FlatOBBPacketFrame { unsigned node; int depth; FlatOBBPacket::Mask rays; };
+
+/* Same traversal as the single-ray query for each ray in the packet.  A ray
+ * that is screened out at a node skips the visit, which has no effect on
+ * its state: the next node it visits is no deeper than the skipped one, and
+ * resets the current surface just as the skipped node would have. */
+ErrorCode FlatOBBPacket::traverse()
+{
+  std::vector<FlatOBBPacketFrame> stack;
+  stack.reserve(64);
+  FlatOBBPacketFrame frame = { 0, 0, all_rays() };
+  stack.push_back( frame );
+  ErrorCode rval;
+
+  while (!stack.empty()) {
+    frame = stack.back();
+    stack.pop_back();
+
+    if (count_lanes( frame.rays ) < MIN_PACKET_RAYS) {
+      for (Mask m = frame.rays; m; m &= m - 1) {
+        int max_depth = -1;
+        rval = ops[first_lane( m )].traverse( frame.node, frame.depth, 0, max_depth );
+        if (MB_SUCCESS != rval)
+          return rval;
+      }
+      continue;
+    }
+
+    Mask descend = 0;
+    for (Mask m = frame.rays & ~screen_box( frame.node, frame.rays ); m; m &= m - 1) {
+      const unsigned i = first_lane( m );
+      bool ray_descend = true;
+      rval = ops[i].visit( frame.node, frame.depth, ray_descend );
+      if (MB_SUCCESS != rval)
+        return rval;
+      if (ray_descend)
+        descend |= (Mask)1 << i;
+    }
+    if (!descend)
+      continue;
+
+    const int* children = &tree.nodeChildren[2*frame.node];
+    if (children[0] < 0) {
+      rval = leaf( frame.node, descend );
+      if (MB_SUCCESS != rval)
+        return rval;
+    }
+    else {
+      FlatOBBPacketFrame child = { (unsigned)children[0], frame.depth + 1, descend };
+      stack.push_back( child );
+      child.node = children[1];
+      stack.push_back( child );
+    }
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode FlatOBBTree::ray_intersect_sets( unsigned                   num_rays,
+                                           std::vector<double>*       distances_out,
+                                           std::vector<EntityHandle>* sets_out,
+                                           std::vector<EntityHandle>* facets_out,
+                                           double                     tolerance,
+                                           int                        min_tolerance_intersections,
+                                           const double*              ray_points,
+                                           const double*              unit_ray_dirs,
+                                           const double*              nonneg_ray_lens,
+                                           const double*              neg_ray_lens,
+                                           const EntityHandle*        geom_vol,
+                                           const int*                 desired_orient,
+                                           const std::vector<EntityHandle>* const* prev_facets ) const
+{
+  if (empty())
+    return MB_ENTITY_NOT_FOUND;
+
+    // Group rays with similar directions into packets, so that they
+    // tend to visit the same nodes.  The rays are independent, so the
+    // grouping does not change the results.
+  std::vector< std::pair<unsigned,unsigned> > order( num_rays );
+  for (unsigned i = 0; i < num_rays; ++i)
+    order[i] = std::make_pair( direction_key( unit_ray_dirs + 3*i ), i );
+  std::sort( order.begin(), order.end() );
+
+  std::vector<FlatRayIntersectSets> ops;
+  ops.reserve( FlatOBBPacket::PACKET_SIZE );
+  for (unsigned first = 0; first < num_rays; first += FlatOBBPacket::PACKET_SIZE) {
+    const unsigned count = std::min( num_rays - first, (unsigned)FlatOBBPacket::PACKET_SIZE );
+    ops.clear();
+    for (unsigned j = first; j < first + count; ++j) {
+      const unsigned i = order[j].second;
+      ops.push_back( FlatRayIntersectSets( *this, ray_points + 3*i, unit_ray_dirs + 3*i,
+                                           nonneg_ray_lens ? nonneg_ray_lens + i : 0,
+                                           neg_ray_lens ? neg_ray_lens + i : 0,
+                                           tolerance, min_tolerance_intersections,
+                                           distances_out[i], sets_out[i], facets_out[i],
+                                           geom_vol, desired_orient,
+                                           prev_facets ? prev_facets[i] : 0, 0 ) );
+    }
+
+    FlatOBBPacket packet( *this, ops );
+    for (unsigned j = 0; j < count; ++j) {
+      const unsigned i = order[first+j].second;
+      packet.set_ray( j, ray_points + 3*i, unit_ray_dirs + 3*i );
+    }
+    ErrorCode rval = packet.traverse();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+
+  return MB_SUCCESS;
+}
+
+} // namespace moab
@@ -172,7 +172,8 @@ ErrorCode GeomTopoTool::find_geomsets(Range *ranges)
   return MB_SUCCESS;
 }
 
-ErrorCode GeomTopoTool::construct_obb_trees(bool make_one_vol)
+ErrorCode GeomTopoTool::construct_obb_trees(bool make_one_vol,
+                                            const OrientedBoxTreeTool::Settings* settings)
 {
   ErrorCode rval;
 
@@ -234,7 +235,7 @@ ErrorCode GeomTopoTool::construct_obb_trees(bool make_one_vol)
       std::cerr << "WARNING: Surface has no facets." << std::endl;
     }
 
-    rval = obbTree.build(tris, root);
+    rval = obbTree.build(tris, root, settings);
     if (MB_SUCCESS != rval)
       return rval;
 
@@ -272,7 +273,7 @@ ErrorCode GeomTopoTool::construct_obb_trees(bool make_one_vol)
 
     // build OBB tree for volume
     if (!make_one_vol) {
-      rval = obbTree.join_trees(trees, root);
+      rval = obbTree.join_trees(trees, root, settings);
       if (MB_SUCCESS != rval)
         return rval;
       if (contiguous)
@@ -284,7 +285,7 @@ ErrorCode GeomTopoTool::construct_obb_trees(bool make_one_vol)
 
   // build OBB tree for volume
   if (make_one_vol) {
-    rval = obbTree.join_trees(trees, root);
+    rval = obbTree.join_trees(trees, root, settings);
     if (MB_SUCCESS != rval)
       return rval;
     oneVolRootSet = root;
@@ -15,11 +15,16 @@
 #include <iomanip>
 
 #include <stdlib.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace moab {
 
 MergeMesh::MergeMesh(Interface *impl, bool printErrorIn) :
-    mbImpl(impl), mbMergeTag(0), mergeTol(0.001), mergeTolSq(0.000001), printError(printErrorIn)
+    mbImpl(impl), mbMergeTag(0), mergeTol(0.001), mergeTolSq(0.000001), printError(printErrorIn),
+    searchMethod(KD_TREE), numThreads(1)
 {
 }
 
@@ -76,26 +81,20 @@ ErrorCode MergeMesh::merge_entities(Range &elems,
   if (MB_SUCCESS != result)
     return result;
 
-  // create a tag to mark merged-to entity; reuse tree_root
-  EntityHandle tree_root = 0;
+  // create a tag to mark merged-to entity
+  EntityHandle def_val = 0;
   if (0 == merge_tag)
   {
     result = mbImpl->tag_get_handle("__merge_tag", 1, MB_TYPE_HANDLE,
-        mbMergeTag, MB_TAG_DENSE | MB_TAG_EXCL, &tree_root);
+        mbMergeTag, MB_TAG_DENSE | MB_TAG_EXCL, &def_val);
     if (MB_SUCCESS != result)
       return result;
   }
   else
     mbMergeTag = merge_tag;
 
-  // build a kd tree with the vertices
-  AdaptiveKDTree kd(mbImpl);
-  result = kd.build_tree(skin_range, &tree_root);
-  if (MB_SUCCESS != result)
-    return result;
-
   // find matching vertices, mark them
-  result = find_merged_to(tree_root, kd, mbMergeTag);
+  result = find_merged_to(skin_range, mbMergeTag);
   if (MB_SUCCESS != result)
     return result;
 
@@ -141,13 +140,8 @@ ErrorCode MergeMesh::merge_all(EntityHandle meshset, const double merge_tol)
   Range verts;
   rval = mbImpl->get_connectivity(entities, verts); MB_CHK_ERR(rval);
 
-  // build a kd tree with the vertices
-  AdaptiveKDTree kd(mbImpl);
-  EntityHandle tree_root;
-  rval = kd.build_tree(verts, &tree_root);MB_CHK_ERR(rval);
-
   // find matching vertices, mark them
-  rval = find_merged_to(tree_root, kd, mbMergeTag); MB_CHK_ERR(rval);
+  rval = find_merged_to(verts, mbMergeTag); MB_CHK_ERR(rval);
 
   rval = perform_merge(mbMergeTag); MB_CHK_ERR(rval);
 
@@ -269,6 +263,20 @@ ErrorCode MergeMesh::merge_using_integer_tag(Range & verts, Tag user_tag, Tag me
 
   return rval;
 }
+ErrorCode MergeMesh::find_merged_to(const Range &verts, Tag merge_tag)
+{
+  if (GRID == searchMethod)
+    return find_merged_to_grid(verts, merge_tag);
+
+  // build a kd tree with the vertices
+  AdaptiveKDTree kd(mbImpl);
+  EntityHandle tree_root;
+  ErrorCode result = kd.build_tree(verts, &tree_root);
+  if (MB_SUCCESS != result)
+    return result;
+  return find_merged_to(tree_root, kd, merge_tag);
+}
+
 ErrorCode MergeMesh::find_merged_to(EntityHandle &tree_root,
     AdaptiveKDTree &tree, Tag merge_tag)
 {
@@ -395,6 +403,192 @@ ErrorCode MergeMesh::find_merged_to(EntityHandle &tree_root,
   return MB_SUCCESS;
 }
 
+// vertex binned in a cell of the merge grid
+struct GridVertex
+{
+  long cell[3];  // integer cell coordinates
+  size_t index;  // index of vertex in input range
+
+  bool operator<(const GridVertex& other) const
+  {
+    for (int d = 0; d < 3; ++d)
+      if (cell[d] != other.cell[d])
+        return cell[d] < other.cell[d];
+    return index < other.index;
+  }
+};
+
+// compare cells of grid vertices, ignoring the vertex index
+static bool cell_less(const GridVertex& a, const GridVertex& b)
+{
+  return a.cell[0] < b.cell[0] || (a.cell[0] == b.cell[0] &&
+        (a.cell[1] < b.cell[1] || (a.cell[1] == b.cell[1] && a.cell[2] < b.cell[2])));
+}
+
+// pair of coincident vertices, as indices into the input range
+struct MergePair
+{
+  size_t keep, dead;
+
+  bool operator<(const MergePair& other) const
+  {
+    return keep < other.keep || (keep == other.keep && dead < other.dead);
+  }
+};
+
+// sort list by sorting one chunk per thread and merging pairs of chunks
+template <typename T>
+static void sort_chunks(std::vector<T>& list, int num_threads)
+{
+  if (num_threads < 2 || list.size() < (size_t)num_threads)
+  {
+    std::sort(list.begin(), list.end());
+    return;
+  }
+  std::vector<size_t> bounds(num_threads + 1);
+  for (int t = 0; t <= num_threads; ++t)
+    bounds[t] = list.size() * t / num_threads;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+  for (int t = 0; t < num_threads; ++t)
+    std::sort(list.begin() + bounds[t], list.begin() + bounds[t + 1]);
+  for (int step = 1; step < num_threads; step *= 2)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+    for (int t = 0; t < num_threads - step; t += 2 * step)
+    {
+      const int last = std::min(t + 2 * step, num_threads);
+      std::inplace_merge(list.begin() + bounds[t], list.begin() + bounds[t + step],
+          list.begin() + bounds[last]);
+    }
+  }
+}
+
+ErrorCode MergeMesh::find_merged_to_grid(const Range &verts, Tag merge_tag)
+{
+  // Bin vertices in cells with an edge length of the merge tolerance, such
+  // that coincident vertices are either in the same cell or in one of the
+  // 26 neighboring cells.  For each occupied cell, compare its vertices to
+  // each other and to those in the 13 neighboring cells that sort after it,
+  // so that each pair of cells is checked once.  Candidate pairs are found in
+  // parallel, then each vertex not already merged keeps all vertices coincident
+  // with it that have a larger handle.
+  if (verts.empty())
+    return MB_SUCCESS;
+
+  const int num_threads = numThreads > 0 ? numThreads : 1;
+  const size_t count = verts.size();
+  std::vector<double> coords(3 * count);
+  ErrorCode result = mbImpl->get_coords(verts, &coords[0]);
+  if (MB_SUCCESS != result)
+    return result;
+  std::vector<EntityHandle> merge_tag_val(count);
+  result = mbImpl->tag_get_data(merge_tag, verts, &merge_tag_val[0]);
+  if (MB_SUCCESS != result)
+    return result;
+
+  const double cell_size = mergeTol > 0.0 ? mergeTol : 1.0;
+  std::vector<GridVertex> grid(count);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+  for (long i = 0; i < (long)count; ++i)
+  {
+    for (int d = 0; d < 3; ++d)
+      grid[i].cell[d] = (long)floor(coords[3 * i + d] / cell_size);
+    grid[i].index = i;
+  }
+  sort_chunks(grid, num_threads);
+
+  // start of each occupied cell in sorted list
+  std::vector<size_t> cell_start;
+  for (size_t i = 0; i < count; ++i)
+    if (0 == i || cell_less(grid[i - 1], grid[i]))
+      cell_start.push_back(i);
+  const long num_cells = cell_start.size();
+  cell_start.push_back(count);
+
+  std::vector< std::vector<MergePair> > thread_pairs(num_threads);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,256) num_threads(num_threads)
+#endif
+  for (long c = 0; c < num_cells; ++c)
+  {
+#ifdef _OPENMP
+    std::vector<MergePair>& pairs = thread_pairs[omp_get_thread_num()];
+#else
+    std::vector<MergePair>& pairs = thread_pairs[0];
+#endif
+    const size_t begin = cell_start[c], end = cell_start[c + 1];
+    for (int n = 0; n < 14; ++n)
+    {
+      // offsets of this cell (n=0) and the neighbors that sort after it
+      GridVertex key = grid[begin];
+      const int off = 13 + n;
+      key.cell[0] += off / 9 - 1;
+      key.cell[1] += (off / 3) % 3 - 1;
+      key.cell[2] += off % 3 - 1;
+      size_t nbegin = begin, nend = end;
+      if (n)
+      {
+        std::vector<GridVertex>::const_iterator it =
+            std::lower_bound(grid.begin() + end, grid.end(), key, cell_less);
+        if (it == grid.end() || cell_less(key, *it))
+          continue;
+        nbegin = it - grid.begin();
+        nend = *(std::upper_bound(cell_start.begin(), cell_start.end(), nbegin));
+      }
+      for (size_t i = begin; i < end; ++i)
+      {
+        const size_t vi = grid[i].index;
+        const CartVect from(&coords[3 * vi]);
+        for (size_t j = n ? nbegin : i + 1; j < nend; ++j)
+        {
+          const size_t vj = grid[j].index;
+          if ((from - CartVect(&coords[3 * vj])).length_squared() < mergeTolSq)
+          {
+            MergePair p = { std::min(vi, vj), std::max(vi, vj) };
+            pairs.push_back(p);
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<MergePair> pairs;
+  for (int t = 0; t < num_threads; ++t)
+  {
+    pairs.insert(pairs.end(), thread_pairs[t].begin(), thread_pairs[t].end());
+    std::vector<MergePair>().swap(thread_pairs[t]);
+  }
+  std::sort(pairs.begin(), pairs.end());
+
+  // vertices already merged (in the tag) neither keep nor merge
+  std::vector<EntityHandle> handles(verts.begin(), verts.end());
+  std::vector<EntityHandle> dead;
+  std::vector<EntityHandle> dead_to;
+  for (std::vector<MergePair>::const_iterator p = pairs.begin(); p != pairs.end(); ++p)
+  {
+    if (merge_tag_val[p->keep] || merge_tag_val[p->dead])
+      continue;
+    merge_tag_val[p->dead] = handles[p->keep];
+    dead.push_back(handles[p->dead]);
+    dead_to.push_back(merge_tag_val[p->dead]);
+  }
+  if (dead.empty())
+    return MB_SUCCESS;
+
+  result = mbImpl->tag_set_data(merge_tag, &dead[0], dead.size(), &dead_to[0]);
+  if (MB_SUCCESS != result)
+    return result;
+  std::sort(dead.begin(), dead.end());
+  std::copy(dead.rbegin(), dead.rend(), range_inserter(deadEnts));
+  return MB_SUCCESS;
+}
+
 //Determine which higher dimensional entities should be merged
 ErrorCode MergeMesh::merge_higher_dimensions(Range &elems)
 {
@@ -218,7 +218,8 @@ OrientedBoxTreeTool::Settings::Settings()
     max_depth( 0 ),
     worst_split_ratio( 0.95 ),
     best_split_ratio( 0.4 ),
-    set_options( MESHSET_SET )
+    set_options( MESHSET_SET ),
+    sah_bins( 0 )
   {}
 
 bool OrientedBoxTreeTool::Settings::valid() const
@@ -228,6 +229,7 @@ bool OrientedBoxTreeTool::Settings::valid() const
       && worst_split_ratio <= 1.0
       && best_split_ratio >= 0.0
       && worst_split_ratio >= best_split_ratio
+      && (sah_bins == 0 || sah_bins >= 2)
       ;
 }
 
@@ -372,6 +374,155 @@ static ErrorCode split_box( Interface* instance,
 }
 
 
+/**\brief Split triangles with a binned surface area heuristic
+ *
+ * Bin the entity centroids along each axis of the box, and choose the
+ * plane between two bins, among all axes, that minimizes the sum over
+ * both sides of the number of entities times the surface area of their
+ * bounding box (in the coordinate frame of the box).  Entity bounds are
+ * not split, so the two sides may overlap.
+ *\param instance   MOAB instance
+ *\param box        The oriented box containing all the entities
+ *\param num_bins   Number of bins along each axis
+ *\param left_list  Output, entities to the left of the plane
+ *\param right_list Output, entities to the right of the plane; both
+ *                  lists are empty if no plane separates the centroids
+ */
+static ErrorCode sah_split( Interface* instance,
+                            const OrientedBox& box,
+                            int num_bins,
+                            const Range& entities,
+                            Range& left_list,
+                            Range& right_list )
+{
+  ErrorCode rval;
+  left_list.clear();
+  right_list.clear();
+
+  CartVect axes[3];
+  for (int a = 0; a < 3; ++a) {
+    axes[a] = box.axis[a];
+    axes[a].normalize();
+  }
+
+    // centroid, lower and upper bound of each entity along each axis
+  const size_t n = entities.size();
+  std::vector<double> ent_data( 9*n );
+  double cmin[3], cmax[3];
+  for (int a = 0; a < 3; ++a) {
+    cmin[a] = std::numeric_limits<double>::max();
+    cmax[a] = -std::numeric_limits<double>::max();
+  }
+  std::vector<CartVect> coords;
+  double* d = &ent_data[0];
+  for (Range::const_iterator i = entities.begin(); i != entities.end(); ++i, d += 9) {
+    const EntityHandle *conn = NULL;
+    int conn_len = 0;
+    rval = instance->get_connectivity( *i, conn, conn_len );
+    if (MB_SUCCESS != rval)
+      return rval;
+
+    coords.resize( conn_len );
+    rval = instance->get_coords( conn, conn_len, coords[0].array() );
+    if (MB_SUCCESS != rval)
+      return rval;
+
+    for (int a = 0; a < 3; ++a) {
+      double lo = std::numeric_limits<double>::max(), hi = -lo, sum = 0.0;
+      for (int j = 0; j < conn_len; ++j) {
+        const double p = axes[a] % (coords[j] - box.center);
+        lo = std::min( lo, p );
+        hi = std::max( hi, p );
+        sum += p;
+      }
+      d[a] = sum / conn_len;
+      d[3+a] = lo;
+      d[6+a] = hi;
+      cmin[a] = std::min( cmin[a], d[a] );
+      cmax[a] = std::max( cmax[a], d[a] );
+    }
+  }
+
+    // per bin: count, and lower and upper bounds on each axis
+  std::vector<int> counts( num_bins );
+  std::vector<double> bounds( 6*num_bins ), left_cost( num_bins );
+  double best_cost = std::numeric_limits<double>::max();
+  int best_axis = -1, best_plane = -1;
+  for (int a = 0; a < 3; ++a) {
+    if (!(cmax[a] > cmin[a]))
+      continue;
+    const double scale = num_bins / (cmax[a] - cmin[a]);
+
+    std::fill( counts.begin(), counts.end(), 0 );
+    for (int b = 0; b < num_bins; ++b)
+      for (int k = 0; k < 3; ++k) {
+        bounds[6*b+k] = std::numeric_limits<double>::max();
+        bounds[6*b+3+k] = -std::numeric_limits<double>::max();
+      }
+    d = &ent_data[0];
+    for (size_t i = 0; i < n; ++i, d += 9) {
+      const int b = std::min( num_bins - 1, (int)(scale * (d[a] - cmin[a])) );
+      ++counts[b];
+      for (int k = 0; k < 3; ++k) {
+        bounds[6*b+k] = std::min( bounds[6*b+k], d[3+k] );
+        bounds[6*b+3+k] = std::max( bounds[6*b+3+k], d[6+k] );
+      }
+    }
+
+      // sweep from the left, then from the right, accumulating bounds;
+      // the cost of plane b separates bins [0,b] from [b+1,num_bins)
+    for (int dir = 0; dir < 2; ++dir) {
+      double lo[3], hi[3];
+      for (int k = 0; k < 3; ++k) {
+        lo[k] = std::numeric_limits<double>::max();
+        hi[k] = -std::numeric_limits<double>::max();
+      }
+      int count = 0;
+      for (int j = 0; j < num_bins - 1; ++j) {
+        const int b = dir ? num_bins - 1 - j : j;
+        count += counts[b];
+        for (int k = 0; k < 3; ++k) {
+          lo[k] = std::min( lo[k], bounds[6*b+k] );
+          hi[k] = std::max( hi[k], bounds[6*b+3+k] );
+        }
+        double cost = std::numeric_limits<double>::max();
+        if (count) {
+          const double x = hi[0] - lo[0], y = hi[1] - lo[1], z = hi[2] - lo[2];
+          cost = count * (x*y + y*z + z*x);
+        }
+        if (!dir) {
+          left_cost[b] = cost;
+        }
+        else if (count && left_cost[b-1] < std::numeric_limits<double>::max()) {
+          cost += left_cost[b-1];
+          if (cost < best_cost) {
+            best_cost = cost;
+            best_axis = a;
+            best_plane = b - 1;
+          }
+        }
+      }
+    }
+  }
+
+  if (best_axis < 0)
+    return MB_SUCCESS;
+
+  const double scale = num_bins / (cmax[best_axis] - cmin[best_axis]);
+  d = &ent_data[9*n];
+  for (Range::const_reverse_iterator i = entities.rbegin(); i != entities.rend(); ++i) {
+    d -= 9;
+    const int b = std::min( num_bins - 1, (int)(scale * (d[best_axis] - cmin[best_axis])) );
+    if (b <= best_plane)
+      left_list.insert( *i );
+    else
+      right_list.insert( *i );
+  }
+
+  return MB_SUCCESS;
+}
+
+
 ErrorCode OrientedBoxTreeTool::build_tree( const Range& entities,
                                                EntityHandle& set,
                                                int depth,
@@ -408,6 +559,16 @@ ErrorCode OrientedBoxTreeTool::build_tree( const Range& entities,
       // until we find an acceptable split
     double best_ratio = settings.worst_split_ratio; // worst case ratio
     Range best_left_list, best_right_list;
+      // use the surface area heuristic if requested, and the planes
+      // through the box center if it cannot separate the entities
+    if (settings.sah_bins) {
+      rval = sah_split( instance, tmp_box, settings.sah_bins, entities,
+                        best_left_list, best_right_list );
+      if (MB_SUCCESS != rval)
+        { delete_tree( set ); return rval; }
+      if (!best_left_list.empty())
+        best_ratio = 0.0;
+    }
       // Axes are sorted from shortest to longest, so search backwards
     for (int axis = 2; best_ratio > settings.best_split_ratio && axis >= 0; --axis) {
       Range left_list, right_list;
@@ -48,6 +48,9 @@ ErrorCode ReadUtil::get_node_coords(const int /*num_arrays*/,
   ErrorCode error;
   EntitySequence* seq = 0;
 
+  if (mMB->is_frozen())
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   if (num_nodes < 1) {
     actual_start_handle = 0;
     arrays.clear();
@@ -89,6 +92,9 @@ ErrorCode ReadUtil::get_element_connect(const int num_elements,
   ErrorCode error;
   EntitySequence* seq;
 
+  if (mMB->is_frozen())
+    MB_SET_ERR(MB_FAILURE, "Cannot modify frozen mesh");
+
   if (num_elements < 1) {
     actual_start_handle = 0;
     array = 0;
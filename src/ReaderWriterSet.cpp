@@ -120,6 +120,9 @@ ReaderWriterSet::ReaderWriterSet(Core* mdb)
 
   register_factory( ReadVtk::factory, WriteVtk::factory, "Kitware VTK", "vtk", "VTK" );
 
+  const char* vtu_sufxs[] = { "vtu", "pvtu", NULL };
+  register_factory( ReadVtk::factory, WriteVtk::factory, "Kitware VTK XML unstructured grid", vtu_sufxs, "VTU" );
+
   register_factory( ReadSms::factory, NULL, "RPI SMS", "sms", "SMS" );
 
   register_factory( Tqdcfr::factory, NULL, "Cubit", "cub", "CUBIT" );
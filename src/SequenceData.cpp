@@ -10,6 +10,8 @@ SequenceData::~SequenceData()
   for (int i = -numSequenceData; i <= (int)numTagData; ++i)
     free( arraySet[i] );
   free( arraySet - numSequenceData );
+  free( compactAdjOffsets );
+  free( compactAdjList );
 }
 
 void* SequenceData::create_data( int index, int bytes_per_ent, const void* initial_value )
@@ -53,6 +55,20 @@ SequenceData::AdjacencyDataType* SequenceData::allocate_adjacency_data()
   return reinterpret_cast<AdjacencyDataType*>(arraySet[0]);
 }
 
+void SequenceData::release_adjacency_data()
+{
+  free( arraySet[0] );
+  arraySet[0] = 0;
+}
+
+void SequenceData::set_compact_adjacency( EntityID* offsets, EntityHandle* list )
+{
+  free( compactAdjOffsets );
+  free( compactAdjList );
+  compactAdjOffsets = offsets;
+  compactAdjList = list;
+}
+
 void SequenceData::increase_tag_count( unsigned amount )
 {
   void** list = arraySet - numSequenceData;
@@ -92,6 +108,8 @@ SequenceData::SequenceData( const SequenceData* from,
                             const int* sequence_data_sizes )
   : numSequenceData( from->numSequenceData ),
     numTagData( from->numTagData ),
+    compactAdjOffsets( 0 ),
+    compactAdjList( 0 ),
     startHandle( start ),
     endHandle( end )
 {
@@ -110,6 +128,17 @@ SequenceData::SequenceData( const SequenceData* from,
   copy_data_subset( 0, sizeof(AdjacencyDataType*), from->get_adjacency_data(), offset, count );
   for (unsigned i = 1; i <= numTagData; ++i)
     arraySet[i] = 0;
+  
+  if (from->compactAdjOffsets) {
+    const EntityID* from_offsets = from->compactAdjOffsets + offset;
+    const size_t list_size = from_offsets[count] - from_offsets[0];
+    compactAdjOffsets = (EntityID*)malloc( sizeof(EntityID) * (count + 1) );
+    for (size_t i = 0; i <= count; ++i)
+      compactAdjOffsets[i] = from_offsets[i] - from_offsets[0];
+    compactAdjList = (EntityHandle*)malloc( sizeof(EntityHandle) * list_size );
+    memcpy( compactAdjList, from->compactAdjList + from_offsets[0], 
+            sizeof(EntityHandle) * list_size );
+  }
 }
 
 void SequenceData::copy_data_subset( int index, 
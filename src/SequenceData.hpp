@@ -51,6 +51,22 @@ public:
   AdjacencyDataType const* get_adjacency_data( ) const 
                 { return reinterpret_cast<AdjacencyDataType const*>(arraySet[0]); }
   
+  /**\return offsets into compact adjacency list, or NULL if none.
+   *
+   * Compact adjacencies for the entity at index i in this SequenceData 
+   * are get_compact_adjacency_list()[offsets[i]] through 
+   * get_compact_adjacency_list()[offsets[i+1]-1].  An entry in the
+   * per-entity adjacency array takes precedence over the compact list.
+   */
+  EntityID const* get_compact_adjacency_offsets( ) const
+                { return compactAdjOffsets; }
+  /**\return compact adjacency list, or NULL if none. */
+  EntityHandle*       get_compact_adjacency_list( )
+                { return compactAdjList; }
+  /**\return compact adjacency list, or NULL if none. */
+  EntityHandle const* get_compact_adjacency_list( ) const
+                { return compactAdjList; }
+  
   /**\return array of dense tag data, or NULL if none. */
   void*       get_tag_data( unsigned tag_num )              
                 { return tag_num < numTagData  ? arraySet[tag_num+1] : 0; }
@@ -90,6 +106,22 @@ public:
    */
   AdjacencyDataType* allocate_adjacency_data();
   
+  /**\brief Free array for storing adjacency data.
+   *
+   * Free the per-entity adjacency array.  Does not free the
+   * adjacency lists it points to.
+   */
+  void release_adjacency_data();
+  
+  /**\brief Replace compact adjacency storage
+   *
+   * Free any existing compact adjacency storage and take ownership
+   * of the passed arrays, which must have been allocated with malloc.
+   *\param offsets  Array of size()+1 offsets into list, or NULL.
+   *\param list     Concatenated adjacency lists, or NULL.
+   */
+  void set_compact_adjacency( EntityID* offsets, EntityHandle* list );
+  
   /**\brief Allocate array of dense tag data
    *
    * Allocate an array of dense tag data.
@@ -146,6 +178,8 @@ private:
   const int numSequenceData;
   unsigned numTagData;
   void** arraySet;
+  EntityID* compactAdjOffsets;
+  EntityHandle* compactAdjList;
   EntityHandle startHandle, endHandle;
 };
 
@@ -154,6 +188,8 @@ inline SequenceData::SequenceData( int num_sequence_arrays,
                                    EntityHandle end )
   : numSequenceData(num_sequence_arrays),
     numTagData(0),
+    compactAdjOffsets(0),
+    compactAdjList(0),
     startHandle(start),
     endHandle(end)
 {
@@ -35,6 +35,14 @@ class SequenceManager
         return typeData[TYPE_FROM_HANDLE(handle)].find( handle, sequence_out );
       }
     
+      /** Stop (or resume) updating last accessed sequence in find(),
+       *  such that lookups may be done concurrently.  See Core::freeze */
+    void freeze( bool frozen )
+      {
+        for (EntityType t = MBVERTEX; t < MBMAXTYPE; ++t)
+          typeData[t].freeze( frozen );
+      }
+    
       /** Get all entities of a given EntityType, return all entities
        *  if type == MBMAXTYPE */
     void get_entities( EntityType type, Range& entities_out ) const
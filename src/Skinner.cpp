@@ -1048,6 +1048,15 @@ ErrorCode Skinner::find_skin_vertices( const EntityHandle this_set,
   if (dim < 1 || dim > 3 || !entities.all_of_dimension(dim))
     return MB_TYPE_OUT_OF_RANGE;
   
+  if (mNumThreads > 0 && dim > 1) {
+    bool supported;
+    rval = find_skin_threaded( this_set, entities, skin_verts, skin_elems,
+                               skin_rev_elems, create_skin_elems, corners_only,
+                               supported );
+    if (MB_SUCCESS != rval || supported)
+      return rval;
+  }
+  
     // are we skinning all entities
   size_t count = entities.size();
   int num_total;
@@ -2089,4 +2098,334 @@ ErrorCode Skinner::find_skin_vertices_3D(const EntityHandle this_set, Tag tag,
   return MB_SUCCESS;
 }
 
+// Block of entities with contiguous connectivity, as returned
+// by connect_iterate
+struct SkinConnBlock {
+  EntityHandle start;        //!< handle of first entity in block
+  const EntityHandle* conn;  //!< connectivity of first entity
+  int verts_per_entity;      //!< length of connectivity of each entity
+  size_t count;              //!< number of entities in block
+};
+
+// A side of an element, or an existing entity that may represent
+// the side of an element, identified by its sorted corner vertices.
+struct SkinSide {
+  EntityHandle corners[4]; //!< sorted corner vertices, padded with zeros
+  EntityHandle handle;     //!< element, or existing side entity
+  int side;                //!< side number in element, or -1 for existing entity
+  
+  bool same_corners( const SkinSide& other ) const 
+  {
+    return corners[0] == other.corners[0] && corners[1] == other.corners[1]
+        && corners[2] == other.corners[2] && corners[3] == other.corners[3];
+  }
+  
+  bool operator<( const SkinSide& other ) const 
+  {
+    for (int i = 0; i < 4; ++i)
+      if (corners[i] != other.corners[i])
+        return corners[i] < other.corners[i];
+    return handle < other.handle || (handle == other.handle && side < other.side);
+  }
+};
+
+// A side that is on the skin, and the existing entity representing it, if any
+struct SkinResult {
+  EntityHandle elem;      //!< element that this is a side of
+  int side;               //!< side number in element
+  EntityHandle side_ent;  //!< lowest handle of existing entity for side, or zero
+  
+  bool operator<( const SkinResult& other ) const
+    { return elem < other.elem || (elem == other.elem && side < other.side); }
+};
+
+// Get connectivity pointers for a range of entities.  Returns
+// false in 'explicit_conn' if any entity does not have explicitly
+// stored connectivity (e.g. structured mesh.)
+static ErrorCode get_skin_conn_blocks( Interface* mb, const Range& ents,
+                                       std::vector<SkinConnBlock>& blocks,
+                                       bool& explicit_conn )
+{
+  std::vector<EntityHandle> storage;
+  const EntityHandle* conn;
+  EntityHandle* conn_ptr;
+  int len, count;
+  explicit_conn = true;
+  Range::const_iterator i = ents.begin();
+  while (i != ents.end()) {
+      // connect_iterate fails noisily for structured mesh, so check first
+    storage.clear();
+    ErrorCode rval = mb->get_connectivity( *i, conn, len, false, &storage );
+    if (MB_SUCCESS != rval) return rval;
+    if (!storage.empty()) {
+      explicit_conn = false;
+      return MB_SUCCESS;
+    }
+    
+    rval = mb->connect_iterate( i, ents.end(), conn_ptr, len, count );
+    if (MB_SUCCESS != rval) return rval;
+    SkinConnBlock block = { *i, conn_ptr, len, (size_t)count };
+    blocks.push_back( block );
+    i += count;
+  }
+  return MB_SUCCESS;
+}
+
+// Choose one of 'num_buckets' lists for a side, such that all
+// instances of a side end up in the same list
+static inline size_t skin_bucket( const SkinSide& side, size_t num_buckets )
+{
+  EntityHandle h = 0;
+  for (int i = 0; i < 4; ++i)
+    h = (h ^ side.corners[i]) * 2654435761u;
+  return (size_t)(h ^ (h >> 29)) % num_buckets;
+}
+
+// Add the sides of entities [first,last) in the concatenated list of blocks to
+// the per-bucket lists.  If 'side_dim' is less than the dimension of the
+// entities, add each side of dimension 'side_dim' of each element.  Otherwise
+// the entities are themselves candidate sides.
+static void get_skin_sides( const std::vector<SkinConnBlock>& blocks,
+                            const std::vector<size_t>& offsets,
+                            size_t first, size_t last, int side_dim,
+                            size_t num_buckets, std::vector<SkinSide>* buckets )
+{
+  SkinSide s;
+  size_t b = std::upper_bound( offsets.begin(), offsets.end(), first ) - offsets.begin() - 1;
+  for (size_t idx = first; idx < last; ++b) {
+    const SkinConnBlock& block = blocks[b];
+    const EntityType type = TYPE_FROM_HANDLE(block.start);
+    const size_t end = std::min( last - offsets[b], block.count );
+    
+    if (CN::Dimension(type) == side_dim) {
+        // use only corners of higher-order entities, and only
+        // polygons that could be the side of an element
+      const int num_corners = MBPOLYGON == type ? block.verts_per_entity
+                                                : CN::VerticesPerEntity(type);
+      for (size_t k = idx - offsets[b]; k < end; ++k, ++idx) {
+        if (num_corners > 4)
+          continue;
+        const EntityHandle* conn = block.conn + k*block.verts_per_entity;
+        std::fill( s.corners, s.corners + 4, 0 );
+        std::copy( conn, conn + num_corners, s.corners );
+        std::sort( s.corners, s.corners + num_corners );
+        s.handle = block.start + k;
+        s.side = -1;
+        buckets[skin_bucket( s, num_buckets )].push_back( s );
+      }
+    }
+    else {
+      const int num_sides = CN::NumSubEntities( type, side_dim );
+      for (size_t k = idx - offsets[b]; k < end; ++k, ++idx) {
+        const EntityHandle* conn = block.conn + k*block.verts_per_entity;
+        s.handle = block.start + k;
+        for (int f = 0; f < num_sides; ++f) {
+          EntityType side_type;
+          int num_corners;
+          const short* indices = CN::SubEntityVertexIndices( type, side_dim, f, 
+                                                             side_type, num_corners );
+          std::fill( s.corners, s.corners + 4, 0 );
+          for (int c = 0; c < num_corners; ++c)
+            s.corners[c] = conn[indices[c]];
+          std::sort( s.corners, s.corners + num_corners );
+          s.side = f;
+          buckets[skin_bucket( s, num_buckets )].push_back( s );
+        }
+      }
+    }
+  }
+}
+
+// Sort the list of sides and pass back those that are the side of
+// exactly one element, along with the first existing entity (if any)
+// that has the same corners.
+static void match_skin_sides( std::vector<SkinSide>& list, 
+                              std::vector<SkinResult>& results )
+{
+  std::sort( list.begin(), list.end() );
+  size_t i = 0;
+  while (i < list.size()) {
+    SkinResult r = { 0, 0, 0 };
+    int num_elem = 0;
+    size_t j = i;
+    for (; j < list.size() && list[j].same_corners( list[i] ); ++j) {
+      if (list[j].side < 0) {
+        if (!r.side_ent)
+          r.side_ent = list[j].handle;
+      }
+      else {
+        ++num_elem;
+        r.elem = list[j].handle;
+        r.side = list[j].side;
+      }
+    }
+    if (1 == num_elem)
+      results.push_back( r );
+    i = j;
+  }
+}
+
+ErrorCode Skinner::find_skin_threaded( const EntityHandle this_set,
+                                       const Range& entities,
+                                       Range* skin_verts,
+                                       Range* skin_sides,
+                                       Range* reversed_sides,
+                                       bool create_sides,
+                                       bool corners_only,
+                                       bool& supported )
+{
+  // Every side of every element is listed along with all existing entities
+  // of the side dimension.  Sides are distributed into several buckets per thread
+  // by a hash of their sorted corner vertices such that all instances of a
+  // side end up in the same bucket.  Each bucket is then sorted to find the
+  // sides that occur for exactly one element.  Skin entities are created and
+  // the output ranges populated in the calling thread, in the order of
+  // element handle and side number.
+
+  ErrorCode rval;
+  supported = false;
+  const int dim = CN::Dimension(TYPE_FROM_HANDLE(entities.front()));
+  if (entities.num_of_type( MBPOLYGON ) || entities.num_of_type( MBPOLYHEDRON ))
+    return MB_SUCCESS;
+  
+  bool explicit_conn;
+  std::vector<SkinConnBlock> elem_blocks, side_blocks;
+  rval = get_skin_conn_blocks( thisMB, entities, elem_blocks, explicit_conn );
+  if (MB_SUCCESS != rval || !explicit_conn)
+    return rval;
+  
+    // existing entities that might represent sides
+  Range side_ents;
+  if (skin_sides || create_sides) {
+    rval = thisMB->get_entities_by_dimension( 0, dim-1, side_ents );
+    if (MB_SUCCESS != rval) return rval;
+    rval = get_skin_conn_blocks( thisMB, side_ents, side_blocks, explicit_conn );
+    if (MB_SUCCESS != rval || !explicit_conn)
+      return rval;
+  }
+  supported = true;
+  
+  const int num_threads = mNumThreads;
+  
+    // Entities are numbered by concatenating all blocks of elements
+    // followed by all blocks of existing side entities.
+  std::vector<SkinConnBlock> blocks( elem_blocks );
+  blocks.insert( blocks.end(), side_blocks.begin(), side_blocks.end() );
+  std::vector<size_t> offsets( blocks.size() + 1, 0 );
+  for (size_t b = 0; b < blocks.size(); ++b)
+    offsets[b+1] = offsets[b] + blocks[b].count;
+  const size_t num_elem = entities.size();
+  const size_t num_ents = offsets.back();
+
+    // Bucket lists are indexed by [thread][bucket].  Use more buckets
+    // than threads so that the sorts are smaller and better balanced.
+  const size_t num_buckets = 8 * num_threads;
+  std::vector< std::vector<SkinSide> > lists( num_threads * num_buckets );
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+  for (int t = 0; t < num_threads; ++t) {
+    const size_t elem_begin = num_elem * t / num_threads;
+    const size_t elem_end = num_elem * (t+1) / num_threads;
+    get_skin_sides( blocks, offsets, elem_begin, elem_end, dim-1,
+                    num_buckets, &lists[t*num_buckets] );
+    const size_t side_begin = num_elem + (num_ents - num_elem) * t / num_threads;
+    const size_t side_end = num_elem + (num_ents - num_elem) * (t+1) / num_threads;
+    get_skin_sides( blocks, offsets, side_begin, side_end, dim-1,
+                    num_buckets, &lists[t*num_buckets] );
+  }
+  
+  std::vector< std::vector<SkinResult> > results( num_buckets );
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(num_threads)
+#endif
+  for (int b = 0; b < (int)num_buckets; ++b) {
+    std::vector<SkinSide> list;
+    size_t count = 0;
+    for (int t = 0; t < num_threads; ++t)
+      count += lists[t*num_buckets + b].size();
+    list.reserve( count );
+    for (int t = 0; t < num_threads; ++t) {
+      std::vector<SkinSide>& tlist = lists[t*num_buckets + b];
+      list.insert( list.end(), tlist.begin(), tlist.end() );
+      std::vector<SkinSide>().swap( tlist );
+    }
+    match_skin_sides( list, results[b] );
+  }
+  
+  std::vector<SkinResult> skin;
+  for (size_t b = 0; b < num_buckets; ++b) {
+    skin.insert( skin.end(), results[b].begin(), results[b].end() );
+    std::vector<SkinResult>().swap( results[b] );
+  }
+  std::sort( skin.begin(), skin.end() );
+  
+  const EntityHandle* conn;
+  const EntityHandle* side_conn;
+  int len, side_len;
+  std::vector<EntityHandle> verts, sides, reversed;
+  for (std::vector<SkinResult>::const_iterator r = skin.begin(); r != skin.end(); ++r) {
+    const EntityType type = TYPE_FROM_HANDLE(r->elem);
+    rval = thisMB->get_connectivity( r->elem, conn, len, false );
+    if (MB_SUCCESS != rval) return rval;
+    
+    EntityType side_type;
+    int num_corners;
+    const short* corner_idx = CN::SubEntityVertexIndices( type, dim-1, r->side, 
+                                                          side_type, num_corners );
+    EntityHandle corners[4];
+    for (int c = 0; c < num_corners; ++c)
+      corners[c] = conn[corner_idx[c]];
+    
+    if (skin_verts) {
+      if (corners_only || len == CN::VerticesPerEntity(type))
+        verts.insert( verts.end(), corners, corners + num_corners );
+      else {
+        int indices[9];
+        CN::SubEntityNodeIndices( type, len, dim-1, r->side, side_type, side_len, indices );
+        for (int n = 0; n < side_len; ++n)
+          verts.push_back( conn[indices[n]] );
+      }
+    }
+    
+    if (r->side_ent) {
+      if (!skin_sides)
+        continue;
+      rval = thisMB->get_connectivity( r->side_ent, side_conn, side_len, true );
+      if (MB_SUCCESS != rval) return rval;
+      bool rev = false;
+      if (reversed_sides) {
+        if (2 == dim)
+          rev = edge_reversed( r->elem, side_conn );
+        else
+          rev = face_reversed( r->elem, side_conn, 3 == side_len ? MBTRI : MBQUAD );
+      }
+      (rev ? reversed : sides).push_back( r->side_ent );
+    }
+    else if (create_sides) {
+      EntityHandle side_ent;
+      rval = create_side( this_set, r->elem, side_type, corners, side_ent );
+      if (MB_SUCCESS != rval) return rval;
+      if (skin_sides)
+        sides.push_back( side_ent );
+    }
+  }
+  
+  if (skin_verts) {
+    std::sort( verts.begin(), verts.end() );
+    verts.erase( std::unique( verts.begin(), verts.end() ), verts.end() );
+    std::copy( verts.rbegin(), verts.rend(), range_inserter( *skin_verts ) );
+  }
+  if (skin_sides) {
+    std::sort( sides.begin(), sides.end() );
+    std::copy( sides.rbegin(), sides.rend(), range_inserter( *skin_sides ) );
+  }
+  if (reversed_sides) {
+    std::sort( reversed.begin(), reversed.end() );
+    std::copy( reversed.rbegin(), reversed.rend(), range_inserter( *reversed_sides ) );
+  }
+  
+  return MB_SUCCESS;
+}
+
 } // namespace moab
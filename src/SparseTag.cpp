@@ -49,7 +49,8 @@ SparseTag::SparseTag(const char* name,
                      int size,
                      DataType type,
                      const void* default_value)
-  : TagInfo(name, size, type, default_value, size)
+  : TagInfo(name, size, type, default_value, size),
+    mAllocator(size)
   {}
 
 SparseTag::~SparseTag()
@@ -62,28 +63,132 @@ TagType SparseTag::get_storage_type() const
   return MB_TAG_SPARSE;
 }
 
+SparseTagDataAllocator::SparseTagDataAllocator( size_t data_size )
+  : blockSize(0), blockUsed(0), allocBytes(0), freeList(0)
+{
+  // Pad values such that every value in a block is suitably aligned
+  // for any tag data type and can hold the free list link.
+  const size_t align = std::max(sizeof(double), sizeof(void*));
+  valueSize = std::max(data_size, sizeof(void*));
+  valueSize = align * ((valueSize + align - 1) / align);
+}
+
+void SparseTagDataAllocator::new_block()
+{
+  // Start with small blocks so that tags set on only a few
+  // entities (e.g. set tags) remain cheap, and double the block
+  // size up to 64k per block.
+  const size_t max_block = std::max((size_t)1, (size_t)65536 / valueSize);
+  if (blockList.empty())
+    blockSize = std::min((size_t)8, max_block);
+  else
+    blockSize = std::min(2 * blockSize, max_block);
+  blockList.push_back(static_cast<char*>(malloc(blockSize * valueSize)));
+  allocBytes += blockSize * valueSize;
+  blockUsed = 0;
+}
+
+void SparseTagDataAllocator::release_all()
+{
+  for (std::vector<char*>::iterator i = blockList.begin(); i != blockList.end(); ++i)
+    free(*i);
+  std::vector<char*> empty;
+  blockList.swap(empty);
+  blockSize = blockUsed = 0;
+  allocBytes = 0;
+  freeList = 0;
+}
+
+void SparseTagMap::insert( EntityHandle h, void* data )
+{
+  // Keep load factor at or below 3/4
+  if (4 * (mSize + 1) > 3 * mCapacity)
+    rehash(mCapacity ? 2 * mCapacity : 16);
+
+  const size_t mask = mCapacity - 1;
+  size_t i = home_slot(h);
+  while (mSlots[i].first != empty_key())
+    i = (i + 1) & mask;
+  mSlots[i].first = h;
+  mSlots[i].second = data;
+  ++mSize;
+}
+
+void* SparseTagMap::erase( EntityHandle h )
+{
+  value_type* slot = const_cast<value_type*>(lookup(h));
+  if (!slot)
+    return 0;
+  void* result = slot->second;
+
+  // Move back any following entries that can no longer be
+  // reached once this slot is empty.
+  const size_t mask = mCapacity - 1;
+  size_t i = slot - mSlots;
+  for (size_t j = (i + 1) & mask; mSlots[j].first != empty_key(); j = (j + 1) & mask) {
+    const size_t k = home_slot(mSlots[j].first);
+    // Entry at j may move to i only if its home slot is not
+    // cyclically within (i,j]
+    if (i <= j ? (k <= i || k > j) : (k <= i && k > j)) {
+      mSlots[i] = mSlots[j];
+      i = j;
+    }
+  }
+  mSlots[i].first = empty_key();
+  --mSize;
+  return result;
+}
+
+void SparseTagMap::clear()
+{
+  free(mSlots);
+  mSlots = 0;
+  mCapacity = mSize = 0;
+  mShift = 0;
+}
+
+void SparseTagMap::rehash( size_t new_capacity )
+{
+  value_type* old_slots = mSlots;
+  const size_t old_capacity = mCapacity;
+
+  mSlots = static_cast<value_type*>(malloc(new_capacity * sizeof(value_type)));
+  mCapacity = new_capacity;
+  mShift = 64;
+  for (size_t c = new_capacity; c > 1; c /= 2)
+    --mShift;
+  for (size_t i = 0; i < new_capacity; ++i)
+    mSlots[i].first = empty_key();
+
+  const size_t mask = mCapacity - 1;
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (old_slots[i].first == empty_key())
+      continue;
+    size_t j = home_slot(old_slots[i].first);
+    while (mSlots[j].first != empty_key())
+      j = (j + 1) & mask;
+    mSlots[j] = old_slots[i];
+  }
+  free(old_slots);
+}
+
 ErrorCode SparseTag::release_all_data(SequenceManager*, Error*, bool)
 {
-  for(MapType::iterator i = mData.begin(); i != mData.end(); ++i)
-    mAllocator.destroy(i->second);
   mData.clear();
+  mAllocator.release_all();
   return MB_SUCCESS;
 }
 
 ErrorCode SparseTag::set_data(Error*, EntityHandle entity_handle, const void* data)
 {
-#ifdef MOAB_HAVE_UNORDERED_MAP
-  MapType::iterator iter = mData.find(entity_handle);
-#else
-  MapType::iterator iter = mData.lower_bound(entity_handle);
-#endif
+  void* ptr = mData.get(entity_handle);
 
   // Data space already exists
-  if (iter!= mData.end() && iter->first == entity_handle)
-    memcpy(iter->second, data, get_size());
+  if (ptr)
+    memcpy(ptr, data, get_size());
   // We need to make some data space
   else {
-    void *new_data = allocate_data(entity_handle, iter, false);
+    void *new_data = allocate_data(entity_handle, false);
     memcpy(new_data, data, get_size());
   }
 
@@ -92,12 +197,12 @@ ErrorCode SparseTag::set_data(Error*, EntityHandle entity_handle, const void* da
 
 ErrorCode SparseTag::get_data_ptr(EntityHandle entity_handle, const void*& ptr, bool allocate) const
 {
-  MapType::const_iterator iter = mData.find(entity_handle);
+  const void* data = mData.get(entity_handle);
 
-  if (iter != mData.end())
-    ptr = iter->second;
+  if (data)
+    ptr = data;
   else if (get_default_value() && allocate)
-    ptr = const_cast<SparseTag*>(this)->allocate_data(entity_handle, iter, allocate);
+    ptr = const_cast<SparseTag*>(this)->allocate_data(entity_handle, allocate);
   else 
     return MB_FAILURE;
 
@@ -122,12 +227,11 @@ ErrorCode SparseTag::get_data(Error* /* error */, EntityHandle entity_handle, vo
 
 ErrorCode SparseTag::remove_data(Error* /* error */, EntityHandle entity_handle)
 {
-  MapType::iterator i = mData.find(entity_handle);
-  if (i == mData.end()) 
+  void* data = mData.erase(entity_handle);
+  if (!data) 
     return not_found(get_name(), entity_handle);
 
-  mAllocator.destroy(i->second);
-  mData.erase(i);
+  mAllocator.destroy(data);
 
   return MB_SUCCESS;
 }
@@ -374,7 +478,7 @@ ErrorCode SparseTag::tag_iterate(SequenceManager* seqman,
   if (MB_SUCCESS == rval) 
     data_ptr = const_cast<void*>(ptr);
   else if (get_default_value() && allocate) {
-    ptr = allocate_data(*iter, mData.end());
+    ptr = allocate_data(*iter);
     data_ptr = const_cast<void*>(ptr);
   }
   else {
@@ -390,29 +494,31 @@ ErrorCode SparseTag::tag_iterate(SequenceManager* seqman,
   return MB_SUCCESS;
 }
 
+//! Predicate for removing handles of other types
+struct NotType {
+  EntityType type;
+  NotType( EntityType t ) : type(t) {}
+  bool operator()( EntityHandle h ) const { return TYPE_FROM_HANDLE(h) != type; }
+};
+
 template <class Container> static inline
 void get_tagged(const SparseTag::MapType& mData,
                 EntityType type,
                 Container& output_range)
 {
+  // Hash table order is arbitrary: sort handles before inserting
+  // them such that the insertion hint is always effective.
+  std::vector<EntityHandle> handles;
+  handles.reserve(mData.size());
   SparseTag::MapType::const_iterator iter;
+  for (iter = mData.begin(); iter != mData.end(); ++iter)
+    if (MBMAXTYPE == type || TYPE_FROM_HANDLE(iter->first) == type)
+      handles.push_back(iter->first);
+  std::sort(handles.begin(), handles.end());
+
   typename Container::iterator hint = output_range.begin();
-  if (MBMAXTYPE == type) {
-    for (iter = mData.begin(); iter != mData.end(); ++iter)
-      hint = output_range.insert(hint, iter->first);
-  }
-  else {
-#ifdef MOAB_HAVE_UNORDERED_MAP
-    for (iter = mData.begin(); iter != mData.end(); ++iter)
-      if (TYPE_FROM_HANDLE(iter->first) == type)
-        hint = output_range.insert(hint, iter->first);
-#else
-    iter = mData.lower_bound(FIRST_HANDLE(type));
-    SparseTag::MapType::const_iterator end = mData.lower_bound(LAST_HANDLE(type) + 1);
-    for (; iter != end; ++iter)
-      hint = output_range.insert(hint, iter->first);
-#endif
-  }
+  for (std::vector<EntityHandle>::const_iterator i = handles.begin(); i != handles.end(); ++i)
+    hint = output_range.insert(hint, *i);
 }
 
 template <class Container> static inline
@@ -465,12 +571,7 @@ ErrorCode SparseTag::num_tagged_entities(const SequenceManager*,
   return MB_SUCCESS;
 }
 
-ErrorCode SparseTag::find_entities_with_value(
-#ifdef MOAB_HAVE_UNORDERED_MAP
-                                              const SequenceManager* seqman,
-#else
-                                              const SequenceManager*,
-#endif
+ErrorCode SparseTag::find_entities_with_value(const SequenceManager*,
                                               Error* /* error */,
                                               Range& output_entities,
                                               const void* value,
@@ -482,8 +583,6 @@ ErrorCode SparseTag::find_entities_with_value(
     MB_SET_ERR(MB_INVALID_SIZE, "Invalid data size " << get_size() << " specified for sparse tag " << get_name() << " of size " << value_bytes);
   }
 
-  MapType::const_iterator iter, end;
-#ifdef MOAB_HAVE_UNORDERED_MAP
   if (intersect_entities) {
     std::pair<Range::iterator,Range::iterator> r;
     if (type == MBMAXTYPE) {
@@ -498,48 +597,28 @@ ErrorCode SparseTag::find_entities_with_value(
                           r.first, r.second,
                           mData, output_entities);
   }
-  else if (type == MBMAXTYPE) {
+  else {
+    // Hash table order is arbitrary: collect and sort matching
+    // handles before inserting them into the output range.
+    std::vector<EntityHandle> handles;
     find_tag_values_equal(*this, value, get_size(),
                           mData.begin(), mData.end(),
-                          output_entities);
-  }
-  else {
-    Range tmp;
-    seqman->get_entities(type, tmp);
-    find_map_values_equal(*this, value, get_size(),
-                          tmp.begin(), tmp.end(),
-                          mData, output_entities);
-  }
-#else
-  if (intersect_entities) {
-    for (Range::const_pair_iterator p = intersect_entities->begin();
-         p != intersect_entities->end(); ++p) {
-      iter = mData.lower_bound(p->first);
-      end = mData.upper_bound(p->second);
-      find_tag_values_equal(*this, value, get_size(), iter, end,
-                            output_entities);
-    }
-  }
-  else {
-    if (type == MBMAXTYPE) {
-      iter = mData.begin();
-      end = mData.end();
-    }
-    else {
-      iter = mData.lower_bound(CREATE_HANDLE(type, MB_START_ID));
-      end = mData.upper_bound(CREATE_HANDLE(type, MB_END_ID));
-    }
-    find_tag_values_equal(*this, value, get_size(), iter, end,
-                          output_entities);
+                          handles);
+    if (type != MBMAXTYPE)
+      handles.erase(std::remove_if(handles.begin(), handles.end(), NotType(type)),
+                    handles.end());
+    std::sort(handles.begin(), handles.end());
+    Range::iterator hint = output_entities.begin();
+    for (std::vector<EntityHandle>::const_iterator i = handles.begin(); i != handles.end(); ++i)
+      hint = output_entities.insert(hint, *i);
   }
-#endif
 
   return MB_SUCCESS;
 }
 
 bool SparseTag::is_tagged(const SequenceManager*, EntityHandle h) const
 {
-  return mData.find(h) != mData.end();
+  return 0 != mData.get(h);
 }
 
 ErrorCode SparseTag::get_memory_use(const SequenceManager*,
@@ -547,8 +626,8 @@ ErrorCode SparseTag::get_memory_use(const SequenceManager*,
                                     unsigned long& per_entity) const
 
 {
-  per_entity = get_size() + 4*sizeof(void*);
-  total = (mData.size() * per_entity)
+  per_entity = mAllocator.value_size() + sizeof(SparseTagMap::value_type);
+  total = mData.get_memory_use() + mAllocator.get_memory_use()
         + sizeof(*this) + TagInfo::get_memory_use();
 
   return MB_SUCCESS;
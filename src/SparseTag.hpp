@@ -25,15 +25,8 @@
 #pragma warning(disable : 4786)
 #endif
 
-#include "moab/MOABConfig.h"
-#define STRINGIFY_(X) #X
-#define STRINGIFY(X) STRINGIFY_(X)
-#ifdef MOAB_HAVE_UNORDERED_MAP
-# include STRINGIFY(MOAB_HAVE_UNORDERED_MAP)
-#else
-# include <map>
-#endif
 #include <vector>
+#include <utility>
 
 #include "TagInfo.hpp"
 #include <stdlib.h>
@@ -41,19 +34,156 @@
 namespace moab {
 
 //! allocator for tag data
+/** Tag values are carved out of larger blocks rather than being
+ *  allocated individually.  Values never move once allocated, so
+ *  pointers returned by tag_get_by_ptr and tag_iterate remain valid
+ *  until the value is removed.  Freed values are kept on a free list
+ *  for reuse.
+ */
 class SparseTagDataAllocator
 {
 public:
   //! constructor
-  SparseTagDataAllocator(){}
+  SparseTagDataAllocator( size_t data_size );
   //! destructor
-  ~SparseTagDataAllocator(){}
-  //! allocates memory of size and returns pointer
-  void* allocate(size_t data_size) { return malloc(data_size); }
-  //! frees the memory
-  void destroy(void* p){ free(p); }
+  ~SparseTagDataAllocator() { release_all(); }
+  //! allocates memory for one value and returns pointer
+  inline void* allocate();
+  //! frees the memory for one value
+  void destroy(void* p) 
+    { *reinterpret_cast<void**>(p) = freeList; freeList = p; }
+  //! frees all memory
+  void release_all();
+  //! memory allocated for values, in bytes
+  unsigned long get_memory_use() const
+    { return allocBytes + blockList.capacity() * sizeof(char*); }
+  //! size of storage used for each value, in bytes
+  size_t value_size() const { return valueSize; }
+
+private:
+  SparseTagDataAllocator( const SparseTagDataAllocator& );
+  SparseTagDataAllocator& operator=( const SparseTagDataAllocator& );
+
+  void new_block();
+
+  size_t valueSize;              //!< size of each value, padded for alignment
+  size_t blockSize;              //!< number of values in last block
+  size_t blockUsed;              //!< number of values used in last block
+  unsigned long allocBytes;      //!< total size of all blocks
+  void* freeList;                //!< linked list of freed values
+  std::vector<char*> blockList;  //!< allocated blocks
+};
+
+inline void* SparseTagDataAllocator::allocate()
+{
+  if (freeList) {
+    void* result = freeList;
+    freeList = *reinterpret_cast<void**>(freeList);
+    return result;
+  }
+  if (blockUsed == blockSize)
+    new_block();
+  return blockList.back() + valueSize * blockUsed++;
+}
+
+//! map from entity handle to tag data
+/** Open-addressing hash table with linear probing.  Entries are
+ *  stored in a single flat array, so a lookup usually touches
+ *  one cache line rather than walking a tree of heap-allocated
+ *  nodes.  Erasing an entry shifts following entries of the same
+ *  probe sequence backwards, so no tombstones are left behind.
+ *  The iteration order is unspecified.
+ */
+class SparseTagMap
+{
+public:
+  typedef std::pair<EntityHandle,void*> value_type;
+
+  //! iterator over occupied slots (map-like: first is the handle,
+  //! second is the pointer to the tag data)
+  class const_iterator
+  {
+  public:
+    const_iterator() : mPtr(0), mEnd(0) {}
+    const_iterator( const value_type* ptr, const value_type* end )
+      : mPtr(ptr), mEnd(end) { skip(); }
+    const value_type& operator*() const { return *mPtr; }
+    const value_type* operator->() const { return mPtr; }
+    const_iterator& operator++() { ++mPtr; skip(); return *this; }
+    const_iterator operator++(int) 
+      { const_iterator tmp(*this); ++*this; return tmp; }
+    bool operator==( const const_iterator& other ) const
+      { return mPtr == other.mPtr; }
+    bool operator!=( const const_iterator& other ) const
+      { return mPtr != other.mPtr; }
+  private:
+    void skip() { while (mPtr != mEnd && mPtr->first == empty_key()) ++mPtr; }
+    const value_type* mPtr;
+    const value_type* mEnd;
+  };
+  typedef const_iterator iterator;
+
+  SparseTagMap() : mSlots(0), mCapacity(0), mSize(0), mShift(0) {}
+  ~SparseTagMap() { free(mSlots); }
+
+  size_t size() const { return mSize; }
+  bool empty() const { return !mSize; }
+
+  const_iterator begin() const { return const_iterator( mSlots, mSlots + mCapacity ); }
+  const_iterator end() const { return const_iterator( mSlots + mCapacity, mSlots + mCapacity ); }
+  const_iterator find( EntityHandle h ) const
+    { const value_type* s = lookup(h); return s ? const_iterator( s, mSlots + mCapacity ) : end(); }
+
+  //! get tag data for handle, or NULL if handle is not in map
+  void* get( EntityHandle h ) const
+    { const value_type* s = lookup(h); return s ? s->second : 0; }
+
+  //! insert handle that is not already in map
+  void insert( EntityHandle h, void* data );
+
+  //! remove handle from map
+  //!\return tag data for handle, or NULL if handle was not in map
+  void* erase( EntityHandle h );
+
+  //! remove all entries and release table storage
+  void clear();
+
+  //! memory used for table, in bytes
+  unsigned long get_memory_use() const { return mCapacity * sizeof(value_type); }
+
+private:
+  SparseTagMap( const SparseTagMap& );
+  SparseTagMap& operator=( const SparseTagMap& );
+
+  static EntityHandle empty_key() { return ~(EntityHandle)0; }
+
+    // Fibonacci hashing: spreads both consecutive handles and
+    // handles with a power-of-two stride over the table
+  size_t home_slot( EntityHandle h ) const
+    { return (size_t)(((unsigned long long)h * 0x9E3779B97F4A7C15ULL) >> mShift); }
+
+  inline const value_type* lookup( EntityHandle h ) const;
+
+  void rehash( size_t new_capacity );
+
+  value_type* mSlots;  //!< table of mCapacity slots
+  size_t mCapacity;    //!< zero or a power of two
+  size_t mSize;        //!< number of occupied slots
+  unsigned mShift;     //!< 64 - log2(mCapacity)
 };
 
+inline const SparseTagMap::value_type* SparseTagMap::lookup( EntityHandle h ) const
+{
+  if (!mSize)
+    return 0;
+  const size_t mask = mCapacity - 1;
+  for (size_t i = home_slot(h); ; i = (i + 1) & mask) {
+    if (mSlots[i].first == h)
+      return mSlots + i;
+    if (mSlots[i].first == empty_key())
+      return 0;
+  }
+}
 
 //! Sparse tag data
 class SparseTag : public TagInfo
@@ -409,11 +539,7 @@ public:
 
 
   //! map of entity id and tag data
-#ifdef MOAB_HAVE_UNORDERED_MAP
-  typedef MOAB_UNORDERED_MAP_NS::unordered_map<EntityHandle,void*> MapType;
-#else
-  typedef std::map<EntityHandle,void*> MapType;
-#endif
+  typedef SparseTagMap MapType;
 
 private:
   
@@ -421,7 +547,7 @@ private:
   SparseTag& operator=( const SparseTag& );
 
     //! allocate an entry for this sparse tag w/o setting its value (yet)
-  inline void *allocate_data(EntityHandle h, MapType::const_iterator iter, bool copy_default = true);
+  inline void *allocate_data(EntityHandle h, bool copy_default = true);
   
   //! set the tag data for an entity id
   //!\NOTE Will fail with MB_VARIABLE_DATA_LENGTH if called for 
@@ -449,20 +575,10 @@ private:
   MapType mData;
 };
 
-inline void *SparseTag::allocate_data(EntityHandle h,
-#ifdef MOAB_HAVE_UNORDERED_MAP
-                                      MapType::const_iterator iter,
-#else
-                                      MapType::const_iterator,
-#endif
-                                      bool copy_default) 
+inline void *SparseTag::allocate_data(EntityHandle h, bool copy_default) 
 {
-  void* new_data = mAllocator.allocate(get_size());
-#ifdef MOAB_HAVE_UNORDERED_MAP
-  mData.insert(iter, std::pair<const EntityHandle,void*>(h, new_data));
-#else
-  mData[h] = new_data;
-#endif
+  void* new_data = mAllocator.allocate();
+  mData.insert(h, new_data);
   if (copy_default)
     memcpy(new_data, get_default_value(), get_size());
   return new_data;
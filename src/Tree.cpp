@@ -39,6 +39,10 @@ namespace moab
       rval = options.get_str_option("TAG_NAME", tmp_str);
       if (MB_SUCCESS == rval) boxTagName = tmp_str;
 
+        // NUM_THREADS: number of OpenMP threads used to build the tree; default = 1
+      rval = options.get_int_option("NUM_THREADS", tmp_int);
+      if (MB_SUCCESS == rval) numThreads = std::max(tmp_int, 1);
+
       return MB_SUCCESS;
     }
 
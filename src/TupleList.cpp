@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 #include "moab/TupleList.hpp"
 
@@ -65,7 +67,7 @@ void TupleList::buffer::reset()
 
 TupleList::TupleList(uint p_mi, uint p_ml, uint p_mul, uint p_mr, uint p_max)
 : vi(NULL), vl(NULL), vul(NULL), vr(NULL),
-  last_sorted(-1)
+  last_sorted(-1), numThreads(1)
 {
   initialize(p_mi, p_ml, p_mul, p_mr, p_max);
 }
@@ -75,7 +77,7 @@ TupleList::TupleList()
   mi(0), ml(0), mul(0), mr(0),
   n(0), max(0),
   vi(NULL), vl(NULL), vul(NULL), vr(NULL),
-  last_sorted(-1)
+  last_sorted(-1), numThreads(1)
 {
   disableWriteAccess();
 }
@@ -562,17 +564,32 @@ ErrorCode TupleList::sort(uint key, TupleList::buffer *buf)
   uint *work;
   buf->buffer_reserve(work_min);
   work = (uint *) buf->ptr;
-  if (key < mi)
-    index_sort((uint *) &vi[key], n, mi, work, (SortData<uint>*) work);
-  else if (key < mi + ml)
-    index_sort((long*) &vl[key - mi], n, ml, work, (SortData<long>*) work);
-  else if (key < mi + ml + mul)
-    index_sort((Ulong*) &vul[key - mi - ml], n, mul, work,
-        (SortData<Ulong>*) work);
+  if (mi + ml + mul + mr == 1 && key == 0 && !mr)
+  {
+    /* tuples consist of the key only; no need to permute */
+    if (mi)
+      radix_sort((uint *) vi, n, work, numThreads);
+    else if (ml)
+      radix_sort((long*) vl, n, (long*) work, numThreads);
+    else
+      radix_sort((Ulong*) vul, n, (Ulong*) work, numThreads);
+  }
   else
-    return MB_NOT_IMPLEMENTED;
+  {
+    if (key < mi)
+      index_sort((uint *) &vi[key], n, mi, work, (SortData<uint>*) work,
+          numThreads);
+    else if (key < mi + ml)
+      index_sort((long*) &vl[key - mi], n, ml, work, (SortData<long>*) work,
+          numThreads);
+    else if (key < mi + ml + mul)
+      index_sort((Ulong*) &vul[key - mi - ml], n, mul, work,
+          (SortData<Ulong>*) work, numThreads);
+    else
+      return MB_NOT_IMPLEMENTED;
 
-  permute(work, work + n);
+    permute(work, work + n);
+  }
 
   if (!writeEnabled)
     last_sorted = key;
@@ -636,15 +653,17 @@ void TupleList::radix_offsets(Index *c)
   while (c != ce);
 }
 
+/* skip digits that are the same for all keys: if the OR of a digit over
+   all keys has count n, every key has that value of the digit */
 template<class Value>
-unsigned TupleList::radix_zeros(Value bitorkey,
+unsigned TupleList::radix_zeros(Value bitorkey, Index n,
     Index count[DIGITS][DIGIT_VALUES], unsigned *shift, Index **offsets)
 {
   unsigned digits = 0, sh = 0;
   Index *c = &count[0][0];
   do
   {
-    if (bitorkey & DIGIT_MASK)
+    if (c[bitorkey & DIGIT_MASK] != n)
       *shift++ = sh, *offsets++ = c, ++digits, radix_offsets(c);
   } while (bitorkey >>= DIGIT_BITS,sh += DIGIT_BITS,c += DIGIT_VALUES,sh
       != VALUE_BITS);
@@ -702,7 +721,7 @@ void TupleList::radix_index_sort(const Value *A, Index n, Index stride,
   Value bitorkey = radix_count(A, A + n * stride, stride, count);
   unsigned shift[DIGITS];
   Index *offsets[DIGITS];
-  unsigned digits = radix_zeros(bitorkey, count, shift, offsets);
+  unsigned digits = radix_zeros(bitorkey, n, count, shift, offsets);
   if (digits == 0)
   {
     Index i = 0;
@@ -834,9 +853,161 @@ void TupleList::merge_index_sort(const Value *A, const Index An, Index stride,
   }
 }
 
+/* chunk of [0,n) handled by thread t */
+#define THREAD_CHUNK(t,lo,hi) \
+    const Index lo = std::min((Index)(t)*chunk, n), \
+                hi = std::min(lo + chunk, n)
+
+/* thread counts for one digit are at counts[t*DIGITS*DIGIT_VALUES +
+   digit*DIGIT_VALUES]; returns the digits that are not the same for all
+   keys */
+template<class Value>
+unsigned TupleList::radix_thread_digits(Index *counts, unsigned num_threads,
+    Index n, unsigned *shift)
+{
+  unsigned digits = 0;
+  for (unsigned d = 0; d < DIGITS; ++d)
+  {
+    bool same = false;
+    for (unsigned b = 0; b < DIGIT_VALUES && !same; ++b)
+    {
+      Index total = 0;
+      for (unsigned t = 0; t < num_threads; ++t)
+        total += counts[(t * DIGITS + d) * DIGIT_VALUES + b];
+      same = (total == n);
+    }
+    if (!same)
+      shift[digits++] = d * DIGIT_BITS;
+  }
+  return digits;
+}
+
+/* turn per-thread digit counts (counts[t*DIGIT_VALUES + b]) into the
+   position at which thread t writes its first key with digit b, so that
+   keys with the same digit stay in order */
+void TupleList::radix_thread_offsets(Index *counts, unsigned num_threads)
+{
+  Index sum = 0;
+  for (unsigned b = 0; b < DIGIT_VALUES; ++b)
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+      Index c = counts[t * DIGIT_VALUES + b];
+      counts[t * DIGIT_VALUES + b] = sum;
+      sum += c;
+    }
+}
+
+template<class Value>
+void TupleList::radix_index_sort_mt(const Value *A, Index n, Index stride,
+    Index *idx, SortData<Value> *work, unsigned num_threads)
+{
+  const Index chunk = CEILDIV(n, num_threads);
+  std::vector<Index> counts(num_threads * COUNT_SIZE);
+  std::vector<Index> offsets(num_threads * DIGIT_VALUES);
+
+  /* count all digits of each chunk */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+  for (int t = 0; t < (int)num_threads; ++t)
+  {
+    THREAD_CHUNK(t, lo, hi);
+    Index (*c)[DIGIT_VALUES] = (Index (*)[DIGIT_VALUES]) &counts[t * COUNT_SIZE];
+    if (lo == hi)
+      memset(c, 0, COUNT_SIZE * sizeof(Index));
+    else
+      radix_count(A + lo * stride, A + hi * stride, stride, c);
+  }
+
+  unsigned shift[DIGITS];
+  const unsigned digits = radix_thread_digits<Value>(&counts[0], num_threads,
+      n, shift);
+  if (digits == 0)
+  {
+    for (Index i = 0; i < n; ++i)
+      idx[i] = i;
+    return;
+  }
+
+  /* same buffer use as radix_index_sort: the last pass reads from work+n,
+     which does not overlap idx */
+  SortData<Value> *src, *dst;
+  if ((digits & 1) == 0)
+    dst = work, src = dst + n;
+  else
+    src = work, dst = src + n;
+
+  for (unsigned d = 0; d < digits; ++d)
+  {
+    const unsigned sh = shift[d];
+    const bool last = (d + 1 == digits);
+
+    /* thread counts of this digit: from the first count for the first pass,
+       otherwise the chunks hold different keys now */
+    if (d == 0)
+    {
+      for (unsigned t = 0; t < num_threads; ++t)
+        memcpy(&offsets[t * DIGIT_VALUES],
+            &counts[t * COUNT_SIZE + (sh / DIGIT_BITS) * DIGIT_VALUES],
+            DIGIT_VALUES * sizeof(Index));
+    }
+    else
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+      for (int t = 0; t < (int)num_threads; ++t)
+      {
+        THREAD_CHUNK(t, lo, hi);
+        Index *c = &offsets[t * DIGIT_VALUES];
+        memset(c, 0, DIGIT_VALUES * sizeof(Index));
+        for (Index i = lo; i < hi; ++i)
+          ++c[(src[i].v >> sh) & DIGIT_MASK];
+      }
+    }
+    radix_thread_offsets(&offsets[0], num_threads);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+    for (int t = 0; t < (int)num_threads; ++t)
+    {
+      THREAD_CHUNK(t, lo, hi);
+      Index *off = &offsets[t * DIGIT_VALUES];
+      if (d == 0)
+      {
+        const Value *a = A + lo * stride;
+        for (Index i = lo; i < hi; ++i, a += stride)
+        {
+          Index pos = off[(*a >> sh) & DIGIT_MASK]++;
+          if (last)
+            idx[pos] = i;
+          else
+            src[pos].v = *a, src[pos].i = i;
+        }
+      }
+      else if (lo != hi)
+      {
+        if (last)
+          radix_index_pass_e(src + lo, src + hi, sh, off, idx);
+        else
+          radix_index_pass_m(src + lo, src + hi, sh, off, dst);
+      }
+    }
+    if (d != 0 && !last)
+    {
+      SortData<Value> *t = src;
+      src = dst, dst = t;
+    }
+  }
+}
+
+/* don't start threads for small lists */
+#define MT_SORT_MIN (DIGIT_VALUES*DIGIT_VALUES)
+
 template<class Value>
 void TupleList::index_sort(const Value *A, Index n, Index stride, Index *idx,
-    SortData<Value> *work)
+    SortData<Value> *work, unsigned num_threads)
 {
   if (n < DIGIT_VALUES)
   {
@@ -847,10 +1018,90 @@ void TupleList::index_sort(const Value *A, Index n, Index stride, Index *idx,
     else
       merge_index_sort(A, n, stride, idx, work);
   }
+  else if (num_threads > 1 && n >= MT_SORT_MIN)
+    radix_index_sort_mt(A, n, stride, idx, work, num_threads);
   else
     radix_index_sort(A, n, stride, idx, work);
 }
 
+template<class Value>
+void TupleList::radix_sort(Value *A, Index n, Value *work,
+    unsigned num_threads)
+{
+  if (n < DIGIT_VALUES)
+  {
+    std::sort(A, A + n);
+    return;
+  }
+  if (num_threads < 1 || n < MT_SORT_MIN)
+    num_threads = 1;
+
+  const Index chunk = CEILDIV(n, num_threads);
+  std::vector<Index> counts(num_threads * COUNT_SIZE);
+  std::vector<Index> offsets(num_threads * DIGIT_VALUES);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+  for (int t = 0; t < (int)num_threads; ++t)
+  {
+    THREAD_CHUNK(t, lo, hi);
+    Index (*c)[DIGIT_VALUES] = (Index (*)[DIGIT_VALUES]) &counts[t * COUNT_SIZE];
+    if (lo == hi)
+      memset(c, 0, COUNT_SIZE * sizeof(Index));
+    else
+      radix_count(A + lo, A + hi, 1, c);
+  }
+
+  unsigned shift[DIGITS];
+  const unsigned digits = radix_thread_digits<Value>(&counts[0], num_threads,
+      n, shift);
+  Value *src = A, *dst = work;
+  for (unsigned d = 0; d < digits; ++d)
+  {
+    const unsigned sh = shift[d];
+    if (d == 0)
+    {
+      for (unsigned t = 0; t < num_threads; ++t)
+        memcpy(&offsets[t * DIGIT_VALUES],
+            &counts[t * COUNT_SIZE + (sh / DIGIT_BITS) * DIGIT_VALUES],
+            DIGIT_VALUES * sizeof(Index));
+    }
+    else
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+      for (int t = 0; t < (int)num_threads; ++t)
+      {
+        THREAD_CHUNK(t, lo, hi);
+        Index *c = &offsets[t * DIGIT_VALUES];
+        memset(c, 0, DIGIT_VALUES * sizeof(Index));
+        for (Index i = lo; i < hi; ++i)
+          ++c[(src[i] >> sh) & DIGIT_MASK];
+      }
+    }
+    radix_thread_offsets(&offsets[0], num_threads);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(num_threads)
+#endif
+    for (int t = 0; t < (int)num_threads; ++t)
+    {
+      THREAD_CHUNK(t, lo, hi);
+      Index *off = &offsets[t * DIGIT_VALUES];
+      for (Index i = lo; i < hi; ++i)
+        dst[off[(src[i] >> sh) & DIGIT_MASK]++] = src[i];
+    }
+    Value *t = src;
+    src = dst, dst = t;
+  }
+  if (src != A)
+    memcpy(A, src, n * sizeof(Value));
+}
+
+#undef THREAD_CHUNK
+#undef MT_SORT_MIN
+
 #undef DIGIT_BITS
 #undef DIGIT_VALUES
 #undef DIGIT_MASK
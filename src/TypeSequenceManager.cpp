@@ -39,13 +39,29 @@ TypeSequenceManager::~TypeSequenceManager()
   availableList.clear();
 }
 
+void TypeSequenceManager::rebuild_index() const
+{
+  indexStart.clear();
+  indexSeq.clear();
+  indexStart.reserve(sequenceSet.size());
+  indexSeq.reserve(sequenceSet.size());
+  for (const_iterator i = begin(); i != end(); ++i) {
+    indexStart.push_back((*i)->start_handle());
+    indexSeq.push_back(*i);
+  }
+  indexValid = true;
+  staleLookups = 0;
+}
+
 ErrorCode TypeSequenceManager::merge_internal(iterator i, iterator j)
 {
   EntitySequence* dead = *j;
   sequenceSet.erase(j);
+  invalidate_index();
   ErrorCode rval = (*i)->merge(*dead);
   if (MB_SUCCESS != rval) {
     sequenceSet.insert(dead);
+    invalidate_index();
     return rval;
   }
 
@@ -113,11 +129,13 @@ ErrorCode TypeSequenceManager::insert_sequence(EntitySequence* seq_ptr)
   }
 
   i = sequenceSet.insert(i, seq_ptr);
+  invalidate_index();
 
   // Merge with previous sequence ?
   if (seq_ptr->start_handle() > seq_ptr->data()->start_handle() && i != begin()) {
     if (MB_SUCCESS != check_merge_prev(i)) {
       sequenceSet.erase(i);
+      invalidate_index();
       return MB_FAILURE;
     }
   }
@@ -126,6 +144,7 @@ ErrorCode TypeSequenceManager::insert_sequence(EntitySequence* seq_ptr)
   if ((*i)->end_handle() < (*i)->data()->end_handle()) {
     if (MB_SUCCESS != check_merge_next(i)) {
       sequenceSet.erase(i);
+      invalidate_index();
       return MB_FAILURE;
     }
   }
@@ -202,6 +221,7 @@ ErrorCode TypeSequenceManager::replace_subsequence(EntitySequence* seq_ptr,
     if (p == dead)
       p = i;
     sequenceSet.erase(dead);
+    invalidate_index();
 
     // Delete old sequence
     delete seq;
@@ -283,6 +303,7 @@ TypeSequenceManager::iterator TypeSequenceManager::erase(iterator i)
   // Remove sequence, updating i to be next sequence
   j = i++;
   sequenceSet.erase(j);
+  invalidate_index();
 
   // Make sure lastReferenced isn't stale. It can only be NULL if
   // no sequences.
@@ -309,6 +330,7 @@ ErrorCode TypeSequenceManager::remove_sequence(const EntitySequence* seq_ptr,
   if (i == end() || *i != seq_ptr)
     return MB_ENTITY_NOT_FOUND;
   sequenceSet.erase(i);
+  invalidate_index();
 
   // Check if this is the only sequence referencing its data
   if (seq_ptr->using_entire_data()) 
@@ -716,6 +738,7 @@ TypeSequenceManager::iterator TypeSequenceManager::split_sequence(iterator i, En
     return end();
 
   i = sequenceSet.insert(i, seq);
+  invalidate_index();
   assert(check_valid_data(*i));
 
   return i;
@@ -65,9 +65,30 @@ public:
   };
 private:
   mutable EntitySequence* lastReferenced;//!< Last accessed EntitySequence - Null only if no sequences
+  bool isFrozen;                 //!< If true, find() does not update lastReferenced
   set_type sequenceSet;          //!< Set of all managed EntitySequence instances
   data_set_type availableList;   //!< SequenceData containing unused entries
 
+    // Flat copy of sequenceSet for lookups by handle: start handles
+    // of all sequences in a sorted array, which can be searched 
+    // without chasing tree pointers.  Rebuilt lazily after sequences
+    // are added or removed, once enough lookups have been done to
+    // amortize the cost of rebuilding it.
+  mutable std::vector<EntityHandle> indexStart;   //!< Start handle of each sequence
+  mutable std::vector<EntitySequence*> indexSeq;  //!< Sequence for each entry in indexStart
+  mutable bool indexValid;                        //!< indexStart/indexSeq match sequenceSet
+  mutable size_t staleLookups;                    //!< Lookups since index was invalidated
+
+  void invalidate_index() const
+    { indexValid = false; staleLookups = 0; }
+  void rebuild_index() const;
+    // Search index for sequence containing handle.  May return
+    // NULL for handles in a sequence that was resized after the
+    // index was built.
+  inline EntitySequence* search_index( EntityHandle h ) const;
+    // Find sequence containing handle, ignoring lastReferenced
+  inline EntitySequence* find_sequence( EntityHandle h ) const;
+
   iterator erase( iterator i );  //!< Remove a sequence
   
   iterator split_sequence( iterator i, EntityHandle h ); //!< split a sequence
@@ -133,7 +154,8 @@ public:
                                  const int* tag_sizes,
                                  int num_tag_sizes );
   
-  TypeSequenceManager() : lastReferenced(0) {}
+  TypeSequenceManager() 
+    : lastReferenced(0), isFrozen(false), indexValid(false), staleLookups(0) {}
   
   ~TypeSequenceManager();
 
@@ -184,6 +206,15 @@ public:
   inline ErrorCode find( EntityHandle h, const EntitySequence*& ) const;
   inline const EntitySequence* get_last_accessed() const;
   
+    /**\brief Stop updating last accessed EntitySequence in find()
+     *
+     * When frozen, the find() methods do not modify any data and
+     * may be called concurrently from multiple threads.  Sequences
+     * must not be added or removed while frozen.
+     */
+  void freeze( bool frozen ) 
+    { if (frozen && !indexValid) rebuild_index(); isFrozen = frozen; }
+  
     /**\brief Get handles for all entities in all sequences. */
   inline void get_entities( Range& entities_out ) const;
   
@@ -350,6 +381,47 @@ public:
   EntityID get_occupied_size( const SequenceData* ) const;
 };
 
+inline EntitySequence* TypeSequenceManager::search_index( EntityHandle h ) const
+{
+  if (indexStart.empty() || h < indexStart.front())
+    return 0;
+
+    // branch-free binary search for last start handle <= h
+  const EntityHandle* base = &indexStart[0];
+  size_t n = indexStart.size();
+  while (n > 1) {
+    const size_t half = n / 2;
+    base = (base[half] <= h) ? base + half : base;
+    n -= half;
+  }
+
+  EntitySequence* seq = indexSeq[base - &indexStart[0]];
+  return (h >= seq->start_handle() && h <= seq->end_handle()) ? seq : 0;
+}
+
+inline EntitySequence* TypeSequenceManager::find_sequence( EntityHandle h ) const
+{
+  if (!indexValid && !isFrozen && ++staleLookups > sequenceSet.size())
+    rebuild_index();
+
+  if (indexValid) {
+    EntitySequence* seq = search_index( h );
+    if (seq)
+      return seq;
+  }
+  
+  DummySequence ds(h);
+  const_iterator i = sequenceSet.find( &ds );
+  if (i == end())
+    return 0;
+    // Index missed a sequence that was resized after it was built.
+    // Leave the index alone while frozen so that lookups remain
+    // read-only; freeze(true) rebuilds it if it is invalid.
+  if (indexValid && !isFrozen)
+    invalidate_index();
+  return *i;
+}
+
 inline EntitySequence* TypeSequenceManager::find( EntityHandle h ) const
 {
   if (!lastReferenced) // only null if empty
@@ -357,70 +429,27 @@ inline EntitySequence* TypeSequenceManager::find( EntityHandle h ) const
   else if (h >= lastReferenced->start_handle() && h <= lastReferenced->end_handle())
     return lastReferenced;
   else {
-    DummySequence seq(h);
-    const_iterator i = sequenceSet.find( &seq );
-    return i == end() ? 0 : (lastReferenced = *i);
+    EntitySequence* seq = find_sequence( h );
+    if (seq && !isFrozen)
+      lastReferenced = seq;
+    return seq;
   }
 }   
 inline EntitySequence* TypeSequenceManager::find( EntityHandle h )
 {
-  if (!lastReferenced) // only null if empty
-    return 0;
-  else if (h >= lastReferenced->start_handle() && h <= lastReferenced->end_handle())
-    return lastReferenced;
-  else {
-    DummySequence seq(h);
-    iterator i = sequenceSet.find( &seq );
-    return i == end() ? 0 : (lastReferenced = *i);
-  }
+  return const_cast<const TypeSequenceManager*>(this)->find( h );
 }   
 
 inline ErrorCode TypeSequenceManager::find( EntityHandle h, EntitySequence*& seq )
 {
-  if (!lastReferenced) { // only null if empty
-    seq = 0;
-    return MB_ENTITY_NOT_FOUND;
-  }
-  else if (h >= lastReferenced->start_handle() && h <= lastReferenced->end_handle()) {
-    seq = lastReferenced;
-    return MB_SUCCESS;
-  }
-  else {
-    DummySequence ds(h);
-    iterator i = sequenceSet.lower_bound( &ds );
-    if (i == end() || (*i)->start_handle() > h ) {
-      seq = 0;
-      return MB_ENTITY_NOT_FOUND;
-    }
-    else {
-      seq = lastReferenced = *i;
-      return MB_SUCCESS;
-    }
-  }
+  seq = find( h );
+  return seq ? MB_SUCCESS : MB_ENTITY_NOT_FOUND;
 }   
 
 inline ErrorCode TypeSequenceManager::find( EntityHandle h, const EntitySequence*& seq ) const
 {
-  if (!lastReferenced) { // only null if empty
-    seq = 0;
-    return MB_ENTITY_NOT_FOUND;
-  }
-  else if (h >= lastReferenced->start_handle() && h <= lastReferenced->end_handle()) {
-    seq = lastReferenced;
-    return MB_SUCCESS;
-  }
-  else {
-    DummySequence ds(h);
-    const_iterator i = sequenceSet.lower_bound( &ds );
-    if (i == end() || (*i)->start_handle() > h ) {
-      seq = 0;
-      return MB_ENTITY_NOT_FOUND;
-    }
-    else {
-      seq = lastReferenced = *i;
-      return MB_SUCCESS;
-    }
-  }
+  seq = find( h );
+  return seq ? MB_SUCCESS : MB_ENTITY_NOT_FOUND;
 }   
 
 inline const EntitySequence* TypeSequenceManager::get_last_accessed() const
@@ -430,7 +430,7 @@ bool FileTokenizer::get_binary(size_t size, void* mem)
   if (nextToken != bufferEnd) {
     // If requested size is less than buffer contents,
     // just pass back part of the buffer
-    if (bufferEnd - nextToken <= (int)size) {
+    if ((size_t)(bufferEnd - nextToken) >= size) {
       memcpy(mem, nextToken, size);
       nextToken += size;
       return true;
@@ -868,12 +868,25 @@ ErrorCode ReadHDF5::load_file_partial(const ReaderIface::IDTag* subset_list,
     MB_SET_ERR(rval, "Invalid value for 'SETS' option");
   }
 
+  // If the file has a partition index for the sets, get all the
+  // entities to read from it rather than from the set contents.
+  Range sets;
+  intersect(fileInfo->sets, file_ids, sets);
+  bool indexed = false;
+  if (content_mode == RSM_CONTENTS && child_mode == RSM_CONTENTS &&
+      MB_SUCCESS != opts.get_null_option("IGNORE_PARTITION_INDEX")) {
+    dbgOut.tprint(1, "  doing read_partition_index\n");
+    rval = read_partition_index(sets, file_ids, indexed);
+    if (MB_SUCCESS != rval)
+      MB_SET_ERR(rval, "ReadHDF5 Failure");
+    if (indexed)
+      intersect(fileInfo->sets, file_ids, sets);
+  }
+
   // If we want the contents of contained/child sets,
   // search for them now (before gathering the non-set contents
   // of the sets.)
-  Range sets;
-  intersect(fileInfo->sets, file_ids, sets);
-  if (content_mode == RSM_CONTENTS || child_mode == RSM_CONTENTS) {
+  if (!indexed && (content_mode == RSM_CONTENTS || child_mode == RSM_CONTENTS)) {
     dbgOut.tprint(1, "  doing read_set_ids_recursive\n");
     rval = read_set_ids_recursive(sets, content_mode == RSM_CONTENTS, child_mode == RSM_CONTENTS);
     if (MB_SUCCESS != rval)
@@ -885,10 +898,12 @@ ErrorCode ReadHDF5::load_file_partial(const ReaderIface::IDTag* subset_list,
   debug_barrier();
 
   // Get elements and vertices contained in sets
-  dbgOut.tprint(1, "  doing get_set_contents\n");
-  rval = get_set_contents(sets, file_ids);
-  if (MB_SUCCESS != rval)
-    MB_SET_ERR(rval, "ReadHDF5 Failure");
+  if (!indexed) {
+    dbgOut.tprint(1, "  doing get_set_contents\n");
+    rval = get_set_contents(sets, file_ids);
+    if (MB_SUCCESS != rval)
+      MB_SET_ERR(rval, "ReadHDF5 Failure");
+  }
 
   if (cputime)
     _times[GET_SET_CONTENTS_TIME] = timer->time_elapsed();
@@ -969,9 +984,10 @@ ErrorCode ReadHDF5::load_file_partial(const ReaderIface::IDTag* subset_list,
     // the node ID range now because a) we'll have to read the whole
     // connectivity table again later, and b) we don't want to worry
     // about accidentally creating multiple copies of the same element.
+    // The partition index already includes the nodes.
     if (CN::Dimension(type) == max_dim)
       rval = read_elems(i, subset, &nodes);
-    else
+    else if (!indexed)
       rval = read_elems(i, subset, nodes);
     mpe_event.end(rval);
     if (MB_SUCCESS != rval)
@@ -2593,6 +2609,82 @@ ErrorCode ReadHDF5::read_set_data(const Range& set_file_ids,
   return MB_SUCCESS;
 }
 
+ErrorCode ReadHDF5::read_partition_index(const Range& sets, Range& file_ids, bool& found)
+{
+  CHECK_OPEN_HANDLES;
+
+  mhdf_Status status;
+  found = false;
+  if (mhdf_havePartIndex(filePtr, &status) < 1)
+    return MB_SUCCESS;
+
+  long num_parts, num_ranges;
+  hid_t table = mhdf_openPartIndex(filePtr, &num_parts, &status);
+  if (is_error(status))
+    MB_SET_ERR(MB_FAILURE, "ReadHDF5 Failure");
+  std::vector<EntityHandle> index(2 * num_parts);
+  mhdf_readPartIndexWithOpt(table, 0, num_parts, handleType, &index[0], indepIO, &status);
+  mhdf_closeData(filePtr, table, &status);
+  if (is_error(status))
+    MB_SET_ERR(MB_FAILURE, "ReadHDF5 Failure");
+
+  // Find {begin, end} of ranges for each set, merging
+  // those of consecutive rows in the index.  Index rows
+  // are sorted by set ID.
+  typedef std::pair<EntityHandle, EntityHandle> PairType;
+  std::vector<PairType> rows;
+  const PairType* iarr = reinterpret_cast<const PairType*>(&index[0]);
+  const PairType* iend = iarr + num_parts;
+  int have_all = 1;
+  for (Range::const_iterator s = sets.begin(); s != sets.end(); ++s) {
+    const PairType* row = std::lower_bound(iarr, iend, PairType(*s, 0));
+    if (row == iend || row->first != *s) {
+      have_all = 0;
+      break;
+    }
+    EntityHandle begin = (row == iarr) ? 0 : (row - 1)->second;
+    if (!rows.empty() && rows.back().second == begin)
+      rows.back().second = row->second;
+    else
+      rows.push_back(PairType(begin, row->second));
+  }
+
+#ifdef MOAB_HAVE_MPI
+  if (nativeParallel) {
+    int send = have_all;
+    MPI_Allreduce(&send, &have_all, 1, MPI_INT, MPI_MIN, *mpiComm);
+  }
+#endif
+  if (!have_all) {
+    dbgOut.print(2, "Partition index does not contain all sets to read\n");
+    return MB_SUCCESS;
+  }
+
+  table = mhdf_openPartRanges(filePtr, &num_ranges, &status);
+  if (is_error(status))
+    MB_SET_ERR(MB_FAILURE, "ReadHDF5 Failure");
+  std::vector<EntityHandle> ranges;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    long count = rows[i].second - rows[i].first;
+    ranges.resize(2 * count);
+    if (count)
+      mhdf_readPartIndexWithOpt(table, rows[i].first, count, handleType,
+                                &ranges[0], indepIO, &status);
+    if (is_error(status)) {
+      mhdf_closeData(filePtr, table, &status);
+      MB_SET_ERR(MB_FAILURE, "ReadHDF5 Failure");
+    }
+    for (long j = 0; j < count; ++j)
+      file_ids.insert(ranges[2*j], ranges[2*j] + ranges[2*j+1] - 1);
+  }
+  mhdf_closeData(filePtr, table, &status);
+  if (is_error(status))
+    MB_SET_ERR(MB_FAILURE, "ReadHDF5 Failure");
+
+  found = true;
+  return MB_SUCCESS;
+}
+
 ErrorCode ReadHDF5::get_set_contents(const Range& sets, Range& file_ids)
 {
   CHECK_OPEN_HANDLES;
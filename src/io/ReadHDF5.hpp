@@ -429,6 +429,21 @@ private:
    *\param file_ids   Output: File IDs of entities contained in sets.
    */
   ErrorCode get_set_contents(const Range& sets, Range& file_ids);
+
+  /**\brief Get the file IDs of entities in sets from the partition index.
+   *
+   * If the file contains a partition index (see the PARTITION_INDEX
+   * write option) listing all of the passed sets, add the file IDs of
+   * all entities that must be read to read the sets (recursively
+   * contained and child sets, their contents, and the nodes of
+   * elements) to file_ids.  When reading in parallel, the index is
+   * used only if it lists the sets to be read by every process.
+   *\param sets       Container of file IDs designating entity sets.
+   *\param file_ids   Output: File IDs of entities to read.
+   *\param found      Output: false if index cannot be used, in which
+   *                  case file_ids is not modified.
+   */
+  ErrorCode read_partition_index(const Range& sets, Range& file_ids, bool& found);
  
   /** Given a list of file IDs for entity sets, find all contained
    *  or child sets (at any depth) and append them to the Range
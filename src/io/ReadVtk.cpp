@@ -22,6 +22,10 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <map>
+#include <vector>
+#include <algorithm>
 
 #include "ReadVtk.hpp"
 #include "moab/Range.hpp"
@@ -31,11 +35,15 @@
 #include "moab/FileOptions.hpp"
 #include "FileTokenizer.hpp"
 #include "VtkUtil.hpp"
+#include "SysUtil.hpp"
+
+#ifdef MOAB_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #define MB_VTK_MATERIAL_SETS
 #ifdef MB_VTK_MATERIAL_SETS
 #include "MBTagConventions.hpp"
-#include <map>
 
 namespace moab {
 
@@ -108,9 +116,9 @@ public:
     rval = this->mesh->add_entities(mset, &ent, 1);MB_CHK_SET_ERR_RET(rval, "Failed to add entities to mesh");
   }
 
-  void add_entities(Range& range, const unsigned char* bytes, size_t bytes_per_ent)
+  void add_entities(const Range& range, const unsigned char* bytes, size_t bytes_per_ent)
   {
-    for (Range::iterator it = range.begin(); it != range.end(); ++it, bytes += bytes_per_ent) {
+    for (Range::const_iterator it = range.begin(); it != range.end(); ++it, bytes += bytes_per_ent) {
       Hash h(bytes, bytes_per_ent);
       EntityHandle mset = this->congruence_class(h, bytes);
       ErrorCode rval;
@@ -150,7 +158,7 @@ ReaderIface* ReadVtk::factory(Interface* iface)
 }
 
 ReadVtk::ReadVtk(Interface* impl)
-  : mdbImpl(impl), mPartitionTagName(MATERIAL_SET_TAG_NAME)
+  : mBinary(false), mdbImpl(impl), mPartitionTagName(MATERIAL_SET_TAG_NAME)
 {
   mdbImpl->query_interface(readMeshIface);
 }
@@ -177,6 +185,482 @@ const char* const vtk_type_names[] = {"bit",
                                       "vtkIdType",
                                       0};
 
+// Size in bytes of each type in vtk_type_names (indexed from one, as returned
+// by FileTokenizer::match_token) in binary data.  Legacy files always write
+// vtkIdType values as 32-bit ints.  Bit arrays are packed and handled
+// separately.
+static const size_t vtk_type_sizes[] = {0, 0, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8, 4};
+
+// Names of the VTK XML data types, in the same order as vtk_type_names.
+// There is no bit type in XML files.
+const char* const vtu_type_names[] = {"",
+                                      "Int8",
+                                      "UInt8",
+                                      "Int16",
+                                      "UInt16",
+                                      "Int32",
+                                      "UInt32",
+                                      "Int64",
+                                      "UInt64",
+                                      "Float32",
+                                      "Float64",
+                                      0};
+
+template <typename S, typename T>
+static void copy_values(const void* src, size_t count, T* dest)
+{
+  const S* values = reinterpret_cast<const S*>(src);
+  for (size_t i = 0; i < count; ++i)
+    dest[i] = static_cast<T>(values[i]);
+}
+
+template <typename T>
+static void convert_values(int vtk_type, const void* src, size_t count, T* dest)
+{
+  switch (vtk_type) {
+    case 2:  copy_values<int8_t>  (src, count, dest); break;
+    case 3:  copy_values<uint8_t> (src, count, dest); break;
+    case 4:  copy_values<int16_t> (src, count, dest); break;
+    case 5:  copy_values<uint16_t>(src, count, dest); break;
+    case 6:  copy_values<int32_t> (src, count, dest); break;
+    case 7:  copy_values<uint32_t>(src, count, dest); break;
+    case 8:  copy_values<int64_t> (src, count, dest); break;
+    case 9:  copy_values<uint64_t>(src, count, dest); break;
+    case 10: copy_values<float>   (src, count, dest); break;
+    case 11: copy_values<double>  (src, count, dest); break;
+    case 12: copy_values<int32_t> (src, count, dest); break;
+  }
+}
+
+// True if binary data of the VTK type can be read directly into the array
+static inline bool native_type(int vtk_type, const double*)
+  { return vtk_type == 11; }
+static inline bool native_type(int vtk_type, const int*)
+  { return sizeof(int) == 4 && (vtk_type == 6 || vtk_type == 12); }
+static inline bool native_type(int vtk_type, const long*)
+  { return sizeof(long) == 8 && vtk_type == 8; }
+
+static inline bool native_big_endian()
+{
+  const unsigned one = 1;
+  return !*reinterpret_cast<const char*>(&one);
+}
+
+static void swap_values(void* data, size_t size, size_t count)
+{
+  switch (size) {
+    case 2: SysUtil::byteswap2(data, count); break;
+    case 4: SysUtil::byteswap4(data, count); break;
+    case 8: SysUtil::byteswap8(data, count); break;
+  }
+}
+
+// Sources of binary data for read_binary_values()
+struct TokenizerSource
+{
+  FileTokenizer& tokens;
+  bool read(size_t bytes, void* mem) { return tokens.get_binary(bytes, mem); }
+};
+
+struct FileSource
+{
+  FILE* file;
+  bool read(size_t bytes, void* mem) { return bytes == fread(mem, 1, bytes, file); }
+};
+
+struct MemorySource
+{
+  const unsigned char* ptr;
+  const unsigned char* end;
+  bool read(size_t bytes, void* mem)
+  {
+    if ((size_t)(end - ptr) < bytes)
+      return false;
+    memcpy(mem, ptr, bytes);
+    ptr += bytes;
+    return true;
+  }
+};
+
+// Read binary values of a VTK data type, swapping the byte order if
+// requested.  If the values need no conversion they are read directly
+// into the output array, otherwise they are converted in blocks.
+template <class Source, typename T>
+static bool read_binary_values(Source& source, int vtk_type, bool swap,
+                               size_t count, T* array)
+{
+  if (vtk_type < 2 || vtk_type > 12)
+    return false;
+  if (!count)
+    return true;
+
+  const size_t size = vtk_type_sizes[vtk_type];
+  if (native_type(vtk_type, array)) {
+    if (!source.read(count * size, array))
+      return false;
+    if (swap)
+      swap_values(array, size, count);
+    return true;
+  }
+
+  const size_t block_size = 8192;
+  std::vector<double> buffer(std::min(count, block_size));
+  while (count) {
+    const size_t n = std::min(count, block_size);
+    if (!source.read(n * size, &buffer[0]))
+      return false;
+    if (swap)
+      swap_values(&buffer[0], size, n);
+    convert_values(vtk_type, &buffer[0], n, array);
+    array += n;
+    count -= n;
+  }
+
+  return true;
+}
+
+// An element of a VTK XML file.  Character data is kept only
+// for data arrays, which may contain inline ASCII values.
+struct VtuElement
+{
+  std::string name;
+  std::map<std::string, std::string> attribs;
+  int parent; // Index of enclosing element, or -1 for the root
+  std::string text;
+
+  const char* get(const char* attrib, const char* default_val = 0) const
+  {
+    std::map<std::string, std::string>::const_iterator i = attribs.find(attrib);
+    return i == attribs.end() ? default_val : i->second.c_str();
+  }
+};
+
+// Parse the XML part of a VTK XML file (everything preceding the appended
+// data) into a flat list of elements in document order.  This is not a
+// general XML parser: it handles only what VTK writes.
+static bool parse_vtu_elements(const std::string& xml, std::vector<VtuElement>& list)
+{
+  std::vector<int> open; // Elements not yet closed
+  std::vector<size_t> content; // Start of character data for each element
+  size_t pos = 0;
+  while ((pos = xml.find('<', pos)) != std::string::npos) {
+    // Skip comments and processing instructions
+    if (!xml.compare(pos, 4, "<!--") || !xml.compare(pos, 2, "<?")) {
+      const char* end_str = xml[pos + 1] == '?' ? "?>" : "-->";
+      pos = xml.find(end_str, pos);
+      if (pos == std::string::npos)
+        return false;
+      continue;
+    }
+
+    const size_t end = xml.find('>', pos);
+    if (end == std::string::npos)
+      return false;
+
+    // End tag
+    if (xml[pos + 1] == '/') {
+      if (open.empty())
+        return false;
+      VtuElement& elem = list[open.back()];
+      if (elem.name == "DataArray")
+        elem.text = xml.substr(content[open.back()], pos - content[open.back()]);
+      open.pop_back();
+      pos = end + 1;
+      continue;
+    }
+
+    // Start tag or empty element tag
+    const bool empty = xml[end - 1] == '/';
+    const size_t tag_end = empty ? end - 1 : end;
+    VtuElement elem;
+    elem.parent = open.empty() ? -1 : open.back();
+    size_t i = pos + 1;
+    while (i < tag_end && !isspace(xml[i]))
+      ++i;
+    elem.name = xml.substr(pos + 1, i - pos - 1);
+    for (;;) {
+      while (i < tag_end && isspace(xml[i]))
+        ++i;
+      if (i >= tag_end)
+        break;
+      size_t eq = xml.find('=', i);
+      if (eq >= tag_end)
+        return false;
+      size_t name_end = eq;
+      while (name_end > i && isspace(xml[name_end - 1]))
+        --name_end;
+      size_t quote = eq + 1;
+      while (quote < tag_end && isspace(xml[quote]))
+        ++quote;
+      if (quote >= tag_end || (xml[quote] != '"' && xml[quote] != '\''))
+        return false;
+      const size_t value_end = xml.find(xml[quote], quote + 1);
+      if (value_end >= tag_end)
+        return false;
+      elem.attribs[xml.substr(i, name_end - i)] = xml.substr(quote + 1, value_end - quote - 1);
+      i = value_end + 1;
+    }
+
+    list.push_back(elem);
+    content.push_back(end + 1);
+    if (!empty)
+      open.push_back(list.size() - 1);
+    pos = end + 1;
+  }
+
+  return true;
+}
+
+// Decode base64 text, ignoring white space, until at least min_bytes
+// have been decoded or the text ends.  Characters are decoded in groups
+// of four, so separately encoded blocks can be decoded one at a time.
+static void decode_base64(const char*& text, size_t min_bytes,
+                          std::vector<unsigned char>& bytes)
+{
+  unsigned long value = 0;
+  int num_chars = 0, num_pad = 0;
+  while (*text && (num_chars || bytes.size() < min_bytes)) {
+    const char c = *text++;
+    int digit;
+    if (c >= 'A' && c <= 'Z')
+      digit = c - 'A';
+    else if (c >= 'a' && c <= 'z')
+      digit = c - 'a' + 26;
+    else if (c >= '0' && c <= '9')
+      digit = c - '0' + 52;
+    else if (c == '+')
+      digit = 62;
+    else if (c == '/')
+      digit = 63;
+    else if (c == '=') {
+      digit = 0;
+      ++num_pad;
+    }
+    else
+      continue;
+
+    value = (value << 6) | digit;
+    if (++num_chars == 4) {
+      bytes.push_back((unsigned char)(value >> 16));
+      if (num_pad < 2)
+        bytes.push_back((unsigned char)(value >> 8));
+      if (num_pad < 1)
+        bytes.push_back((unsigned char)value);
+      value = 0;
+      num_chars = num_pad = 0;
+    }
+  }
+}
+
+// Get a 4- or 8-byte value from the header of a block of VTK XML binary data
+static uint64_t header_value(const unsigned char* bytes, bool header64, bool swap)
+{
+  if (header64) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    if (swap)
+      SysUtil::byteswap(&value, 1);
+    return value;
+  }
+
+  uint32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  if (swap)
+    SysUtil::byteswap(&value, 1);
+  return value;
+}
+
+#ifdef MOAB_HAVE_ZLIB
+// Decompress data written by vtkZLibDataCompressor, given the compression
+// header: the number of blocks, the block size, the size of the last block
+// if it is partial and the compressed size of each block.
+static bool uncompress_blocks(const std::vector<uint64_t>& header,
+                              const unsigned char* data, size_t data_len,
+                              std::vector<unsigned char>& out)
+{
+  const uint64_t num_blocks = header[0], block_size = header[1], last_size = header[2];
+  const uint64_t total = num_blocks ? (num_blocks - 1) * block_size + (last_size ? last_size : block_size) : 0;
+  out.resize(total);
+  uint64_t in = 0, pos = 0;
+  for (uint64_t b = 0; b < num_blocks; ++b) {
+    const uint64_t comp_size = header[3 + b];
+    uLongf len = (b + 1 == num_blocks && last_size) ? last_size : block_size;
+    if (in + comp_size > data_len || pos + len > total)
+      return false;
+    if (Z_OK != uncompress(&out[pos], &len, data + in, comp_size))
+      return false;
+    in += comp_size;
+    pos += len;
+  }
+  return pos == total;
+}
+#endif
+
+// Sequential access to the values of a DataArray in a VTK XML file,
+// either inline ASCII values, inline base64 data or raw binary appended
+// data.  Base64 and compressed data are decoded into memory when the
+// array is opened.
+class VtuArray
+{
+public:
+  VtuArray(const VtuElement& element)
+    : elem(element), vtkType(0), numComp(1), filePtr(0), swapBytes(false), textPtr(0)
+  {
+    memSource.ptr = memSource.end = 0;
+    const char* type = elem.get("type", "");
+    for (int i = 1; vtu_type_names[i]; ++i)
+      if (!strcmp(type, vtu_type_names[i]))
+        vtkType = i + 1;
+    numComp = atol(elem.get("NumberOfComponents", "1"));
+  }
+
+  // Check the size of the array and prepare to read its values.
+  //   appended   - file offset of the appended data, or -1 if none
+  //   header64   - true if binary block sizes are UInt64 rather than UInt32
+  //   compressed - true if binary data is compressed with zlib
+  //   swap       - true if the file byte order is not the native one
+  //   count      - expected number of values
+  ErrorCode open(FILE* file, long appended, bool header64, bool compressed,
+                 bool swap, size_t count)
+  {
+    const char* name = elem.get("Name", "");
+    if (!vtkType) {
+      MB_SET_ERR(MB_FAILURE, "Unsupported type \"" << elem.get("type", "") << "\" for DataArray \"" << name << "\"");
+    }
+    if (numComp < 1) {
+      MB_SET_ERR(MB_FAILURE, "Invalid number of components for DataArray \"" << name << "\"");
+    }
+
+    const char* format = elem.get("format", "ascii");
+    if (!strcmp(format, "ascii")) {
+      textPtr = elem.text.c_str();
+      return MB_SUCCESS;
+    }
+
+    const uint64_t bytes = count * vtk_type_sizes[vtkType];
+    const size_t header_size = header64 ? sizeof(uint64_t) : sizeof(uint32_t);
+    swapBytes = swap;
+    std::vector<uint64_t> header;
+    std::vector<unsigned char> data;
+
+    if (!strcmp(format, "binary")) {
+      // Inline base64 data.  Compressed data is preceded by the separately
+      // encoded compression header, uncompressed data by its size.
+      const char* text = elem.text.c_str();
+      if (compressed) {
+        std::vector<unsigned char> head;
+        decode_base64(text, 3 * header_size, head);
+        if (head.size() >= 3 * header_size)
+          decode_base64(text, (3 + header_value(&head[0], header64, swap)) * header_size, head);
+        for (size_t i = 0; i + header_size <= head.size(); i += header_size)
+          header.push_back(header_value(&head[i], header64, swap));
+        decode_base64(text, (size_t)-1, data);
+      }
+      else {
+        decode_base64(text, (size_t)-1, buffer);
+        if (buffer.size() < header_size || header_value(&buffer[0], header64, swap) != bytes) {
+          MB_SET_ERR(MB_FAILURE, "Size of DataArray \"" << name << "\" inconsistent with number of entities");
+        }
+        memSource.ptr = &buffer[0] + header_size;
+        memSource.end = &buffer[0] + buffer.size();
+      }
+    }
+    else if (!strcmp(format, "appended")) {
+      const char* offset = elem.get("offset");
+      if (appended < 0 || !offset) {
+        MB_SET_ERR(MB_FAILURE, "Missing appended data for DataArray \"" << name << "\"");
+      }
+      if (fseek(file, appended + atol(offset), SEEK_SET)) {
+        MB_SET_ERR(MB_FAILURE, "Invalid offset for DataArray \"" << name << "\"");
+      }
+
+      // Each block of appended data begins with its size in bytes,
+      // or with the compression header
+      const size_t num_head = compressed ? 3 : 1;
+      std::vector<unsigned char> head(num_head * header_size);
+      if (head.size() != fread(&head[0], 1, head.size(), file)) {
+        MB_SET_ERR(MB_FAILURE, "File truncated");
+      }
+      if (!compressed) {
+        if (header_value(&head[0], header64, swap) != bytes) {
+          MB_SET_ERR(MB_FAILURE, "Size of DataArray \"" << name << "\" inconsistent with number of entities");
+        }
+        filePtr = file;
+        return MB_SUCCESS;
+      }
+
+      const uint64_t num_blocks = header_value(&head[0], header64, swap);
+      head.resize((3 + num_blocks) * header_size);
+      if (num_blocks && num_blocks * header_size != fread(&head[3 * header_size], 1, num_blocks * header_size, file)) {
+        MB_SET_ERR(MB_FAILURE, "File truncated");
+      }
+      uint64_t data_size = 0;
+      for (size_t i = 0; i < head.size(); i += header_size) {
+        header.push_back(header_value(&head[i], header64, swap));
+        if (i >= 3 * header_size)
+          data_size += header.back();
+      }
+      data.resize(data_size);
+      if (data_size && data_size != fread(&data[0], 1, data_size, file)) {
+        MB_SET_ERR(MB_FAILURE, "File truncated");
+      }
+    }
+    else {
+      MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Unsupported format \"" << format << "\" for DataArray \"" << name << "\"");
+    }
+
+    if (compressed) {
+#ifdef MOAB_HAVE_ZLIB
+      if (header.size() < 3 || header.size() != 3 + header[0] ||
+          !uncompress_blocks(header, data.empty() ? 0 : &data[0], data.size(), buffer)) {
+        MB_SET_ERR(MB_FAILURE, "Invalid compressed data for DataArray \"" << name << "\"");
+      }
+      if (buffer.size() != bytes) {
+        MB_SET_ERR(MB_FAILURE, "Size of DataArray \"" << name << "\" inconsistent with number of entities");
+      }
+      memSource.ptr = buffer.empty() ? 0 : &buffer[0];
+      memSource.end = memSource.ptr + buffer.size();
+#else
+      MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Cannot read compressed VTK XML files: MOAB was built without zlib");
+#endif
+    }
+
+    return MB_SUCCESS;
+  }
+
+  template <typename T>
+  bool read(size_t count, T* array)
+  {
+    if (filePtr) {
+      FileSource source = {filePtr};
+      return read_binary_values(source, vtkType, swapBytes, count, array);
+    }
+    if (memSource.ptr)
+      return read_binary_values(memSource, vtkType, swapBytes, count, array);
+
+    for (size_t i = 0; i < count; ++i) {
+      char* end;
+      const double val = strtod(textPtr, &end);
+      if (end == textPtr)
+        return false;
+      array[i] = static_cast<T>(val);
+      textPtr = end;
+    }
+    return true;
+  }
+
+  const VtuElement& elem;
+  int vtkType; // Index in vtk_type_names
+  long numComp;
+
+private:
+  FILE* filePtr;
+  bool swapBytes;
+  const char* textPtr;
+  std::vector<unsigned char> buffer; // Decoded binary data
+  MemorySource memSource;
+};
+
 ErrorCode ReadVtk::read_tag_values(const char* /* file_name */,
                                    const char* /* tag_name */,
                                    const FileOptions& /* opts */,
@@ -210,7 +694,7 @@ ErrorCode ReadVtk::load_file(const char *filename,
   if (result == MB_SUCCESS)
     mPartitionTagName = partition_tag_name;
 
-  FILE* file = fopen(filename, "r");
+  FILE* file = fopen(filename, "rb");
   if (!file)
     return MB_FILE_DOES_NOT_EXIST;
 
@@ -221,6 +705,16 @@ ErrorCode ReadVtk::load_file(const char *filename,
     return MB_FAILURE;
   }
 
+  // XML file?
+  if (vendor_string[strspn(vendor_string, " \t\r\n")] == '<') {
+    rewind(file);
+    result = vtu_read_file(filename, file, vertices, element_list);
+    fclose(file);
+    if (MB_SUCCESS == result && file_id_tag)
+      result = store_file_ids(*file_id_tag, vertices, element_list);
+    return result;
+  }
+
   if (!strchr(vendor_string, '\n') ||
       2 != sscanf(vendor_string, "# vtk DataFile Version %d.%d", &major, &minor)) {
     fclose(file);
@@ -245,10 +739,12 @@ ErrorCode ReadVtk::load_file(const char *filename,
   int filetype = tokens.match_token(file_type_names);
   switch (filetype) {
     case 2:  // BINARY
-      MB_SET_ERR(MB_FAILURE, "Cannot read BINARY VTK files");
+      mBinary = true;
+      break;
     default: // ERROR 
       return MB_FAILURE;
     case 1:  // ASCII
+      mBinary = false;
       break;
   }
 
@@ -340,6 +836,7 @@ ErrorCode ReadVtk::allocate_vertices(long num_verts,
 
 ErrorCode ReadVtk::read_vertices(FileTokenizer& tokens,
                                  long num_verts,
+                                 int vtk_type,
                                  EntityHandle& start_handle_out)
 {
   ErrorCode result;
@@ -350,16 +847,83 @@ ErrorCode ReadVtk::read_vertices(FileTokenizer& tokens,
     return result;
 
   // Read vertex coordinates
-  for (long vtx = 0; vtx < num_verts; ++vtx) {
-    if (!tokens.get_doubles(1, x++) ||
-        !tokens.get_doubles(1, y++) ||
-        !tokens.get_doubles(1, z++))
-      return MB_FAILURE;
+  if (!mBinary) {
+    for (long vtx = 0; vtx < num_verts; ++vtx) {
+      if (!tokens.get_doubles(1, x++) ||
+          !tokens.get_doubles(1, y++) ||
+          !tokens.get_doubles(1, z++))
+        return MB_FAILURE;
+    }
+    return MB_SUCCESS;
+  }
+
+  // Binary coordinates are interleaved, so read them in blocks
+  const long block_size = 4096;
+  std::vector<double> coords(3 * std::min(num_verts, block_size));
+  for (long vtx = 0; vtx < num_verts; vtx += block_size) {
+    const long count = std::min(num_verts - vtx, block_size);
+    if (!vtk_read_values(tokens, vtk_type, 3 * count, &coords[0]))
+      MB_SET_ERR(MB_FAILURE, "Error reading binary vertex coordinates");
+    for (long i = 0; i < count; ++i) {
+      *x++ = coords[3*i];
+      *y++ = coords[3*i + 1];
+      *z++ = coords[3*i + 2];
+    }
   }
 
   return MB_SUCCESS;
 }
 
+bool ReadVtk::vtk_read_values(FileTokenizer& tokens, int vtk_type,
+                              size_t count, double* array)
+{
+  if (!mBinary)
+    return tokens.get_doubles(count, array);
+
+  // Binary data in legacy files is always big-endian
+  TokenizerSource source = {tokens};
+  return read_binary_values(source, vtk_type, !native_big_endian(), count, array);
+}
+
+bool ReadVtk::vtk_read_values(FileTokenizer& tokens, int vtk_type,
+                              size_t count, int* array)
+{
+  if (!mBinary)
+    return tokens.get_integers(count, array);
+
+  TokenizerSource source = {tokens};
+  return read_binary_values(source, vtk_type, !native_big_endian(), count, array);
+}
+
+bool ReadVtk::vtk_read_values(FileTokenizer& tokens, int vtk_type,
+                              size_t count, long* array)
+{
+  if (!mBinary)
+    return tokens.get_long_ints(count, array);
+
+  TokenizerSource source = {tokens};
+  return read_binary_values(source, vtk_type, !native_big_endian(), count, array);
+}
+
+bool ReadVtk::vtk_read_values(FileTokenizer& tokens, int vtk_type,
+                              size_t count, bool* array)
+{
+  if (!mBinary)
+    return tokens.get_booleans(count, array);
+
+  if (vtk_type != 1)
+    return false;
+
+  // Binary bit arrays are packed, most significant bit first
+  std::vector<unsigned char> bits((count + 7) / 8);
+  if (!bits.empty() && !tokens.get_binary(bits.size(), &bits[0]))
+    return false;
+  for (size_t i = 0; i < count; ++i)
+    array[i] = 0 != (bits[i / 8] & (0x80 >> (i % 8)));
+
+  return true;
+}
+
 ErrorCode ReadVtk::allocate_elements(long num_elements,
                                      int vert_per_element,
                                      EntityType type,
@@ -472,9 +1036,10 @@ ErrorCode ReadVtk::vtk_read_structured_grid(FileTokenizer& tokens,
     MB_SET_ERR(MB_FAILURE, "Invalid dimension at line " << tokens.line_number());
   }
 
+  int vtk_type;
   if (!tokens.match_token("POINTS") ||
       !tokens.get_long_ints(1, &num_verts) ||
-      !tokens.match_token(vtk_type_names) ||
+      !(vtk_type = tokens.match_token(vtk_type_names)) ||
       !tokens.get_newline())
     return MB_FAILURE;
 
@@ -484,7 +1049,7 @@ ErrorCode ReadVtk::vtk_read_structured_grid(FileTokenizer& tokens,
 
   // Create and read vertices
   EntityHandle start_handle = 0;
-  result = read_vertices(tokens, num_verts, start_handle);
+  result = read_vertices(tokens, num_verts, vtk_type, start_handle);
   if (MB_SUCCESS != result)
     return result;
   vertex_list.insert(start_handle, start_handle + num_verts - 1);
@@ -513,9 +1078,11 @@ ErrorCode ReadVtk::vtk_read_rectilinear_grid(FileTokenizer& tokens,
 
   for (i = 0; i < 3; i++) {
     long count;
+    int vtk_type;
     if (!tokens.match_token(labels[i]) ||
         !tokens.get_long_ints(1, &count) ||
-        !tokens.match_token(vtk_type_names))
+        !(vtk_type = tokens.match_token(vtk_type_names)) ||
+        (mBinary && !tokens.get_newline()))
       return MB_FAILURE;
 
     if (count != dims[i]) {
@@ -523,7 +1090,7 @@ ErrorCode ReadVtk::vtk_read_rectilinear_grid(FileTokenizer& tokens,
     }
 
     coords[i].resize(count);
-    if (!tokens.get_doubles(count, &coords[i][0]))
+    if (!vtk_read_values(tokens, vtk_type, count, &coords[i][0]))
       return MB_FAILURE;
   }
 
@@ -560,9 +1127,10 @@ ErrorCode ReadVtk::vtk_read_polydata(FileTokenizer& tokens,
                                          "TRIANGLE_STRIPS",
                                           0};
 
+  int vtk_type;
   if (!tokens.match_token("POINTS") ||
       !tokens.get_long_ints(1, &num_verts) ||
-      !tokens.match_token(vtk_type_names) ||
+      !(vtk_type = tokens.match_token(vtk_type_names)) ||
       !tokens.get_newline())
     return MB_FAILURE;
 
@@ -572,7 +1140,7 @@ ErrorCode ReadVtk::vtk_read_polydata(FileTokenizer& tokens,
 
   // Create vertices and read coordinates
   EntityHandle start_handle = 0;
-  result = read_vertices(tokens, num_verts, start_handle);
+  result = read_vertices(tokens, num_verts, vtk_type, start_handle);
   if (MB_SUCCESS != result)
     return result;
   vertex_list.insert(start_handle, start_handle + num_verts - 1);
@@ -617,12 +1185,13 @@ ErrorCode ReadVtk::vtk_read_polygons(FileTokenizer& tokens,
   std::vector<long> conn_idx;
   EntityHandle first = 0, prev = 0, handle;
   for (int i = 0; i < size[0]; ++i) {
+    // Binary cell lists are 32-bit ints
     long count;
-    if (!tokens.get_long_ints(1, &count))
+    if (!vtk_read_values(tokens, 6, 1, &count))
       return MB_FAILURE;
     conn_idx.resize(count);
     conn_hdl.resize(count);
-    if (!tokens.get_long_ints(count, &conn_idx[0]))
+    if (!vtk_read_values(tokens, 6, count, &conn_idx[0]))
       return MB_FAILURE;
     
     for (long j = 0; j < count; ++j)
@@ -657,7 +1226,6 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
 {
   ErrorCode result;
   long i, num_verts, num_elems[2];
-  EntityHandle tmp_conn_list[27];
 
   // Poorly formatted VTK legacy format document seems to
   // lead many to think that a FIELD block can occur within
@@ -674,8 +1242,9 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
   if (i != 2)
     return MB_FAILURE;
 
+  int vtk_type;
   if (!tokens.get_long_ints(1, &num_verts) ||
-      !tokens.match_token(vtk_type_names) ||
+      !(vtk_type = tokens.match_token(vtk_type_names)) ||
       !tokens.get_newline())
     return MB_FAILURE;
 
@@ -685,7 +1254,7 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
 
   // Create vertices and read coordinates
   EntityHandle first_vertex = 0;
-  result = read_vertices(tokens, num_verts, first_vertex);
+  result = read_vertices(tokens, num_verts, vtk_type, first_vertex);
   if (MB_SUCCESS != result)
     return result;
   vertex_list.insert(first_vertex, first_vertex + num_verts - 1);
@@ -703,9 +1272,10 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
       !tokens.get_newline())
     return MB_FAILURE;
 
-  // Read element connectivity for all elements
+  // Read element connectivity for all elements (binary
+  // cell lists are 32-bit ints)
   std::vector<long> connectivity(num_elems[1]);
-  if (!tokens.get_long_ints(num_elems[1], &connectivity[0]))
+  if (!vtk_read_values(tokens, 6, num_elems[1], &connectivity[0]))
     return MB_FAILURE;
 
   if (!tokens.match_token("CELL_TYPES") ||
@@ -715,16 +1285,30 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
 
   // Read element types
   std::vector<long> types(num_elems[0]);
-  if (!tokens.get_long_ints(num_elems[0], &types[0]))
+  if (!vtk_read_values(tokens, 6, num_elems[0], &types[0]))
     return MB_FAILURE;
 
+  return vtk_create_unstructured_elems(first_vertex, num_elems[0],
+                                       connectivity, types, elem_list);
+}
+
+ErrorCode ReadVtk::vtk_create_unstructured_elems(EntityHandle first_vertex,
+                                                 long num_elems,
+                                                 const std::vector<long>& connectivity,
+                                                 const std::vector<long>& types,
+                                                 std::vector<Range>& elem_list)
+{
+  ErrorCode result;
+  long i;
+  EntityHandle tmp_conn_list[27];
+
   // Create elements in blocks of the same type
   // It is important to preserve the order in
   // which the elements were read for later reading
   // attribute data.
   long id = 0;
-  std::vector<long>::iterator conn_iter = connectivity.begin();
-  while (id < num_elems[0]) {
+  std::vector<long>::const_iterator conn_iter = connectivity.begin();
+  while (id < num_elems) {
     unsigned vtk_type = types[id];
     if (vtk_type >= VtkUtil::numVtkElemType)
       return MB_FAILURE;
@@ -743,11 +1327,11 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
 
     // Find any subsequent elements of the same type
     // if polyhedra, need to look at the number of faces to put in the same range
-    std::vector<long>::iterator conn_iter2 = conn_iter + num_vtx + 1;
+    std::vector<long>::const_iterator conn_iter2 = conn_iter + num_vtx + 1;
     long end_id = id + 1; 
     if (MBPOLYHEDRON != type)
     {
-      while (end_id < num_elems[0] &&
+      while (end_id < num_elems &&
              (unsigned)types[end_id] == vtk_type &&
              *conn_iter2 == num_vtx) {
         ++end_id;
@@ -758,7 +1342,7 @@ ErrorCode ReadVtk::vtk_read_unstructured_grid(FileTokenizer& tokens,
     {
       // advance only if next is polyhedron too, and if number of faces is the same
       int num_faces = conn_iter[1];
-      while (end_id < num_elems[0] &&
+      while (end_id < num_elems &&
              (unsigned)types[end_id] == vtk_type &&
              conn_iter2[1] == num_faces) {
         ++end_id;
@@ -972,12 +1556,30 @@ ErrorCode ReadVtk::vtk_read_field(FileTokenizer& tokens)
     /*const char* name =*/ tokens.get_string();
 
     long dims[2];
+    int type;
     if (!tokens.get_long_ints(2, dims) ||
-        !tokens.match_token(vtk_type_names))
+        !(type = tokens.match_token(vtk_type_names)) ||
+        (mBinary && !tokens.get_newline()))
       return MB_FAILURE;
 
     long num_vals = dims[0] * dims[1];
 
+    if (mBinary) {
+      bool success;
+      if (type == 1) {
+        bool* junk = new bool[num_vals];
+        success = vtk_read_values(tokens, type, num_vals, junk);
+        delete [] junk;
+      }
+      else {
+        std::vector<double> junk(num_vals);
+        success = vtk_read_values(tokens, type, num_vals, junk.empty() ? 0 : &junk[0]);
+      }
+      if (!success)
+        return MB_FAILURE;
+      continue;
+    }
+
     for (long j = 0; j < num_vals; j++) {
       double junk;
       if (!tokens.get_doubles(1, &junk))
@@ -1064,14 +1666,19 @@ ErrorCode ReadVtk::vtk_read_tag_data(FileTokenizer& tokens,
   std::vector<Range>::iterator iter;
 
   if (type == 1) {
-    for (iter = entities.begin(); iter != entities.end(); ++iter) {
-      bool *data = new bool[iter->size() * per_elem];
-      if (!tokens.get_booleans(per_elem*iter->size(), data)) {
-        delete [] data;
-        return MB_FAILURE;
-      }
+    // Read values for all entities at once, as binary bit
+    // arrays are packed without regard to entity blocks
+    size_t count = 0;
+    for (iter = entities.begin(); iter != entities.end(); ++iter)
+      count += iter->size() * per_elem;
+    bool *data = new bool[count];
+    if (!vtk_read_values(tokens, type, count, data)) {
+      delete [] data;
+      return MB_FAILURE;
+    }
 
-      bool* data_iter = data;
+    bool* data_iter = data;
+    for (iter = entities.begin(); iter != entities.end(); ++iter) {
       Range::iterator ent_iter = iter->begin();
       for ( ; ent_iter != iter->end(); ++ent_iter) {
         unsigned char bits = 0;
@@ -1087,14 +1694,14 @@ ErrorCode ReadVtk::vtk_read_tag_data(FileTokenizer& tokens,
           return result;
         }
       }
-      delete [] data;
     }
+    delete [] data;
   }
   else if ((type >= 2 && type <= 9) || type == 12) {
     std::vector<int> data;
     for (iter = entities.begin(); iter != entities.end(); ++iter) {
       data.resize(iter->size() * per_elem);
-      if (!tokens.get_integers(iter->size() * per_elem, &data[0]))
+      if (!vtk_read_values(tokens, type, iter->size() * per_elem, &data[0]))
         return MB_FAILURE;
 #ifdef MB_VTK_MATERIAL_SETS
       if (isMaterial)
@@ -1109,7 +1716,7 @@ ErrorCode ReadVtk::vtk_read_tag_data(FileTokenizer& tokens,
     std::vector<double> data;
     for (iter = entities.begin(); iter != entities.end(); ++iter) {
       data.resize(iter->size() * per_elem);
-      if (!tokens.get_doubles(iter->size() * per_elem, &data[0]))
+      if (!vtk_read_values(tokens, type, iter->size() * per_elem, &data[0]))
         return MB_FAILURE;
 #ifdef MB_VTK_MATERIAL_SETS
       if (isMaterial)
@@ -1152,7 +1759,8 @@ ErrorCode ReadVtk::vtk_read_scalar_attrib(FileTokenizer& tokens,
   }
 
   if (!tokens.match_token("LOOKUP_TABLE") ||
-      !tokens.match_token("default"))
+      !tokens.match_token("default") ||
+      (mBinary && !tokens.get_newline()))
     return MB_FAILURE;
 
   return vtk_read_tag_data(tokens, type, size, entities, name);
@@ -1166,7 +1774,32 @@ ErrorCode ReadVtk::vtk_read_color_attrib(FileTokenizer& tokens,
   if (!tokens.get_long_ints(1, &size) || size < 1)
     return MB_FAILURE;
 
-  return vtk_read_tag_data(tokens, 10, size, entities, name);
+  if (!mBinary)
+    return vtk_read_tag_data(tokens, 10, size, entities, name);
+
+  // Binary color values are unsigned chars rather than floats in [0,1]
+  if (!tokens.get_newline())
+    return MB_FAILURE;
+
+  Tag handle;
+  ErrorCode result = mdbImpl->tag_get_handle(name, size, MB_TYPE_DOUBLE, handle,
+                                             MB_TAG_DENSE | MB_TAG_CREAT);MB_CHK_SET_ERR(result, "Tag name conflict for attribute \"" << name << "\" at line " << tokens.line_number());
+
+  std::vector<unsigned char> bytes;
+  std::vector<double> data;
+  for (std::vector<Range>::iterator iter = entities.begin(); iter != entities.end(); ++iter) {
+    bytes.resize(iter->size() * size);
+    data.resize(bytes.size());
+    if (!tokens.get_binary(bytes.size(), &bytes[0]))
+      return MB_FAILURE;
+    for (size_t i = 0; i < bytes.size(); ++i)
+      data[i] = bytes[i] / 255.0;
+    result = mdbImpl->tag_set_data(handle, *iter, &data[0]);
+    if (MB_SUCCESS != result)
+      return result;
+  }
+
+  return MB_SUCCESS;
 }
 
 ErrorCode ReadVtk::vtk_read_vector_attrib(FileTokenizer& tokens,
@@ -1174,7 +1807,7 @@ ErrorCode ReadVtk::vtk_read_vector_attrib(FileTokenizer& tokens,
                                           const char* name)
 {
   int type = tokens.match_token(vtk_type_names);
-  if (!type)
+  if (!type || (mBinary && !tokens.get_newline()))
     return MB_FAILURE;
 
   return vtk_read_tag_data(tokens, type, 3, entities, name);
@@ -1186,7 +1819,8 @@ ErrorCode ReadVtk::vtk_read_texture_attrib(FileTokenizer& tokens,
 {
   int type, dim;
   if (!tokens.get_integers(1, &dim) ||
-      !(type = tokens.match_token(vtk_type_names)))
+      !(type = tokens.match_token(vtk_type_names)) ||
+      (mBinary && !tokens.get_newline()))
     return MB_FAILURE;
 
   if (dim < 1 || dim > 3) {
@@ -1201,7 +1835,7 @@ ErrorCode ReadVtk::vtk_read_tensor_attrib(FileTokenizer& tokens,
                                           const char* name)
 {
   int type = tokens.match_token(vtk_type_names);
-  if (!type)
+  if (!type || (mBinary && !tokens.get_newline()))
     return MB_FAILURE;
 
   return vtk_read_tag_data(tokens, type, 9, entities, name);
@@ -1232,7 +1866,7 @@ ErrorCode ReadVtk::vtk_read_field_attrib(FileTokenizer& tokens,
       return MB_FAILURE;
 
     int type = tokens.match_token(vtk_type_names);
-    if (!type)
+    if (!type || (mBinary && !tokens.get_newline()))
       return MB_FAILURE;
 
     ErrorCode result = vtk_read_tag_data(tokens, type, num_comp, entities,
@@ -1242,6 +1876,289 @@ ErrorCode ReadVtk::vtk_read_field_attrib(FileTokenizer& tokens,
   return MB_SUCCESS;
 }
 
+ErrorCode ReadVtk::vtu_read_file(const char* file_name,
+                                 FILE* file,
+                                 Range& vertex_list,
+                                 std::vector<Range>& elem_list)
+{
+  ErrorCode result;
+
+  // Read the XML up to the start of the appended data, if any.
+  // Appended data is read directly from the file as needed.
+  std::string xml;
+  long appended = -1;
+  size_t tag_pos = std::string::npos;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file))) {
+    const size_t search = xml.size() > 16 ? xml.size() - 16 : 0;
+    xml.append(buffer, count);
+    if (tag_pos == std::string::npos)
+      tag_pos = xml.find("<AppendedData", search);
+    if (tag_pos != std::string::npos) {
+      // Data begins after the first underscore following the tag
+      size_t mark = xml.find('>', tag_pos);
+      if (mark != std::string::npos)
+        mark = xml.find('_', mark);
+      if (mark != std::string::npos) {
+        appended = mark + 1;
+        xml.resize(mark);
+        break;
+      }
+    }
+  }
+
+  std::vector<VtuElement> elems;
+  if (!parse_vtu_elements(xml, elems) || elems.empty() || elems[0].name != "VTKFile") {
+    MB_SET_ERR(MB_FAILURE, "Invalid VTK XML file");
+  }
+
+  const VtuElement& root = elems[0];
+  if (!strcmp(root.get("type", ""), "PUnstructuredGrid")) {
+    // Read each piece from its own file, named relative to this one
+    std::string dir(file_name);
+    const std::string::size_type slash = dir.find_last_of("/\\");
+    dir.erase(slash == std::string::npos ? 0 : slash + 1);
+    for (size_t i = 0; i < elems.size(); ++i) {
+      if (elems[i].name != "Piece")
+        continue;
+      const char* source = elems[i].get("Source");
+      if (!source || !*source) {
+        MB_SET_ERR(MB_FAILURE, "Piece of parallel VTK XML file has no source");
+      }
+      const std::string piece_name = (*source == '/') ? std::string(source) : dir + source;
+      FILE* piece = fopen(piece_name.c_str(), "rb");
+      if (!piece) {
+        MB_SET_ERR(MB_FILE_DOES_NOT_EXIST, "Could not open piece: " << piece_name);
+      }
+      result = vtu_read_file(piece_name.c_str(), piece, vertex_list, elem_list);
+      fclose(piece);
+      MB_CHK_ERR(result);
+    }
+    return MB_SUCCESS;
+  }
+  if (strcmp(root.get("type", ""), "UnstructuredGrid")) {
+    MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Unsupported VTK XML data set type: " << root.get("type", ""));
+  }
+  const char* compressor = root.get("compressor");
+  if (compressor && strcmp(compressor, "vtkZLibDataCompressor")) {
+    MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Unsupported VTK XML compressor: " << compressor);
+  }
+  const bool compressed = (0 != compressor);
+  const bool big_endian = !strcmp(root.get("byte_order", "LittleEndian"), "BigEndian");
+  const bool swap = big_endian != native_big_endian();
+  const bool header64 = !strcmp(root.get("header_type", "UInt32"), "UInt64");
+  for (size_t i = 0; i < elems.size(); ++i) {
+    if (elems[i].name == "AppendedData" && strcmp(elems[i].get("encoding", "raw"), "raw")) {
+      MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Unsupported encoding for appended data: " << elems[i].get("encoding"));
+    }
+  }
+
+  for (size_t p = 0; p < elems.size(); ++p) {
+    if (elems[p].name != "Piece")
+      continue;
+
+    const long num_verts = atol(elems[p].get("NumberOfPoints", "0"));
+    const long num_cells = atol(elems[p].get("NumberOfCells", "0"));
+    if (num_verts < 1) {
+      if (num_cells > 0) {
+        MB_SET_ERR(MB_FAILURE, "Piece has cells but no points");
+      }
+      continue;
+    }
+
+    // Find the data arrays for this piece
+    const VtuElement *points = 0, *conn = 0, *offsets = 0, *types = 0;
+    std::vector<const VtuElement*> point_data, cell_data;
+    for (size_t i = p + 1; i < elems.size(); ++i) {
+      if (elems[i].name != "DataArray" || elems[i].parent < 0 ||
+          elems[elems[i].parent].parent != (int)p)
+        continue;
+      const std::string& section = elems[elems[i].parent].name;
+      const char* name = elems[i].get("Name", "");
+      if (section == "Points")
+        points = &elems[i];
+      else if (section == "PointData")
+        point_data.push_back(&elems[i]);
+      else if (section == "CellData")
+        cell_data.push_back(&elems[i]);
+      else if (section == "Cells") {
+        if (!strcmp(name, "connectivity"))
+          conn = &elems[i];
+        else if (!strcmp(name, "offsets"))
+          offsets = &elems[i];
+        else if (!strcmp(name, "types"))
+          types = &elems[i];
+      }
+    }
+
+    // Create vertices and read coordinates
+    if (!points) {
+      MB_SET_ERR(MB_FAILURE, "Piece has no point coordinates");
+    }
+    VtuArray coords(*points);
+    if (coords.numComp != 3) {
+      MB_SET_ERR(MB_FAILURE, "Point coordinates must have 3 components");
+    }
+    result = coords.open(file, appended, header64, compressed, swap, 3 * num_verts);MB_CHK_ERR(result);
+
+    EntityHandle first_vertex = 0;
+    double *x, *y, *z;
+    result = allocate_vertices(num_verts, first_vertex, x, y, z);
+    if (MB_SUCCESS != result)
+      return result;
+    vertex_list.insert(first_vertex, first_vertex + num_verts - 1);
+
+    const long block_size = 4096;
+    std::vector<double> xyz(3 * std::min(num_verts, block_size));
+    for (long vtx = 0; vtx < num_verts; vtx += block_size) {
+      const long n = std::min(num_verts - vtx, block_size);
+      if (!coords.read(3 * n, &xyz[0])) {
+        MB_SET_ERR(MB_FAILURE, "Error reading point coordinates");
+      }
+      for (long i = 0; i < n; ++i) {
+        *x++ = xyz[3*i];
+        *y++ = xyz[3*i + 1];
+        *z++ = xyz[3*i + 2];
+      }
+    }
+
+    // Read cells and convert them to the legacy layout,
+    // where each cell is its vertex count followed by
+    // the vertex indices
+    std::vector<Range> piece_elems;
+    if (num_cells > 0) {
+      if (!conn || !offsets || !types) {
+        MB_SET_ERR(MB_FAILURE, "Piece is missing cell connectivity, offsets or types");
+      }
+
+      std::vector<long> offset_list(num_cells), type_list(num_cells);
+      VtuArray offset_array(*offsets), type_array(*types);
+      result = offset_array.open(file, appended, header64, compressed, swap, num_cells);MB_CHK_ERR(result);
+      if (!offset_array.read(num_cells, &offset_list[0])) {
+        MB_SET_ERR(MB_FAILURE, "Error reading cell offsets");
+      }
+      result = type_array.open(file, appended, header64, compressed, swap, num_cells);MB_CHK_ERR(result);
+      if (!type_array.read(num_cells, &type_list[0])) {
+        MB_SET_ERR(MB_FAILURE, "Error reading cell types");
+      }
+
+      const long conn_len = offset_list.back();
+      if (conn_len < 1) {
+        MB_SET_ERR(MB_FAILURE, "Invalid cell offsets");
+      }
+      // Read the connectivity into the end of the list and
+      // then shift it forward to insert the vertex counts
+      std::vector<long> cell_list(num_cells + conn_len);
+      long* conn_list = &cell_list[num_cells];
+      VtuArray conn_array(*conn);
+      result = conn_array.open(file, appended, header64, compressed, swap, conn_len);MB_CHK_ERR(result);
+      if (!conn_array.read(conn_len, conn_list)) {
+        MB_SET_ERR(MB_FAILURE, "Error reading cell connectivity");
+      }
+
+      long prev = 0, pos = 0;
+      for (long i = 0; i < num_cells; ++i) {
+        if (offset_list[i] < prev || offset_list[i] > conn_len) {
+          MB_SET_ERR(MB_FAILURE, "Invalid offset for cell " << i);
+        }
+        if (type_list[i] >= 0 && type_list[i] < (long)VtkUtil::numVtkElemType &&
+            VtkUtil::vtkElemTypes[type_list[i]].mb_type == MBPOLYHEDRON) {
+          MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Cannot read polyhedra from VTK XML files");
+        }
+        cell_list[pos++] = offset_list[i] - prev;
+        for ( ; prev < offset_list[i]; ++prev)
+          cell_list[pos++] = conn_list[prev];
+      }
+
+      result = vtk_create_unstructured_elems(first_vertex, num_cells, cell_list,
+                                             type_list, piece_elems);
+      if (MB_SUCCESS != result)
+        return result;
+    }
+
+    // Read attribute data
+    std::vector<Range> piece_verts(1, Range(first_vertex, first_vertex + num_verts - 1));
+    for (size_t i = 0; i < point_data.size(); ++i) {
+      VtuArray array(*point_data[i]);
+      result = array.open(file, appended, header64, compressed, swap, num_verts * array.numComp);MB_CHK_ERR(result);
+      result = vtu_read_tag_data(array, piece_verts);MB_CHK_ERR(result);
+    }
+
+    long num_elems = 0;
+    for (size_t i = 0; i < piece_elems.size(); ++i)
+      num_elems += piece_elems[i].size();
+    if (!cell_data.empty() && num_elems != num_cells) {
+      MB_SET_ERR(MB_FAILURE, "Cannot read cell data for pieces containing vertex cells");
+    }
+    for (size_t i = 0; i < cell_data.size(); ++i) {
+      VtuArray array(*cell_data[i]);
+      result = array.open(file, appended, header64, compressed, swap, num_cells * array.numComp);MB_CHK_ERR(result);
+      result = vtu_read_tag_data(array, piece_elems);MB_CHK_ERR(result);
+    }
+
+    elem_list.insert(elem_list.end(), piece_elems.begin(), piece_elems.end());
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode ReadVtk::vtu_read_tag_data(VtuArray& array,
+                                     const std::vector<Range>& entities)
+{
+  const char* name = array.elem.get("Name", "");
+  if (!*name) {
+    MB_SET_ERR(MB_FAILURE, "DataArray has no name");
+  }
+
+  const bool is_float = (array.vtkType == 10 || array.vtkType == 11);
+  const DataType mb_type = is_float ? MB_TYPE_DOUBLE : MB_TYPE_INTEGER;
+  const size_t size = is_float ? sizeof(double) : sizeof(int);
+  const size_t per_elem = array.numComp;
+
+#ifdef MB_VTK_MATERIAL_SETS
+  Modulator materialMap(this->mdbImpl, this->mPartitionTagName, mb_type, size, per_elem);
+  bool isMaterial =
+    size * per_elem <= 4 &&                          // Must have int-sized values (ParallelComm requires it)
+    ! this->mPartitionTagName.empty() &&             // Must have a non-empty field name...
+    ! strcmp(name, this->mPartitionTagName.c_str()); // ... that matches our spec.
+#endif // MB_VTK_MATERIAL_SETS
+
+  Tag handle;
+  ErrorCode result = mdbImpl->tag_get_handle(name, per_elem, mb_type, handle,
+                                             MB_TAG_DENSE | MB_TAG_CREAT);MB_CHK_SET_ERR(result, "Tag name conflict for attribute \"" << name << "\"");
+
+  std::vector<double> dbl_data;
+  std::vector<int> int_data;
+  for (std::vector<Range>::const_iterator iter = entities.begin(); iter != entities.end(); ++iter) {
+    const size_t count = iter->size() * per_elem;
+    void* data;
+    bool success;
+    if (is_float) {
+      dbl_data.resize(count);
+      data = &dbl_data[0];
+      success = array.read(count, &dbl_data[0]);
+    }
+    else {
+      int_data.resize(count);
+      data = &int_data[0];
+      success = array.read(count, &int_data[0]);
+    }
+    if (!success) {
+      MB_SET_ERR(MB_FAILURE, "Error reading data for attribute \"" << name << "\"");
+    }
+#ifdef MB_VTK_MATERIAL_SETS
+    if (isMaterial)
+      materialMap.add_entities(*iter, (unsigned char*) data, per_elem * size);
+#endif // MB_VTK_MATERIAL_SETS
+    result = mdbImpl->tag_set_data(handle, *iter, data);
+    if (MB_SUCCESS != result)
+      return result;
+  }
+
+  return MB_SUCCESS;
+}
+
 ErrorCode ReadVtk::store_file_ids(Tag tag, const Range& verts,
                                   const std::vector<Range>& elems)
 {
@@ -20,11 +20,13 @@
 #include "moab/ReaderIface.hpp"
 
 #include <string>
+#include <cstdio>
 
 namespace moab {
 
 class ReadUtilIface;
 class FileTokenizer;
+class VtuArray;
 
 class ReadVtk : public ReaderIface
 {
@@ -62,8 +64,20 @@ protected:
 
   ErrorCode read_vertices( FileTokenizer& tokens,
                              long num_verts, 
+                             int vtk_type,
                              EntityHandle& start_handle_out );
 
+    //! Read values of the specified VTK data type (index into the list
+    //! of VTK type names), as ASCII or as big-endian binary data.
+  bool vtk_read_values( FileTokenizer& tokens, int vtk_type,
+                        size_t count, double* array );
+  bool vtk_read_values( FileTokenizer& tokens, int vtk_type,
+                        size_t count, int* array );
+  bool vtk_read_values( FileTokenizer& tokens, int vtk_type,
+                        size_t count, long* array );
+  bool vtk_read_values( FileTokenizer& tokens, int vtk_type,
+                        size_t count, bool* array );
+
   ErrorCode allocate_elements( long num_elements,
                                  int vert_per_element,
                                  EntityType type,
@@ -99,6 +113,14 @@ protected:
                                           Range& vertex_list,
                                           std::vector<Range>& elem_list  );
 
+    //! Create elements from a legacy-format cell list: for each cell,
+    //! the number of vertices followed by the vertex indices.
+  ErrorCode vtk_create_unstructured_elems( EntityHandle first_vertex,
+                                           long num_elems,
+                                           const std::vector<long>& connectivity,
+                                           const std::vector<long>& types,
+                                           std::vector<Range>& elem_list );
+
   ErrorCode vtk_create_structured_elems( const long* dims, 
                                            EntityHandle first_vtx,
                                            std::vector<Range>& elem_list );
@@ -138,6 +160,16 @@ protected:
                                      std::vector<Range>& entities,
                                      const char* name);
 
+    //! Read a VTK XML unstructured grid (.vtu) file, or the
+    //! pieces listed in a parallel (.pvtu) file
+  ErrorCode vtu_read_file( const char* file_name,
+                           std::FILE* file,
+                           Range& vertex_list,
+                           std::vector<Range>& elem_list );
+
+  ErrorCode vtu_read_tag_data( VtuArray& array,
+                               const std::vector<Range>& entities );
+
   ErrorCode store_file_ids( Tag tag,
                               const Range& vertices,
                               const std::vector<Range>& elements );
@@ -146,6 +178,9 @@ private:
 
   ReadUtilIface* readMeshIface;
 
+    //! True if the data sections of the legacy file being read are binary
+  bool mBinary;
+
   //------------member variables ------------//
 
     //! interface instance
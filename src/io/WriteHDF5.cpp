@@ -42,9 +42,11 @@
 #include <H5Tpublic.h>
 #include <H5Ppublic.h>
 #include <H5Epublic.h>
+#include <H5FDcore.h>
 #include "moab/Interface.hpp"
 #include "Internals.hpp"
 #include "MBTagConventions.hpp"
+#include "MBParallelConventions.h"
 #include "moab/CN.hpp"
 #include "moab/FileOptions.hpp"
 #include "moab/Version.h"
@@ -101,6 +103,12 @@ void VALGRIND_MAKE_VEC_UNDEFINED(std::vector<T>& v) {
 
 #define WRITE_HDF5_BUFFER_SIZE (40 * 1024 * 1024)
 
+// Default chunk size for bulk data tables if filters are requested.
+// Chunks should fit in the default HDF5 chunk cache (1MB) so that
+// writes and partial reads that do not cover entire chunks do not
+// repeatedly decompress and recompress the same chunk.
+#define WRITE_HDF5_CHUNK_SIZE (512 * 1024)
+
 static hid_t get_id_type()
 {
   if (8 == sizeof(WriteHDF5::wid_t)) {
@@ -397,6 +405,14 @@ WriteHDF5::WriteHDF5(Interface* iface)
     parallelWrite(false),
     collectiveIO(false),
     writeTagDense(false),
+    chunkSize(0),
+    deflateLevel(0),
+    shuffleData(false),
+    fileImage(0),
+    writePartIndex(false),
+    partIndexTag(0),
+    partIndexOffset(0),
+    partRangeOffset(0),
     writeProp(H5P_DEFAULT),
     dbgOut("H5M", stderr),
     debugTrack(false)
@@ -460,6 +476,8 @@ ErrorCode WriteHDF5::write_finished()
   setSet.range.clear();
   tagList.clear();
   idMap.clear();
+  partIndexData.clear();
+  partRangeData.clear();
 
   HDF5ErrorHandler handler;
 #if defined(H5Eget_auto_vers) && H5Eget_auto_vers > 1
@@ -521,6 +539,40 @@ ErrorCode WriteHDF5::write_file(const char* filename,
   if (MB_SUCCESS == rval && buf_size >= 24)
     bufferSize = buf_size;
 
+  // Chunked storage and filters for coordinates, connectivity
+  // and tag data.  Any filter implies chunked storage.
+  deflateLevel = 0;
+  rval = opts.get_int_option("COMPRESS", 6, deflateLevel);
+  if (MB_TYPE_OUT_OF_RANGE == rval || deflateLevel < 0 || deflateLevel > 9) {
+    MB_SET_ERR(MB_TYPE_OUT_OF_RANGE, "Invalid value for COMPRESS option");
+  }
+  shuffleData = (MB_SUCCESS == opts.get_null_option("SHUFFLE"));
+  chunkSize = (deflateLevel || shuffleData) ? WRITE_HDF5_CHUNK_SIZE : 0;
+  int chunk_size;
+  rval = opts.get_int_option("CHUNK_SIZE", chunk_size);
+  if (MB_SUCCESS == rval && chunk_size > 0)
+    chunkSize = chunk_size;
+  else if (MB_ENTITY_NOT_FOUND != rval) {
+    MB_SET_ERR(MB_TYPE_OUT_OF_RANGE, "Invalid value for CHUNK_SIZE option");
+  }
+
+  // Index of the entities to read for each part of a partition
+  writePartIndex = false;
+  partIndexTag = 0;
+  std::string part_tag_name;
+  rval = opts.get_option("PARTITION_INDEX", part_tag_name);
+  if (MB_SUCCESS == rval) {
+    writePartIndex = true;
+    if (part_tag_name.empty())
+      part_tag_name = PARALLEL_PARTITION_TAG_NAME;
+    rval = iFace->tag_get_handle(part_tag_name.c_str(), 1, MB_TYPE_INTEGER, partIndexTag);
+    if (MB_TAG_NOT_FOUND == rval)
+      partIndexTag = 0; // Nothing to index
+    else if (MB_SUCCESS != rval) {
+      MB_SET_ERR(rval, "Invalid tag for PARTITION_INDEX option: \"" << part_tag_name << "\"");
+    }
+  }
+
   // Allocate internal buffer to use when gathering data to write.
   dataBuffer = (char*)malloc(bufferSize);
   if (!dataBuffer)
@@ -544,10 +596,25 @@ ErrorCode WriteHDF5::write_file(const char* filename,
   free(dataBuffer);
   dataBuffer = 0;
 
+  // Copy in-memory file before closing it
+  if (filePtr && fileImage && MB_SUCCESS == result) {
+    size_t size = mhdf_getFileImage(filePtr, 0, 0, &status);
+    if (!mhdf_isError(&status)) {
+      fileImage->resize(size);
+      if (size)
+        mhdf_getFileImage(filePtr, &(*fileImage)[0], size, &status);
+    }
+    if (mhdf_isError(&status)) {
+      MB_SET_ERR_CONT(mhdf_message(&status));
+      fileImage->clear();
+      result = MB_FAILURE;
+    }
+  }
+
   // Close file
   bool created_file = false;
   if (filePtr) {
-    created_file = true;
+    created_file = !fileImage;
     mhdf_closeFile(filePtr, &status);
     filePtr = 0;
     if (mhdf_isError(&status)) {
@@ -643,6 +710,9 @@ ErrorCode WriteHDF5::write_file_impl(const char* filename,
   const char* optnames[] = {"WRITE_PART", "FORMAT", 0};
   int junk;
   parallelWrite = (MB_SUCCESS == opts.match_option("PARALLEL", optnames, junk));
+  if (parallelWrite && fileImage) {
+    MB_SET_ERR(MB_NOT_IMPLEMENTED, "Cannot write parallel file to memory");
+  }
   if (parallelWrite) {
     // Just store Boolean value based on string option here.
     // parallel_create_file will set writeProp accordingly.
@@ -692,6 +762,14 @@ ErrorCode WriteHDF5::write_file_impl(const char* filename,
     return error(result);
   debug_barrier();
 
+  if (writePartIndex) {
+    topState.start("writing partition index");
+    result = write_partition_index();
+    topState.end(result);
+    if (MB_SUCCESS != result)
+      return error(result);
+  }
+
   times[SET_TIME] = timer.time_elapsed();
   dbgOut.tprint(1, "Writing adjacencies.\n");
 
@@ -2285,6 +2363,131 @@ ErrorCode WriteHDF5::write_tag_values(Tag tag_id,
   return MB_SUCCESS;
 }
 
+ErrorCode WriteHDF5::gather_partition_index()
+{
+  ErrorCode rval;
+
+  partIndexData.clear();
+  partRangeData.clear();
+  if (!partIndexTag)
+    return MB_SUCCESS;
+
+  Range parts;
+  rval = iFace->get_entities_by_type_and_tag(0, MBENTITYSET, &partIndexTag, 0, 1, parts);CHK_MB_ERR_0(rval);
+  parts = intersect(parts, setSet.range);
+
+  for (Range::iterator p = parts.begin(); p != parts.end(); ++p) {
+    // Get contained and child sets recursively, and the
+    // non-set contents of all of them (as ReadHDF5 would
+    // with the default CHILDREN=CONTENTS and SETS=CONTENTS).
+    Range sets, ents;
+    std::vector<EntityHandle> stack(1, *p);
+    while (!stack.empty()) {
+      EntityHandle set = stack.back();
+      stack.pop_back();
+      Range contents;
+      rval = iFace->get_entities_by_handle(set, contents);CHK_MB_ERR_0(rval);
+      std::vector<EntityHandle> children;
+      rval = iFace->get_child_meshsets(set, children);CHK_MB_ERR_0(rval);
+      Range new_sets = contents.subset_by_type(MBENTITYSET);
+      contents -= new_sets;
+      ents.merge(contents);
+      std::copy(children.begin(), children.end(), range_inserter(new_sets));
+      new_sets = subtract(new_sets, sets);
+      new_sets.erase(*p);
+      sets.merge(new_sets);
+      stack.insert(stack.end(), new_sets.begin(), new_sets.end());
+    }
+
+    // Get nodes of elements, and faces and nodes of polyhedra
+    Range elems = subtract(ents, ents.subset_by_type(MBVERTEX));
+    Range adj;
+    rval = iFace->get_connectivity(elems, adj);CHK_MB_ERR_0(rval);
+    ents.merge(adj);
+    Range faces = subtract(adj, adj.subset_by_type(MBVERTEX));
+    if (!faces.empty()) {
+      adj.clear();
+      rval = iFace->get_connectivity(faces, adj);CHK_MB_ERR_0(rval);
+      ents.merge(adj);
+    }
+    ents.merge(sets);
+
+    // Convert to ranges of file IDs, skipping entities not written
+    Range ids;
+    RangeMap<EntityHandle, wid_t>::iterator ri = idMap.begin();
+    for (Range::const_pair_iterator pi = ents.const_pair_begin();
+         pi != ents.const_pair_end(); ++pi) {
+      EntityHandle h = pi->first;
+      while (h <= pi->second) {
+        ri = idMap.lower_bound(ri, idMap.end(), h);
+        if (ri == idMap.end() || ri->begin > pi->second)
+          break;
+        if (ri->begin > h)
+          h = ri->begin;
+        EntityHandle last = std::min(pi->second, ri->begin + ri->count - 1);
+        EntityHandle id = ri->value + (h - ri->begin);
+        ids.insert(id, id + (last - h));
+        h = last + 1;
+      }
+    }
+    for (Range::const_pair_iterator pi = ids.const_pair_begin();
+         pi != ids.const_pair_end(); ++pi) {
+      partRangeData.push_back(pi->first);
+      partRangeData.push_back(pi->second - pi->first + 1);
+    }
+
+    partIndexData.push_back(idMap.find(*p));
+    partIndexData.push_back(partRangeData.size() / 2);
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteHDF5::create_partition_index(long num_parts, long num_ranges)
+{
+  mhdf_Status status;
+  hid_t handle;
+
+  handle = mhdf_createPartIndex(filePtr, num_parts, &status);CHK_MHDF_ERR_0(status);
+  mhdf_closeData(filePtr, handle, &status);CHK_MHDF_ERR_0(status);
+  handle = mhdf_createPartRanges(filePtr, num_ranges, &status);CHK_MHDF_ERR_0(status);
+  mhdf_closeData(filePtr, handle, &status);CHK_MHDF_ERR_0(status);
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteHDF5::write_partition_index()
+{
+  mhdf_Status status;
+  hid_t table;
+  long num_parts, num_ranges;
+
+  // End of ranges for each set is relative to the ranges
+  // written by this processor
+  std::vector<wid_t> index(partIndexData);
+  for (size_t i = 1; i < index.size(); i += 2)
+    index[i] += partRangeOffset;
+
+  table = mhdf_openPartIndex(filePtr, &num_parts, &status);CHK_MHDF_ERR_0(status);
+  IODebugTrack track(debugTrack, "PartIndex", num_parts);
+  track.record_io(partIndexOffset, index.size() / 2);
+  mhdf_writePartIndexWithOpt(table, partIndexOffset, index.size() / 2, id_type,
+                             index.empty() ? 0 : &index[0], writeProp, &status);
+  CHK_MHDF_ERR_1(status, table);
+  mhdf_closeData(filePtr, table, &status);CHK_MHDF_ERR_0(status);
+
+  table = mhdf_openPartRanges(filePtr, &num_ranges, &status);CHK_MHDF_ERR_0(status);
+  IODebugTrack track2(debugTrack, "PartRanges", num_ranges);
+  track2.record_io(partRangeOffset, partRangeData.size() / 2);
+  mhdf_writePartIndexWithOpt(table, partRangeOffset, partRangeData.size() / 2, id_type,
+                             partRangeData.empty() ? 0 : &partRangeData[0],
+                             writeProp, &status);
+  CHK_MHDF_ERR_1(status, table);
+  mhdf_closeData(filePtr, table, &status);CHK_MHDF_ERR_0(status);
+
+  return MB_SUCCESS;
+}
+
 ErrorCode WriteHDF5::write_qa(const std::vector<std::string>& list)
 {
   const char* app = "MOAB";
@@ -2446,10 +2649,22 @@ ErrorCode WriteHDF5::serial_create_file(const char* filename,
   for (EntityType i = MBEDGE; i < MBENTITYSET; ++i)
     type_names[i] = CN::EntityTypeName(i);
 
-  // Create the file
-  filePtr = mhdf_createFile(filename, overwrite, type_names, MBMAXTYPE, id_type, &status);CHK_MHDF_ERR_0(status);
+  // Create the file, in memory using the core driver
+  // (without a backing store) if writing a file image
+  hid_t access_prop = H5P_DEFAULT;
+  if (fileImage) {
+    access_prop = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_core(access_prop, bufferSize, 0);
+    overwrite = true;
+  }
+  filePtr = mhdf_createFileWithOpt(filename, overwrite, type_names, MBMAXTYPE, id_type, access_prop, &status);
+  if (H5P_DEFAULT != access_prop)
+    H5Pclose(access_prop);
+  CHK_MHDF_ERR_0(status);
   assert(!!filePtr);
 
+  mhdf_setDataLayout(filePtr, chunkSize, deflateLevel, shuffleData, &status);CHK_MHDF_ERR_0(status);
+
   rval = write_qa(qa_records);CHK_MB_ERR_0(rval);
 
   // Create node table
@@ -2505,6 +2720,17 @@ ErrorCode WriteHDF5::serial_create_file(const char* filename,
     maxNumSetParents = parents_len;
   } // if (!setSet.range.empty())
 
+  // Create partition index tables after all entities have IDs
+  if (writePartIndex) {
+    rval = gather_partition_index();CHK_MB_ERR_0(rval);
+    partIndexOffset = partRangeOffset = 0;
+    writePartIndex = !partRangeData.empty();
+    if (writePartIndex) {
+      rval = create_partition_index(partIndexData.size() / 2,
+                                    partRangeData.size() / 2);CHK_MB_ERR_0(rval);
+    }
+  }
+
   // Create adjacency table after set table, because sets do not have yet an id
   // some entities are adjacent to sets (exodus?)
   // Create node adjacency table
@@ -70,6 +70,15 @@ public:
                           int num_tags = 0,
                           int user_dimension = 3 );
 
+  /** Write the file to an in-memory HDF5 file image rather than to disk
+   *
+   * If non-null, the next call to write_file creates the file in memory
+   * and, if successful, passes back its contents in \c image rather than
+   * creating the named file.  Not supported for parallel writes.
+   */
+  void set_file_image( std::vector<char>* image )
+    { fileImage = image; }
+
   /** The type to use for entity IDs w/in the file.
    * 
    * NOTE:  If this is changed, the value of id_type 
@@ -274,6 +283,23 @@ protected:
                                long children_length,
                                long parents_length );
 
+  /** Helper function for create-file
+   *
+   * For each set tagged with partIndexTag, get the file IDs of
+   * all entities that must be read to read the set and store
+   * them in partIndexData and partRangeData.
+   */
+  ErrorCode gather_partition_index();
+
+  /** Helper function for create-file
+   *
+   * Create zero-ed partition index tables.
+   */
+  ErrorCode create_partition_index( long num_parts, long num_ranges );
+
+  //! Write partition index
+  ErrorCode write_partition_index();
+
   //! Write exodus-type QA info
   ErrorCode write_qa( const std::vector<std::string>& list );
 
@@ -366,6 +392,26 @@ protected:
   bool collectiveIO;
   //! True if writing dense-formatted tag data
   bool writeTagDense;
+  //! Approximate size of chunks for bulk data tables, or zero for contiguous
+  long chunkSize;
+  //! Deflate level for chunked bulk data tables, or zero for none
+  int deflateLevel;
+  //! True if applying shuffle filter to chunked bulk data tables
+  bool shuffleData;
+  //! If non-null, write file in memory and pass back image here
+  std::vector<char>* fileImage;
+  //! True if writing a partition index (see PARTITION_INDEX option).
+  //! Cleared during file creation if there is nothing to index.
+  bool writePartIndex;
+  //! Tag identifying sets to write in partition index, or zero
+  Tag partIndexTag;
+  //! Partition index rows for this processor: {set id, end} pairs,
+  //! where end is one past the last of the set's rows in partRangeData
+  std::vector<wid_t> partIndexData;
+  //! Partition index {start id, count} ranges for this processor
+  std::vector<wid_t> partRangeData;
+  //! Offset into partition index tables (zero except for parallel)
+  long partIndexOffset, partRangeOffset;
   
   //! Property set to pass to H5Dwrite calls. 
   //! For serial, should be H5P_DEFAULTS.
@@ -27,12 +27,16 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include <vector>
 #include <set>
 #include <map>
 #include <iterator>
+#include <algorithm>
 
 #include "moab/Interface.hpp"
 #include "moab/Range.hpp"
@@ -43,6 +47,15 @@
 #include "moab/FileOptions.hpp"
 #include "moab/Version.h"
 
+#ifdef MOAB_HAVE_MPI
+#include "moab/ParallelComm.hpp"
+#include "MBParallelConventions.h"
+#endif
+
+#ifdef MOAB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #define INS_ID(stringvar, prefix, id) \
   sprintf(stringvar, prefix, id)
 
@@ -51,13 +64,293 @@ namespace moab {
 const int DEFAULT_PRECISION = 10;
 const bool DEFAULT_STRICT = true;
 
+// Number of entities processed at once when writing binary data
+const int BLOCK_SIZE = 16384;
+
+// Uncompressed size of the blocks in which VTK XML data arrays are
+// compressed (the vtkZLibDataCompressor default)
+const size_t ZLIB_BLOCK_SIZE = 32768;
+
+// Contents of binary arrays written by WriteVtk::write_cells
+// and WriteVtk::write_vtu_values
+enum {
+  LEGACY_CELLS,     // Legacy cell list: vertex count followed by vertex indices
+  LEGACY_TYPES,     // Legacy cell types, as 32-bit integers
+  VTU_CONNECTIVITY, // VTK XML cell connectivity
+  VTU_OFFSETS,      // VTK XML offsets of the end of each cell in the connectivity
+  VTU_TYPES,        // VTK XML cell types, as bytes
+  VTU_COORDS,       // Point coordinates
+  VTU_POINT_DATA,   // Tag values on vertices
+  VTU_CELL_DATA     // Tag values on elements
+};
+
+static inline bool native_big_endian()
+{
+  const unsigned one = 1;
+  return !*reinterpret_cast<const char*>(&one);
+}
+
+// Destination for binary data written to a VTK file
+class VtkDataSink
+{
+public:
+  virtual ~VtkDataSink() {}
+
+  // Write count values of size bytes each
+  virtual void write(const void* data, size_t size, size_t count) = 0;
+};
+
+// Write binary data directly to a stream, optionally swapping the
+// byte order of each value.
+class RawSink : public VtkDataSink
+{
+public:
+  RawSink(std::ostream& str, bool swap) : stream(str), swapBytes(swap) {}
+
+  void write(const void* data, size_t size, size_t count)
+  {
+    const char* bytes = static_cast<const char*>(data);
+    if (!swapBytes || size == 1) {
+      stream.write(bytes, size * count);
+      return;
+    }
+
+    buffer.assign(bytes, bytes + size * count);
+    switch (size) {
+      case 2: SysUtil::byteswap2(&buffer[0], count); break;
+      case 4: SysUtil::byteswap4(&buffer[0], count); break;
+      case 8: SysUtil::byteswap8(&buffer[0], count); break;
+      default: SysUtil::byteswap(&buffer[0], size, count); break;
+    }
+    stream.write(&buffer[0], buffer.size());
+  }
+
+private:
+  std::ostream& stream;
+  bool swapBytes;
+  std::vector<char> buffer;
+};
+
+// Base64-encode binary data written to a stream.  Bytes are encoded
+// in groups of three, so an incomplete group is held back until more
+// data is written or the encoded block is ended with finish().
+class Base64Sink : public VtkDataSink
+{
+public:
+  Base64Sink(std::ostream& str) : stream(str), numPending(0) {}
+
+  void write(const void* data, size_t size, size_t count)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    size_t n = size * count;
+    text.clear();
+    if (numPending) {
+      for ( ; numPending < 3 && n; --n)
+        pending[numPending++] = *bytes++;
+      if (numPending < 3)
+        return;
+      encode(pending, 3);
+      numPending = 0;
+    }
+    for ( ; n >= 3; n -= 3, bytes += 3)
+      encode(bytes, 3);
+    for ( ; n; --n)
+      pending[numPending++] = *bytes++;
+    stream.write(text.data(), text.size());
+  }
+
+  // Encode any remaining bytes, padding the last group
+  void finish()
+  {
+    text.clear();
+    if (numPending)
+      encode(pending, numPending);
+    numPending = 0;
+    stream.write(text.data(), text.size());
+  }
+
+private:
+  void encode(const unsigned char* bytes, int n)
+  {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const unsigned long v = ((unsigned long)bytes[0] << 16) |
+                            (n > 1 ? (unsigned long)bytes[1] << 8 : 0) |
+                            (n > 2 ? (unsigned long)bytes[2] : 0);
+    text += chars[(v >> 18) & 63];
+    text += chars[(v >> 12) & 63];
+    text += n > 1 ? chars[(v >> 6) & 63] : '=';
+    text += n > 2 ? chars[v & 63] : '=';
+  }
+
+  std::ostream& stream;
+  std::string text;
+  unsigned char pending[3];
+  int numPending;
+};
+
+#ifdef MOAB_HAVE_ZLIB
+// Compress binary data in fixed-size blocks, as expected by VTK's
+// vtkZLibDataCompressor.  The compressed blocks are kept in memory
+// because the VTK compression header, which lists the size of every
+// compressed block, must be written before the blocks.
+class ZlibSink : public VtkDataSink
+{
+public:
+  ZlibSink(int compression_level) : level(compression_level), numBytes(0), failed(false) {}
+
+  void write(const void* data, size_t size, size_t count)
+  {
+    const char* bytes = static_cast<const char*>(data);
+    size_t n = size * count;
+    numBytes += n;
+    while (n) {
+      const size_t k = std::min(n, ZLIB_BLOCK_SIZE - block.size());
+      block.insert(block.end(), bytes, bytes + k);
+      bytes += k;
+      n -= k;
+      if (block.size() == ZLIB_BLOCK_SIZE)
+        compress_block();
+    }
+  }
+
+  // Compress any partial last block and get the compression header:
+  // the number of blocks, the block size, the size of the last block
+  // if it is partial (or zero) and the compressed size of each block.
+  bool finish(std::vector<uint64_t>& header)
+  {
+    if (!block.empty())
+      compress_block();
+    header.clear();
+    header.push_back(blockSizes.size());
+    header.push_back(ZLIB_BLOCK_SIZE);
+    header.push_back(numBytes % ZLIB_BLOCK_SIZE);
+    header.insert(header.end(), blockSizes.begin(), blockSizes.end());
+    return !failed;
+  }
+
+  std::string compressed; // Compressed blocks
+
+private:
+  void compress_block()
+  {
+    const size_t start = compressed.size();
+    uLongf len = compressBound(block.size());
+    compressed.resize(start + len);
+    if (Z_OK != compress2(reinterpret_cast<Bytef*>(&compressed[start]), &len,
+                          reinterpret_cast<const Bytef*>(&block[0]), block.size(), level))
+      failed = true;
+    compressed.resize(start + len);
+    blockSizes.push_back(len);
+    block.clear();
+  }
+
+  int level;
+  uint64_t numBytes;
+  bool failed;
+  std::vector<char> block;
+  std::vector<uint64_t> blockSizes;
+};
+#endif
+
+// Map from vertex handle to the index of the vertex in the output file
+class VertexIndex
+{
+public:
+  VertexIndex(const Range& nodes)
+  {
+    long offset = 0;
+    for (Range::const_pair_iterator p = nodes.const_pair_begin(); p != nodes.const_pair_end(); ++p) {
+      starts.push_back(p->first);
+      offsets.push_back(offset);
+      offset += p->second - p->first + 1;
+    }
+  }
+
+  long operator()(EntityHandle vertex) const
+  {
+    const size_t i = std::upper_bound(starts.begin(), starts.end(), vertex) - starts.begin() - 1;
+    return offsets[i] + (long)(vertex - starts[i]);
+  }
+
+private:
+  std::vector<EntityHandle> starts;
+  std::vector<long> offsets;
+};
+
+// Get the VTK type for elements of the passed type and number of
+// vertices.  If there is none, try ignoring the last vertex.
+static ErrorCode get_vtk_type(EntityType type, int conn_len,
+                              const VtkElemType*& vtk_type, int& vtk_len)
+{
+  vtk_len = conn_len;
+  vtk_type = VtkUtil::get_vtk_type(type, conn_len);
+  if (!vtk_type) {
+    // Try connectivity with 1 fewer node
+    vtk_type = VtkUtil::get_vtk_type(type, conn_len - 1);
+    if (vtk_type)
+      vtk_len--;
+    else {
+      MB_SET_ERR(MB_FAILURE, "Vtk file format does not support elements of type " << CN::EntityTypeName(type) << " (" << (int)type << ") with " << conn_len << " nodes");
+    }
+  }
+  return MB_SUCCESS;
+}
+
+// Append the connectivity of a block of elements to a list, as vertex
+// indices in VTK order, optionally preceding each element with its
+// number of vertices.
+template <typename T>
+static void append_connectivity(std::vector<T>& list, const EntityHandle* conn,
+                                int conn_len, int count, const VtkElemType* vtk_type,
+                                int vtk_len, bool with_len, const VertexIndex& index)
+{
+  for (int e = 0; e < count; ++e, conn += conn_len) {
+    if (with_len)
+      list.push_back(vtk_len);
+    if (vtk_type->node_order)
+      for (int k = 0; k < vtk_len; ++k)
+        list.push_back(index(conn[vtk_type->node_order[k]]));
+    else
+      for (int k = 0; k < vtk_len; ++k)
+        list.push_back(index(conn[k]));
+  }
+}
+
+// Description of a data array in a VTK XML file
+struct WriteVtk::VtuArray
+{
+  const char* section; // Enclosing element: PointData, CellData, Points or Cells
+  std::string name;
+  const char* type;    // VTK XML data type name
+  int numComp;
+  size_t valueSize;
+  size_t numValues;    // Total number of values
+  int content;         // What to write (see enum above)
+  Tag tag;
+  Range tagged;        // Entities for which the tag is set
+
+  // Compressed data, for compressed arrays that must be prepared before
+  // writing the XML header
+  std::vector<uint64_t> header;
+  std::string data;
+
+  // Size in bytes of the array data, including the leading header
+  uint64_t block_size(bool compressed) const
+  {
+    if (compressed)
+      return header.size() * sizeof(uint64_t) + data.size();
+    return sizeof(uint64_t) + numValues * valueSize;
+  }
+};
+
 WriterIface *WriteVtk::factory(Interface* iface)
 {
   return new WriteVtk(iface);
 }
 
 WriteVtk::WriteVtk(Interface* impl)
-  : mbImpl(impl), writeTool(0), mStrict(DEFAULT_STRICT), freeNodes(0), createOneNodeCells(false)
+  : mbImpl(impl), writeTool(0), mStrict(DEFAULT_STRICT), freeNodes(0), createOneNodeCells(false),
+    mBinary(false), mBase64(false), mCompress(0)
 {
   assert(impl != NULL);
   impl->query_interface(writeTool);
@@ -95,12 +388,37 @@ ErrorCode WriteVtk::write_file(const char *file_name,
   if (MB_SUCCESS == opts.get_null_option("CREATE_ONE_NODE_CELLS"))
     createOneNodeCells = true;
 
+  // Binary legacy file, or inline base64 data in VTK XML files
+  mBinary = (MB_SUCCESS == opts.get_null_option("BINARY"));
+  mBase64 = (MB_SUCCESS == opts.get_null_option("BASE64"));
+
+  // Compression of VTK XML data arrays, with an optional zlib level
+  mCompress = 0;
+  rval = opts.get_int_option("COMPRESS", -1, mCompress);
+  if (MB_TYPE_OUT_OF_RANGE == rval) {
+    MB_SET_ERR(rval, "Invalid value for COMPRESS option");
+  }
+#ifndef MOAB_HAVE_ZLIB
+  if (mCompress) {
+    MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Cannot compress VTK data: MOAB was built without zlib");
+  }
+#endif
+
   // Get entities to write
   Range nodes, elems;
   rval = gather_mesh(output_list, num_sets, nodes, elems);
   if (MB_SUCCESS != rval)
     return rval;
 
+  // The file name extension selects the VTK XML formats
+  std::string ext;
+  const char* dot = strrchr(file_name, '.');
+  if (dot)
+    for (++dot; *dot; ++dot)
+      ext += tolower(*dot);
+  if (ext == "pvtu")
+    return write_pvtu(file_name, overwrite, opts, nodes, elems, tag_list, num_tags);
+
   // Honor overwrite flag
   if (!overwrite) {
     rval = writeTool->check_doesnt_exist(file_name);
@@ -108,8 +426,15 @@ ErrorCode WriteVtk::write_file(const char *file_name,
       return rval;
   }
 
+  if (ext == "vtu") {
+    rval = write_vtu(file_name, nodes, elems, tag_list, num_tags);
+    if (MB_SUCCESS != rval)
+      remove(file_name);
+    return rval;
+  }
+
   // Create file
-  std::ofstream file(file_name);
+  std::ofstream file(file_name, mBinary ? std::ios::out | std::ios::binary : std::ios::out);
   if (!file) {
     MB_SET_ERR(MB_FILE_WRITE_ERROR, "Could not open file: " << file_name);
   }
@@ -214,7 +539,7 @@ ErrorCode WriteVtk::write_header(std::ostream& stream)
 {
   stream << "# vtk DataFile Version 3.0" << std::endl;
   stream << MOAB_VERSION_STRING << std::endl;
-  stream << "ASCII" << std::endl;
+  stream << (mBinary ? "BINARY" : "ASCII") << std::endl;
   stream << "DATASET UNSTRUCTURED_GRID" << std::endl;
   return MB_SUCCESS;
 }
@@ -225,6 +550,14 @@ ErrorCode WriteVtk::write_nodes(std::ostream& stream, const Range& nodes)
 
   stream << "POINTS " << nodes.size() << " double" << std::endl;
 
+  // Binary legacy data is big-endian
+  if (mBinary) {
+    RawSink sink(stream, !native_big_endian());
+    rval = write_coords(sink, nodes);MB_CHK_ERR(rval);
+    stream << std::endl;
+    return MB_SUCCESS;
+  }
+
   double coords[3];
   for (Range::const_iterator i = nodes.begin(); i != nodes.end(); ++i) {
     coords[1] = coords[2] = 0.0;
@@ -237,12 +570,16 @@ ErrorCode WriteVtk::write_nodes(std::ostream& stream, const Range& nodes)
   return MB_SUCCESS;
 }
 
-ErrorCode WriteVtk::write_elems(std::ostream& stream,
-                                const Range& nodes,
-                                const Range& elems)
+ErrorCode WriteVtk::get_free_nodes(const Range& nodes,
+                                   const Range& elems,
+                                   Range& free_nodes)
 {
   ErrorCode rval;
 
+  free_nodes.clear();
+  freeNodes = 0;
+  if (!createOneNodeCells)
+    return MB_SUCCESS; // do not create one node cells
 
   Range connectivity; // because we now support polyhedra, it could contain faces
   rval = mbImpl->get_connectivity(elems, connectivity); MB_CHK_ERR(rval);
@@ -254,7 +591,188 @@ ErrorCode WriteVtk::write_elems(std::ostream& stream,
   rval = mbImpl->get_connectivity(faces_from_connectivity, connected_nodes); MB_CHK_ERR(rval);
   connected_nodes.merge(nodes_from_connectivity);
 
-  Range free_nodes = subtract(nodes, connected_nodes);
+  free_nodes = subtract(nodes, connected_nodes);
+  freeNodes = (int)free_nodes.size();
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::get_elem_block(Range::const_iterator iter,
+                                   Range::const_iterator end,
+                                   const EntityHandle*& conn,
+                                   int& conn_len,
+                                   int& count,
+                                   std::vector<EntityHandle>& storage)
+{
+  ErrorCode rval;
+
+  // If the connectivity of the first element is not returned in the
+  // storage vector, it is stored explicitly and can be accessed directly.
+  storage.clear();
+  rval = mbImpl->get_connectivity(*iter, conn, conn_len, false, &storage);MB_CHK_ERR(rval);
+  if (storage.empty()) {
+    EntityHandle* conn_ptr;
+    rval = mbImpl->connect_iterate(iter, end, conn_ptr, conn_len, count);MB_CHK_ERR(rval);
+    conn = conn_ptr;
+    count = std::min(count, BLOCK_SIZE);
+    return MB_SUCCESS;
+  }
+
+  // Otherwise (e.g. structured mesh) copy the connectivity of the
+  // contiguous block of elements beginning with the first one.
+  std::vector<EntityHandle> handles(1, *iter);
+  for (Range::const_iterator i = iter + 1; i != end && handles.size() < (size_t)BLOCK_SIZE; ++i) {
+    if (*i != handles.back() + 1)
+      break;
+    handles.push_back(*i);
+  }
+  std::vector<int> offsets;
+  rval = mbImpl->get_connectivity(&handles[0], handles.size(), storage, false, &offsets);MB_CHK_ERR(rval);
+  count = handles.size();
+  conn = &storage[0];
+  conn_len = offsets[1];
+  // Fall back to a single element if the number of vertices varies
+  for (int i = 2; i <= count; ++i)
+    if (offsets[i] != i * conn_len)
+      count = 1;
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::write_coords(VtkDataSink& sink, const Range& nodes)
+{
+  std::vector<double> xyz;
+  int count;
+  for (Range::const_iterator i = nodes.begin(); i != nodes.end(); i += count) {
+    double *x, *y, *z;
+    ErrorCode rval = mbImpl->coords_iterate(i, nodes.end(), x, y, z, count);MB_CHK_ERR(rval);
+    count = std::min(count, BLOCK_SIZE);
+
+    // Interleave coordinates
+    xyz.resize(3 * count);
+    for (int j = 0; j < count; ++j) {
+      xyz[3*j    ] = x[j];
+      xyz[3*j + 1] = y[j];
+      xyz[3*j + 2] = z[j];
+    }
+    sink.write(&xyz[0], sizeof(double), xyz.size());
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::write_cells(VtkDataSink& sink,
+                                int what,
+                                const Range& nodes,
+                                const Range& elems,
+                                const Range& free_nodes)
+{
+  ErrorCode rval;
+  const VertexIndex index(nodes);
+  std::vector<EntityHandle> storage;
+  std::vector<int> ints; // Legacy cell list and types
+  std::vector<int64_t> ids; // VTK XML connectivity and offsets
+  std::vector<unsigned char> types; // VTK XML types
+  int64_t offset = 0;
+
+  int count;
+  for (Range::const_iterator i = elems.begin(); i != elems.end(); i += count) {
+    const EntityHandle* conn;
+    int conn_len;
+    rval = get_elem_block(i, elems.end(), conn, conn_len, count, storage);MB_CHK_ERR(rval);
+
+    const EntityType type = TYPE_FROM_HANDLE(*i);
+    const VtkElemType* vtk_type;
+    int vtk_len;
+    rval = get_vtk_type(type, conn_len, vtk_type, vtk_len);MB_CHK_ERR(rval);
+
+    ints.clear();
+    ids.clear();
+    switch (what) {
+      case LEGACY_TYPES:
+        ints.resize(count, vtk_type->vtk_type);
+        sink.write(&ints[0], sizeof(int), count);
+        break;
+      case VTU_TYPES:
+        types.assign(count, vtk_type->vtk_type);
+        sink.write(&types[0], 1, count);
+        break;
+      case VTU_OFFSETS:
+        for (int j = 0; j < count; ++j)
+          ids.push_back(offset += vtk_len);
+        sink.write(&ids[0], sizeof(int64_t), count);
+        break;
+      case VTU_CONNECTIVITY:
+        append_connectivity(ids, conn, conn_len, count, vtk_type, vtk_len, false, index);
+        sink.write(&ids[0], sizeof(int64_t), ids.size());
+        break;
+      case LEGACY_CELLS:
+        if (type != MBPOLYHEDRON)
+          append_connectivity(ints, conn, conn_len, count, vtk_type, vtk_len, true, index);
+        else for (int e = 0; e < count; ++e, conn += conn_len) {
+          // POLYHEDRON: total number of fields, number of faces, and
+          // for each face its number of vertices and the vertices
+          const size_t start = ints.size();
+          ints.push_back(0);
+          ints.push_back(conn_len);
+          for (int k = 0; k < conn_len; ++k) {
+            const EntityHandle* face_conn;
+            int num_nodes;
+            rval = mbImpl->get_connectivity(conn[k], face_conn, num_nodes);MB_CHK_ERR(rval);
+            ints.push_back(num_nodes);
+            for (int j = 0; j < num_nodes; ++j)
+              ints.push_back(index(face_conn[j]));
+          }
+          ints[start] = ints.size() - start - 1;
+        }
+        sink.write(&ints[0], sizeof(int), ints.size());
+        break;
+      default:
+        return MB_FAILURE;
+    }
+  }
+
+  // One-node cells for free nodes
+  if (free_nodes.empty())
+    return MB_SUCCESS;
+  ints.clear();
+  ids.clear();
+  for (Range::const_iterator v = free_nodes.begin(); v != free_nodes.end(); ++v) {
+    switch (what) {
+      case LEGACY_CELLS:
+        ints.push_back(1);
+        ints.push_back(index(*v));
+        break;
+      case LEGACY_TYPES:
+        ints.push_back(1);
+        break;
+      case VTU_CONNECTIVITY:
+        ids.push_back(index(*v));
+        break;
+      case VTU_OFFSETS:
+        ids.push_back(++offset);
+        break;
+    }
+  }
+  if (VTU_TYPES == what) {
+    types.assign(free_nodes.size(), 1);
+    sink.write(&types[0], 1, types.size());
+  }
+  else if (!ints.empty())
+    sink.write(&ints[0], sizeof(int), ints.size());
+  else
+    sink.write(&ids[0], sizeof(int64_t), ids.size());
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::write_elems(std::ostream& stream,
+                                const Range& nodes,
+                                const Range& elems)
+{
+  ErrorCode rval;
+
+  Range free_nodes;
+  rval = get_free_nodes(nodes, elems, free_nodes);MB_CHK_ERR(rval);
 
   // Get and write counts
   unsigned long num_elems, num_uses;
@@ -262,38 +780,48 @@ ErrorCode WriteVtk::write_elems(std::ostream& stream,
 
   std::map<EntityHandle, int> sizeFieldsPolyhedra;
 
-  for (Range::const_iterator i = elems.begin(); i != elems.end(); ++i) {
-    EntityType type = mbImpl->type_from_handle(*i);
-    if (!VtkUtil::get_vtk_type(type, CN::VerticesPerEntity(type)))
-      continue;
-
+  std::vector<EntityHandle> storage;
+  int count;
+  for (Range::const_iterator i = elems.begin(); i != elems.end(); i += count) {
+    const EntityHandle* connect;
+    int conn_len;
+    rval = get_elem_block(i, elems.end(), connect, conn_len, count, storage);MB_CHK_ERR(rval);
 
-    EntityHandle elem=*i;
-    const EntityHandle * connect=NULL;
-    int conn_len=0;
-    rval = mbImpl->get_connectivity(elem, connect, conn_len);MB_CHK_ERR(rval);
+    const VtkElemType* vtk_type;
+    int vtk_len;
+    rval = get_vtk_type(TYPE_FROM_HANDLE(*i), conn_len, vtk_type, vtk_len);MB_CHK_ERR(rval);
+    num_uses += (unsigned long)count * vtk_len;
 
-    num_uses += conn_len;
     // if polyhedra, we will count the number of nodes in each face too
-    if ( TYPE_FROM_HANDLE(elem) == MBPOLYHEDRON)
+    if (TYPE_FROM_HANDLE(*i) == MBPOLYHEDRON)
     {
-      int numFields = 1; // there will be one for number of faces; forgot about this one
-      for (int j=0; j<conn_len; j++)
-      {
-        const EntityHandle * conn = NULL;
-        int num_nd=0;
-        rval = mbImpl->get_connectivity(connect[j], conn, num_nd);MB_CHK_ERR(rval);
-        numFields += num_nd +1;
+      Range::const_iterator elem = i;
+      for (int e = 0; e < count; ++e, ++elem, connect += conn_len) {
+        int numFields = 1; // there will be one for number of faces; forgot about this one
+        for (int j=0; j<conn_len; j++)
+        {
+          const EntityHandle * conn = NULL;
+          int num_nd=0;
+          rval = mbImpl->get_connectivity(connect[j], conn, num_nd);MB_CHK_ERR(rval);
+          numFields += num_nd +1;
+        }
+        sizeFieldsPolyhedra[*elem] = numFields; // will be used later, at writing
+        num_uses +=  (numFields-conn_len);
       }
-      sizeFieldsPolyhedra[elem] = numFields; // will be used later, at writing
-      num_uses +=  (numFields-conn_len);
     }
   }
-  freeNodes = (int)free_nodes.size();
-  if (!createOneNodeCells)
-    freeNodes=0; // do not create one node cells
   stream << "CELLS " << num_elems + freeNodes<< ' ' << num_uses + 2*freeNodes << std::endl;
 
+  // Binary cell list and types are written directly from the connectivity
+  if (mBinary) {
+    RawSink sink(stream, !native_big_endian());
+    rval = write_cells(sink, LEGACY_CELLS, nodes, elems, free_nodes);MB_CHK_ERR(rval);
+    stream << std::endl << "CELL_TYPES " << num_elems + freeNodes << std::endl;
+    rval = write_cells(sink, LEGACY_TYPES, nodes, elems, free_nodes);MB_CHK_ERR(rval);
+    stream << std::endl;
+    return MB_SUCCESS;
+  }
+
   // Write element connectivity
   std::vector<int> conn_data;
   std::vector<unsigned> vtk_types(elems.size() + freeNodes );
@@ -306,19 +834,11 @@ ErrorCode WriteVtk::write_elems(std::ostream& stream,
     // Get element connectivity
     const EntityHandle *  connect = NULL;
     int conn_len = 0;
-    rval = mbImpl->get_connectivity(elem, connect, conn_len); MB_CHK_ERR(rval);
+    rval = mbImpl->get_connectivity(elem, connect, conn_len, false, &storage); MB_CHK_ERR(rval);
 
     // Get VTK type
-    const VtkElemType* vtk_type = VtkUtil::get_vtk_type(type, conn_len);
-    if (!vtk_type) {
-      // Try connectivity with 1 fewer node
-      vtk_type = VtkUtil::get_vtk_type(type, conn_len - 1);
-      if (vtk_type)
-        conn_len--;
-      else {
-        MB_SET_ERR(MB_FAILURE, "Vtk file format does not support elements of type " << CN::EntityTypeName(type) << " (" << (int)type << ") with " << conn_len << " nodes");
-      }
-    }
+    const VtkElemType* vtk_type;
+    rval = get_vtk_type(type, conn_len, vtk_type, conn_len);MB_CHK_ERR(rval);
 
     // Save VTK type index for later
     *t = vtk_type->vtk_type;
@@ -383,11 +903,12 @@ ErrorCode WriteVtk::write_elems(std::ostream& stream,
   return MB_SUCCESS;
 }
 
-ErrorCode WriteVtk::write_tags(std::ostream& stream,
-                               bool nodes,
-                               const Range& entities,
-                               const Tag* tag_list,
-                               int num_tags)
+ErrorCode WriteVtk::get_tags(bool nodes,
+                             const Range& entities,
+                             const Tag* tag_list,
+                             int num_tags,
+                             std::vector<Tag>& tags_out,
+                             std::vector<Range>& tagged_out)
 {
   ErrorCode rval;
 
@@ -416,7 +937,6 @@ ErrorCode WriteVtk::write_tags(std::ostream& stream,
     return rval;
 
   // For each tag...
-  bool entities_have_tags = false;
   for (i = tags.begin(); i != tags.end(); ++i) {
     // Skip tags holding entity handles -- no way to save them
     DataType dtype;
@@ -450,32 +970,59 @@ ErrorCode WriteVtk::write_tags(std::ostream& stream,
 
     // If any entities were tagged
     if (!tagged.empty()) {
-      // If this is the first tag being written for the
-      // entity type, write the label marking the beginning
-      // of the tag data.
-      if (!entities_have_tags) {
-        entities_have_tags = true;
-        if (nodes)
-          stream << "POINT_DATA "  << entities.size() << std::endl;
-        else
-          stream << "CELL_DATA " << entities.size() + freeNodes << std::endl;
-      }
-
-      // Write the tag
-      rval = write_tag(stream, *i, entities, tagged);
-      if (MB_SUCCESS != rval)
-        return rval;
+      tags_out.push_back(*i);
+      tagged_out.push_back(tagged);
     }
   }
 
   return MB_SUCCESS;
 }
 
+ErrorCode WriteVtk::write_tags(std::ostream& stream,
+                               bool nodes,
+                               const Range& entities,
+                               const Tag* tag_list,
+                               int num_tags)
+{
+  ErrorCode rval;
+
+  std::vector<Tag> tags;
+  std::vector<Range> tagged;
+  rval = get_tags(nodes, entities, tag_list, num_tags, tags, tagged);
+  if (MB_SUCCESS != rval)
+    return rval;
+  if (tags.empty())
+    return MB_SUCCESS;
+
+  // Write the label marking the beginning of the tag data
+  if (nodes)
+    stream << "POINT_DATA "  << entities.size() << std::endl;
+  else
+    stream << "CELL_DATA " << entities.size() + freeNodes << std::endl;
+
+  for (size_t i = 0; i < tags.size(); ++i) {
+    // Write the tag
+    rval = write_tag(stream, tags[i], entities, tagged[i]);
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+
+  return MB_SUCCESS;
+}
+
 template <typename T>
 void WriteVtk::write_data(std::ostream& stream,
                           const std::vector<T>& data,
                           unsigned vals_per_tag)
 {
+  // Binary legacy data is big-endian
+  if (mBinary) {
+    RawSink sink(stream, !native_big_endian());
+    sink.write(&data[0], sizeof(T), data.size());
+    stream << std::endl;
+    return;
+  }
+
   typename std::vector<T>::const_iterator d = data.begin();
   const unsigned long n = data.size() / vals_per_tag;
 
@@ -490,27 +1037,11 @@ void WriteVtk::write_data(std::ostream& stream,
   }
 }
 
-//template <>
-//void WriteVtk::write_data<unsigned char>(std::ostream& stream,
-//                                         const std::vector<unsigned char>& data,
-//                                         unsigned vals_per_tag)
-//{
-//  std::vector<unsigned char>::const_iterator d = data.begin();
-//  const unsigned long n = data.size() / vals_per_tag;
-//  
-//  for (unsigned long i = 0; i < n; ++i) {
-//    for (unsigned j = 0; j < vals_per_tag; ++j, ++d)
-//      stream << (unsigned int)*d << ' ';
-//    stream << std::endl;
-//  }
-//}
-
 template <typename T>
-ErrorCode WriteVtk::write_tag(std::ostream& stream,
-                              Tag tag,
-                              const Range& entities,
-                              const Range& tagged,
-                              const int)
+ErrorCode WriteVtk::get_tag_data(Tag tag,
+                                 const Range& entities,
+                                 const Range& tagged,
+                                 std::vector<T>& data)
 {
   ErrorCode rval;
   int addFreeNodes = 0;
@@ -523,16 +1054,14 @@ ErrorCode WriteVtk::write_tag(std::ostream& stream,
 
   // Get tag properties
 
-  std::string name;
   int vals_per_tag;
-  if (MB_SUCCESS != mbImpl->tag_get_name(tag, name) ||
-      MB_SUCCESS != mbImpl->tag_get_length(tag, vals_per_tag))
+  if (MB_SUCCESS != mbImpl->tag_get_length(tag, vals_per_tag))
     return MB_FAILURE;
 
   // Get a tag value for each entity. Do this by initializing the
   // "data" vector with zero, and then filling in the values for
   // the entities that actually have the tag set.
-  std::vector<T> data;
+  data.clear();
   data.resize(n * vals_per_tag, 0);
   // If there is a default value for the tag, set the actual default value
   std::vector<T> def_value(vals_per_tag);
@@ -552,19 +1081,41 @@ ErrorCode WriteVtk::write_tag(std::ostream& stream,
     }
   }
 
+  return MB_SUCCESS;
+}
+
+template <typename T>
+ErrorCode WriteVtk::write_tag(std::ostream& stream,
+                              Tag tag,
+                              const Range& entities,
+                              const Range& tagged,
+                              const int)
+{
+  int vals_per_tag;
+  if (MB_SUCCESS != mbImpl->tag_get_length(tag, vals_per_tag))
+    return MB_FAILURE;
+
+  std::vector<T> data;
+  ErrorCode rval = get_tag_data(tag, entities, tagged, data);
+  if (MB_SUCCESS != rval)
+    return rval;
+
   // Write the tag values, one entity per line.
   write_data(stream, data, vals_per_tag);
 
   return MB_SUCCESS;
 }
 
-ErrorCode WriteVtk::write_bit_tag(std::ostream& stream,
-                                  Tag tag,
-                                  const Range& entities,
-                                  const Range& tagged)
+ErrorCode WriteVtk::get_bit_tag_data(Tag tag,
+                                     const Range& entities,
+                                     const Range& tagged,
+                                     std::vector<unsigned char>& data)
 {
   ErrorCode rval;
-  const unsigned long n = entities.size();
+  int addFreeNodes = 0;
+  if (TYPE_FROM_HANDLE(entities[0]) > MBVERTEX)
+    addFreeNodes = freeNodes;
+  const unsigned long n = entities.size() + addFreeNodes;
 
   // Get tag properties
 
@@ -583,10 +1134,10 @@ ErrorCode WriteVtk::write_bit_tag(std::ostream& stream,
   // one integer in the 'data' array for each bit.
   // Initialize 'data' to zero because we will skip
   // those entities for which the tag is not set.
-  std::vector<unsigned short> data;
+  data.clear();
   data.resize(n * vals_per_tag, 0);
   Range::const_iterator t = tagged.begin();
-  std::vector<unsigned short>::iterator d = data.begin();
+  std::vector<unsigned char>::iterator d = data.begin();
   for (Range::const_iterator i = entities.begin();
        i != entities.end() && t != tagged.end(); ++i) {
     if (*i == *t) {
@@ -594,7 +1145,7 @@ ErrorCode WriteVtk::write_bit_tag(std::ostream& stream,
       unsigned char value;
       rval = mbImpl->tag_get_data(tag, &(*i), 1, &value);
       for (int j = 0; j < vals_per_tag; ++j, ++d)
-        *d = (unsigned short)(value & (1 << j) ? 1 : 0);
+        *d = (unsigned char)(value & (1 << j) ? 1 : 0);
       if (MB_SUCCESS != rval)
         return rval;
     }
@@ -604,6 +1155,34 @@ ErrorCode WriteVtk::write_bit_tag(std::ostream& stream,
     }
   }
 
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::write_bit_tag(std::ostream& stream,
+                                  Tag tag,
+                                  const Range& entities,
+                                  const Range& tagged)
+{
+  int vals_per_tag;
+  if (MB_SUCCESS != mbImpl->tag_get_length(tag, vals_per_tag))
+    return MB_FAILURE;
+
+  std::vector<unsigned char> data;
+  ErrorCode rval = get_bit_tag_data(tag, entities, tagged, data);
+  if (MB_SUCCESS != rval)
+    return rval;
+
+  // Binary bit data is packed, most significant bit first
+  if (mBinary) {
+    std::vector<unsigned char> bits((data.size() + 7) / 8, 0);
+    for (size_t i = 0; i < data.size(); ++i)
+      if (data[i])
+        bits[i / 8] |= (unsigned char)(0x80 >> (i % 8));
+    stream.write(reinterpret_cast<const char*>(&bits[0]), bits.size());
+    stream << std::endl;
+    return MB_SUCCESS;
+  }
+
   // Write the tag values, one entity per line.
   write_data(stream, data, vals_per_tag);
 
@@ -658,4 +1237,356 @@ ErrorCode WriteVtk::write_tag(std::ostream& s, Tag tag,
   }
 }
 
+ErrorCode WriteVtk::write_vtu_values(VtkDataSink& sink,
+                                     const VtuArray& array,
+                                     const Range& nodes,
+                                     const Range& elems,
+                                     const Range& free_nodes)
+{
+  switch (array.content) {
+    case VTU_COORDS:
+      return write_coords(sink, nodes);
+    case VTU_CONNECTIVITY:
+    case VTU_OFFSETS:
+    case VTU_TYPES:
+      return write_cells(sink, array.content, nodes, elems, free_nodes);
+    case VTU_POINT_DATA:
+    case VTU_CELL_DATA:
+      break;
+    default:
+      return MB_FAILURE;
+  }
+
+  const Range& entities = (VTU_POINT_DATA == array.content) ? nodes : elems;
+  DataType type;
+  ErrorCode rval = mbImpl->tag_get_data_type(array.tag, type);MB_CHK_ERR(rval);
+  switch (type) {
+    case MB_TYPE_OPAQUE: {
+      std::vector<unsigned char> data;
+      rval = get_tag_data(array.tag, entities, array.tagged, data);MB_CHK_ERR(rval);
+      sink.write(&data[0], sizeof(unsigned char), data.size());
+      break;
+    }
+    case MB_TYPE_INTEGER: {
+      std::vector<int> data;
+      rval = get_tag_data(array.tag, entities, array.tagged, data);MB_CHK_ERR(rval);
+      sink.write(&data[0], sizeof(int), data.size());
+      break;
+    }
+    case MB_TYPE_DOUBLE: {
+      std::vector<double> data;
+      rval = get_tag_data(array.tag, entities, array.tagged, data);MB_CHK_ERR(rval);
+      sink.write(&data[0], sizeof(double), data.size());
+      break;
+    }
+    case MB_TYPE_BIT: {
+      std::vector<unsigned char> data;
+      rval = get_bit_tag_data(array.tag, entities, array.tagged, data);MB_CHK_ERR(rval);
+      sink.write(&data[0], sizeof(unsigned char), data.size());
+      break;
+    }
+    default:
+      return MB_FAILURE;
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::write_vtu(const char* file_name,
+                              const Range& nodes,
+                              const Range& elems,
+                              const Tag* tag_list,
+                              int num_tags,
+                              std::vector<VtuArray>* arrays_out)
+{
+  ErrorCode rval;
+
+  if (elems.num_of_type(MBPOLYHEDRON)) {
+    MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Cannot write polyhedra to VTK XML files");
+  }
+
+  Range free_nodes;
+  rval = get_free_nodes(nodes, elems, free_nodes);MB_CHK_ERR(rval);
+  const size_t num_cells = elems.size() + free_nodes.size();
+
+  // Get length of connectivity list
+  size_t conn_len = free_nodes.size();
+  std::vector<EntityHandle> storage;
+  int count;
+  for (Range::const_iterator i = elems.begin(); i != elems.end(); i += count) {
+    const EntityHandle* conn;
+    int len, vtk_len;
+    const VtkElemType* vtk_type;
+    rval = get_elem_block(i, elems.end(), conn, len, count, storage);MB_CHK_ERR(rval);
+    rval = get_vtk_type(TYPE_FROM_HANDLE(*i), len, vtk_type, vtk_len);MB_CHK_ERR(rval);
+    conn_len += (size_t)count * vtk_len;
+  }
+
+  // List data arrays in the order they are written: tag data,
+  // then point coordinates, then cells
+  std::vector<VtuArray> local_arrays;
+  std::vector<VtuArray>& arrays = arrays_out ? *arrays_out : local_arrays;
+  arrays.clear();
+  for (int pass = 0; pass < 2; ++pass) {
+    const bool is_nodes = (0 == pass);
+    std::vector<Tag> tags;
+    std::vector<Range> tagged;
+    rval = get_tags(is_nodes, is_nodes ? nodes : elems, tag_list, num_tags, tags, tagged);MB_CHK_ERR(rval);
+    for (size_t i = 0; i < tags.size(); ++i) {
+      VtuArray array;
+      DataType type;
+      if (MB_SUCCESS != mbImpl->tag_get_name(tags[i], array.name) ||
+          MB_SUCCESS != mbImpl->tag_get_length(tags[i], array.numComp) ||
+          MB_SUCCESS != mbImpl->tag_get_data_type(tags[i], type))
+        return MB_FAILURE;
+      // Remove characters that are not allowed in the XML attribute
+      for (std::string::iterator c = array.name.begin(); c != array.name.end(); ++c)
+        if (isspace(*c) || iscntrl(*c) || strchr("<>&\"'", *c))
+          *c = '_';
+      array.section = is_nodes ? "PointData" : "CellData";
+      switch (type) {
+        case MB_TYPE_INTEGER: array.type = "Int32";   array.valueSize = sizeof(int);    break;
+        case MB_TYPE_DOUBLE:  array.type = "Float64"; array.valueSize = sizeof(double); break;
+        default:              array.type = "UInt8";   array.valueSize = 1;              break;
+      }
+      array.numValues = (is_nodes ? nodes.size() : num_cells) * array.numComp;
+      array.content = is_nodes ? VTU_POINT_DATA : VTU_CELL_DATA;
+      array.tag = tags[i];
+      array.tagged.swap(tagged[i]);
+      arrays.push_back(array);
+    }
+  }
+
+  const char* sections[] = { "Points", "Cells", "Cells", "Cells" };
+  const char* names[] = { "", "connectivity", "offsets", "types" };
+  const char* types[] = { "Float64", "Int64", "Int64", "UInt8" };
+  const int ncomp[] = { 3, 1, 1, 1 };
+  const size_t sizes[] = { sizeof(double), sizeof(int64_t), sizeof(int64_t), 1 };
+  const size_t counts[] = { 3 * nodes.size(), conn_len, num_cells, num_cells };
+  const int contents[] = { VTU_COORDS, VTU_CONNECTIVITY, VTU_OFFSETS, VTU_TYPES };
+  for (int i = 0; i < 4; ++i) {
+    VtuArray array;
+    array.section = sections[i];
+    array.name = names[i];
+    array.type = types[i];
+    array.numComp = ncomp[i];
+    array.valueSize = sizes[i];
+    array.numValues = counts[i];
+    array.content = contents[i];
+    array.tag = 0;
+    arrays.push_back(array);
+  }
+
+  // The offsets of compressed appended data depend on the compressed
+  // sizes, so compress all arrays before writing anything.
+  const bool appended = !mBase64;
+#ifdef MOAB_HAVE_ZLIB
+  if (mCompress && appended) {
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      ZlibSink sink(mCompress);
+      rval = write_vtu_values(sink, arrays[i], nodes, elems, free_nodes);MB_CHK_ERR(rval);
+      if (!sink.finish(arrays[i].header)) {
+        MB_SET_ERR(MB_FAILURE, "Error compressing VTK data");
+      }
+      arrays[i].data.swap(sink.compressed);
+    }
+  }
+#endif
+
+  std::ofstream file(file_name, std::ios::out | std::ios::binary);
+  if (!file) {
+    MB_SET_ERR(MB_FILE_WRITE_ERROR, "Could not open file: " << file_name);
+  }
+
+  file << "<?xml version=\"1.0\"?>" << std::endl
+       << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+       << (native_big_endian() ? "BigEndian" : "LittleEndian") << "\" header_type=\"UInt64\"";
+  if (mCompress)
+    file << " compressor=\"vtkZLibDataCompressor\"";
+  file << ">" << std::endl
+       << "  <UnstructuredGrid>" << std::endl
+       << "    <Piece NumberOfPoints=\"" << nodes.size()
+       << "\" NumberOfCells=\"" << num_cells << "\">" << std::endl;
+
+  uint64_t offset = 0;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const VtuArray& array = arrays[i];
+    if (!i || strcmp(array.section, arrays[i - 1].section))
+      file << "      <" << array.section << ">" << std::endl;
+
+    file << "        <DataArray type=\"" << array.type << "\"";
+    if (!array.name.empty())
+      file << " Name=\"" << array.name << "\"";
+    file << " NumberOfComponents=\"" << array.numComp << "\"";
+    if (appended) {
+      file << " format=\"appended\" offset=\"" << offset << "\"/>" << std::endl;
+      offset += array.block_size(mCompress != 0);
+    }
+    else {
+      // Inline data is base64-encoded. Compressed data is preceded by
+      // the separately encoded compression header, while uncompressed
+      // data is encoded together with its size.
+      file << " format=\"binary\">" << std::endl << "          ";
+      Base64Sink sink(file);
+#ifdef MOAB_HAVE_ZLIB
+      if (mCompress) {
+        ZlibSink zsink(mCompress);
+        std::vector<uint64_t> header;
+        rval = write_vtu_values(zsink, array, nodes, elems, free_nodes);MB_CHK_ERR(rval);
+        if (!zsink.finish(header)) {
+          MB_SET_ERR(MB_FAILURE, "Error compressing VTK data");
+        }
+        sink.write(&header[0], sizeof(uint64_t), header.size());
+        sink.finish();
+        if (!zsink.compressed.empty())
+          sink.write(zsink.compressed.data(), 1, zsink.compressed.size());
+      }
+      else
+#endif
+      {
+        const uint64_t bytes = array.numValues * array.valueSize;
+        sink.write(&bytes, sizeof(bytes), 1);
+        rval = write_vtu_values(sink, array, nodes, elems, free_nodes);MB_CHK_ERR(rval);
+      }
+      sink.finish();
+      file << std::endl << "        </DataArray>" << std::endl;
+    }
+
+    if (i + 1 == arrays.size() || strcmp(array.section, arrays[i + 1].section))
+      file << "      </" << array.section << ">" << std::endl;
+  }
+
+  file << "    </Piece>" << std::endl
+       << "  </UnstructuredGrid>" << std::endl;
+
+  // Raw appended data begins after an underscore
+  if (appended) {
+    file << "  <AppendedData encoding=\"raw\">" << std::endl << "   _";
+    RawSink sink(file, false);
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      VtuArray& array = arrays[i];
+      if (mCompress) {
+        sink.write(&array.header[0], sizeof(uint64_t), array.header.size());
+        if (!array.data.empty())
+          sink.write(array.data.data(), 1, array.data.size());
+        std::string().swap(array.data);
+      }
+      else {
+        const uint64_t bytes = array.numValues * array.valueSize;
+        sink.write(&bytes, sizeof(bytes), 1);
+        rval = write_vtu_values(sink, array, nodes, elems, free_nodes);MB_CHK_ERR(rval);
+      }
+    }
+    file << std::endl << "  </AppendedData>" << std::endl;
+  }
+
+  file << "</VTKFile>" << std::endl;
+  if (!file) {
+    MB_SET_ERR(MB_FILE_WRITE_ERROR, "Error writing file: " << file_name);
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode WriteVtk::write_pvtu(const char* file_name,
+                               bool overwrite,
+                               const FileOptions& opts,
+                               const Range& nodes,
+                               Range& elems,
+                               const Tag* tag_list,
+                               int num_tags)
+{
+  ErrorCode rval;
+
+  // With PARALLEL=WRITE_PART each process writes one piece,
+  // otherwise the whole mesh is written as a single piece.
+  int rank = 0, num_procs = 1;
+#ifdef MOAB_HAVE_MPI
+  if (opts.match_option("PARALLEL", "WRITE_PART") != MB_ENTITY_NOT_FOUND) {
+    int pcomm_no = 0;
+    rval = opts.get_int_option("PARALLEL_COMM", pcomm_no);
+    if (MB_TYPE_OUT_OF_RANGE == rval) {
+      MB_SET_ERR(rval, "Invalid value for PARALLEL_COMM option");
+    }
+    ParallelComm* pcomm = ParallelComm::get_pcomm(mbImpl, pcomm_no);
+    if (pcomm) {
+      rank = pcomm->rank();
+      num_procs = pcomm->size();
+      // Write each element only once: skip ghost elements and
+      // shared elements owned by another process
+      rval = pcomm->filter_pstatus(elems, PSTATUS_NOT_OWNED, PSTATUS_NOT);MB_CHK_ERR(rval);
+    }
+    else {
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+      MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    }
+  }
+#else
+  if (opts.match_option("PARALLEL", "WRITE_PART") != MB_ENTITY_NOT_FOUND) {
+    MB_SET_ERR(MB_UNSUPPORTED_OPERATION, "Cannot write VTK pieces in parallel: MOAB was built without MPI");
+  }
+#endif
+
+  // Pieces are named for the file and the process rank, and
+  // are referred to relative to the directory of the file.
+  const std::string base(file_name, strlen(file_name) - strlen(".pvtu"));
+  std::string::size_type slash = base.find_last_of("/\\");
+  const std::string source_base = (slash == std::string::npos) ? base : base.substr(slash + 1);
+  std::ostringstream piece_name;
+  piece_name << base << '_' << rank << ".vtu";
+
+  if (!overwrite) {
+    rval = writeTool->check_doesnt_exist(piece_name.str().c_str());
+    if (MB_SUCCESS == rval && !rank)
+      rval = writeTool->check_doesnt_exist(file_name);
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+
+  std::vector<VtuArray> arrays;
+  rval = write_vtu(piece_name.str().c_str(), nodes, elems, tag_list, num_tags, &arrays);
+  if (MB_SUCCESS != rval) {
+    remove(piece_name.str().c_str());
+    return rval;
+  }
+  if (rank)
+    return MB_SUCCESS;
+
+  // The first process writes the parallel file, listing the data
+  // arrays of its own piece.
+  std::ofstream file(file_name);
+  if (!file) {
+    MB_SET_ERR(MB_FILE_WRITE_ERROR, "Could not open file: " << file_name);
+  }
+
+  file << "<?xml version=\"1.0\"?>" << std::endl
+       << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+       << (native_big_endian() ? "BigEndian" : "LittleEndian") << "\" header_type=\"UInt64\">" << std::endl
+       << "  <PUnstructuredGrid GhostLevel=\"0\">" << std::endl;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const VtuArray& array = arrays[i];
+    if (!strcmp(array.section, "Cells"))
+      continue;
+    if (!i || strcmp(array.section, arrays[i - 1].section))
+      file << "    <P" << array.section << ">" << std::endl;
+    file << "      <PDataArray type=\"" << array.type << "\"";
+    if (!array.name.empty())
+      file << " Name=\"" << array.name << "\"";
+    file << " NumberOfComponents=\"" << array.numComp << "\"/>" << std::endl;
+    if (i + 1 == arrays.size() || strcmp(array.section, arrays[i + 1].section))
+      file << "    </P" << array.section << ">" << std::endl;
+  }
+  for (int p = 0; p < num_procs; ++p)
+    file << "    <Piece Source=\"" << source_base << '_' << p << ".vtu\"/>" << std::endl;
+  file << "  </PUnstructuredGrid>" << std::endl
+       << "</VTKFile>" << std::endl;
+  if (!file) {
+    file.close();
+    remove(file_name);
+    MB_SET_ERR(MB_FILE_WRITE_ERROR, "Error writing file: " << file_name);
+  }
+
+  return MB_SUCCESS;
+}
+
 } // namespace moab
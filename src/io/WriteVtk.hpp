@@ -18,13 +18,16 @@
 #define WRITE_VTK_HPP
 
 #include <iosfwd>
+#include <vector>
 
 #include "moab/Forward.hpp"
 #include "moab/WriterIface.hpp"
+#include "moab/Range.hpp"
 
 namespace moab {
 
 class WriteUtilIface;
+class VtkDataSink;
 
 //class MB_DLL_EXPORT WriteVtk : public WriterIface
 class WriteVtk : public WriterIface
@@ -53,6 +56,9 @@ public:
 
 private:
 
+    //! Description of a data array in a VTK XML file
+  struct VtuArray;
+
     //! Get entities to write, given set list passed to \ref write_file
   ErrorCode gather_mesh( const EntityHandle* set_list,
                            int num_sets, 
@@ -86,13 +92,67 @@ private:
   template <typename T>
   void write_data( std::ostream& stream, const std::vector<T>& data, unsigned vals_per_tag );
 
+    //! Get the tags to write for the passed entities and, for each tag,
+    //! the subset of the entities for which it is set.
+  ErrorCode get_tags( bool nodes, const Range& entities,
+                      const Tag* tag_list, int num_tags,
+                      std::vector<Tag>& tags, std::vector<Range>& tagged );
+
+    //! Get tag values for all entities, using the default value (or zero)
+    //! for entities that do not have the tag set.
+  template <typename T>
+  ErrorCode get_tag_data( Tag tag, const Range& entities, const Range& tagged,
+                          std::vector<T>& data );
+
+    //! Get bit tag values for all entities, one value per bit.
+  ErrorCode get_bit_tag_data( Tag tag, const Range& entities, const Range& tagged,
+                              std::vector<unsigned char>& data );
+
+    //! Get connectivity of a block of elements starting at \c iter, all
+    //! with the same type and number of vertices.  The connectivity is
+    //! accessed directly where possible, otherwise it is copied to \c storage.
+  ErrorCode get_elem_block( Range::const_iterator iter, Range::const_iterator end,
+                            const EntityHandle*& conn, int& conn_len, int& count,
+                            std::vector<EntityHandle>& storage );
+
+    //! Write node coordinates as a binary stream of interleaved doubles
+  ErrorCode write_coords( VtkDataSink& sink, const Range& nodes );
+
+    //! Write one of the binary arrays describing the cells: legacy cell
+    //! list or cell types, or XML connectivity, offsets or cell types.
+  ErrorCode write_cells( VtkDataSink& sink, int what, const Range& nodes,
+                         const Range& elems, const Range& free_nodes );
+
+    //! Get the nodes not used by any element, if one-node cells are
+    //! to be written for them.
+  ErrorCode get_free_nodes( const Range& nodes, const Range& elems, Range& free_nodes );
+
+    //! Write a VTK XML unstructured grid (.vtu) file.  If \c arrays is
+    //! not NULL, the list of data arrays written is returned in it.
+  ErrorCode write_vtu( const char* file_name, const Range& nodes, const Range& elems,
+                       const Tag* tag_list, int num_tags,
+                       std::vector<VtuArray>* arrays = 0 );
+
+    //! Write a parallel VTK XML unstructured grid (.pvtu) file and
+    //! one .vtu piece per process.
+  ErrorCode write_pvtu( const char* file_name, bool overwrite, const FileOptions& opts,
+                        const Range& nodes, Range& elems,
+                        const Tag* tag_list, int num_tags );
+
+    //! Write the values of a VTK XML data array
+  ErrorCode write_vtu_values( VtkDataSink& sink, const VtuArray& array,
+                              const Range& nodes, const Range& elems,
+                              const Range& free_nodes );
+
   Interface* mbImpl;
   WriteUtilIface* writeTool;
  
   bool mStrict; // If true, do not write data that cannot fit in strict VTK file format.
   int freeNodes;
   bool createOneNodeCells;
-  
+  bool mBinary; // Write binary rather than ASCII legacy file
+  bool mBase64; // Write VTK XML data arrays inline as base64 rather than raw appended data
+  int mCompress; // zlib compression level for VTK XML data arrays, or zero for none
 };
 
 } // namespace moab
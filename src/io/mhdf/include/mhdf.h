@@ -453,6 +453,38 @@ mhdf_createFile( const char* filename,
                  hid_t id_type,
                  mhdf_Status* status );
 
+/** \brief Create a new file with options.
+ *
+ * Create a new HDF mesh file.  This handle must be closed with
+ * <code>mhdf_closeFile</code> to avoid resource loss.  This function
+ * allows the calling application to specify the HDF5 access property
+ * list that is passed to the HDF5 H5Fcreate API.  If this is passed as
+ * H5P_DEFAULT, the behavior is the same as \ref mhdf_createFile .
+ * This argument is typically used to create the file in memory using
+ * the HDF5 core driver.
+ *
+ * \param filename   The path and name of the file to create
+ * \param overwrite  If zero, will fail if the specified file
+ *                   already exists.  If non-zero, will overwrite
+ *                   an existing file.
+ * \param elem_type_list The list of element types that will be stored
+ *                   in the file.  See \ref mhdf_createFile.
+ * \param elem_type_list_len The length of <code>elem_type_list</code>.
+ * \param id_type    Type to use when creating datasets containing file IDs
+ * \param options    The HDF5 access property list to use when creating
+ *                   the file.  See the HDF5 documentation for H5Fcreate.
+ * \param status     Passed back status of API call.
+ * \return An opaque handle to the file.
+ */
+mhdf_FileHandle
+mhdf_createFileWithOpt( const char* filename,
+                        int overwrite,
+                        const char** elem_type_list,
+                        size_t elem_type_list_len,
+                        hid_t id_type,
+                        hid_t options,
+                        mhdf_Status* status );
+
 /** \brief Open an existing file. 
  *
  * Open an existing HDF mesh file.  This handle must be closed with
@@ -606,6 +638,26 @@ void
 mhdf_closeFile( mhdf_FileHandle handle,
                 mhdf_Status* status );
 
+/** \brief Get an image of the file contents
+ *
+ * Flush the file and copy its contents into the passed buffer.  This
+ * is typically used to retreive the contents of a file created in
+ * memory with the HDF5 core driver.  Call first with a null buffer
+ * to get the required buffer size.
+ *
+ * \param handle     The file.
+ * \param buffer     The buffer into which to copy the file image,
+ *                   or NULL.
+ * \param buffer_size The length of <code>buffer</code>.
+ * \param status     Passed back status of API call.
+ * \return The size of the file image in bytes.
+ */
+size_t
+mhdf_getFileImage( mhdf_FileHandle handle,
+                   void* buffer,
+                   size_t buffer_size,
+                   mhdf_Status* status );
+
 /**\brief Check for open handles in file
  **/
 int
@@ -638,6 +690,36 @@ mhdf_getNextStartId( mhdf_FileHandle file,
                      mhdf_index_t* start_id_out,
                      mhdf_Status* status );
 
+/**\brief Set storage layout for subsequently created bulk data tables
+ *
+ * Specify the storage layout used for tables subsequently created
+ * by mhdf_createNodeCoords, mhdf_createConnectivity, 
+ * mhdf_createPolyConnectivity, mhdf_createDenseTagData, 
+ * mhdf_createSparseTagData and mhdf_createVarLenTagData.  Other tables
+ * are always stored contiguously.  The default is contiguous, unfiltered
+ * storage.  Reading chunked or compressed tables requires no special
+ * handling by the caller.
+ *
+ * \param file       The file.
+ * \param chunk_size Approximate size, in bytes, of each chunk.  The
+ *                   number of rows in a chunk is chosen such that the
+ *                   chunk does not exceed this size, but each chunk
+ *                   contains at least one row.  If zero, tables are
+ *                   stored contiguously and the filter arguments are
+ *                   ignored.
+ * \param deflate_level If non-zero, compress chunks with the deflate
+ *                   (zlib) filter at the specified level (1-9).
+ * \param shuffle    If non-zero, apply the byte shuffle filter to
+ *                   chunks before compressing them.
+ * \param status     Passed back status of API call.
+ */
+void
+mhdf_setDataLayout( mhdf_FileHandle file,
+                    long chunk_size,
+                    int deflate_level,
+                    int shuffle,
+                    mhdf_Status* status );
+
 /** \brief Write the file history as a list of strings.
  *
  * Each entry is composed of four strings:
@@ -2042,6 +2124,145 @@ mhdf_readSetParentsChildrenWithOpt( hid_t data_handle,
                              hid_t read_prop,
                              mhdf_Status* status );
 
+/** \brief Check if file contains a partition index
+ *
+ * The optional partition index lists, for each of a subset of the sets
+ * (typically the parts of a parallel partition), the global IDs of
+ * all of the entities that must be read to read the set:  contained
+ * and child sets (recursively), the entities contained in all of those
+ * sets, and the nodes (and for polyhedra, the faces) of any elements
+ * among them.  It allows a reader to select the data for a part without
+ * reading set contents or connectivity.  The index is composed of two
+ * tables (see \ref mhdf_createPartIndex and \ref mhdf_createPartRanges).
+ *
+ *\param file_handle The file.
+ *\param status      Passed back status of API call.
+ *\return Non-zero if file contains a partition index, zero otherwise.
+ */
+int
+mhdf_havePartIndex( mhdf_FileHandle file_handle,
+                    mhdf_Status* status );
+
+/** \brief Create file object for the partition index
+ *
+ * Create the table listing the sets in the partition index.  The
+ * table has two columns and one row per set:  the global ID of the
+ * set and the end (one past the last row) of the ranges for the set
+ * in the partition range table (see \ref mhdf_createPartRanges).  The
+ * ranges for each set begin immediately after those of the previous
+ * set.  Rows are in order of increasing set ID.
+ *
+ *\param file_handle The file
+ *\param num_parts   The number of sets in the index.
+ *\param status      Passed back status of API call.
+ *\return A handle to the data object in the file.
+ */
+hid_t
+mhdf_createPartIndex( mhdf_FileHandle file_handle,
+                      long num_parts,
+                      mhdf_Status* status );
+
+/** \brief Open the file object for the partition index
+ *
+ *\param file_handle   The file
+ *\param num_parts_out The number of sets in the index.
+ *\param status        Passed back status of API call.
+ *\return A handle to the data object in the file.
+ */
+hid_t
+mhdf_openPartIndex( mhdf_FileHandle file_handle,
+                    long* num_parts_out,
+                    mhdf_Status* status );
+
+/** \brief Create file object for the partition index ranges
+ *
+ * Create the table of the global IDs of entities for each set in
+ * the partition index (see \ref mhdf_createPartIndex.)  The table
+ * has two columns:  each row is a {start_id, count} pair describing
+ * a range of consecutive global IDs.
+ *
+ *\param file_handle The file
+ *\param num_ranges  The total number of ranges for all sets.
+ *\param status      Passed back status of API call.
+ *\return A handle to the data object in the file.
+ */
+hid_t
+mhdf_createPartRanges( mhdf_FileHandle file_handle,
+                       long num_ranges,
+                       mhdf_Status* status );
+
+/** \brief Open the file object for the partition index ranges
+ *
+ *\param file_handle    The file
+ *\param num_ranges_out The total number of ranges for all sets.
+ *\param status         Passed back status of API call.
+ *\return A handle to the data object in the file.
+ */
+hid_t
+mhdf_openPartRanges( mhdf_FileHandle file_handle,
+                     long* num_ranges_out,
+                     mhdf_Status* status );
+
+/** \brief Write partition index data
+ *
+ * Write rows of either of the two partition index tables.
+ *
+ *\param data_handle The value returned from \ref mhdf_createPartIndex,
+ *                   \ref mhdf_openPartIndex, \ref mhdf_createPartRanges
+ *                   or \ref mhdf_openPartRanges.
+ *\param offset      The first row to write.
+ *\param count       The number of rows to write.
+ *\param hdf_integer_type The type of the integer data in <code>data</code>.
+ *                   The HDF class of this type object <em>must</em> be H5T_INTEGER
+ *\param data        The data to write, two values per row.
+ *\param status      Passed back status of API call.
+ */
+void
+mhdf_writePartIndex( hid_t data_handle,
+                     long offset,
+                     long count,
+                     hid_t hdf_integer_type,
+                     const void* data,
+                     mhdf_Status* status );
+void
+mhdf_writePartIndexWithOpt( hid_t data_handle,
+                     long offset,
+                     long count,
+                     hid_t hdf_integer_type,
+                     const void* data,
+                     hid_t write_prop,
+                     mhdf_Status* status );
+
+/** \brief Read partition index data
+ *
+ * Read rows from either of the two partition index tables.
+ *
+ *\param data_handle The value returned from \ref mhdf_openPartIndex
+ *                   or \ref mhdf_openPartRanges.
+ *\param offset      The first row to read.
+ *\param count       The number of rows to read.
+ *\param hdf_integer_type The type of the integer data in <code>data</code>.
+ *                   The HDF class of this type object <em>must</em> be H5T_INTEGER
+ *\param data        Pointer to memory in which to store the read data,
+ *                   two values per row.
+ *\param status      Passed back status of API call.
+ */
+void
+mhdf_readPartIndex( hid_t data_handle,
+                    long offset,
+                    long count,
+                    hid_t hdf_integer_type,
+                    void* data,
+                    mhdf_Status* status );
+void
+mhdf_readPartIndexWithOpt( hid_t data_handle,
+                    long offset,
+                    long count,
+                    hid_t hdf_integer_type,
+                    void* data,
+                    hid_t read_prop,
+                    mhdf_Status* status );
+
 /*@}*/
 
 /**
@@ -53,11 +53,12 @@ mhdf_createConnectivity( mhdf_FileHandle file_handle,
   
   dims[0] = (hsize_t)count;
   dims[1] = (hsize_t)nodes_per_elem;
-  table_id = mhdf_create_table( elem_id, 
-                                CONNECTIVITY_NAME,
-                                file_ptr->id_type,
-                                2, dims, 
-                                status );
+  table_id = mhdf_create_data_table( file_ptr,
+                                     elem_id, 
+                                     CONNECTIVITY_NAME,
+                                     file_ptr->id_type,
+                                     2, dims, 
+                                     status );
   H5Gclose( elem_id );
   if (table_id < 0)
     return -1;
@@ -264,11 +265,12 @@ mhdf_createPolyConnectivity( mhdf_FileHandle file_handle,
   
   
   dim = (hsize_t)data_list_length;
-  conn_id = mhdf_create_table( elem_id, 
-                                CONNECTIVITY_NAME,
-                                file_ptr->id_type,
-                                1, &dim, 
-                                status );
+  conn_id = mhdf_create_data_table( file_ptr,
+                                    elem_id, 
+                                    CONNECTIVITY_NAME,
+                                    file_ptr->id_type,
+                                    1, &dim, 
+                                    status );
   H5Gclose( elem_id );
   if (conn_id < 0)
   {
@@ -61,5 +61,8 @@ FileHandle* mhdf_alloc_FileHandle( hid_t hdf_table, hid_t id_type, mhdf_Status*
   rval->open_handle_count = 0;
   rval->id_type = id_type;
   rval->max_id = 0L;
+  rval->chunk_size = 0L;
+  rval->deflate_level = 0;
+  rval->shuffle = 0;
   return rval;
 }
@@ -32,6 +32,9 @@ typedef struct struct_FileHandle {
   int open_handle_count;
   hid_t id_type;    /* data type to use when creating tables of IDs */
   long max_id;
+  long chunk_size;  /* approx. bytes per chunk for bulk data, or zero if contiguous */
+  int deflate_level;/* compression level for chunked bulk data, or zero for none */
+  int shuffle;      /* apply shuffle filter to chunked bulk data */
 } FileHandle;
 
 FileHandle* mhdf_alloc_FileHandle( hid_t hdf_handle, hid_t id_type, mhdf_Status* status );
@@ -22,6 +22,7 @@
 #include <H5Spublic.h>
 #include <H5Tpublic.h>
 #include <H5Apublic.h>
+#include <H5Zpublic.h>
 #ifdef MOAB_HAVE_HDF5_PARALLEL
 #  include <H5FDmpi.h>
 #  include <H5FDmpio.h>
@@ -42,6 +43,24 @@ mhdf_createFile( const char* filename,
                  size_t elem_list_len,
                  hid_t id_type,
                  mhdf_Status* status )
+{
+  return mhdf_createFileWithOpt( filename,
+                                 overwrite,
+                                 elem_type_list,
+                                 elem_list_len,
+                                 id_type,
+                                 H5P_DEFAULT,
+                                 status );
+}
+
+mhdf_FileHandle
+mhdf_createFileWithOpt( const char* filename, 
+                        int overwrite, 
+                        const char** elem_type_list,
+                        size_t elem_list_len,
+                        hid_t id_type,
+                        hid_t access_prop,
+                        mhdf_Status* status )
 {
   FileHandle* file_ptr;
   unsigned int flags;
@@ -64,7 +83,7 @@ mhdf_createFile( const char* filename,
 
     /* Create the file */
   flags = overwrite ? H5F_ACC_TRUNC : H5F_ACC_EXCL;
-  file_ptr->hdf_handle = H5Fcreate( filename, flags, H5P_DEFAULT, H5P_DEFAULT );
+  file_ptr->hdf_handle = H5Fcreate( filename, flags, H5P_DEFAULT, access_prop );
   if (file_ptr->hdf_handle < 0)
   {
     mhdf_setFail( status, "Failed to create file \"%s\"", filename );
@@ -422,6 +441,39 @@ mhdf_getElemName( mhdf_FileHandle file_handle,
   API_END;
 }
 
+size_t
+mhdf_getFileImage( mhdf_FileHandle handle,
+                   void* buffer,
+                   size_t buffer_size,
+                   mhdf_Status* status )
+{
+  FileHandle* file_ptr;
+  ssize_t result;
+  API_BEGIN;
+
+  file_ptr = (FileHandle*)(handle);
+  if (!mhdf_check_valid_file( file_ptr, status ))
+    return 0;
+
+  /* H5Fget_file_image does not flush all cached metadata */
+  if (0 > H5Fflush( file_ptr->hdf_handle, H5F_SCOPE_GLOBAL ))
+  {
+    mhdf_setFail( status, "H5Fflush failed." );
+    return 0;
+  }
+
+  result = H5Fget_file_image( file_ptr->hdf_handle, buffer, buffer_size );
+  if (result < 0)
+  {
+    mhdf_setFail( status, "Failed to get file image." );
+    return 0;
+  }
+
+  mhdf_setOkay( status );
+  API_END;
+  return (size_t)result;
+}
+
 int
 mhdf_checkOpenHandles( mhdf_FileHandle handle,
                        mhdf_Status* status )
@@ -520,6 +572,39 @@ mhdf_closeData( mhdf_FileHandle file, hid_t handle, mhdf_Status* status )
 }
 
 
+void
+mhdf_setDataLayout( mhdf_FileHandle file,
+                    long chunk_size,
+                    int deflate_level,
+                    int shuffle,
+                    mhdf_Status* status )
+{
+  FileHandle* file_ptr;
+  API_BEGIN;
+
+  file_ptr = (FileHandle*)(file);
+  if (!mhdf_check_valid_file( file_ptr, status ))
+    return;
+
+  if (chunk_size < 0 || deflate_level < 0 || deflate_level > 9)
+  {
+    mhdf_setFail( status, "Invalid argument." );
+    return;
+  }
+
+  if (chunk_size && deflate_level && !H5Zfilter_avail( H5Z_FILTER_DEFLATE ))
+  {
+    mhdf_setFail( status, "HDF5 library does not support deflate compression." );
+    return;
+  }
+
+  file_ptr->chunk_size = chunk_size;
+  file_ptr->deflate_level = deflate_level;
+  file_ptr->shuffle = shuffle;
+  mhdf_setOkay( status );
+  API_END;
+}
+
 void
 mhdf_addElement( mhdf_FileHandle file_handle, 
                  const char* name, 
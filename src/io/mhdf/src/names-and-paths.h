@@ -61,6 +61,10 @@
 #define SET_DATA_NAME          "contents"
 #define SET_DATA_PATH          SET_GROUP  SET_DATA_NAME
 #define SET_TAG_GROUP          SET_GROUP  DENSE_TAG_SUBGROUP
+#define SET_PART_INDEX_NAME    "part_index"
+#define SET_PART_INDEX_PATH    SET_GROUP  SET_PART_INDEX_NAME
+#define SET_PART_RANGES_NAME   "part_ranges"
+#define SET_PART_RANGES_PATH   SET_GROUP  SET_PART_RANGES_NAME
 
 /* Group for all element types.  Subgroups for each type. */
 #define ELEMENT_GROUP_NAME     "elements"
@@ -97,11 +97,12 @@ mhdf_createNodeCoords( mhdf_FileHandle file_handle,
   
   dims[0] = (hsize_t)num_nodes;
   dims[1] = (hsize_t)dimension;
-  table_id = mhdf_create_table( file_ptr->hdf_handle,
-                                NODE_COORD_PATH,
-                                H5T_NATIVE_DOUBLE,
-                                2, dims,
-                                status );
+  table_id = mhdf_create_data_table( file_ptr,
+                                     file_ptr->hdf_handle,
+                                     NODE_COORD_PATH,
+                                     H5T_NATIVE_DOUBLE,
+                                     2, dims,
+                                     status );
   if (table_id < 0)
     return -1;
   
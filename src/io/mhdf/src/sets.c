@@ -971,3 +971,203 @@ mhdf_readSetParentsChildrenWithOpt( hid_t table_id,
   mhdf_read_data( table_id, offset, count, type, data, prop, status );
   API_END;
 }
+
+int
+mhdf_havePartIndex( mhdf_FileHandle file_handle,
+                    mhdf_Status* status )
+{
+  FileHandle* file_ptr = (FileHandle*)file_handle;
+  hid_t set_id;
+  int result;
+  API_BEGIN;
+  
+  if (!mhdf_check_valid_file( file_ptr, status ))
+    return -1;
+  
+  result = mhdf_haveSets( file_handle, 0, 0, 0, status );
+  if (result < 1)
+    return result;
+  
+#if defined(H5Gopen_vers) && H5Gopen_vers > 1  
+  set_id = H5Gopen2( file_ptr->hdf_handle, SET_GROUP, H5P_DEFAULT );
+#else
+  set_id = H5Gopen( file_ptr->hdf_handle, SET_GROUP );
+#endif
+  if (set_id < 0)
+  {
+    mhdf_setFail( status, "H5Gopen( \"%s\" ) failed.", SET_GROUP );
+    return -1;
+  }
+  
+  result = mhdf_is_in_group( set_id, SET_PART_INDEX_NAME, status );
+  if (result > 0)
+    result = mhdf_is_in_group( set_id, SET_PART_RANGES_NAME, status );
+  H5Gclose( set_id );
+  if (result >= 0)
+    mhdf_setOkay( status );
+  API_END;
+  return result;
+}
+
+static hid_t
+mhdf_create_part_table( mhdf_FileHandle file_handle,
+                        const char* path,
+                        long num_rows,
+                        mhdf_Status* status )
+{
+  FileHandle* file_ptr = (FileHandle*)file_handle;
+  hid_t table_id;
+  hsize_t dims[2];
+  
+  if (!mhdf_check_valid_file( file_ptr, status ))
+    return -1;
+
+  if (num_rows < 1)
+  {
+    mhdf_setFail( status, "Invalid argument.\n" );
+    return -1;
+  }
+  
+  dims[0] = (hsize_t)num_rows;
+  dims[1] = 2;
+  table_id = mhdf_create_table( file_ptr->hdf_handle,
+                                path,
+                                file_ptr->id_type,
+                                2, dims,
+                                status );
+  if (table_id < 0)
+    return -1;
+  
+  file_ptr->open_handle_count++;
+  mhdf_setOkay( status );
+  return table_id;
+}
+
+static hid_t
+mhdf_open_part_table( mhdf_FileHandle file_handle,
+                      const char* path,
+                      long* num_rows_out,
+                      mhdf_Status* status )
+{
+  FileHandle* file_ptr = (FileHandle*)file_handle;
+  hid_t table_id;
+  hsize_t rows;
+  
+  if (!mhdf_check_valid_file( file_ptr, status ))
+    return -1;
+
+  if (!num_rows_out)
+  {
+    mhdf_setFail( status, "Invalid argument.\n" );
+    return -1;
+  }
+  
+  table_id = mhdf_open_table( file_ptr->hdf_handle, path, 0, &rows, status );
+  if (table_id < 0)
+    return -1;
+  
+  *num_rows_out = (long)rows;
+  file_ptr->open_handle_count++;
+  mhdf_setOkay( status );
+  return table_id;
+}
+
+hid_t
+mhdf_createPartIndex( mhdf_FileHandle file_handle,
+                      long num_parts,
+                      mhdf_Status* status )
+{
+  hid_t table_id;
+  API_BEGIN;
+  table_id = mhdf_create_part_table( file_handle, SET_PART_INDEX_PATH, num_parts, status );
+  API_END_H(1);
+  return table_id;
+}
+
+hid_t
+mhdf_openPartIndex( mhdf_FileHandle file_handle,
+                    long* num_parts_out,
+                    mhdf_Status* status )
+{
+  hid_t table_id;
+  API_BEGIN;
+  table_id = mhdf_open_part_table( file_handle, SET_PART_INDEX_PATH, num_parts_out, status );
+  API_END_H(1);
+  return table_id;
+}
+
+hid_t
+mhdf_createPartRanges( mhdf_FileHandle file_handle,
+                       long num_ranges,
+                       mhdf_Status* status )
+{
+  hid_t table_id;
+  API_BEGIN;
+  table_id = mhdf_create_part_table( file_handle, SET_PART_RANGES_PATH, num_ranges, status );
+  API_END_H(1);
+  return table_id;
+}
+
+hid_t
+mhdf_openPartRanges( mhdf_FileHandle file_handle,
+                     long* num_ranges_out,
+                     mhdf_Status* status )
+{
+  hid_t table_id;
+  API_BEGIN;
+  table_id = mhdf_open_part_table( file_handle, SET_PART_RANGES_PATH, num_ranges_out, status );
+  API_END_H(1);
+  return table_id;
+}
+
+void
+mhdf_writePartIndex( hid_t table_id,
+                     long offset,
+                     long count,
+                     hid_t type,
+                     const void* data,
+                     mhdf_Status* status )
+{
+  API_BEGIN;
+  mhdf_write_data( table_id, offset, count, type, data, H5P_DEFAULT, status );
+  API_END;
+}
+void
+mhdf_writePartIndexWithOpt( hid_t table_id,
+                     long offset,
+                     long count,
+                     hid_t type,
+                     const void* data,
+                     hid_t prop,
+                     mhdf_Status* status )
+{
+  API_BEGIN;
+  mhdf_write_data( table_id, offset, count, type, data, prop, status );
+  API_END;
+}
+
+void
+mhdf_readPartIndex( hid_t table_id,
+                    long offset,
+                    long count,
+                    hid_t type,
+                    void* data,
+                    mhdf_Status* status )
+{
+  API_BEGIN;
+  mhdf_read_data( table_id, offset, count, type, data, H5P_DEFAULT, status );
+  API_END;
+}
+void
+mhdf_readPartIndexWithOpt( hid_t table_id,
+                    long offset,
+                    long count,
+                    hid_t type,
+                    void* data,
+                    hid_t prop,
+                    mhdf_Status* status )
+{
+  API_BEGIN;
+  mhdf_read_data( table_id, offset, count, type, data, prop, status );
+  API_END;
+}
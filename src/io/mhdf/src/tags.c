@@ -1391,7 +1391,7 @@ mhdf_createDenseTagData( mhdf_FileHandle file_handle,
     { H5Gclose( elem_id ); return -1; }
   
   size = (hsize_t)num_values;
-  data_id = mhdf_create_table( elem_id, path, type_id, 1, &size, status );
+  data_id = mhdf_create_data_table( file_ptr, elem_id, path, type_id, 1, &size, status );
   free( path );
   H5Gclose( elem_id );
   H5Tclose( type_id );
@@ -1476,6 +1476,7 @@ mhdf_createSparseTagData( mhdf_FileHandle file_handle,
 {
   hid_t tag_id, index_id, data_id, type_id, id_type;
   hsize_t count = (hsize_t)num_values;
+  FileHandle* file_ptr = (FileHandle*)file_handle;
   API_BEGIN;
   
   tag_id = get_tag( file_handle, tag_name, &id_type, status );
@@ -1493,9 +1494,9 @@ mhdf_createSparseTagData( mhdf_FileHandle file_handle,
     return ;
   }
   
-  index_id = mhdf_create_table( tag_id, SPARSE_ENTITY_NAME,
-                                id_type, 1, &count,
-                                status );
+  index_id = mhdf_create_data_table( file_ptr, tag_id, SPARSE_ENTITY_NAME,
+                                     id_type, 1, &count,
+                                     status );
   if (index_id < 0) 
   { 
     H5Gclose( tag_id ); 
@@ -1503,8 +1504,8 @@ mhdf_createSparseTagData( mhdf_FileHandle file_handle,
     return ; 
   }
   
-  data_id = mhdf_create_table( tag_id, SPARSE_VALUES_NAME,
-                               type_id, 1, &count, status );
+  data_id = mhdf_create_data_table( file_ptr, tag_id, SPARSE_VALUES_NAME,
+                                    type_id, 1, &count, status );
   H5Tclose( type_id );
   H5Gclose( tag_id ); 
   if (data_id < 0) 
@@ -1529,6 +1530,7 @@ mhdf_createVarLenTagData( mhdf_FileHandle file_handle,
 {
   hid_t tag_id, index_id, data_id, type_id, offset_id, id_type;
   hsize_t count = (hsize_t)num_entities;
+  FileHandle* file_ptr = (FileHandle*)file_handle;
   API_BEGIN;
   
   tag_id = get_tag( file_handle, tag_name, &id_type, status );
@@ -1546,9 +1548,9 @@ mhdf_createVarLenTagData( mhdf_FileHandle file_handle,
     return ;
   }
   
-  index_id = mhdf_create_table( tag_id, SPARSE_ENTITY_NAME,
-                                id_type, 1, &count,
-                                status );
+  index_id = mhdf_create_data_table( file_ptr, tag_id, SPARSE_ENTITY_NAME,
+                                     id_type, 1, &count,
+                                     status );
   if (index_id < 0) 
   { 
     H5Gclose( tag_id ); 
@@ -1556,9 +1558,9 @@ mhdf_createVarLenTagData( mhdf_FileHandle file_handle,
     return ; 
   }
   
-  offset_id = mhdf_create_table( tag_id, TAG_VAR_INDICES,
-                                 MHDF_INDEX_TYPE, 1, &count,
-                                 status );
+  offset_id = mhdf_create_data_table( file_ptr, tag_id, TAG_VAR_INDICES,
+                                      MHDF_INDEX_TYPE, 1, &count,
+                                      status );
   if (index_id < 0) 
   { 
     H5Dclose( offset_id );
@@ -1568,8 +1570,8 @@ mhdf_createVarLenTagData( mhdf_FileHandle file_handle,
   }
   
   count = (hsize_t)num_values;
-  data_id = mhdf_create_table( tag_id, SPARSE_VALUES_NAME,
-                               type_id, 1, &count, status );
+  data_id = mhdf_create_data_table( file_ptr, tag_id, SPARSE_VALUES_NAME,
+                                    type_id, 1, &count, status );
   H5Tclose( type_id );
   H5Gclose( tag_id ); 
   if (data_id < 0) 
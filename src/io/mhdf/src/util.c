@@ -632,6 +632,51 @@ mhdf_create_table_with_prop( hid_t group_id,
   
 }
 
+hid_t
+mhdf_create_data_table( FileHandle* file_ptr,
+                        hid_t group_id,
+                        const char* path,
+                        hid_t type,
+                        int rank,
+                        hsize_t* dims,
+                        mhdf_Status* status )
+{
+  hid_t prop_id, table_id;
+  hsize_t chunk_dims[2], row_size, rows;
+
+  /* HDF5 does not allow chunked datasets with zero-length dimensions */
+  if (file_ptr->chunk_size <= 0 || rank < 1 || rank > 2 || dims[0] == 0)
+    return mhdf_create_table( group_id, path, type, rank, dims, status );
+
+  row_size = H5Tget_size( type );
+  if (rank > 1)
+    row_size *= dims[1];
+  rows = row_size ? (hsize_t)file_ptr->chunk_size / row_size : 0;
+  if (rows < 1)
+    rows = 1;
+  else if (rows > dims[0])
+    rows = dims[0];
+  chunk_dims[0] = rows;
+  chunk_dims[1] = rank > 1 ? dims[1] : 1;
+
+  prop_id = H5Pcreate( H5P_DATASET_CREATE );
+  if (prop_id < 0 ||
+      H5Pset_chunk( prop_id, rank, chunk_dims ) < 0 ||
+      (file_ptr->shuffle && H5Pset_shuffle( prop_id ) < 0) ||
+      (file_ptr->deflate_level > 0 && 
+        H5Pset_deflate( prop_id, file_ptr->deflate_level ) < 0))
+  {
+    if (prop_id >= 0)
+      H5Pclose( prop_id );
+    mhdf_setFail( status, "Internal error creating chunked dataset properties." );
+    return -1;
+  }
+
+  table_id = mhdf_create_table_with_prop( group_id, path, type, rank, dims, prop_id, status );
+  H5Pclose( prop_id );
+  return table_id;
+}
+
 hid_t
 mhdf_open_table( hid_t group_id,
                  const char* path,
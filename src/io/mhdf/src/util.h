@@ -125,6 +125,18 @@ mhdf_create_table_with_prop( hid_t group,
                    hid_t dataset_creation_prop,
                    mhdf_Status* status );
 
+/* Create a table of bulk data (coordinates, connectivity, tag
+ * values) using the storage layout specified for the file
+ * with mhdf_setDataLayout. */
+hid_t
+mhdf_create_data_table( FileHandle* file_ptr,
+                        hid_t group,
+                        const char* path,
+                        hid_t type,
+                        int rank,
+                        hsize_t* dims,
+                        mhdf_Status* status );
+
 hid_t
 mhdf_open_table( hid_t group,
                  const char* path,
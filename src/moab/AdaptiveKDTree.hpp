@@ -11,6 +11,7 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <math.h>
 
 namespace moab {
@@ -53,6 +54,13 @@ namespace moab {
          * SPLITS_PER_DIR: number of candidate splits considered per direction; default = 3
          * PLANE_SET: method used to decide split planes; see CandidatePlaneSet enum (below)
          *          for possible values; default = 1 (SUBDIVISION_SNAP)
+         * With NUM_THREADS > 1, the split planes are chosen in memory before the tree sets are
+         * created: the candidate planes of the top levels are tested in parallel, then the
+         * subtrees below them are split by separate threads.  The MOAB instance (which must be
+         * a Core) is frozen while the planes are chosen (see Core::freeze.)  The tree sets are
+         * created in the same order as by the serial build, so the tree is the same.  VERTEX_SAMPLE
+         * draws candidate planes from rand(), and is always built serially, as are trees in an
+         * instance that is already frozen.
          * \param entities Entities with which to build the tree
          * \param tree_root Root set for tree (see function description)
          * \param opts Options for tree (see function description)
@@ -281,43 +289,113 @@ namespace moab {
           Range& left_tris,
           Range& right_tris,
           Range& both_tris,
-          double& metric_value );
+          double& metric_value,
+          TreeStats& stats );
+
+        /**\brief Choose the best of a list of candidate split planes
+         *
+         * Candidates with norm < 0 are skipped.  With num_threads > 1, the
+         * candidates are tested in parallel, with the same result.
+         */
+      ErrorCode best_candidate_plane( const std::vector<Plane>& candidates,
+                                      const Range& entities,
+                                      const CartVect& box_min,
+                                      const CartVect& box_max,
+                                      double eps,
+                                      Range& best_left,
+                                      Range& best_right,
+                                      Range& best_both,
+                                      AdaptiveKDTree::Plane& best_plane,
+                                      TreeStats& stats,
+                                      int num_threads );
+
+        //! Choose the split plane of a node with the method set by PLANE_SET
+      ErrorCode choose_split_plane( const Range& entities,
+                                    const CartVect& box_min,
+                                    const CartVect& box_max,
+                                    Range& best_left,
+                                    Range& best_right,
+                                    Range& best_both,
+                                    AdaptiveKDTree::Plane& best_plane,
+                                    std::vector<double>& tmp_data,
+                                    std::vector<EntityHandle>& tmp_data2,
+                                    TreeStats& stats,
+                                    int num_threads );
 
       ErrorCode best_subdivision_snap_plane( int num_planes,
-                                                    const AdaptiveKDTreeIter& iter,
+                                                    const Range& entities,
+                                                    const CartVect& box_min,
+                                                    const CartVect& box_max,
                                                     Range& best_left,
                                                     Range& best_right,
                                                     Range& best_both,
                                                     AdaptiveKDTree::Plane& best_plane,
                                                     std::vector<double>& tmp_data,
-                                                    double eps );
+                                                    double eps,
+                                                    TreeStats& stats,
+                                                    int num_threads );
   
       ErrorCode best_subdivision_plane( int num_planes,
-                                               const AdaptiveKDTreeIter& iter,
+                                               const Range& entities,
+                                               const CartVect& box_min,
+                                               const CartVect& box_max,
                                                Range& best_left,
                                                Range& best_right,
                                                Range& best_both,
                                                AdaptiveKDTree::Plane& best_plane,
-                                               double eps );
+                                               double eps,
+                                               TreeStats& stats,
+                                               int num_threads );
   
       ErrorCode best_vertex_median_plane( int num_planes,
-                                                 const AdaptiveKDTreeIter& iter,
+                                                 const Range& entities,
+                                                 const CartVect& box_min,
+                                                 const CartVect& box_max,
                                                  Range& best_left,
                                                  Range& best_right,
                                                  Range& best_both,
                                                  AdaptiveKDTree::Plane& best_plane,
                                                  std::vector<double>& coords,
-                                                 double eps);
+                                                 double eps,
+                                                 TreeStats& stats,
+                                                 int num_threads );
   
       ErrorCode best_vertex_sample_plane( int num_planes,
-                                                 const AdaptiveKDTreeIter& iter,
+                                                 const Range& entities,
+                                                 const CartVect& box_min,
+                                                 const CartVect& box_max,
                                                  Range& best_left,
                                                  Range& best_right,
                                                  Range& best_both,
                                                  AdaptiveKDTree::Plane& best_plane,
                                                  std::vector<double>& coords,
                                                  std::vector<EntityHandle>& indices,
-                                                 double eps );
+                                                 double eps,
+                                                 TreeStats& stats );
+
+        //! Node of a tree built in memory by parallel_build_tree
+      struct BuildNode;
+
+        //! Build the tree below root with numThreads threads; same tree as the serial build
+      ErrorCode parallel_build_tree( EntityHandle root,
+                                     const Range& entities,
+                                     const BoundBox& box );
+
+        //! Choose the split plane of nodes[index] and, if split, append its children
+      ErrorCode split_build_node( std::deque<BuildNode>& nodes,
+                                  size_t index,
+                                  std::vector<double>& tmp_data,
+                                  std::vector<EntityHandle>& tmp_data2,
+                                  TreeStats& stats,
+                                  int num_threads );
+
+        //! Create the tree sets below handle for nodes[index], in the order of the serial
+        //! build; nodes in subtree_of are replaced by those subtrees
+      ErrorCode create_build_sets( std::deque<BuildNode>& nodes,
+                                   size_t index,
+                                   EntityHandle handle,
+                                   std::vector< std::deque<BuildNode> >* subtrees = 0,
+                                   const std::vector<int>* subtree_of = 0 );
 
       static const char *treeName;
       
@@ -216,9 +216,25 @@ namespace moab {
         }
       }; // TreeNode
 
+      class Subtree {
+    public:
+        Subtree(HandleDataVec::iterator b, HandleDataVec::iterator e, unsigned int n,
+                const BoundBox &bx, int d) : begin(b), end(e), node(n), box(bx), depth(d) {}
+        HandleDataVec::iterator begin, end;
+        unsigned int node;
+        BoundBox box;
+        int depth;
+        std::vector<Node> nodes;
+      }; // Subtree
+
+      void bin_elements(HandleDataVec::const_iterator begin, 
+                        HandleDataVec::const_iterator end, 
+                        const BoundBox &interval, std::vector<std::vector<Bucket> > &buckets) const;
+
       void establish_buckets(HandleDataVec::const_iterator begin, 
                              HandleDataVec::const_iterator end, 
-                             const BoundBox &interval, std::vector<std::vector<Bucket> > &buckets) const;
+                             const BoundBox &interval, std::vector<std::vector<Bucket> > &buckets,
+                             int num_threads = 1) const;
 
       unsigned int set_interval(BoundBox & interval, 
                                 std::vector<Bucket>::const_iterator begin, 
@@ -230,7 +246,8 @@ namespace moab {
 
       void order_elements(HandleDataVec::iterator &begin, 
                           HandleDataVec::iterator &end, 
-                          SplitData &data) const;
+                          SplitData &data,
+                          int num_threads = 1) const;
 
       void median_order(HandleDataVec::iterator &begin, 
                         HandleDataVec::iterator &end, 
@@ -242,7 +259,8 @@ namespace moab {
 
       void find_split(HandleDataVec::iterator &begin, 
                       HandleDataVec::iterator &end, 
-                      SplitData &data) const;
+                      SplitData &data,
+                      int num_threads = 1) const;
 
       ErrorCode find_point(const std::vector<double> &point, 
                            const unsigned int &index,
@@ -254,11 +272,27 @@ namespace moab {
                                    const double iter_tol = 1.0e-10,
                                    const double inside_tol = 1.0e-6);
 
+        // if subtrees is non-NULL, the top levels are split with numThreads threads, and the
+        // nodes at subtree_depth are left to be built as separate subtrees
       int local_build_tree(std::vector<Node> &tree_nodes,
                            HandleDataVec::iterator begin, 
                            HandleDataVec::iterator end,
                            const int index, const BoundBox &box, 
-                           const int depth=0);
+                           const int depth=0,
+                           std::vector<Subtree> *subtrees=NULL,
+                           const int subtree_depth=0);
+
+        // build the tree with numThreads threads; same tree as local_build_tree
+      int parallel_build_tree(std::vector<Node> &tree_nodes,
+                              HandleDataVec &handle_data_vec,
+                              const BoundBox &box);
+
+        // move node src_index and its subtree to dest_index, numbering the nodes below
+        // it as local_build_tree does; nodes in subtree_of are replaced by those subtrees
+      void move_subtree(std::vector<Node> &src, unsigned int src_index,
+                        std::vector<Node> &dest, unsigned int dest_index,
+                        std::vector<Subtree> *subtrees = NULL,
+                        const std::vector<int> *subtree_of = NULL);
 
         // builds up vector of HandleData, which caches elements' bounding boxes
       ErrorCode construct_element_vec(std::vector<HandleData> &handle_data_vec,
@@ -329,18 +363,6 @@ namespace moab {
       return count;
     }
 
-    inline void BVHTree::order_elements(HandleDataVec::iterator &begin, 
-                                        HandleDataVec::iterator &end, 
-                                        SplitData &data) const  
-    {
-      for(HandleDataVec::iterator i = begin; i != end; ++i) 
-      {
-        const int index = Bucket::bucket_index(splitsPerDir, i->myBox, data.boundingBox, data.dim);
-        i->myDim = (index<=data.split)?0:1;
-      }
-      std::sort(begin, end, HandleData_comparator());
-    }
-
     inline void BVHTree::choose_best_split(const std::vector<std::vector<SplitData> > &splits,
                                            SplitData &data) const
     {
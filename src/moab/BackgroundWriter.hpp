@@ -0,0 +1,92 @@
+/**
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#ifndef MOAB_BACKGROUND_WRITER_HPP
+#define MOAB_BACKGROUND_WRITER_HPP
+
+#include "moab/Types.hpp"
+
+namespace moab {
+
+class Interface;
+
+/**\brief Write native (HDF5) checkpoint files in a background thread
+ *
+ * write_file writes the mesh to an in-memory HDF5 file image and
+ * returns as soon as the image is complete.  A background thread then
+ * writes the image to disk, such that the application may continue,
+ * including modifying the mesh, while the disk write is in progress.
+ * The object serves as the handle for the pending write: call wait()
+ * to block until the file is on disk and get the result of the write.
+ * Only one write may be pending at a time: write_file and the
+ * destructor first wait for any pending write to complete.
+ *
+ * The file image requires memory comparable to the size of the file,
+ * in addition to that used by WriteHDF5 to stage the data.
+ *
+ * Parallel writes (any PARALLEL option) are not supported: write_file
+ * fails with MB_NOT_IMPLEMENTED, and the caller should use
+ * Interface::write_file instead.  WriteHDF5Parallel writes the shared
+ * file collectively with MPI-IO, which cannot be redirected to a file
+ * image.  If MOAB is built without HDF5 or pthread support, write_file
+ * is the same as Interface::write_file: the file is written in the
+ * calling thread and wait() returns the result of that write.
+ */
+class BackgroundWriter
+{
+public:
+
+  BackgroundWriter( Interface* iface );
+
+  //! Waits for any pending write to complete
+  ~BackgroundWriter();
+
+  /**\brief Start writing a native file
+   *
+   * Arguments are as for Interface::write_file, except that the file
+   * is always written in the native (.h5m) format.  Returns once the
+   * mesh data has been copied, with any error that occured while copying
+   * it.  Errors writing the file to disk are returned by wait().
+   */
+  ErrorCode write_file( const char* file_name,
+                        const char* options = 0,
+                        const EntityHandle* output_sets = 0,
+                        int num_output_sets = 0,
+                        const Tag* tag_list = 0,
+                        int num_tags = 0 );
+
+  //! Return true if there is no pending write
+  bool is_done();
+
+  /**\brief Wait for the pending write to complete
+   *
+   * Returns the result of writing the file to disk, or MB_SUCCESS if
+   * no write has been started.
+   */
+  ErrorCode wait();
+
+private:
+
+  struct Job;
+  static void* write_job( void* job );
+
+  Interface* mbImpl;
+  Job* pendingJob;
+  ErrorCode lastResult;
+};
+
+} // namespace moab
+
+#endif
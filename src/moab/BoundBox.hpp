@@ -56,11 +56,6 @@ namespace moab {
          */
       double distance(const double *from_point) const;
       
-      BoundBox &operator=(const BoundBox &from) {
-        bMin = from.bMin;
-        bMax = from.bMax;
-        return *this;
-      }
       inline bool operator==(const BoundBox &box) const {
         return (bMin == box.bMin && bMax == box.bMax);
       }
@@ -194,6 +194,14 @@ public:
                                   double* y_coords,
                                   double* z_coords ) const;
 
+  //! get the vertex coordinates of elements in structure-of-arrays form
+  virtual ErrorCode get_element_coords( const Range& elements,
+                                        int nodes_per_elem,
+                                        double* x_coords,
+                                        double* y_coords,
+                                        double* z_coords,
+                                        EntityHandle* connect = 0 ) const;
+
   //! set the coordinate information for this handle if it is of type Vertex
   //! otherwise, return an error
   virtual ErrorCode  set_coords( const EntityHandle *entity_handles, 
@@ -349,11 +357,51 @@ public:
      * \param adjs_ptr Pointer to pointer to const std::vector<EntityHandle>; each member of that array is 
      *                 the vector of adjacencies for this entity
      * \param count Number of entities in the contiguous chunk starting from *iter
+     *\Note Adjacencies stored compactly (see compact_adjacencies) are moved back 
+     *      to per-entity vectors for the contiguous chunk's sequence.
      */
   ErrorCode adjacencies_iterate(Range::const_iterator iter,
                                 Range::const_iterator end,
                                 const std::vector<EntityHandle> **& adjs_ptr,
                                 int& count);
+
+    /**\brief Store adjacency lists compactly
+     *
+     * Create vertex-to-element adjacencies if they do not exist, then move all
+     * adjacency lists from per-entity std::vectors into one offset array and one
+     * handle array per block of entities.  This saves the vector header and heap
+     * allocation for each entity and improves locality of adjacency queries on 
+     * meshes that are no longer being modified.  Lists for entities modified 
+     * afterwards move back to per-entity vectors individually.
+     */
+  ErrorCode compact_adjacencies();
+
+    /**\brief Enter read-only mode for concurrent queries
+     *
+     * Create all data that is otherwise created lazily by queries (e.g.
+     * vertex-to-element adjacencies) and stop caching the most recently
+     * accessed entity sequence, such that the mesh is not modified by
+     * queries.  While frozen, get_coords, get_connectivity, get_adjacencies
+     * (with create_if_missing == false), get_entities_by_*, tag_get_data and
+     * other const queries may be called concurrently from multiple threads.
+     *
+     * Creating vertices or elements (including with ReadUtilIface and 
+     * create_scd_sequence), deleting any entities, changing connectivity or
+     * coordinates, changing explicit adjacencies, and get_adjacencies with 
+     * create_if_missing == true fail while frozen.  Entity sets may still be
+     * created (create_meshset, ReadUtilIface::create_entity_sets), and tag 
+     * data, set contents and set parent/child links may still be modified,
+     * but not concurrently with any other call.  Error messages for failed
+     * queries are not thread-safe.
+     */
+  ErrorCode freeze();
+  
+    /**\brief Leave read-only mode entered with freeze() */
+  void unfreeze();
+  
+    /**\brief Check if in read-only mode entered with freeze() */
+  bool is_frozen() const
+    { return meshFrozen; }
   
       /**\brief Get all vertices for input entities
        *
@@ -1356,6 +1404,7 @@ private:
   ReaderWriterSet* readerWriterSet;
 
   Error* mError;
+  bool meshFrozen;
   bool mpiFinalize;
   int writeMPELog;
   bool initErrorHandlerInCore;
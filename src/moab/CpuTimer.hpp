@@ -7,6 +7,9 @@
 #endif
 
 #include <time.h>
+#ifndef _WIN32
+#  include <sys/time.h>
+#endif
 
 namespace moab 
 {
@@ -36,6 +39,8 @@ public:
   }
   double time_since_birth() { return (tAtLast = runtime()) - tAtBirth; };
   double time_elapsed() { double tmp = tAtLast; return (tAtLast = runtime()) - tmp; }
+    //! Wall clock time in seconds, for timing threaded code
+  static double wall_time();
 };
 
 inline double CpuTimer::runtime()
@@ -49,6 +54,18 @@ inline double CpuTimer::runtime()
     return (double)clock() / CLOCKS_PER_SEC;
 #endif
     }
+
+inline double CpuTimer::wall_time()
+{
+#ifdef _WIN32
+    // clock() is elapsed wall time with the Microsoft C runtime
+  return (double)clock() / CLOCKS_PER_SEC;
+#else
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+#endif
+}
 }
 
 #endif
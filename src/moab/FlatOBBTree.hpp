@@ -0,0 +1,189 @@
+/*
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+/**\file FlatOBBTree.hpp
+ */
+
+#ifndef MOAB_FLAT_OBB_TREE_HPP
+#define MOAB_FLAT_OBB_TREE_HPP
+
+#include "moab/Forward.hpp"
+#include "moab/OrientedBoxTreeTool.hpp"
+
+#include <vector>
+
+namespace moab {
+
+class OrientedBox;
+
+/** \class FlatOBBTree
+ * \brief Read-only, array-based copy of an OBB tree for fast ray queries
+ *
+ * Compiles an existing tree built by OrientedBoxTreeTool into flat
+ * arrays: the node boxes as a structure of arrays, two child indices per
+ * node, and for each leaf a contiguous block of triangles with their
+ * corner handles and coordinates.  Queries on the compiled tree do not
+ * touch the MOAB instance, and return exactly the same results as the
+ * corresponding OrientedBoxTreeTool queries on the original tree.
+ *
+ * The compiled tree is a snapshot: it must be rebuilt if the tree or
+ * the triangle coordinates change.
+ */
+class FlatOBBTree
+{
+  public:
+
+    FlatOBBTree();
+
+    /**\brief Compile an OBB tree
+     *
+     *\param tool      The tool that built the tree
+     *\param root_set  The root of the tree
+     *\param sense_tag Optional surface sense tag.  If given, the senses
+     *                 of the surface sets in the tree are stored, so that
+     *                 ray_intersect_sets may screen intersections by
+     *                 orientation and handle edge/node intersections.
+     */
+    ErrorCode build( OrientedBoxTreeTool* tool,
+                     EntityHandle root_set,
+                     const Tag* sense_tag = 0 );
+
+    //! Free all storage
+    void clear();
+
+    //! True if no tree has been compiled
+    bool empty() const { return 0 == nodeCount; }
+
+    unsigned num_nodes() const { return nodeCount; }
+    unsigned num_triangles() const { return triHandles.size(); }
+
+    //! Approximate storage used by the compiled tree, in bytes
+    unsigned long memory_use() const;
+
+    /**\brief Intersect a ray with the triangles in the tree
+     *
+     * Same as OrientedBoxTreeTool::ray_intersect_sets for the compiled
+     * tree, which takes the place of root_set.  Orientation screening and
+     * edge/node intersection handling are done if geom_vol is given and
+     * the tree was built with a sense tag.
+     */
+    ErrorCode ray_intersect_sets( std::vector<double>&       distances_out,
+                                  std::vector<EntityHandle>& sets_out,
+                                  std::vector<EntityHandle>& facets_out,
+                                  double                     tolerance,
+                                  int                        min_tolerance_intersections,
+                                  const double               ray_point[3],
+                                  const double               unit_ray_dir[3],
+                                  const double*              nonneg_ray_len = 0,
+                                  OrientedBoxTreeTool::TrvStats* accum    = 0,
+                                  const double*              neg_ray_len    = 0,
+                                  const EntityHandle*        geom_vol       = 0,
+                                  const int*                 desired_orient = 0,
+                                  const std::vector<EntityHandle>* prev_facets = 0 ) const;
+
+    /**\brief Intersect a batch of rays with the triangles in the tree
+     *
+     * Same as calling the single-ray ray_intersect_sets for each ray,
+     * with exactly the same results, but the rays are sorted by direction
+     * and traced in packets: each node and triangle of the tree is loaded
+     * once per packet, and the rays that cannot intersect it are screened
+     * out several at a time with SIMD (AVX or SSE2, if enabled at compile
+     * time) slab and Plucker sign tests.  The rays that pass the screening
+     * are given to the exact single-ray tests.
+     *
+     * Per-ray inputs and outputs are arrays of num_rays entries.
+     *\param ray_points      3*num_rays coordinates
+     *\param unit_ray_dirs   3*num_rays direction components
+     *\param nonneg_ray_lens Optional limits, as for the single-ray query
+     *\param neg_ray_lens    Optional limits, as for the single-ray query
+     *\param prev_facets     Optional array of num_rays (possibly null)
+     *                       pointers to facet lists to skip
+     */
+    ErrorCode ray_intersect_sets( unsigned                   num_rays,
+                                  std::vector<double>*       distances_out,
+                                  std::vector<EntityHandle>* sets_out,
+                                  std::vector<EntityHandle>* facets_out,
+                                  double                     tolerance,
+                                  int                        min_tolerance_intersections,
+                                  const double*              ray_points,
+                                  const double*              unit_ray_dirs,
+                                  const double*              nonneg_ray_lens = 0,
+                                  const double*              neg_ray_lens    = 0,
+                                  const EntityHandle*        geom_vol        = 0,
+                                  const int*                 desired_orient  = 0,
+                                  const std::vector<EntityHandle>* const* prev_facets = 0 ) const;
+
+    /**\brief Get the triangles within a distance of a point
+     *
+     * Same as OrientedBoxTreeTool::sphere_intersect_triangles for the
+     * compiled tree.
+     */
+    ErrorCode sphere_intersect_triangles( const double* center,
+                                          double radius,
+                                          std::vector<EntityHandle>& facets_out,
+                                          std::vector<EntityHandle>* sets_out = 0,
+                                          OrientedBoxTreeTool::TrvStats* accum = 0 ) const;
+
+    /**\brief Find the closest triangle in the tree to a point
+     *
+     * Same as OrientedBoxTreeTool::closest_to_location for the compiled
+     * tree, with the same result.
+     */
+    ErrorCode closest_to_location( const double* point,
+                                   double* point_out,
+                                   EntityHandle& facet_out,
+                                   EntityHandle* set_out = 0,
+                                   OrientedBoxTreeTool::TrvStats* accum = 0 ) const;
+
+  private:
+
+    friend class FlatRayIntersectSets;
+    friend class FlatOBBPacket;
+
+    void get_box( unsigned node, OrientedBox& box ) const;
+
+    ErrorCode sphere_intersect_tris( const double* center,
+                                     double radius,
+                                     std::vector<unsigned>& tris_out,
+                                     std::vector<int>* surfs_out,
+                                     OrientedBoxTreeTool::TrvStats* accum ) const;
+
+      //! Number of nodes; node 0 is the root, and nodes are numbered
+      //! in the order of a depth-first traversal
+    unsigned nodeCount;
+      //! Box of each node, as 16 arrays of nodeCount values: center (3),
+      //! axes (9), lengths (3) and outer radius
+    std::vector<double> boxData;
+      //! Two child node indices per node, -1 for leaves
+    std::vector<int> nodeChildren;
+      //! Index in surfSets of the set contained in each node, or -1
+    std::vector<int> nodeSurf;
+      //! Triangles of node i are leafTris[i] to leafTris[i+1]-1
+    std::vector<unsigned> leafTris;
+
+      //! Triangle handles, corner handles (3 per triangle)
+      //! and corner coordinates (9 per triangle)
+    std::vector<EntityHandle> triHandles, triConn;
+    std::vector<double> triCoords;
+
+      //! Surface sets in the tree, and their two sense volumes
+      //! (forward and reverse) if built with a sense tag
+    std::vector<EntityHandle> surfSets, surfSenses;
+    bool haveSenses;
+};
+
+} // namespace moab
+
+#endif
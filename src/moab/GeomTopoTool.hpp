@@ -85,7 +85,16 @@ public:
   
   ErrorCode find_geomsets(Range *ranges = NULL);
 
-  ErrorCode construct_obb_trees(bool make_one_vol = false);
+    /** \brief build OBB trees for all surfaces and volumes
+     *
+     * \param make_one_vol If true, build a single tree for all volumes
+     *        (see get_one_vol_root) instead of one tree per volume
+     * \param settings Optional settings for the surface trees, e.g. to
+     *        build them with a surface area heuristic (see
+     *        OrientedBoxTreeTool::Settings)
+     */
+  ErrorCode construct_obb_trees(bool make_one_vol = false,
+                                const OrientedBoxTreeTool::Settings* settings = 0);
 
   ErrorCode get_root(EntityHandle vol_or_surf, EntityHandle &root);
 
@@ -432,6 +432,37 @@ public:
                                   double* x_coords,
                                   double* y_coords,
                                   double* z_coords ) const = 0;
+
+  /**\brief Get vertex coordinates of elements in structure-of-arrays form.
+   *
+   * Gather the coordinates of the first \c nodes_per_elem vertices of
+   * each element into separate X, Y, and Z arrays, grouped by the index
+   * of the vertex within the element:  the coordinates of the i-th vertex
+   * of the j-th element in \c elements are stored at index 
+   * i*elements.size()+j.  With this layout, a kernel evaluating many
+   * elements of the same type (e.g. a volume or quality measure) can
+   * process consecutive elements in consecutive vector lanes.  The
+   * gather is done in a single pass over element and vertex sequence 
+   * storage, without a handle lookup per vertex.
+   *
+   * For higher-order elements, passing the number of corner vertices
+   * for \c nodes_per_elem returns only the corner vertex coordinates.
+   *\param elements        Elements of any type except polyhedra.  Every
+   *                       element must have at least \c nodes_per_elem
+   *                       vertices.
+   *\param nodes_per_elem  Number of vertices to gather for each element.
+   *\param x_coords        Output: the X coordinates, nodes_per_elem*elements.size() values.
+   *\param y_coords        Output: the Y coordinates, nodes_per_elem*elements.size() values.
+   *\param z_coords        Output: the Z coordinates, nodes_per_elem*elements.size() values.
+   *\param connect         Optional output: the vertex handles, in the same
+   *                       layout as the coordinates.  May be NULL.
+   */
+  virtual ErrorCode get_element_coords( const Range& elements,
+                                        int nodes_per_elem,
+                                        double* x_coords,
+                                        double* y_coords,
+                                        double* z_coords,
+                                        EntityHandle* connect = 0 ) const = 0;
   
   
     //! Sets the xyz coordinates for a vector of vertices
@@ -11,6 +11,12 @@ class AdaptiveKDTree;
 class MergeMesh
 {
 public:
+  //! Method used to find coincident vertices
+  enum SearchMethod {
+    KD_TREE,  //!< point search in an AdaptiveKDTree of the vertices
+    GRID      //!< compare vertices in neighboring cells of a tolerance-sized grid
+  };
+
   /* \brief Constructor
    */
   MergeMesh(Interface *mbImpl, bool printErrorIn = true);
@@ -19,6 +25,23 @@ public:
    */
   virtual ~MergeMesh();
 
+  /* \brief Select method used to find coincident vertices (default: KD_TREE)
+   *
+   * The GRID method bins vertices in cells of edge length equal to the merge
+   * tolerance, sorts the cell keys, and compares each vertex only to those
+   * in the same and neighboring cells.  It uses no tree and can use multiple
+   * OpenMP threads (see set_num_threads.)  For each group of coincident
+   * vertices, both methods keep the vertex encountered first; for GRID
+   * that is the one with the lowest handle.
+   */
+  void set_search_method(SearchMethod method) { searchMethod = method; }
+
+  SearchMethod get_search_method() const { return searchMethod; }
+
+  /* \brief Number of OpenMP threads used by the GRID method (default: 1)
+   */
+  void set_num_threads(int num_threads) { numThreads = num_threads; }
+
   /* \brief Merge vertices in elements passed in
    */
   ErrorCode merge_entities(EntityHandle *elems, int elems_size,
@@ -49,6 +72,13 @@ private:
   ErrorCode find_merged_to(EntityHandle &tree_root,
       AdaptiveKDTree &tree, Tag merged_to);
 
+  //- using a grid of tolerance-sized cells, set tag on vertices
+  //- to the vertices to which they should be merged
+  ErrorCode find_merged_to_grid(const Range &verts, Tag merged_to);
+
+  //- find vertices to merge using the selected search method
+  ErrorCode find_merged_to(const Range &verts, Tag merged_to);
+
   Interface *mbImpl;
 
   //- the tag pointing to the entity to which an entity will be merged
@@ -64,6 +94,10 @@ private:
 
   //Allow a warning to be suppressed when no merging is done
   bool printError;
+
+  SearchMethod searchMethod;
+
+  int numThreads;
 };
 
 }
@@ -71,6 +71,18 @@ class OrientedBoxTreeTool
      * at least Settings::best_split_ratio .  Giving Settings::best_split_ratio
      * a non-zero value gives preference to a split orthogonal to larger
      * box dimensions.
+     *
+     * If Settings::sah_bins is non-zero, the node is instead subdivided
+     * with a binned surface area heuristic (SAH): the entity centroids are
+     * sorted into sah_bins bins along each box axis, and the plane between
+     * two bins that minimizes \f$n_L A_L + n_R A_R\f$ is chosen, where
+     * \f$A_L\f$ and \f$A_R\f$ are the surface areas of the bounding boxes
+     * (in the frame of the node box) of the entities on each side.  This
+     * gives better trees than the center planes for meshes with widely
+     * varying element sizes, such as CAD-derived faceted models.  The
+     * ratios are not used for an SAH split, and the center planes are
+     * used only if no plane separates the centroids.  Settings::sah_bins
+     * does not affect join_trees.
      */
     struct Settings {
       public:
@@ -88,6 +100,9 @@ class OrientedBoxTreeTool
         double best_split_ratio;
         //! Flags used to create entity sets representing tree nodes
         unsigned int set_options;
+        //! Number of bins per axis for a surface area heuristic split,
+        //! or zero (the default) to split at the box center
+        int sah_bins;
         //! Check if settings are valid.
         bool valid() const;
     };
@@ -177,6 +192,8 @@ class OrientedBoxTreeTool
         void end_traversal( unsigned depth );
 
       friend class OrientedBoxTreeTool;
+      friend class FlatOBBTree;
+      friend class FlatRayIntersectSets;
 
     };
 
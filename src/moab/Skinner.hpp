@@ -45,15 +45,31 @@ protected:
   Tag mDeletableMBTag;
   Tag mAdjTag;
   int mTargetDim;
+  int mNumThreads;
 
 public:
   //! constructor, takes mdb instance
   Skinner(Interface* mdb) 
-    : thisMB(mdb), mDeletableMBTag(0), mAdjTag(0), mTargetDim(0) {}
+    : thisMB(mdb), mDeletableMBTag(0), mAdjTag(0), mTargetDim(0), mNumThreads(0) {}
 
   //! destructor
   ~Skinner();
 
+    /**\brief Set number of threads used to skin surface and volume meshes
+     *
+     * If zero (the default), skin is found by walking vertex-to-element
+     * adjacencies.  Otherwise the skin of faces or regions with explicit
+     * connectivity (not polygons, polyhedra or structured blocks) is found by
+     * matching the sorted corner vertices of element sides, with the elements
+     * partitioned over \c num_threads OpenMP threads.  Without OpenMP the
+     * partitions are processed in the calling thread.  The skin returned is
+     * the same for either algorithm, except that any new skin entities are
+     * created in order of element handle and side number.
+     */
+  void set_num_threads( int num_threads ) { mNumThreads = num_threads; }
+  
+  int get_num_threads() const { return mNumThreads; }
+
   ErrorCode find_geometric_skin(const EntityHandle meshset, Range &forward_target_entities);
   
     /**\brief will accept entities all of one dimension and 
@@ -265,6 +281,24 @@ protected:
                                      bool create_faces = false,
                                      bool corners_only = false );
 
+  /**\brief Skin faces or regions by matching sides in parallel
+   *
+   * Find the sides of the passed elements that are not shared with any
+   * other element in the list by hashing sorted side corners over
+   * mNumThreads threads.  Arguments are as for find_skin_vertices_3D.
+   *\param supported Output: false if the elements could not be skinned
+   *                  this way (polygons, polyhedra or structured mesh), in
+   *                  which case nothing is done.
+   */
+  ErrorCode find_skin_threaded( const EntityHandle this_set,
+                                const Range& entities,
+                                Range* skin_verts,
+                                Range* skin_sides,
+                                Range* reversed_sides,
+                                bool create_sides,
+                                bool corners_only,
+                                bool& supported );
+
   ErrorCode create_side(const EntityHandle this_set, EntityHandle element,
                            EntityType side_type,
                            const EntityHandle* side_corners,
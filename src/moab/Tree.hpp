@@ -56,6 +56,8 @@ namespace moab {
          *          ENTITY_SET_PROPERTY (see Types.hpp); default = MESHSET_SET
          * CLEAN_UP: if false, do not delete tree sets upon tree class destruction; default = true
          * TAG_NAME: tag name to store tree information on tree nodes; default determined by tree type
+         * NUM_THREADS: number of OpenMP threads used to build the tree, if MOAB was built with
+         *          OpenMP; the tree is the same for any number of threads; default = 1
          * \param entities Entities with which to build the tree
          * \param tree_root Root set for tree (see function description)
          * \param opts Options for tree (see function description)
@@ -154,6 +156,9 @@ namespace moab {
         /** \brief Get max entities per leaf set on tree */
       double get_max_per_leaf() {return maxPerLeaf;}
 
+        /** \brief Set number of OpenMP threads used by build_tree (same as NUM_THREADS option) */
+      void set_num_threads(int num_threads) {numThreads = num_threads;}
+
         /** \brief Get tree traversal stats object */
       TreeStats &tree_stats() {return treeStats;}
       
@@ -218,6 +223,9 @@ namespace moab {
         // clean up flag
       bool cleanUp;
 
+        // number of threads used to build the tree
+      int numThreads;
+
         // tree root
       EntityHandle myRoot;
 
@@ -236,7 +244,7 @@ namespace moab {
 
     inline Tree::Tree(Interface* iface) 
             : mbImpl(iface), maxPerLeaf(6), maxDepth(30), treeDepth(-1), minWidth(1.0e-10),
-              meshsetFlags(0), cleanUp(true), myRoot(0), boxTag(0), myEval(0)
+              meshsetFlags(0), cleanUp(true), numThreads(1), myRoot(0), boxTag(0), myEval(0)
     {}
 
     inline Tree::~Tree() 
@@ -180,9 +180,23 @@ namespace moab
       uint idx[n]  : the sorted indices (output)
       sort_data work[2*n]: scratch area
 
+      Digits that are the same for all keys (e.g. the high bytes of 64-bit
+      handles or ids) are skipped.  If the tuples consist of the key only,
+      the keys are sorted directly, without computing a permutation.  With
+      more than one thread (see set_num_threads), large lists are sorted
+      with a parallel radix sort; the result is the same.
+
       ----------------------------------------------------------------------------*/
     ErrorCode sort(uint key, TupleList::buffer *buf);
 
+    /**Set the number of threads used by sort (default 1).  Has an
+     * effect only if MOAB was built with OpenMP.
+     */
+    void set_num_threads(unsigned num_threads)
+      { numThreads = num_threads ? num_threads : 1; }
+
+    unsigned get_num_threads() const { return numThreads; }
+
     /**Frees all allocated memory in use by the TupleList
      */
     void reset();
@@ -302,6 +316,8 @@ namespace moab
     //Whether or not the object is currently allowing direct
     //write access to the arrays
     bool writeEnabled;
+    //Number of threads used by sort
+    unsigned numThreads;
 
     typedef uint Index;
 
@@ -323,7 +339,8 @@ namespace moab
     static void radix_offsets(Index *c);
 
     template<class Value>
-    static unsigned radix_zeros(Value bitorkey, Index count[DIGITS][DIGIT_VALUES],
+    static unsigned radix_zeros(Value bitorkey, Index n,
+				Index count[DIGITS][DIGIT_VALUES],
 				unsigned *shift, Index **offsets);
 
     template<class Value> 
@@ -367,9 +384,42 @@ namespace moab
     static void merge_index_sort(const Value *A, const Index An, Index stride,
 				 Index *idx, SortData<Value> *work);
 
+    /*------------------------------------------------------------------------------
+
+  
+      Parallel Radix Sort
+
+      each thread counts and scatters a contiguous chunk of the input;
+      stable; same result as radix_index_sort
+
+      ----------------------------------------------------------------------------*/
+    template<class Value>
+    static void radix_index_sort_mt(const Value *A, Index n, Index stride,
+				    Index *idx, SortData<Value> *work,
+				    unsigned num_threads);
+
     template<class Value>
     static void index_sort(const Value *A, Index n, Index stride,
-			   Index *idx, SortData<Value> *work);
+			   Index *idx, SortData<Value> *work,
+			   unsigned num_threads);
+
+    /*------------------------------------------------------------------------------
+
+  
+      Key-only Radix Sort
+
+      sorts the contiguous values A[n] in place
+
+      ----------------------------------------------------------------------------*/
+    template<class Value>
+    static void radix_sort(Value *A, Index n, Value *work,
+			   unsigned num_threads);
+
+    template<class Value>
+    static unsigned radix_thread_digits(Index *counts, unsigned num_threads,
+					Index n, unsigned *shift);
+
+    static void radix_thread_offsets(Index *counts, unsigned num_threads);
 
 
 #undef DIGIT_BITS
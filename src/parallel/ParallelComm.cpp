@@ -49,6 +49,10 @@ namespace moab {
 
   const int MAX_BCAST_SIZE = (1 << 28);
 
+  // Max # entities whose coordinates or connectivity are translated at once
+  // when packing; bounds the temporary storage needed for large sequences
+  const int PACK_CHUNK_SIZE = 4096;
+
   std::vector<ParallelComm::Buffer*> msgs;
   unsigned int __PACK_num = 0, __UNPACK_num = 0, __PACK_count = 0, __UNPACK_count = 0;
   std::string __PACK_string, __UNPACK_string;
@@ -281,13 +285,57 @@ namespace moab {
    */
 #define PARALLEL_COMM_TAG_NAME "__PARALLEL_COMM"
 
+  struct ParallelComm::PendingExchange
+  {
+    enum { GHOST_CELLS, TAGS } type;
+
+    // Common to ghost and tag exchange
+    std::vector<MPI_Request> recvReqs;
+    int incoming1;
+    int ackBuff;
+
+    // Ghost exchange
+    bool isIface, storeRemoteHandles, waitAll;
+    EntityHandle fileSet;
+    std::vector<MPI_Request> recvRemotehReqs;
+    int incoming2;
+    Range allsent;
+    std::vector<std::vector<EntityHandle> > L1hloc, L1hrem;
+    std::vector<std::vector<int> > L1p;
+    std::vector<EntityHandle> L2hloc, L2hrem;
+    std::vector<unsigned int> L2p;
+    std::vector<EntityHandle> newEnts;
+
+    // Tag exchange
+    std::vector<Tag> srcTags, dstTags;
+    Range entities;
+
+    PendingExchange()
+      : incoming1(0), ackBuff(0), isIface(false), storeRemoteHandles(false),
+        waitAll(true), fileSet(0), incoming2(0)
+      {}
+  };
+
+  // Delete pending exchange state when leaving scope, unless released
+  template <typename T> class DeleteOnExit
+  {
+    T*& ptr;
+    bool keep;
+  public:
+    DeleteOnExit(T*& p) : ptr(p), keep(false) {}
+    ~DeleteOnExit() { if (!keep) { delete ptr; ptr = NULL; } }
+    void release() { keep = true; }
+  };
+
   ParallelComm::ParallelComm(Interface *impl, MPI_Comm cm, int* id)
     : mbImpl(impl), procConfig(cm),
       sharedpTag(0), sharedpsTag(0),
       sharedhTag(0), sharedhsTag(0), pstatusTag(0), ifaceSetsTag(0),
       partitionTag(0), globalPartCount(-1), partitioningSet(0),
       myDebug(NULL),
-      sharedSetData(new SharedSetData(*impl, procConfig.proc_rank()))
+      sharedSetData(new SharedSetData(*impl, procConfig.proc_rank())),
+      hierResolve(false), hierRanksPerNode(0),
+      pendingExchange(NULL)
   {
     initialize();
 
@@ -304,7 +352,9 @@ namespace moab {
       sharedhTag(0), sharedhsTag(0), pstatusTag(0), ifaceSetsTag(0),
       partitionTag(0), globalPartCount(-1), partitioningSet(0),
       myDebug(NULL),
-      sharedSetData(new SharedSetData(*impl, procConfig.proc_rank()))
+      sharedSetData(new SharedSetData(*impl, procConfig.proc_rank())),
+      hierResolve(false), hierRanksPerNode(0),
+      pendingExchange(NULL)
   {
     initialize();
 
@@ -318,6 +368,7 @@ namespace moab {
     delete_all_buffers();
     delete myDebug;
     delete sharedSetData;
+    delete pendingExchange;
   }
 
   void ParallelComm::initialize() 
@@ -1454,9 +1505,17 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       PACK_INT(buff->buff_ptr, ((int) MBVERTEX));
       PACK_INT(buff->buff_ptr, ((int) num_ents));
 
-      std::vector<double> tmp_coords(3*num_ents);
-      result = mbImpl->get_coords(these_ents, &tmp_coords[0]);MB_CHK_SET_ERR(result, "Failed to get vertex coordinates");
-      PACK_DBLS(buff->buff_ptr, &tmp_coords[0], 3*num_ents);
+      // Pack coordinates in chunks of contiguous handles
+      std::vector<double> tmp_coords(3*std::min(num_ents, (unsigned int)PACK_CHUNK_SIZE));
+      for (Range::const_pair_iterator pit = these_ents.const_pair_begin();
+           pit != these_ents.const_pair_end(); ++pit) {
+        for (EntityHandle h = pit->first; h <= pit->second; h += PACK_CHUNK_SIZE) {
+          EntityHandle last = std::min(pit->second, h + PACK_CHUNK_SIZE - 1);
+          Range chunk(h, last);
+          result = mbImpl->get_coords(chunk, &tmp_coords[0]);MB_CHK_SET_ERR(result, "Failed to get vertex coordinates");
+          PACK_DBLS(buff->buff_ptr, &tmp_coords[0], 3*chunk.size());
+        }
+      }
 
       myDebug->tprintf(4, "Packed %lu ents of type %s\n", (unsigned long)these_ents.size(),
                        CN::EntityTypeName(TYPE_FROM_HANDLE(*these_ents.begin())));
@@ -1628,16 +1687,43 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     PACK_INT(buff->buff_ptr, nodes_per_entity);
     myDebug->tprintf(3, "after some pack int  %d \n", buff->get_current_size() );
 
-    // Pack the connectivity
-    std::vector<EntityHandle> connect;
+    // Pack the connectivity, in chunks of contiguous handles; where the
+    // sequence stores connectivity in an array, translate handles directly
+    // from that array
+    std::vector<EntityHandle> connect, remote_connect;
+    remote_connect.reserve(nodes_per_entity*std::min(these_ents.size(), (size_t)PACK_CHUNK_SIZE));
     ErrorCode result = MB_SUCCESS;
-    for (Range::const_iterator rit = these_ents.begin(); rit != these_ents.end(); ++rit) {
-      connect.clear();
-      result = mbImpl->get_connectivity(&(*rit), 1, connect, false);MB_CHK_SET_ERR(result, "Failed to get connectivity");
-      assert((int)connect.size() == nodes_per_entity);
-      result = get_remote_handles(store_remote_handles, &connect[0], &connect[0],
-                                  connect.size(), to_proc, entities_vec);MB_CHK_SET_ERR(result, "Failed in get_remote_handles");
-      PACK_EH(buff->buff_ptr, &connect[0], connect.size());
+    for (Range::const_pair_iterator pit = these_ents.const_pair_begin();
+         pit != these_ents.const_pair_end(); ++pit) {
+      EntityHandle h = pit->first;
+      while (h <= pit->second) {
+        EntitySequence *seq;
+        result = sequenceManager->find(h, seq);MB_CHK_SET_ERR(result, "Failed to find entity sequence");
+        ElementSequence *eseq = static_cast<ElementSequence*>(seq);
+        assert((int)eseq->nodes_per_element() == nodes_per_entity);
+        EntityHandle last = std::min(pit->second, eseq->end_handle());
+        last = std::min(last, h + PACK_CHUNK_SIZE - 1);
+        const int num_conn = nodes_per_entity*(last - h + 1);
+
+        EntityHandle *conn = eseq->get_connectivity_array();
+        if (conn)
+          conn += nodes_per_entity*(h - eseq->start_handle());
+        else {
+          // No connectivity array (e.g. structured elements)
+          std::vector<EntityHandle> handles;
+          for (EntityHandle eh = h; eh <= last; ++eh)
+            handles.push_back(eh);
+          result = mbImpl->get_connectivity(&handles[0], handles.size(), connect, false);MB_CHK_SET_ERR(result, "Failed to get connectivity");
+          assert((int)connect.size() == num_conn);
+          conn = &connect[0];
+        }
+
+        remote_connect.resize(num_conn);
+        result = get_remote_handles(store_remote_handles, conn, &remote_connect[0],
+                                    num_conn, to_proc, entities_vec);MB_CHK_SET_ERR(result, "Failed in get_remote_handles");
+        PACK_EH(buff->buff_ptr, &remote_connect[0], num_conn);
+        h = last + 1;
+      }
     }
 
     myDebug->tprintf(3, "Packed %lu ents of type %s\n", (unsigned long)these_ents.size(),
@@ -1913,21 +1999,38 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
         UNPACK_INT(buff_ptr, verts_per_entity);
       }
 
+      //=======================================
+      // First find existing entities for this batch, so the new ones can
+      // be created all at once
+      //=======================================
       std::vector<int> ps(MAX_SHARING_PROCS, -1);
       std::vector<EntityHandle> hs(MAX_SHARING_PROCS, 0);
-      for (int e = 0; e < num_ents2; e++) {
-        // Check for existing entity, otherwise make new one
-        EntityHandle new_h = 0;
-        EntityHandle connect[CN::MAX_NODES_PER_ELEMENT];
-        double coords[3];
-        int num_ps = -1;
-
-        //=======================================
-        // Unpack all the data at once, to make sure the buffer pointers
-        // are tracked correctly
-        //=======================================
+      std::vector<EntityHandle> batch_h(num_ents2, 0);
+      std::vector<bool> batch_created(num_ents2, false);
+      std::vector<EntityHandle> batch_connect;
+      unsigned char *batch_save = buff_save, *batch_data = buff_ptr;
+      int num_new = is_iface ? 0 : num_ents2;
+      if (MBVERTEX != this_type) {
+        assert(verts_per_entity <= CN::MAX_NODES_PER_ELEMENT);
         if (store_remote_handles) {
+          batch_connect.resize(num_ents2*verts_per_entity);
+          if (num_ents2) {
+            UNPACK_EH(buff_ptr, &batch_connect[0], batch_connect.size());
+
+            // Update connectivity to local handles
+            result = get_local_handles(&batch_connect[0], batch_connect.size(), msg_ents);MB_CHK_SET_ERR(result, "Failed to get local handles");
+          }
+        }
+        else
+          buff_ptr += num_ents2*verts_per_entity*sizeof(EntityHandle);
+      }
+      else
+        buff_ptr += 3*num_ents2*sizeof(double);
+
+      if (store_remote_handles) {
+        for (int e = 0; e < num_ents2; e++) {
           // Pointers to other procs/handles
+          int num_ps = -1;
           UNPACK_INT(buff_save, num_ps);
           if (0 >= num_ps) {
             std::cout << "Shouldn't ever be fewer than 1 procs here." << std::endl;
@@ -1936,56 +2039,87 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
 
           UNPACK_INTS(buff_save, &ps[0], num_ps);
           UNPACK_EH(buff_save, &hs[0], num_ps);
-        }
 
-        if (MBVERTEX == this_type) {
-          UNPACK_DBLS(buff_ptr, coords, 3);
-        }
-        else {
-          assert(verts_per_entity <= CN::MAX_NODES_PER_ELEMENT);
-          UNPACK_EH(buff_ptr, connect, verts_per_entity);
-
-          // Update connectivity to local handles
-          result = get_local_handles(connect, verts_per_entity, msg_ents);MB_CHK_SET_ERR(result, "Failed to get local handles");
-        }
-
-        //=======================================
-        // Now, process that data; begin by finding an identical
-        // entity, if there is one
-        //=======================================
-        if (store_remote_handles) {
-          result = find_existing_entity(is_iface, ps[0], hs[0], num_ps, 
-                                        connect, verts_per_entity,
+          result = find_existing_entity(is_iface, ps[0], hs[0], num_ps,
+                                        (MBVERTEX == this_type ? NULL : &batch_connect[e*verts_per_entity]),
+                                        verts_per_entity,
                                         this_type,
                                         L2hloc, L2hrem, L2p,
-                                        new_h);MB_CHK_SET_ERR(result, "Failed to get existing entity");
+                                        batch_h[e]);MB_CHK_SET_ERR(result, "Failed to get existing entity");
+          if (batch_h[e] && !is_iface)
+            num_new--;
         }
+      }
 
-        //=======================================
-        // If we didn't find one, we'll have to create one
-        //=======================================
-        bool created_here = false;
-        if (!new_h && !is_iface) {
-          if (MBVERTEX == this_type) {
-            // Create a vertex
-            result = mbImpl->create_vertex(coords, new_h);MB_CHK_SET_ERR(result, "Failed to make new vertex");
+      //=======================================
+      // Create the new entities in one sequence, decoding coordinates or
+      // connectivity into it
+      //=======================================
+      if (num_new) {
+        EntityHandle start_h = 0;
+        if (MBVERTEX == this_type) {
+          std::vector<double*> arrays;
+          result = ru->get_node_coords(3, num_new, 0, start_h, arrays);MB_CHK_SET_ERR(result, "Failed to make new vertices");
+          double coords[3];
+          for (int e = 0, k = 0; e < num_ents2; e++) {
+            if (batch_h[e])
+              continue;
+            unsigned char *coords_ptr = batch_data + 3*e*sizeof(double);
+            UNPACK_DBLS(coords_ptr, coords, 3);
+            arrays[0][k] = coords[0];
+            arrays[1][k] = coords[1];
+            arrays[2][k] = coords[2];
+            k++;
+          }
+        }
+        else {
+          EntityHandle *conn = NULL;
+          result = ru->get_element_connect(num_new, verts_per_entity, this_type,
+                                           0, start_h, conn);MB_CHK_SET_ERR(result, "Failed to make new elements");
+          if (num_new == num_ents2 && !store_remote_handles) {
+            // All new, decode straight into the sequence
+            unsigned char *conn_ptr = batch_data;
+            UNPACK_EH(conn_ptr, conn, num_new*verts_per_entity);
+            result = get_local_handles(conn, num_new*verts_per_entity, msg_ents);MB_CHK_SET_ERR(result, "Failed to get local handles");
           }
           else {
-            // Create the element
-            result = mbImpl->create_element(this_type, connect, verts_per_entity,
-                                            new_h);MB_CHK_SET_ERR(result, "Failed to make new element");
-
-            // Update adjacencies
-            result = ru->update_adjacencies(new_h, 1, verts_per_entity,
-                                            connect);MB_CHK_SET_ERR(result, "Failed to update adjacencies");
+            EntityHandle *conn_end = conn;
+            for (int e = 0; e < num_ents2; e++) {
+              if (batch_h[e])
+                continue;
+              std::copy(&batch_connect[e*verts_per_entity], &batch_connect[(e + 1)*verts_per_entity],
+                        conn_end);
+              conn_end += verts_per_entity;
+            }
           }
 
-          // Should have a new handle now
-          assert(new_h);
+          // Update adjacencies
+          result = ru->update_adjacencies(start_h, num_new, verts_per_entity,
+                                          conn);MB_CHK_SET_ERR(result, "Failed to update adjacencies");
+        }
 
-          created_here = true;
+        for (int e = 0; e < num_ents2; e++)
+          if (!batch_h[e]) {
+            batch_h[e] = start_h++;
+            batch_created[e] = true;
+          }
+      }
+
+      //=======================================
+      // Then take care of sharing data for each entity
+      //=======================================
+      buff_save = batch_save;
+      for (int e = 0; e < num_ents2; e++) {
+        EntityHandle new_h = batch_h[e];
+        int num_ps = -1;
+        if (store_remote_handles) {
+          UNPACK_INT(buff_save, num_ps);
+          UNPACK_INTS(buff_save, &ps[0], num_ps);
+          UNPACK_EH(buff_save, &hs[0], num_ps);
         }
 
+        bool created_here = batch_created[e];
+
         //=======================================
         // Take care of sharing data
         //=======================================
@@ -3718,74 +3852,20 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       MB_SET_ERR(MB_FAILURE, "Unsupported id tag");
     }
 
-    // Put handles in vector for passing to gs setup
-    std::vector<Ulong> handle_vec; // Assumes that we can do conversion from Ulong to EntityHandle
-    std::copy(skin_ents[0].begin(), skin_ents[0].end(),
-              std::back_inserter(handle_vec));
-
 #ifdef MOAB_HAVE_MPE
     if (myDebug->get_verbosity() == 2) {
       MPE_Log_event(SHAREDV_START, procConfig.proc_rank(), "Creating crystal router.");
     }
 #endif
 
-    // Get a crystal router
-    gs_data::crystal_data *cd = procConfig.crystal_router();
-
-    /*  
-    // Get total number of entities; will overshoot highest global id, but
-    // that's OK
-    int num_total[2] = {0, 0}, num_local[2] = {0, 0};
-    result = mbImpl->get_number_entities_by_dimension(this_set, 0, num_local);
-    if (MB_SUCCESS != result)return result;
-    int failure = MPI_Allreduce(num_local, num_total, 1,
-    MPI_INTEGER, MPI_SUM, procConfig.proc_comm());
-    if (failure) {
-      MB_SET_ERR(MB_FAILURE, "Allreduce for total number of shared ents failed");
-    }
-    */
-    // Call gather-scatter to get shared ids & procs
-    gs_data *gsd = new gs_data();
-   // assert(sizeof(ulong_) == sizeof(EntityHandle));
-    result = gsd->initialize(skin_ents[0].size(), &lgid_data[0],
-                              &handle_vec[0], 2, 1, 1, cd);MB_CHK_SET_ERR(result, "Failed to create gs data");
-
-    // Get shared proc tags
-    Tag shp_tag, shps_tag, shh_tag, shhs_tag, pstat_tag;
-    result = get_shared_proc_tags(shp_tag, shps_tag,
-                                  shh_tag, shhs_tag, pstat_tag);MB_CHK_SET_ERR(result, "Failed to get shared proc tags");
-
-    // Load shared verts into a tuple, then sort by index
+    // Find sharing procs and remote handles of skin vertices:
+    // (index in skin_ents[0], sharing proc; remote handle), sorted by index
     TupleList shared_verts;
-    shared_verts.initialize(2, 0, 1, 0, 
-                            skin_ents[0].size()*(MAX_SHARING_PROCS + 1));
-    shared_verts.enableWriteAccess();
-
-    unsigned int i = 0, j = 0;
-    for (unsigned int p = 0; p < gsd->nlinfo->_np; p++)
-      for (unsigned int np = 0; np < gsd->nlinfo->_nshared[p]; np++) {
-        shared_verts.vi_wr[i++] = gsd->nlinfo->_sh_ind[j];
-        shared_verts.vi_wr[i++] = gsd->nlinfo->_target[p];
-        shared_verts.vul_wr[j] = gsd->nlinfo->_ulabels[j];
-        j++;
-        shared_verts.inc_n();
-      }
-
-    myDebug->tprintf(3, " shared verts size %d \n", (int)shared_verts.get_n());
-
-
-    int max_size = skin_ents[0].size()*(MAX_SHARING_PROCS + 1);
-    moab::TupleList::buffer sort_buffer;
-    sort_buffer.buffer_init(max_size);
-    shared_verts.sort(0, &sort_buffer);
-    sort_buffer.reset();
-
-    // Set sharing procs and handles tags on skin ents
-    int maxp = -1;
-    std::vector<int> sharing_procs(MAX_SHARING_PROCS);
-    std::fill(sharing_procs.begin(), sharing_procs.end(), maxp);
-    j = 0;
-    i = 0;
+    if (hierResolve && skin_dim > 0)
+      result = get_shared_verts_hierarchical(skin_ents, skin_dim, lgid_data, shared_verts);
+    else
+      result = get_shared_verts(skin_ents, lgid_data, shared_verts);
+    MB_CHK_SET_ERR(result, "Failed to get sharing procs of skin vertices");
 
     // Get ents shared by 1 or n procs
     std::map<std::vector<int>, std::vector<EntityHandle> > proc_nvecs;
@@ -3839,9 +3919,6 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     // Now build parent/child links for interface sets
     result = create_iface_pc_links();MB_CHK_SET_ERR(result, "Failed to create interface parent/child links");
 
-    gsd->reset();
-    delete gsd;
-
 #ifdef MOAB_HAVE_MPE
     if (myDebug->get_verbosity() == 2) {
       MPE_Log_event(RESOLVE_END, procConfig.proc_rank(), "Exiting resolve_shared_ents.");
@@ -3856,6 +3933,297 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     return result;
   }
 
+  ErrorCode ParallelComm::get_shared_verts(Range *skin_ents,
+                                           std::vector<long> &lgid_data,
+                                           TupleList &shared_verts)
+  {
+    // Put handles in vector for passing to gs setup
+    std::vector<Ulong> handle_vec; // Assumes that we can do conversion from Ulong to EntityHandle
+    std::copy(skin_ents[0].begin(), skin_ents[0].end(),
+              std::back_inserter(handle_vec));
+
+    // Get a crystal router
+    gs_data::crystal_data *cd = procConfig.crystal_router();
+
+    // Call gather-scatter to get shared ids & procs
+    gs_data gsd;
+    ErrorCode result = gsd.initialize(skin_ents[0].size(), &lgid_data[0],
+                                      &handle_vec[0], 2, 1, 1, cd);MB_CHK_SET_ERR(result, "Failed to create gs data");
+
+    // Load shared verts into a tuple, then sort by index
+    shared_verts.initialize(2, 0, 1, 0, 
+                            skin_ents[0].size()*(MAX_SHARING_PROCS + 1));
+    shared_verts.enableWriteAccess();
+
+    unsigned int i = 0, j = 0;
+    for (unsigned int p = 0; p < gsd.nlinfo->_np; p++)
+      for (unsigned int np = 0; np < gsd.nlinfo->_nshared[p]; np++) {
+        shared_verts.vi_wr[i++] = gsd.nlinfo->_sh_ind[j];
+        shared_verts.vi_wr[i++] = gsd.nlinfo->_target[p];
+        shared_verts.vul_wr[j] = gsd.nlinfo->_ulabels[j];
+        j++;
+        shared_verts.inc_n();
+      }
+
+    myDebug->tprintf(3, " shared verts size %d \n", (int)shared_verts.get_n());
+
+    int max_size = skin_ents[0].size()*(MAX_SHARING_PROCS + 1);
+    moab::TupleList::buffer sort_buffer;
+    sort_buffer.buffer_init(max_size);
+    shared_verts.sort(0, &sort_buffer);
+    sort_buffer.reset();
+
+    return MB_SUCCESS;
+  }
+
+  ErrorCode ParallelComm::get_shared_verts_hierarchical(Range *skin_ents,
+                                                        int skin_dim,
+                                                        std::vector<long> &lgid_data,
+                                                        TupleList &shared_verts)
+  {
+    int rank = procConfig.proc_rank();
+    const int size = procConfig.proc_size();
+    const size_t num_verts = skin_ents[0].size();
+    ErrorCode result;
+
+    // Group procs into nodes; ranks on a node are in the order of world ranks
+    MPI_Comm node_comm;
+    int success;
+    if (hierRanksPerNode > 0)
+      success = MPI_Comm_split(procConfig.proc_comm(), rank / hierRanksPerNode,
+                               rank, &node_comm);
+    else
+#if MPI_VERSION >= 3
+      success = MPI_Comm_split_type(procConfig.proc_comm(), MPI_COMM_TYPE_SHARED,
+                                    rank, MPI_INFO_NULL, &node_comm);
+#else
+      success = MPI_Comm_split(procConfig.proc_comm(), rank, 0, &node_comm);
+#endif
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to create node communicator");
+    }
+    // Free node_comm on every return; MPI_Comm_free resets it to MPI_COMM_NULL
+    struct CommGuard {
+      MPI_Comm& comm;
+      CommGuard(MPI_Comm& c) : comm(c) {}
+      ~CommGuard() { if (MPI_COMM_NULL != comm) MPI_Comm_free(&comm); }
+    } node_comm_guard(node_comm);
+    int node_size;
+    MPI_Comm_size(node_comm, &node_size);
+    std::vector<int> node_procs(node_size);
+    MPI_Allgather(&rank, 1, MPI_INT, &node_procs[0], 1, MPI_INT, node_comm);
+    const int node_id = node_procs[0];
+
+    // 1. Resolve skin vertices among procs on this node:
+    //    intra = (index, world proc; remote handle), sorted by index
+    std::vector<Ulong> handle_vec;
+    std::copy(skin_ents[0].begin(), skin_ents[0].end(),
+              std::back_inserter(handle_vec));
+    TupleList intra;
+    moab::TupleList::buffer sort_buffer;
+    {
+      gs_data::crystal_data node_cd(node_comm);
+      gs_data gsd;
+      result = gsd.initialize(num_verts, &lgid_data[0], &handle_vec[0],
+                              2, 1, 1, &node_cd);
+      MB_CHK_SET_ERR(result, "Failed to create gs data for node");
+      unsigned int j = 0;
+      intra.initialize(2, 0, 1, 0, num_verts);
+      for (unsigned int p = 0; p < gsd.nlinfo->_np; p++)
+        for (unsigned int np = 0; np < gsd.nlinfo->_nshared[p]; np++, j++) {
+          int vi[2] = { (int)gsd.nlinfo->_sh_ind[j], node_procs[gsd.nlinfo->_target[p]] };
+          Ulong vul = gsd.nlinfo->_ulabels[j];
+          intra.push_back(vi, NULL, &vul, NULL);
+        }
+    }
+    intra.sort(0, &sort_buffer);
+    std::vector<unsigned int> intra_start(num_verts + 1, 0);
+    for (unsigned int i = 0; i < intra.get_n(); i++)
+      intra_start[intra.vi_rd[2*i] + 1]++;
+    for (size_t i = 0; i < num_verts; i++)
+      intra_start[i + 1] += intra_start[i];
+
+    // 2. Find skin faces that are also skin faces of another proc on this
+    //    node, asking the procs sharing all corners of a face whether they
+    //    have a skin face with those corners:
+    //    query = (node rank, face index, num corners; corner handles there)
+    const unsigned int max_corners = 4;
+    std::vector<EntityHandle> faces(skin_ents[skin_dim].begin(), skin_ents[skin_dim].end());
+    std::vector<char> face_matched(faces.size(), 0), vert_on_face(num_verts, 0);
+    TupleList query;
+    query.initialize(3, 0, max_corners, 0, faces.size());
+    std::vector<EntityHandle> conn;
+    std::vector<unsigned int> corner_idx;
+    for (size_t f = 0; f < faces.size(); f++) {
+      result = mbImpl->get_connectivity(&faces[f], 1, conn, true);MB_CHK_SET_ERR(result, "Failed to get skin face connectivity");
+      corner_idx.clear();
+      for (size_t c = 0; c < conn.size(); c++) {
+        Range::const_iterator it = skin_ents[0].find(conn[c]);
+        if (it == skin_ents[0].end())
+          break;
+        corner_idx.push_back(it - skin_ents[0].begin());
+        vert_on_face[corner_idx.back()] = 1;
+      }
+      if (corner_idx.size() != conn.size() || conn.size() > max_corners)
+        continue;
+
+      // Procs on this node sharing the first corner that share all others
+      const unsigned int v0 = corner_idx[0];
+      for (unsigned int s = intra_start[v0]; s < intra_start[v0 + 1]; s++) {
+        const int other = intra.vi_rd[2*s + 1];
+        Ulong handles[max_corners] = { 0, 0, 0, 0 };
+        handles[0] = intra.vul_rd[s];
+        size_t c = 1;
+        for (; c < corner_idx.size(); c++) {
+          const unsigned int v = corner_idx[c];
+          unsigned int t = intra_start[v];
+          while (t < intra_start[v + 1] && intra.vi_rd[2*t + 1] != other)
+            t++;
+          if (t == intra_start[v + 1])
+            break;
+          handles[c] = intra.vul_rd[t];
+        }
+        if (c < corner_idx.size())
+          continue;
+        int vi[3] = { (int)(std::lower_bound(node_procs.begin(), node_procs.end(), other)
+                            - node_procs.begin()),
+                      (int)f, (int)corner_idx.size() };
+        query.push_back(vi, NULL, handles, NULL);
+      }
+    }
+    {
+      gs_data::crystal_data node_cd(node_comm);
+      result = node_cd.gs_transfer(1, query, 0);
+      MB_CHK_SET_ERR(result, "Failed to send skin face queries");
+
+      // Answer queries for faces that are on my skin:
+      // reply = (node rank, face index there)
+      TupleList reply;
+      reply.initialize(2, 0, 0, 0, query.get_n());
+      Range adj;
+      for (unsigned int i = 0; i < query.get_n(); i++) {
+        const EntityHandle* handles = (const EntityHandle*)query.vul_rd + max_corners*i;
+        const int ncorners = query.vi_rd[3*i + 2];
+        adj.clear();
+        result = mbImpl->get_adjacencies(handles, ncorners, skin_dim, false, adj);
+        if (MB_SUCCESS != result)
+          continue;
+        adj = intersect(adj, skin_ents[skin_dim]);
+        for (Range::iterator rit = adj.begin(); rit != adj.end(); ++rit) {
+          result = mbImpl->get_connectivity(&*rit, 1, conn, true);
+          if (MB_SUCCESS == result && (int)conn.size() == ncorners) {
+            int vi[2] = { query.vi_rd[3*i], query.vi_rd[3*i + 1] };
+            reply.push_back(vi, NULL, NULL, NULL);
+            break;
+          }
+        }
+      }
+      query.reset();
+      result = node_cd.gs_transfer(1, reply, 0);
+      MB_CHK_SET_ERR(result, "Failed to send skin face replies");
+      for (unsigned int i = 0; i < reply.get_n(); i++)
+        face_matched[reply.vi_rd[2*i + 1]] = 1;
+    }
+    MPI_Comm_free(&node_comm);
+
+    // Vertices on the skin of this node: those on a face not shared on this
+    // node, and (conservatively) those not on any skin face
+    std::vector<char> node_skin(num_verts, 0);
+    for (size_t v = 0; v < num_verts; v++)
+      node_skin[v] = !vert_on_face[v];
+    for (size_t f = 0; f < faces.size(); f++) {
+      if (face_matched[f])
+        continue;
+      result = mbImpl->get_connectivity(&faces[f], 1, conn, true);MB_CHK_SET_ERR(result, "Failed to get skin face connectivity");
+      for (size_t c = 0; c < conn.size(); c++) {
+        Range::const_iterator it = skin_ents[0].find(conn[c]);
+        if (it != skin_ents[0].end())
+          node_skin[it - skin_ents[0].begin()] = 1;
+      }
+    }
+
+    // 3. Resolve node skin vertices between nodes.  Each proc sends, for
+    //    its node skin vertices, all procs on this node sharing the vertex
+    //    to the proc given by the global id:
+    //    cross = (work proc, proc, node; gid; handle on proc)
+    TupleList cross;
+    cross.initialize(3, 1, 1, 0, 0);
+    size_t num_node_skin = 0;
+    for (size_t v = 0; v < num_verts; v++) {
+      if (!node_skin[v] || 0 == lgid_data[v])
+        continue;
+      num_node_skin++;
+      long gid = lgid_data[v];
+      int vi[3] = { (int)(((gid % size) + size) % size), rank, node_id };
+      Ulong vul = handle_vec[v];
+      cross.push_back(vi, &gid, &vul, NULL);
+      for (unsigned int s = intra_start[v]; s < intra_start[v + 1]; s++) {
+        vi[1] = intra.vi_rd[2*s + 1];
+        vul = intra.vul_rd[s];
+        cross.push_back(vi, &gid, &vul, NULL);
+      }
+    }
+    myDebug->tprintf(1, "Resolving %lu of %lu skin vertices between nodes.\n",
+                     (unsigned long)num_node_skin, (unsigned long)num_verts);
+
+    gs_data::crystal_data *cd = procConfig.crystal_router();
+    result = cd->gs_transfer(1, cross, 0);MB_CHK_SET_ERR(result, "Failed to send node skin vertices");
+
+    // For each pair of procs on different nodes sharing a vertex, tell
+    // both about the other:
+    // pairs = (proc, other proc; handle on proc, handle on other proc)
+    cross.sort(3, &sort_buffer);
+    TupleList pairs;
+    pairs.initialize(2, 0, 2, 0, 0);
+    std::vector< std::pair<int, std::pair<int, Ulong> > > members;
+    for (unsigned int i = 0; i < cross.get_n(); ) {
+      members.clear();
+      const long gid = cross.vl_rd[i];
+      for ( ; i < cross.get_n() && cross.vl_rd[i] == gid; i++)
+        members.push_back(std::make_pair(cross.vi_rd[3*i + 1],
+                                         std::make_pair(cross.vi_rd[3*i + 2], cross.vul_rd[i])));
+      std::sort(members.begin(), members.end());
+      members.erase(std::unique(members.begin(), members.end()), members.end());
+      for (size_t a = 0; a < members.size(); a++)
+        for (size_t b = 0; b < members.size(); b++) {
+          if (members[a].second.first == members[b].second.first)
+            continue;
+          int vi[2] = { members[a].first, members[b].first };
+          Ulong vul[2] = { members[a].second.second, members[b].second.second };
+          pairs.push_back(vi, NULL, vul, NULL);
+        }
+    }
+    cross.reset();
+    result = cd->gs_transfer(1, pairs, 0);MB_CHK_SET_ERR(result, "Failed to send sharing procs between nodes");
+
+    // 4. Combine sharing procs on this node and on other nodes
+    shared_verts.initialize(2, 0, 1, 0, intra.get_n() + pairs.get_n());
+    shared_verts.enableWriteAccess();
+    for (unsigned int i = 0; i < intra.get_n(); i++) {
+      int vi[2] = { intra.vi_rd[2*i], intra.vi_rd[2*i + 1] };
+      Ulong vul = intra.vul_rd[i];
+      shared_verts.push_back(vi, NULL, &vul, NULL);
+    }
+    intra.reset();
+    for (unsigned int i = 0; i < pairs.get_n(); i++) {
+      Range::const_iterator it = skin_ents[0].find((EntityHandle)pairs.vul_rd[2*i]);
+      if (it == skin_ents[0].end()) {
+        MB_SET_ERR(MB_FAILURE, "Received sharing proc for vertex not on skin");
+      }
+      int vi[2] = { (int)(it - skin_ents[0].begin()), pairs.vi_rd[2*i + 1] };
+      Ulong vul = pairs.vul_rd[2*i + 1];
+      shared_verts.push_back(vi, NULL, &vul, NULL);
+    }
+    pairs.reset();
+
+    // Same order as get_shared_verts: by index, then by proc
+    shared_verts.sort(1, &sort_buffer);
+    shared_verts.sort(0, &sort_buffer);
+    myDebug->tprintf(3, " shared verts size %d \n", (int)shared_verts.get_n());
+
+    return MB_SUCCESS;
+  }
+
   void ParallelComm::define_mpe()
   {
 #ifdef MOAB_HAVE_MPE
@@ -5276,6 +5644,22 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
                                                bool wait_all,
                                                EntityHandle *file_set)
   {
+    ErrorCode result = begin_exchange_ghost_cells(ghost_dim, bridge_dim, num_layers,
+                                                  addl_ents, store_remote_handles,
+                                                  wait_all, file_set);MB_CHK_ERR(result);
+    return end_exchange_ghost_cells();
+  }
+
+  ErrorCode ParallelComm::begin_exchange_ghost_cells(int ghost_dim, int bridge_dim,
+                                                     int num_layers, int addl_ents,
+                                                     bool store_remote_handles,
+                                                     bool wait_all,
+                                                     EntityHandle *file_set)
+  {
+    if (pendingExchange) {
+      MB_SET_ERR(MB_FAILURE, "Ghost exchange started while another exchange is pending");
+    }
+
 #ifdef MOAB_HAVE_MPE
     if (myDebug->get_verbosity() == 2) {
       if (!num_layers)
@@ -5301,10 +5685,19 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
 
     int success;
     ErrorCode result = MB_SUCCESS;
-    int incoming1 = 0, incoming2 = 0;
 
     reset_all_buffers();
 
+    // State kept until end_exchange_ghost_cells
+    PendingExchange* pe = new PendingExchange;
+    pendingExchange = pe;
+    DeleteOnExit<PendingExchange> guard(pendingExchange);
+    pe->type = PendingExchange::GHOST_CELLS;
+    pe->isIface = is_iface;
+    pe->storeRemoteHandles = store_remote_handles;
+    pe->waitAll = wait_all;
+    pe->fileSet = file_set ? *file_set : 0;
+
     // When this function is called, buffProcs should already have any
     // communicating procs
 
@@ -5318,17 +5711,19 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
 #endif
 
     // Index reqs the same as buffer/sharing procs indices
-    std::vector<MPI_Request> recv_ent_reqs(3*buffProcs.size(), MPI_REQUEST_NULL),
-      recv_remoteh_reqs(3*buffProcs.size(), MPI_REQUEST_NULL);
+    std::vector<MPI_Request>& recv_ent_reqs = pe->recvReqs;
+    std::vector<MPI_Request>& recv_remoteh_reqs = pe->recvRemotehReqs;
+    recv_ent_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
+    recv_remoteh_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
     std::vector<unsigned int>::iterator proc_it;
     int ind, p;
     sendReqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
     for (ind = 0, proc_it = buffProcs.begin(); 
          proc_it != buffProcs.end(); ++proc_it, ind++) {
-      incoming1++;
+      pe->incoming1++;
       PRINT_DEBUG_IRECV(procConfig.proc_rank(), buffProcs[ind],
                         remoteOwnedBuffs[ind]->mem_ptr, INITIAL_BUFF_SIZE,
-                        MB_MESG_ENTS_SIZE, incoming1);
+                        MB_MESG_ENTS_SIZE, pe->incoming1);
       success = MPI_Irecv(remoteOwnedBuffs[ind]->mem_ptr, INITIAL_BUFF_SIZE,
                           MPI_UNSIGNED_CHAR, buffProcs[ind],
                           MB_MESG_ENTS_SIZE, procConfig.proc_comm(),
@@ -5341,9 +5736,9 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     //===========================================
     // Get entities to be sent to neighbors
     //===========================================
-    Range sent_ents[MAX_SHARING_PROCS], allsent, tmp_range;
+    Range sent_ents[MAX_SHARING_PROCS];
+    Range& allsent = pe->allsent;
     TupleList entprocs;
-    int dum_ack_buff;
     result = get_sent_ents(is_iface, bridge_dim, ghost_dim, num_layers,
                            addl_ents, sent_ents, allsent, entprocs);MB_CHK_SET_ERR(result, "get_sent_ents failed");
 
@@ -5380,102 +5775,137 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       // Send the buffer (size stored in front in send_buffer)
       result = send_buffer(*proc_it, localOwnedBuffs[p],
                            MB_MESG_ENTS_SIZE, sendReqs[3*p],
-                           recv_ent_reqs[3*p + 2], &dum_ack_buff,
-                           incoming1,
+                           recv_ent_reqs[3*p + 2], &pe->ackBuff,
+                           pe->incoming1,
                            MB_MESG_REMOTEH_SIZE,
                            (!is_iface && store_remote_handles ?  // this used for ghosting only
                             localOwnedBuffs[p] : NULL),
-                           &recv_remoteh_reqs[3*p], &incoming2);MB_CHK_SET_ERR(result, "Failed to Isend in ghost exchange");
+                           &recv_remoteh_reqs[3*p], &pe->incoming2);MB_CHK_SET_ERR(result, "Failed to Isend in ghost exchange");
     }
 
     entprocs.reset();
 
-    //===========================================
-    // Receive/unpack new entities
-    //===========================================
     // Number of incoming messages for ghosts is the number of procs we
     // communicate with; for iface, it's the number of those with lower rank
-    MPI_Status status;
-    std::vector<std::vector<EntityHandle> > recd_ents(buffProcs.size());
-    std::vector<std::vector<EntityHandle> > L1hloc(buffProcs.size()), L1hrem(buffProcs.size());
-    std::vector<std::vector<int> > L1p(buffProcs.size());
-    std::vector<EntityHandle> L2hloc, L2hrem;
-    std::vector<unsigned int> L2p;
-    std::vector<EntityHandle> new_ents;
+    pe->L1hloc.resize(buffProcs.size());
+    pe->L1hrem.resize(buffProcs.size());
+    pe->L1p.resize(buffProcs.size());
 
-    while (incoming1) {
-      // Wait for all recvs of ghost ents before proceeding to sending remote handles,
-      // b/c some procs may have sent to a 3rd proc ents owned by me;
-      PRINT_DEBUG_WAITANY(recv_ent_reqs, MB_MESG_ENTS_SIZE, procConfig.proc_rank());
+    guard.release();
+    return MB_SUCCESS;
+  }
 
-      success = MPI_Waitany(3*buffProcs.size(), &recv_ent_reqs[0], &ind, &status);
-      if (MPI_SUCCESS != success) {
-        MB_SET_ERR(MB_FAILURE, "Failed in waitany in ghost exchange");
-      }
+  ErrorCode ParallelComm::recv_ghost_message(int ind, MPI_Status& status)
+  {
+    PendingExchange* pe = pendingExchange;
+    std::vector<MPI_Request>& recv_ent_reqs = pe->recvReqs;
+    std::vector<MPI_Request>& recv_remoteh_reqs = pe->recvRemotehReqs;
+    const bool is_iface = pe->isIface;
+    const bool store_remote_handles = pe->storeRemoteHandles;
+    ErrorCode result;
+    int success;
 
-      PRINT_DEBUG_RECD(status);
+    PRINT_DEBUG_RECD(status);
 
-      // OK, received something; decrement incoming counter
-      incoming1--;
-      bool done = false;
+    // OK, received something; decrement incoming counter
+    pe->incoming1--;
+    bool done = false;
 
-      // In case ind is for ack, we need index of one before it
-      unsigned int base_ind = 3*(ind/3);
-      result = recv_buffer(MB_MESG_ENTS_SIZE,
-                           status,
-                           remoteOwnedBuffs[ind/3],
-                           recv_ent_reqs[base_ind + 1],
-                           recv_ent_reqs[base_ind + 2],
-                           incoming1,
-                           localOwnedBuffs[ind/3],
-                           sendReqs[base_ind + 1],
-                           sendReqs[base_ind + 2],
-                           done,
-                           (!is_iface && store_remote_handles ?
-                            localOwnedBuffs[ind/3] : NULL),
-                           MB_MESG_REMOTEH_SIZE, // maybe base_ind+1?
-                           &recv_remoteh_reqs[base_ind+1], &incoming2);MB_CHK_SET_ERR(result, "Failed to receive buffer");
+    // In case ind is for ack, we need index of one before it
+    unsigned int base_ind = 3*(ind/3);
+    result = recv_buffer(MB_MESG_ENTS_SIZE,
+                         status,
+                         remoteOwnedBuffs[ind/3],
+                         recv_ent_reqs[base_ind + 1],
+                         recv_ent_reqs[base_ind + 2],
+                         pe->incoming1,
+                         localOwnedBuffs[ind/3],
+                         sendReqs[base_ind + 1],
+                         sendReqs[base_ind + 2],
+                         done,
+                         (!is_iface && store_remote_handles ?
+                          localOwnedBuffs[ind/3] : NULL),
+                         MB_MESG_REMOTEH_SIZE, // maybe base_ind+1?
+                         &recv_remoteh_reqs[base_ind+1], &pe->incoming2);MB_CHK_SET_ERR(result, "Failed to receive buffer");
 
-      if (done) {
-        if (myDebug->get_verbosity() == 4) {
-          msgs.resize(msgs.size() + 1);
-          msgs.back() = new Buffer(*remoteOwnedBuffs[ind/3]);
-        }
+    if (done) {
+      if (myDebug->get_verbosity() == 4) {
+        msgs.resize(msgs.size() + 1);
+        msgs.back() = new Buffer(*remoteOwnedBuffs[ind/3]);
+      }
 
-        // Message completely received - process buffer that was sent
-        remoteOwnedBuffs[ind/3]->reset_ptr(sizeof(int));
-        result = unpack_entities(remoteOwnedBuffs[ind/3]->buff_ptr,
-                                 store_remote_handles, ind/3, is_iface,
-                                 L1hloc, L1hrem, L1p, L2hloc, L2hrem, L2p, new_ents);
-        if (MB_SUCCESS != result) {
-          std::cout << "Failed to unpack entities. Buffer contents:" << std::endl;
-          print_buffer(remoteOwnedBuffs[ind/3]->mem_ptr, MB_MESG_ENTS_SIZE, buffProcs[ind/3], false);
-          return result;
-        }
+      // Message completely received - process buffer that was sent
+      remoteOwnedBuffs[ind/3]->reset_ptr(sizeof(int));
+      result = unpack_entities(remoteOwnedBuffs[ind/3]->buff_ptr,
+                               store_remote_handles, ind/3, is_iface,
+                               pe->L1hloc, pe->L1hrem, pe->L1p,
+                               pe->L2hloc, pe->L2hrem, pe->L2p, pe->newEnts);
+      if (MB_SUCCESS != result) {
+        std::cout << "Failed to unpack entities. Buffer contents:" << std::endl;
+        print_buffer(remoteOwnedBuffs[ind/3]->mem_ptr, MB_MESG_ENTS_SIZE, buffProcs[ind/3], false);
+        return result;
+      }
 
-        if (recv_ent_reqs.size() != 3*buffProcs.size()) {
-          // Post irecv's for remote handles from new proc; shouldn't be iface,
-          // since we know about all procs we share with
-          assert(!is_iface);
-          recv_remoteh_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
-          for (unsigned int i = recv_ent_reqs.size(); i < 3*buffProcs.size(); i += 3) {
-            localOwnedBuffs[i/3]->reset_buffer();
-            incoming2++;
-            PRINT_DEBUG_IRECV(procConfig.proc_rank(), buffProcs[i/3],
-                              localOwnedBuffs[i/3]->mem_ptr, INITIAL_BUFF_SIZE,
-                              MB_MESG_REMOTEH_SIZE, incoming2);
-            success = MPI_Irecv(localOwnedBuffs[i/3]->mem_ptr, INITIAL_BUFF_SIZE,
-                                MPI_UNSIGNED_CHAR, buffProcs[i/3],
-                                MB_MESG_REMOTEH_SIZE, procConfig.proc_comm(),
-                                &recv_remoteh_reqs[i]);
-            if (success != MPI_SUCCESS) {
-              MB_SET_ERR(MB_FAILURE, "Failed to post irecv for remote handles in ghost exchange");
-            }
+      if (recv_ent_reqs.size() != 3*buffProcs.size()) {
+        // Post irecv's for remote handles from new proc; shouldn't be iface,
+        // since we know about all procs we share with
+        assert(!is_iface);
+        recv_remoteh_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
+        for (unsigned int i = recv_ent_reqs.size(); i < 3*buffProcs.size(); i += 3) {
+          localOwnedBuffs[i/3]->reset_buffer();
+          pe->incoming2++;
+          PRINT_DEBUG_IRECV(procConfig.proc_rank(), buffProcs[i/3],
+                            localOwnedBuffs[i/3]->mem_ptr, INITIAL_BUFF_SIZE,
+                            MB_MESG_REMOTEH_SIZE, pe->incoming2);
+          success = MPI_Irecv(localOwnedBuffs[i/3]->mem_ptr, INITIAL_BUFF_SIZE,
+                              MPI_UNSIGNED_CHAR, buffProcs[i/3],
+                              MB_MESG_REMOTEH_SIZE, procConfig.proc_comm(),
+                              &recv_remoteh_reqs[i]);
+          if (success != MPI_SUCCESS) {
+            MB_SET_ERR(MB_FAILURE, "Failed to post irecv for remote handles in ghost exchange");
           }
-          recv_ent_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
-          sendReqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
         }
+        recv_ent_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
+        sendReqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
+      }
+    }
+
+    return MB_SUCCESS;
+  }
+
+  ErrorCode ParallelComm::end_exchange_ghost_cells()
+  {
+    PendingExchange* pe = pendingExchange;
+    if (!pe || pe->type != PendingExchange::GHOST_CELLS) {
+      MB_SET_ERR(MB_FAILURE, "No pending ghost exchange");
+    }
+
+    // Free exchange state on return, whether or not successful
+    DeleteOnExit<PendingExchange> guard(pendingExchange);
+    std::vector<MPI_Request>& recv_ent_reqs = pe->recvReqs;
+    std::vector<MPI_Request>& recv_remoteh_reqs = pe->recvRemotehReqs;
+    const bool is_iface = pe->isIface;
+    const bool wait_all = pe->waitAll;
+    Range& allsent = pe->allsent;
+    ErrorCode result = MB_SUCCESS;
+    int success, ind, p;
+    std::vector<unsigned int>::iterator proc_it;
+
+    //===========================================
+    // Receive/unpack new entities
+    //===========================================
+    MPI_Status status;
+    while (pe->incoming1) {
+      // Wait for all recvs of ghost ents before proceeding to sending remote handles,
+      // b/c some procs may have sent to a 3rd proc ents owned by me;
+      PRINT_DEBUG_WAITANY(recv_ent_reqs, MB_MESG_ENTS_SIZE, procConfig.proc_rank());
+
+      success = MPI_Waitany(3*buffProcs.size(), &recv_ent_reqs[0], &ind, &status);
+      if (MPI_SUCCESS != success) {
+        MB_SET_ERR(MB_FAILURE, "Failed in waitany in ghost exchange");
       }
+
+      result = recv_ghost_message(ind, status);MB_CHK_ERR(result);
     }
 
     // Add requests for any new addl procs
@@ -5567,7 +5997,7 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       // Reserve space on front for size and for initial buff size
       remoteOwnedBuffs[p]->reset_buffer(sizeof(int));
 
-      result = pack_remote_handles(L1hloc[p], L1hrem[p], L1p[p], *proc_it,
+      result = pack_remote_handles(pe->L1hloc[p], pe->L1hrem[p], pe->L1p[p], *proc_it,
                                    remoteOwnedBuffs[p]);MB_CHK_SET_ERR(result, "Failed to pack remote handles");
       remoteOwnedBuffs[p]->set_stored_size();
 
@@ -5579,13 +6009,13 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
                            MB_MESG_REMOTEH_SIZE,
                            sendReqs[3*p],
                            recv_remoteh_reqs[3*p + 2],
-                           &dum_ack_buff, incoming2);MB_CHK_SET_ERR(result, "Failed to send remote handles");
+                           &pe->ackBuff, pe->incoming2);MB_CHK_SET_ERR(result, "Failed to send remote handles");
     }
 
     //===========================================
     // Process remote handles of my ghosteds
     //===========================================
-    while (incoming2) {
+    while (pe->incoming2) {
       PRINT_DEBUG_WAITANY(recv_remoteh_reqs, MB_MESG_REMOTEH_SIZE, procConfig.proc_rank());
       success = MPI_Waitany(3*buffProcs.size(), &recv_remoteh_reqs[0], &ind, &status);
       if (MPI_SUCCESS != success) {
@@ -5593,7 +6023,7 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       }
 
       // OK, received something; decrement incoming counter
-      incoming2--;
+      pe->incoming2--;
 
       PRINT_DEBUG_RECD(status);
 
@@ -5602,7 +6032,7 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       result = recv_buffer(MB_MESG_REMOTEH_SIZE, status,
                            localOwnedBuffs[ind/3],
                            recv_remoteh_reqs[base_ind+1],
-                           recv_remoteh_reqs[base_ind + 2], incoming2,
+                           recv_remoteh_reqs[base_ind + 2], pe->incoming2,
                            remoteOwnedBuffs[ind/3],
                            sendReqs[base_ind+1],
                            sendReqs[base_ind + 2],
@@ -5616,7 +6046,7 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
         localOwnedBuffs[ind/3]->reset_ptr(sizeof(int));
         result = unpack_remote_handles(buffProcs[ind/3],
                                        localOwnedBuffs[ind/3]->buff_ptr,
-                                       L2hloc, L2hrem, L2p);MB_CHK_SET_ERR(result, "Failed to unpack remote handles");
+                                       pe->L2hloc, pe->L2hrem, pe->L2p);MB_CHK_SET_ERR(result, "Failed to unpack remote handles");
       }
     }
 
@@ -5651,8 +6081,8 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     result = check_all_shared_handles(true);MB_CHK_SET_ERR(result, "Failed check on all shared handles");
 #endif
 
-    if (file_set && !new_ents.empty()) {
-      result = mbImpl->add_entities(*file_set, &new_ents[0], new_ents.size());MB_CHK_SET_ERR(result, "Failed to add new entities to set");
+    if (pe->fileSet && !pe->newEnts.empty()) {
+      result = mbImpl->add_entities(pe->fileSet, &pe->newEnts[0], pe->newEnts.size());MB_CHK_SET_ERR(result, "Failed to add new entities to set");
     }
 
     myDebug->tprintf(1, "Total number of shared entities = %lu.\n", (unsigned long)sharedEnts.size());
@@ -7065,25 +7495,47 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
   ErrorCode ParallelComm::exchange_tags(const std::vector<Tag> &src_tags,
                                         const std::vector<Tag> &dst_tags,
                                         const Range &entities_in)
+  {
+    ErrorCode result = begin_exchange_tags(src_tags, dst_tags, entities_in);MB_CHK_ERR(result);
+    return end_exchange_tags();
+  }
+
+  ErrorCode ParallelComm::begin_exchange_tags(const std::vector<Tag> &src_tags,
+                                              const std::vector<Tag> &dst_tags,
+                                              const Range &entities_in)
   {
     ErrorCode result;
     int success;
 
+    if (pendingExchange) {
+      MB_SET_ERR(MB_FAILURE, "Tag exchange started while another exchange is pending");
+    }
+
     myDebug->tprintf(1, "Entering exchange_tags\n");
 
     // Get all procs interfacing to this proc
     std::set<unsigned int> exch_procs;
     result = get_comm_procs(exch_procs);
 
+    // State kept until end_exchange_tags
+    PendingExchange* pe = new PendingExchange;
+    pendingExchange = pe;
+    DeleteOnExit<PendingExchange> guard(pendingExchange);
+    pe->type = PendingExchange::TAGS;
+    pe->srcTags = src_tags;
+    pe->dstTags = dst_tags;
+    pe->entities = entities_in;
+
     // Post ghost irecv's for all interface procs
     // Index requests the same as buffer/sharing procs indices
-    std::vector<MPI_Request> recv_tag_reqs(3*buffProcs.size(), MPI_REQUEST_NULL);
+    std::vector<MPI_Request>& recv_tag_reqs = pe->recvReqs;
+    recv_tag_reqs.resize(3*buffProcs.size(), MPI_REQUEST_NULL);
     // sent_ack_reqs(buffProcs.size(), MPI_REQUEST_NULL);
     std::vector<unsigned int>::iterator sit;
     int ind;
 
     reset_all_buffers();
-    int incoming = 0;
+    int& incoming = pe->incoming1;
 
     for (ind = 0, sit = buffProcs.begin(); sit != buffProcs.end(); ++sit, ind++) {
       incoming++;
@@ -7110,8 +7562,6 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     else
       entities = entities_in;
 
-    int dum_ack_buff;
-
     for (ind = 0, sit = buffProcs.begin(); sit != buffProcs.end(); ++sit, ind++) {
       Range tag_ents = entities;
 
@@ -7148,11 +7598,66 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
 
       // Now send it
       result = send_buffer(*sit, localOwnedBuffs[ind], MB_MESG_TAGS_SIZE, sendReqs[3*ind],
-                           recv_tag_reqs[3*ind + 2], &dum_ack_buff, incoming);MB_CHK_SET_ERR(result, "Failed to send buffer");
+                           recv_tag_reqs[3*ind + 2], &pe->ackBuff, incoming);MB_CHK_SET_ERR(result, "Failed to send buffer");
     }
 
+    guard.release();
+    return MB_SUCCESS;
+  }
+
+  ErrorCode ParallelComm::recv_tag_message(int index_in_recv_requests, MPI_Status& status)
+  {
+    PendingExchange* pe = pendingExchange;
+    std::vector<MPI_Request>& recv_tag_reqs = pe->recvReqs;
+
+    // Processor index in the list is divided by 3
+    int ind = index_in_recv_requests / 3;
+
+    PRINT_DEBUG_RECD(status);
+
+    // OK, received something; decrement incoming counter
+    pe->incoming1--;
+
+    bool done = false;
+    std::vector<EntityHandle> dum_vec;
+    ErrorCode result = recv_buffer(MB_MESG_TAGS_SIZE,
+                                   status,
+                                   remoteOwnedBuffs[ind],
+                                   recv_tag_reqs[3*ind + 1], // This is for receiving the second message
+                                   recv_tag_reqs[3*ind + 2], // This would be for ack, but it is not used; consider removing it
+                                   pe->incoming1,
+                                   localOwnedBuffs[ind],
+                                   sendReqs[3*ind + 1], // Send request for sending the second message
+                                   sendReqs[3*ind + 2], // This is for sending the ack
+                                   done);MB_CHK_SET_ERR(result, "Failed to resize recv buffer");
+    if (done) {
+      remoteOwnedBuffs[ind]->reset_ptr(sizeof(int));
+      result = unpack_tags(remoteOwnedBuffs[ind]->buff_ptr,
+                           dum_vec, true, buffProcs[ind]);MB_CHK_SET_ERR(result, "Failed to recv-unpack-tag message");
+    }
+
+    return MB_SUCCESS;
+  }
+
+  ErrorCode ParallelComm::end_exchange_tags()
+  {
+    PendingExchange* pe = pendingExchange;
+    if (!pe || pe->type != PendingExchange::TAGS) {
+      MB_SET_ERR(MB_FAILURE, "No pending tag exchange");
+    }
+
+    // Free exchange state on return, whether or not successful
+    DeleteOnExit<PendingExchange> guard(pendingExchange);
+    std::vector<MPI_Request>& recv_tag_reqs = pe->recvReqs;
+    const std::vector<Tag>& src_tags = pe->srcTags;
+    const std::vector<Tag>& dst_tags = pe->dstTags;
+    const Range& entities_in = pe->entities;
+    Range entities;
+    ErrorCode result;
+    int success;
+
     // Receive/unpack tags
-    while (incoming) {
+    while (pe->incoming1) {
       MPI_Status status;
       int index_in_recv_requests;
       PRINT_DEBUG_WAITANY(recv_tag_reqs, MB_MESG_TAGS_SIZE, procConfig.proc_rank());
@@ -7160,31 +7665,8 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
       if (MPI_SUCCESS != success) {
         MB_SET_ERR(MB_FAILURE, "Failed in waitany in tag exchange");
       }
-      // Processor index in the list is divided by 3
-      ind = index_in_recv_requests / 3;
-
-      PRINT_DEBUG_RECD(status);
 
-      // OK, received something; decrement incoming counter
-      incoming--;
-
-      bool done = false;
-      std::vector<EntityHandle> dum_vec;
-      result = recv_buffer(MB_MESG_TAGS_SIZE,
-                           status,
-                           remoteOwnedBuffs[ind],
-                           recv_tag_reqs[3*ind + 1], // This is for receiving the second message
-                           recv_tag_reqs[3*ind + 2], // This would be for ack, but it is not used; consider removing it
-                           incoming,
-                           localOwnedBuffs[ind],
-                           sendReqs[3*ind + 1], // Send request for sending the second message
-                           sendReqs[3*ind + 2], // This is for sending the ack
-                           done);MB_CHK_SET_ERR(result, "Failed to resize recv buffer");
-      if (done) {
-        remoteOwnedBuffs[ind]->reset_ptr(sizeof(int));
-        result = unpack_tags(remoteOwnedBuffs[ind]->buff_ptr,
-                             dum_vec, true, buffProcs[ind]);MB_CHK_SET_ERR(result, "Failed to recv-unpack-tag message");
-      }
+      result = recv_tag_message(index_in_recv_requests, status);MB_CHK_ERR(result);
     }
 
     // OK, now wait
@@ -7242,6 +7724,39 @@ ErrorCode ParallelComm::send_entities(std::vector<unsigned int>& send_procs,
     return MB_SUCCESS;
   }
 
+  ErrorCode ParallelComm::progress_exchange(bool* done)
+  {
+    PendingExchange* pe = pendingExchange;
+    if (!pe) {
+      MB_SET_ERR(MB_FAILURE, "No pending exchange");
+    }
+
+    // Unpack messages of the first phase of the exchange as they arrive;
+    // the remote handle phase of the ghost exchange follows from
+    // end_exchange_ghost_cells
+    while (pe->incoming1) {
+      MPI_Status status;
+      int ind, flag;
+      int success = MPI_Testany(pe->recvReqs.size(), &pe->recvReqs[0], &ind, &flag, &status);
+      if (MPI_SUCCESS != success) {
+        MB_SET_ERR(MB_FAILURE, "Failed in testany in exchange");
+      }
+      if (!flag || MPI_UNDEFINED == ind)
+        break;
+
+      ErrorCode result;
+      if (PendingExchange::GHOST_CELLS == pe->type)
+        result = recv_ghost_message(ind, status);
+      else
+        result = recv_tag_message(ind, status);
+      MB_CHK_ERR(result);
+    }
+
+    if (done)
+      *done = !pe->incoming1;
+    return MB_SUCCESS;
+  }
+
   ErrorCode ParallelComm::reduce_tags(const std::vector<Tag> &src_tags,
                                       const std::vector<Tag> &dst_tags,
                                       const MPI_Op mpi_op,
@@ -61,6 +61,9 @@ namespace moab{
     /* Gather-Scatter Tuple
        -tup comes out as (remoteProc,handle,x,y,z) */
     myCD.initialize(myPcomm->comm());
+    gs_data::crystal_data *cd = myPcomm->proc_config().crystal_router(false);
+    if (cd)
+      myCD.set_transfer_method(cd->get_transfer_method());
 
     //1 represents dynamic tuple, 0 represents index of the processor to send to
     myCD.gs_transfer(1, myTup, 0);
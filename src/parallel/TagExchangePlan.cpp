@@ -0,0 +1,337 @@
+/**
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include "moab/TagExchangePlan.hpp"
+#include "moab/ParallelComm.hpp"
+#include "moab/Interface.hpp"
+#include "moab/Error.hpp"
+#include "MBParallelConventions.h"
+#include <algorithm>
+
+namespace moab {
+
+  // Message tags, distinct from those used by ParallelComm
+enum PlanMessageTag { PLAN_MESG_COUNT = 16,
+                      PLAN_MESG_HANDLES,
+                      PLAN_MESG_EXCHANGE,
+                      PLAN_MESG_REDUCE };
+
+TagExchangePlan::TagExchangePlan( ParallelComm* pcomm )
+  : myPcomm(pcomm), bytesPerEntity(0)
+{}
+
+TagExchangePlan::~TagExchangePlan()
+{
+  clear();
+}
+
+void TagExchangePlan::free_requests( std::vector<MPI_Request>& reqs )
+{
+  for (size_t i = 0; i < reqs.size(); ++i)
+    if (MPI_REQUEST_NULL != reqs[i])
+      MPI_Request_free( &reqs[i] );
+  reqs.clear();
+}
+
+void TagExchangePlan::clear()
+{
+  Messages* list[] = { &exchangeMsgs, &reduceMsgs };
+  for (int i = 0; i < 2; ++i) {
+    free_requests( list[i]->sendReqs );
+    free_requests( list[i]->recvReqs );
+    *list[i] = Messages();
+  }
+  tagList.clear();
+  tagBytes.clear();
+  tagLengths.clear();
+  tagTypes.clear();
+  neighborProcs.clear();
+  bytesPerEntity = 0;
+}
+
+ErrorCode TagExchangePlan::setup( const std::vector<Tag>& tags, const Range& entities_in )
+{
+  Interface* mb = myPcomm->get_moab();
+  ErrorCode rval;
+
+  clear();
+
+  tagList = tags;
+  for (std::vector<Tag>::const_iterator i = tags.begin(); i != tags.end(); ++i) {
+    int bytes, length;
+    DataType type;
+    rval = mb->tag_get_bytes( *i, bytes );
+    if (MB_VARIABLE_DATA_LENGTH == rval) {
+      MB_SET_ERR(MB_VARIABLE_DATA_LENGTH, "Variable-length tags are not supported in exchange plan");
+    }
+    MB_CHK_SET_ERR(rval, "Failed to get tag size");
+    rval = mb->tag_get_length( *i, length );MB_CHK_SET_ERR(rval, "Failed to get tag length");
+    rval = mb->tag_get_data_type( *i, type );MB_CHK_SET_ERR(rval, "Failed to get tag data type");
+    if (MB_TYPE_HANDLE == type) {
+      MB_SET_ERR(MB_TYPE_OUT_OF_RANGE, "Handle tags are not supported in exchange plan");
+    }
+    tagBytes.push_back( bytes );
+    tagLengths.push_back( length );
+    tagTypes.push_back( type );
+    bytesPerEntity += bytes;
+  }
+
+    // Take all shared entities if incoming list is empty
+  Range entities;
+  if (entities_in.empty())
+    std::copy( myPcomm->sharedEnts.begin(), myPcomm->sharedEnts.end(), range_inserter(entities) );
+  else
+    entities = entities_in;
+
+  neighborProcs = myPcomm->buff_procs();
+  std::sort( neighborProcs.begin(), neighborProcs.end() );
+
+    // Values are sent in the order of the handles on the sending proc;
+    // send the corresponding remote handles to the receiving proc once,
+    // such that it can unpack values without further information.
+  std::vector< std::vector<EntityHandle> > remote;
+  rval = get_send_lists( entities, true, exchangeMsgs.sendEnts, remote );MB_CHK_ERR(rval);
+  rval = exchange_handles( remote, exchangeMsgs.recvEnts );MB_CHK_ERR(rval);
+  rval = get_send_lists( entities, false, reduceMsgs.sendEnts, remote );MB_CHK_ERR(rval);
+  rval = exchange_handles( remote, reduceMsgs.recvEnts );MB_CHK_ERR(rval);
+
+  rval = init_requests( exchangeMsgs, PLAN_MESG_EXCHANGE );MB_CHK_ERR(rval);
+  rval = init_requests( reduceMsgs, PLAN_MESG_REDUCE );MB_CHK_ERR(rval);
+
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::get_send_lists( const Range& entities, bool owned_only,
+                                           std::vector< std::vector<EntityHandle> >& local,
+                                           std::vector< std::vector<EntityHandle> >& remote )
+{
+  ErrorCode rval;
+  local.clear();
+  remote.clear();
+  local.resize( neighborProcs.size() );
+  remote.resize( neighborProcs.size() );
+
+  Range ents = entities;
+  if (owned_only) {
+    rval = myPcomm->filter_pstatus( ents, PSTATUS_NOT_OWNED, PSTATUS_NOT );MB_CHK_SET_ERR(rval, "Failed pstatus NOT check");
+  }
+
+  int procs[MAX_SHARING_PROCS];
+  EntityHandle handles[MAX_SHARING_PROCS];
+  unsigned char pstat;
+  int num_procs;
+  for (Range::iterator i = ents.begin(); i != ents.end(); ++i) {
+    rval = myPcomm->get_sharing_data( *i, procs, handles, pstat, num_procs );MB_CHK_SET_ERR(rval, "Failed to get sharing data");
+    if (!(pstat & PSTATUS_SHARED))
+      continue;
+    for (int j = 0; j < num_procs; ++j) {
+      std::vector<unsigned int>::iterator p =
+        std::lower_bound( neighborProcs.begin(), neighborProcs.end(), (unsigned int)procs[j] );
+      if (p == neighborProcs.end() || *p != (unsigned int)procs[j]) {
+        if (procs[j] != (int)myPcomm->rank()) {
+          MB_SET_ERR(MB_FAILURE, "Entity shared with proc " << procs[j] << " not in communicating procs");
+        }
+        continue;
+      }
+      local[p - neighborProcs.begin()].push_back( *i );
+      remote[p - neighborProcs.begin()].push_back( handles[j] );
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::exchange_handles( std::vector< std::vector<EntityHandle> >& remote,
+                                             std::vector< std::vector<EntityHandle> >& recv_ents )
+{
+  MPI_Comm comm = myPcomm->comm();
+  const size_t n = neighborProcs.size();
+  std::vector<int> send_counts( n ), recv_counts( n );
+  std::vector<MPI_Request> reqs( 2*n, MPI_REQUEST_NULL );
+  int success;
+
+    // Counts first, then handles
+  for (size_t i = 0; i < n; ++i) {
+    send_counts[i] = remote[i].size();
+    success = MPI_Irecv( &recv_counts[i], 1, MPI_INT, neighborProcs[i],
+                         PLAN_MESG_COUNT, comm, &reqs[2*i] );
+    if (MPI_SUCCESS == success)
+      success = MPI_Isend( &send_counts[i], 1, MPI_INT, neighborProcs[i],
+                           PLAN_MESG_COUNT, comm, &reqs[2*i+1] );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to send handle counts for exchange plan");
+    }
+  }
+  if (n) {
+    success = MPI_Waitall( 2*n, &reqs[0], MPI_STATUSES_IGNORE );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to receive handle counts for exchange plan");
+    }
+  }
+
+  recv_ents.clear();
+  recv_ents.resize( n );
+  for (size_t i = 0; i < n; ++i) {
+    recv_ents[i].resize( recv_counts[i] );
+    success = MPI_SUCCESS;
+    if (recv_counts[i])
+      success = MPI_Irecv( &recv_ents[i][0], recv_counts[i]*sizeof(EntityHandle), MPI_UNSIGNED_CHAR,
+                           neighborProcs[i], PLAN_MESG_HANDLES, comm, &reqs[2*i] );
+    if (MPI_SUCCESS == success && send_counts[i])
+      success = MPI_Isend( &remote[i][0], send_counts[i]*sizeof(EntityHandle), MPI_UNSIGNED_CHAR,
+                           neighborProcs[i], PLAN_MESG_HANDLES, comm, &reqs[2*i+1] );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to send handles for exchange plan");
+    }
+  }
+  if (n) {
+    success = MPI_Waitall( 2*n, &reqs[0], MPI_STATUSES_IGNORE );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to receive handles for exchange plan");
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::init_requests( Messages& msgs, int mesg_tag )
+{
+  MPI_Comm comm = myPcomm->comm();
+  const size_t n = neighborProcs.size();
+  int success;
+
+  msgs.sendBuffs.resize( n );
+  msgs.recvBuffs.resize( n );
+  for (size_t i = 0; i < n; ++i) {
+    msgs.sendBuffs[i].resize( msgs.sendEnts[i].size() * bytesPerEntity );
+    msgs.recvBuffs[i].resize( msgs.recvEnts[i].size() * bytesPerEntity );
+
+      // No message if no data
+    if (!msgs.sendBuffs[i].empty()) {
+      msgs.sendReqs.push_back( MPI_REQUEST_NULL );
+      success = MPI_Send_init( &msgs.sendBuffs[i][0], msgs.sendBuffs[i].size(), MPI_UNSIGNED_CHAR,
+                               neighborProcs[i], mesg_tag, comm, &msgs.sendReqs.back() );
+      if (MPI_SUCCESS != success) {
+        MB_SET_ERR(MB_FAILURE, "Failed to create persistent send request");
+      }
+    }
+    if (!msgs.recvBuffs[i].empty()) {
+      msgs.recvReqs.push_back( MPI_REQUEST_NULL );
+      msgs.recvIndex.push_back( i );
+      success = MPI_Recv_init( &msgs.recvBuffs[i][0], msgs.recvBuffs[i].size(), MPI_UNSIGNED_CHAR,
+                               neighborProcs[i], mesg_tag, comm, &msgs.recvReqs.back() );
+      if (MPI_SUCCESS != success) {
+        MB_SET_ERR(MB_FAILURE, "Failed to create persistent receive request");
+      }
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::gather( Messages& msgs )
+{
+  Interface* mb = myPcomm->get_moab();
+  for (size_t i = 0; i < neighborProcs.size(); ++i) {
+    const std::vector<EntityHandle>& ents = msgs.sendEnts[i];
+    if (ents.empty())
+      continue;
+    unsigned char* ptr = &msgs.sendBuffs[i][0];
+    for (size_t t = 0; t < tagList.size(); ++t) {
+      ErrorCode rval = mb->tag_get_data( tagList[t], &ents[0], ents.size(), ptr );MB_CHK_SET_ERR(rval, "Failed to get tag data for exchange plan");
+      ptr += ents.size() * tagBytes[t];
+    }
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::scatter( const std::vector<EntityHandle>& ents,
+                                    std::vector<unsigned char>& buff,
+                                    const MPI_Op* mpi_op )
+{
+  Interface* mb = myPcomm->get_moab();
+  ErrorCode rval;
+  unsigned char* ptr = &buff[0];
+  for (size_t t = 0; t < tagList.size(); ++t) {
+    if (mpi_op) {
+        // Combine existing values with received values
+      scratch.resize( ents.size() * tagBytes[t] );
+      rval = mb->tag_get_data( tagList[t], &ents[0], ents.size(), &scratch[0] );MB_CHK_SET_ERR(rval, "Failed to get existing tag values");
+      rval = myPcomm->reduce_void( tagTypes[t], *mpi_op, tagLengths[t]*ents.size(), &scratch[0], ptr );MB_CHK_SET_ERR(rval, "Failed to perform mpi op on tags");
+    }
+    rval = mb->tag_set_data( tagList[t], &ents[0], ents.size(), ptr );MB_CHK_SET_ERR(rval, "Failed to set tag data for exchange plan");
+    ptr += ents.size() * tagBytes[t];
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::communicate( Messages& msgs, const MPI_Op* mpi_op )
+{
+  ErrorCode rval;
+  int success;
+
+    // Post receives, gather all values before any are updated, then send
+  if (!msgs.recvReqs.empty()) {
+    success = MPI_Startall( msgs.recvReqs.size(), &msgs.recvReqs[0] );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to start receives for exchange plan");
+    }
+  }
+  rval = gather( msgs );MB_CHK_ERR(rval);
+  if (!msgs.sendReqs.empty()) {
+    success = MPI_Startall( msgs.sendReqs.size(), &msgs.sendReqs[0] );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed to start sends for exchange plan");
+    }
+  }
+
+    // Unpack messages as they arrive
+  for (size_t count = 0; count < msgs.recvReqs.size(); ++count) {
+    int ind;
+    success = MPI_Waitany( msgs.recvReqs.size(), &msgs.recvReqs[0], &ind, MPI_STATUS_IGNORE );
+    if (MPI_SUCCESS != success || MPI_UNDEFINED == ind) {
+      MB_SET_ERR(MB_FAILURE, "Failed in waitany for exchange plan");
+    }
+    const int p = msgs.recvIndex[ind];
+    rval = scatter( msgs.recvEnts[p], msgs.recvBuffs[p], mpi_op );MB_CHK_ERR(rval);
+  }
+
+  if (!msgs.sendReqs.empty()) {
+    success = MPI_Waitall( msgs.sendReqs.size(), &msgs.sendReqs[0], MPI_STATUSES_IGNORE );
+    if (MPI_SUCCESS != success) {
+      MB_SET_ERR(MB_FAILURE, "Failed in waitall for exchange plan");
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+ErrorCode TagExchangePlan::exchange_tags()
+{
+  return communicate( exchangeMsgs, NULL );
+}
+
+ErrorCode TagExchangePlan::reduce_tags( MPI_Op mpi_op )
+{
+  for (size_t t = 0; t < tagTypes.size(); ++t) {
+    if (tagTypes[t] != MB_TYPE_INTEGER && tagTypes[t] != MB_TYPE_DOUBLE &&
+        tagTypes[t] != MB_TYPE_BIT) {
+      MB_SET_ERR(MB_FAILURE, "Tags must have integer, double, or bit data type for reduction");
+    }
+  }
+  return communicate( reduceMsgs, &mpi_op );
+}
+
+} // namespace moab
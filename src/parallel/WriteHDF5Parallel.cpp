@@ -202,6 +202,49 @@ static int my_Gatherv(void* sendbuf,
                      sendtype, root, comm);
 }
 
+// Gather records, concatenated in buffer and record_len() bytes long,
+// on rank 0 of comm.  If group_comm is not MPI_COMM_NULL, gather them
+// on the first process of each group first, keeping one copy of
+// identical records, and then from those processes (leader_comm) on
+// the root, such that the root receives from one process per group
+// rather than from every process.  buffer is empty except on the root.
+static int gather_records(std::vector<unsigned char>& buffer,
+                          size_t (*record_len)(const unsigned char*),
+                          MPI_Comm comm,
+                          MPI_Comm group_comm,
+                          MPI_Comm leader_comm)
+{
+  std::vector<int> junk; // don't care how many from each proc
+  std::vector<unsigned char> recv;
+  int err;
+  if (MPI_COMM_NULL == group_comm) {
+    err = my_Gatherv(buffer.empty() ? 0 : &buffer[0], buffer.size(),
+                     MPI_UNSIGNED_CHAR, recv, junk, 0, comm);
+    buffer.swap(recv);
+    return err;
+  }
+
+  err = my_Gatherv(buffer.empty() ? 0 : &buffer[0], buffer.size(),
+                   MPI_UNSIGNED_CHAR, recv, junk, 0, group_comm);
+  buffer.clear();
+  if (MPI_SUCCESS != err || MPI_COMM_NULL == leader_comm)
+    return err;
+
+  std::set<std::string> seen;
+  for (size_t i = 0; i < recv.size(); ) {
+    const size_t len = record_len(&recv[i]);
+    if (seen.insert(std::string(reinterpret_cast<const char*>(&recv[i]), len)).second)
+      buffer.insert(buffer.end(), recv.begin() + i, recv.begin() + i + len);
+    i += len;
+  }
+
+  recv.clear();
+  err = my_Gatherv(buffer.empty() ? 0 : &buffer[0], buffer.size(),
+                   MPI_UNSIGNED_CHAR, recv, junk, 0, leader_comm);
+  buffer.swap(recv);
+  return err;
+}
+
 static void print_type_sets(Interface* iFace, DebugOutput* str, Range& sets)
 {
   const unsigned VB = 2;
@@ -264,16 +307,26 @@ WriterIface* WriteHDF5Parallel::factory(Interface* iface)
 }
 
 WriteHDF5Parallel::WriteHDF5Parallel(Interface* iface)
-  : WriteHDF5(iface), myPcomm(NULL), pcommAllocated(false), hslabOp(H5S_SELECT_OR)
+  : WriteHDF5(iface), myPcomm(NULL), pcommAllocated(false),
+    groupComm(MPI_COMM_NULL), leaderComm(MPI_COMM_NULL), hslabOp(H5S_SELECT_OR)
 {
 }
 
 WriteHDF5Parallel::~WriteHDF5Parallel()
 {
+  free_aggregation_comms();
   if (pcommAllocated && myPcomm) 
     delete myPcomm;
 }
 
+void WriteHDF5Parallel::free_aggregation_comms()
+{
+  if (MPI_COMM_NULL != groupComm)
+    MPI_Comm_free(&groupComm);
+  if (MPI_COMM_NULL != leaderComm)
+    MPI_Comm_free(&leaderComm);
+}
+
 // The parent WriteHDF5 class has ExportSet structs that are
 // populated with the entities to be written, grouped by type
 // (and for elements, connectivity length).  This function:
@@ -352,6 +405,70 @@ ErrorCode WriteHDF5Parallel::parallel_create_file(const char* filename,
     MPI_Info_set (info, const_cast<char*>("cb_buffer_size"), const_cast<char*>(cb_size.c_str()));
   }
 
+  // Aggregated (two-phase) I/O: only a subset of the processes access
+  // the file.  Each of these aggregators gathers the data for a
+  // contiguous region of the file from the other processes and writes
+  // it with large contiguous writes.  As the data for consecutive ranks
+  // is contiguous in each table, each aggregator gathers from a group of
+  // neighboring ranks.
+  int num_aggregators = 0, aggregators_per_node = 0;
+  rval = opts.get_int_option("AGGREGATORS", num_aggregators);
+  if (MB_TYPE_OUT_OF_RANGE == rval || (MB_SUCCESS == rval && num_aggregators < 1)) {
+    MB_SET_ERR(MB_TYPE_OUT_OF_RANGE, "Invalid value for AGGREGATORS option");
+  }
+  rval = opts.get_int_option("AGGREGATORS_PER_NODE", aggregators_per_node);
+  if (MB_TYPE_OUT_OF_RANGE == rval || (MB_SUCCESS == rval && aggregators_per_node < 1)) {
+    MB_SET_ERR(MB_TYPE_OUT_OF_RANGE, "Invalid value for AGGREGATORS_PER_NODE option");
+  }
+  const bool aggregate = num_aggregators || aggregators_per_node;
+  if (aggregate) {
+    if (MPI_INFO_NULL == info)
+      MPI_Info_create (&info);
+    MPI_Info_set (info, const_cast<char*>("romio_cb_write"), const_cast<char*>("enable"));
+    std::ostringstream val;
+    if (num_aggregators) {
+      val << num_aggregators;
+      MPI_Info_set (info, const_cast<char*>("cb_nodes"), const_cast<char*>(val.str().c_str()));
+    }
+    if (aggregators_per_node) {
+      val.str("");
+      val << "*:" << aggregators_per_node;
+      MPI_Info_set (info, const_cast<char*>("cb_config_list"), const_cast<char*>(val.str().c_str()));
+    }
+
+    // Use the same groups of neighboring ranks to gather the type and
+    // tag definitions negotiated before the file is created: each
+    // group gathers on its first rank, and the root gathers only from
+    // these.
+    const MPI_Comm comm = myPcomm->proc_config().proc_comm();
+    const int rank = myPcomm->proc_config().proc_rank();
+    const int size = myPcomm->proc_config().proc_size();
+    int err;
+    free_aggregation_comms();
+    if (num_aggregators) {
+      const int color = (int)((long)rank * std::min(num_aggregators, size) / size);
+      err = MPI_Comm_split(comm, color, rank, &groupComm);CHECK_MPI(err);
+    }
+    else {
+      MPI_Comm node_comm;
+#if MPI_VERSION >= 3
+      err = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);CHECK_MPI(err);
+#else
+      err = MPI_Comm_split(comm, rank, 0, &node_comm);CHECK_MPI(err);
+#endif
+      int node_rank, node_size;
+      MPI_Comm_rank(node_comm, &node_rank);
+      MPI_Comm_size(node_comm, &node_size);
+      const int color = (int)((long)node_rank * std::min(aggregators_per_node, node_size) / node_size);
+      err = MPI_Comm_split(node_comm, color, rank, &groupComm);
+      MPI_Comm_free(&node_comm);
+      CHECK_MPI(err);
+    }
+    int group_rank;
+    MPI_Comm_rank(groupComm, &group_rank);
+    err = MPI_Comm_split(comm, group_rank ? MPI_UNDEFINED : 0, rank, &leaderComm);CHECK_MPI(err);
+  }
+
   dbgOut.set_rank(myPcomm->proc_config().proc_rank());
   dbgOut.limit_output_to_first_N_procs(32);
   Range nonlocal;
@@ -385,6 +502,11 @@ ErrorCode WriteHDF5Parallel::parallel_create_file(const char* filename,
       MB_SET_ERR(MB_FAILURE, mhdf_message(&status));
     }
 
+    mhdf_setDataLayout(filePtr, chunkSize, deflateLevel, shuffleData, &status);
+    if (mhdf_isError(&status)) {
+      MB_SET_ERR(MB_FAILURE, mhdf_message(&status));
+    }
+
     dbgOut.tprint(1, "call write_qa\n");
     rval = write_qa(qa_records);
     if (MB_SUCCESS != rval)
@@ -447,6 +569,18 @@ ErrorCode WriteHDF5Parallel::parallel_create_file(const char* filename,
   if (times)
     times[CREATE_SET_TIME] = timer.time_elapsed();
 
+  /**************** Create partition index *********************/
+
+  if (writePartIndex) {
+    debug_barrier();
+    dbgOut.tprint(1, "creating partition index\n");
+    topState.start("creating partition index");
+    rval = create_partition_index_tables();
+    topState.end(rval);
+    if (MB_SUCCESS != rval)
+      return error(rval);
+  }
+
   /**************** Create adjacency tables *********************/
 
   debug_barrier();
@@ -484,6 +618,16 @@ ErrorCode WriteHDF5Parallel::parallel_create_file(const char* filename,
   unsigned long junk;
   hid_t hdf_opt = H5Pcreate(H5P_FILE_ACCESS);
   H5Pset_fapl_mpio(hdf_opt, myPcomm->proc_config().proc_comm(), info);
+#if defined(H5_VERSION_GE)
+#if H5_VERSION_GE(1, 10, 0)
+  // Have one process read file metadata (table headers, etc.) and
+  // broadcast it rather than having every process read it.
+  if (aggregate) {
+    H5Pset_all_coll_metadata_ops(hdf_opt, true);
+    H5Pset_coll_metadata_write(hdf_opt, true);
+  }
+#endif
+#endif
   filePtr = mhdf_openFileWithOpt(filename, 1, &junk, id_type, hdf_opt, &status);
   H5Pclose(hdf_opt);
   if (!filePtr) {
@@ -560,6 +704,11 @@ struct serial_tag_data {
   void set_default_value(const void* val) { memcpy(default_value(), val, def_val_bytes(def_val_len, type)); }
 };
 
+static size_t serial_tag_len(const unsigned char* ptr)
+{
+  return reinterpret_cast<const serial_tag_data*>(ptr)->len();
+}
+
 ErrorCode WriteHDF5Parallel::append_serial_tag_data(std::vector<unsigned char>& buffer,
                                                     const WriteHDF5::TagDesc& tag)
 {
@@ -778,10 +927,8 @@ ErrorCode WriteHDF5Parallel::create_tag_tables()
     }
 
     // Gather extra tag definitions on root processor
-    std::vector<int> junk; // don't care how many from each proc
     assert(rank || tag_buffer.empty()); // must be empty on root
-    err = my_Gatherv(&tag_buffer[0], tag_buffer.size(),
-                     MPI_UNSIGNED_CHAR, tag_buffer, junk, 0, comm);CHECK_MPI(err);
+    err = gather_records(tag_buffer, &serial_tag_len, comm, groupComm, leaderComm);CHECK_MPI(err);
 
     // Process serialized tag descriptions on root, and
     rval = MB_SUCCESS;
@@ -1013,6 +1160,24 @@ struct DatasetVals {
 };
 STATIC_ASSERT(sizeof(DatasetVals) == 3 * sizeof(long));
 
+ErrorCode WriteHDF5Parallel::create_partition_index_tables()
+{
+  ErrorCode rval = gather_partition_index();CHECK_MB(rval);
+
+  long counts[2] = { (long)partIndexData.size() / 2, (long)partRangeData.size() / 2 };
+  long offsets[2], maxima[2], totals[2];
+  rval = create_dataset(2, counts, offsets, maxima, totals);CHECK_MB(rval);
+  partIndexOffset = offsets[0];
+  partRangeOffset = offsets[1];
+
+  writePartIndex = (totals[1] > 0);
+  if (writePartIndex && 0 == myPcomm->proc_config().proc_rank()) {
+    rval = create_partition_index(totals[0], totals[1]);CHECK_MB(rval);
+  }
+
+  return MB_SUCCESS;
+}
+
 ErrorCode WriteHDF5Parallel::create_dataset(int num_datasets,
                                             const long* num_owned,
                                             long* offsets_out,
@@ -1025,28 +1190,24 @@ ErrorCode WriteHDF5Parallel::create_dataset(int num_datasets,
   int result;
   ErrorCode rval;
   const unsigned rank  = myPcomm->proc_config().proc_rank();
-  const unsigned nproc = myPcomm->proc_config().proc_size();
   const MPI_Comm comm  = myPcomm->proc_config().proc_comm();
 
-  // Gather entity counts for each processor on root
-  std::vector<long> counts(rank ? 0 : nproc * num_datasets);
+  // Reduce entity counts to totals and maxima on root.  Unlike
+  // gathering the per-process counts on root, the cost of this
+  // (and of the prefix sum below) grows only logarithmically
+  // with the number of processes.
   (void)VALGRIND_CHECK_MEM_IS_DEFINED(&num_owned, sizeof(long));
-  result = MPI_Gather(const_cast<long*>(num_owned), num_datasets, MPI_LONG, &counts[0], num_datasets, MPI_LONG, 0, comm);CHECK_MPI(result);
+  std::vector<long> totals(num_datasets), maxima(num_datasets);
+  result = MPI_Reduce(const_cast<long*>(num_owned), &totals[0], num_datasets, MPI_LONG, MPI_SUM, 0, comm);CHECK_MPI(result);
+  result = MPI_Reduce(const_cast<long*>(num_owned), &maxima[0], num_datasets, MPI_LONG, MPI_MAX, 0, comm);CHECK_MPI(result);
 
   // Create node data in file
   DatasetVals zero_val = {0, 0, 0};
   std::vector<DatasetVals> cumulative(num_datasets, zero_val);
   if (rank == 0) {
-    for (unsigned i = 0; i < nproc; i++) {
-      const long* proc_data = &counts[i * num_datasets];
-      for (int index = 0; index < num_datasets; ++index) {
-        cumulative[index].total += proc_data[index];
-        if (proc_data[index] > cumulative[index].max_count)
-          cumulative[index].max_count = proc_data[index];
-      }
-    }
-
     for (int index = 0; index < num_datasets; ++index) {
+      cumulative[index].total = totals[index];
+      cumulative[index].max_count = maxima[index];
       if (cumulative[index].total) {
         rval = creator(this,
                        cumulative[index].total,
@@ -1068,36 +1229,13 @@ ErrorCode WriteHDF5Parallel::create_dataset(int num_datasets,
     total_entities[index] = cumulative[index].total;
   }
 
-  // Convert array of per-process counts to per-process offsets
-  if (rank == 0) {
-    // Initialize prev_size with data sizes for root process
-    std::vector<long> prev_size(counts.begin(), counts.begin() + num_datasets);
-    // Root process gets offset zero
-    std::fill(counts.begin(), counts.begin() + num_datasets, 0L);
-    // For each proc other than this one (root)
-    for (unsigned i = 1; i < nproc; ++i) {
-      // Get pointer to offsets for previous process in list
-      long* prev_data = &counts[(i - 1) * num_datasets];
-      // Get pointer to offsets for this process in list
-      long* proc_data = &counts[i * num_datasets];
-      // For each data set
-      for (int j = 0; j < num_datasets; ++j) {
-        // Get size of data in dataset from process i
-        long mysize = proc_data[j];
-        // Offset for process i is offset of previous process plus
-        // number of values previous process will write
-        proc_data[j] = prev_data[j] + prev_size[j];
-        // Store my size, as it is no longer available in 'counts'
-        prev_size[j] = mysize;
-      }
-    }
-  }
-
-  // Send each proc it's offset in the table
-  if (rank == 0) {
-    (void)VALGRIND_CHECK_MEM_IS_DEFINED(&counts[0], num_datasets*nproc*sizeof(long));
-  }
-  result = MPI_Scatter(&counts[0], num_datasets, MPI_LONG, offsets_out, num_datasets, MPI_LONG, 0, comm);CHECK_MPI(result);
+  // The offset of each process in the table is the number of values
+  // written by all lower-ranked processes, such that the data from
+  // consecutive ranks is contiguous in the file.  The result of the
+  // exclusive scan is undefined on the first process.
+  result = MPI_Exscan(const_cast<long*>(num_owned), offsets_out, num_datasets, MPI_LONG, MPI_SUM, comm);CHECK_MPI(result);
+  if (rank == 0)
+    std::fill(offsets_out, offsets_out + num_datasets, 0L);
 
   return MB_SUCCESS;
 }
@@ -1154,6 +1292,11 @@ struct elemtype {
     { return !this->operator==(other); }
 };
 
+static size_t type_pair_len(const unsigned char*)
+{
+  return sizeof(std::pair<int, int>);
+}
+
 ErrorCode WriteHDF5Parallel::negotiate_type_list()
 {
   int result;
@@ -1205,23 +1348,16 @@ ErrorCode WriteHDF5Parallel::negotiate_type_list()
   int not_done;
   result = MPI_Allreduce(&non_root_count, &not_done, 1, MPI_INT, MPI_LOR, comm);CHECK_MPI(result);
   if (not_done) {
-    // Get number of types each processor has that root does not
-    std::vector<int> counts(myPcomm->proc_config().proc_size());
-    int two_count = 2*non_root_count;
-    result = MPI_Gather(&two_count, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, comm);CHECK_MPI(result);
-
     // Get list of types from each processor
-    std::vector<int> displs(myPcomm->proc_config().proc_size() + 1);
-    (void)VALGRIND_MAKE_VEC_UNDEFINED(displs);
-    displs[0] = 0;
-    for (unsigned long i = 1; i <= myPcomm->proc_config().proc_size(); ++i)
-      displs[i] = displs[i - 1] + counts[i - 1];
-    int total = displs[myPcomm->proc_config().proc_size()];
-    typelist alltypes(total/2);
-    (void)VALGRIND_MAKE_VEC_UNDEFINED(alltypes);
+    std::vector<unsigned char> buffer(non_root_count * sizeof(typelist::value_type));
     (void)VALGRIND_CHECK_MEM_IS_DEFINED(&non_root_types[0], non_root_types.size()*sizeof(int));
-    result = MPI_Gatherv(&non_root_types[0], 2 * non_root_count, MPI_INT,
-                         &alltypes[0], &counts[0], &displs[0], MPI_INT, 0, comm);CHECK_MPI(result);
+    if (non_root_count)
+      memcpy(&buffer[0], &non_root_types[0], buffer.size());
+    result = gather_records(buffer, &type_pair_len, comm, groupComm, leaderComm);CHECK_MPI(result);
+    typelist alltypes(buffer.size() / sizeof(typelist::value_type));
+    const int* vals = buffer.empty() ? 0 : reinterpret_cast<const int*>(&buffer[0]);
+    for (size_t i = 0; i < alltypes.size(); ++i)
+      alltypes[i] = std::make_pair(vals[2*i], vals[2*i + 1]);
 
     // Merge type lists.
     // Prefer O(n) insertions with O(ln n) search time because
@@ -1240,7 +1376,7 @@ ErrorCode WriteHDF5Parallel::negotiate_type_list()
     }
 
     // Send total number of types to each processor
-    total = my_types.size();
+    int total = my_types.size();
     result = MPI_Bcast(&total, 1, MPI_INT, 0, comm);CHECK_MPI(result);
 
     // Send list of types to each processor
@@ -108,6 +108,9 @@ class WriteHDF5Parallel : public WriteHDF5
       //! Create tables for mesh sets
     ErrorCode create_meshset_tables(double* times);
     
+      //! Create partition index tables (see PARTITION_INDEX option)
+    ErrorCode create_partition_index_tables();
+    
       //! Write tag descriptions and create tables to hold tag data.
     ErrorCode create_tag_tables();
    
@@ -187,6 +190,15 @@ class WriteHDF5Parallel : public WriteHDF5
 
       //! whether this instance allocated (and dtor should delete) the pcomm
     bool pcommAllocated;
+
+      //! Processes in the same aggregation group (MPI_COMM_NULL if not aggregating)
+    MPI_Comm groupComm;
+
+      //! First process of each aggregation group (MPI_COMM_NULL on other processes)
+    MPI_Comm leaderComm;
+
+      //! Free groupComm and leaderComm
+    void free_aggregation_comms();
     
       //! Operation to use to append hyperslab selections
     H5S_seloper_t hslabOp;
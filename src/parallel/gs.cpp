@@ -70,6 +70,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <math.h>
+#include <vector>
 #include "moab/gs.hpp"
 #ifdef MOAB_HAVE_MPI
 #  include "moab_mpi.h"
@@ -438,6 +439,10 @@ void gs_data::crystal_data::initialize(MPI_Comm comm)
   this->_id =id;
   MPI_Comm_size(comm,&num);
   this->_num=num;
+  _method = CRYSTAL_ROUTER;
+  const char* method = getenv("MOAB_GS_TRANSFER");
+  if (method && !strcmp(method, "sparse"))
+    _method = SPARSE_EXCHANGE;
 }
 
 void gs_data::crystal_data::reset()
@@ -529,6 +534,12 @@ void gs_data::crystal_data::crystal_router()
   uint bl=0, bh, n=_num, nl, target;
   int recvn;
   crystal_buf *lo, *hi;
+#if MPI_VERSION >= 3
+  if (SPARSE_EXCHANGE == _method && _num > 1) {
+    sparse_exchange();
+    return;
+  }
+#endif
   while (n>1)
   {
     nl = n/2, bh = bl+nl;
@@ -556,6 +567,111 @@ void gs_data::crystal_data::crystal_router()
   }
 }
 
+#if MPI_VERSION >= 3
+/* MPI tags for the sparse exchange.  The crystal router uses the source
+   proc as tag; use the largest tags that are always valid instead.  A proc
+   whose barrier has completed may already send the messages of the next
+   exchange while others still probe for those of the current one, so
+   consecutive exchanges alternate between two tags. */
+#define SPARSE_EXCHANGE_TAG 32766
+
+/* The alternation must be shared by all crystal_data instances on a
+   communicator (e.g. the one of ProcConfig and the one of ParallelMergeMesh),
+   so the number of exchanges done is kept as an attribute of the
+   communicator rather than in each instance. */
+static int sparse_count_keyval = MPI_KEYVAL_INVALID;
+
+static int delete_sparse_count(MPI_Comm, int, void* val, void*)
+{
+  delete (unsigned long*)val;
+  return MPI_SUCCESS;
+}
+
+static int next_sparse_exchange_tag(MPI_Comm comm)
+{
+  if (MPI_KEYVAL_INVALID == sparse_count_keyval)
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, &delete_sparse_count,
+                           &sparse_count_keyval, 0);
+  unsigned long* count;
+  int flag;
+  MPI_Comm_get_attr(comm, sparse_count_keyval, &count, &flag);
+  if (!flag) {
+    count = new unsigned long(0);
+    MPI_Comm_set_attr(comm, sparse_count_keyval, count);
+  }
+  return SPARSE_EXCHANGE_TAG + ((*count)++ & 1);
+}
+
+//Send each message directly to its target, receiving whatever arrives until
+//all procs are done sending (Hoefler et al., "Scalable communication
+//protocols for dynamic sparse data exchange")
+void gs_data::crystal_data::sparse_exchange()
+{
+  const uint *src = (uint*) all->buf.ptr;
+  const uint *end = src + all->n;
+  std::vector<MPI_Request> reqs;
+  MPI_Request barrier = MPI_REQUEST_NULL;
+  MPI_Status status;
+  int flag, count, done = 0;
+  const int mtag = next_sparse_exchange_tag(_comm);
+
+  /* messages to this proc go straight to keep, others are sent */
+  keep->n = 0;
+  while (src != end)
+  {
+    uint chunk_len = 3 + src[2];
+    if (src[0] == _id) {
+      keep->buf.buffer_reserve((keep->n+chunk_len)*sizeof(uint));
+      memcpy((uint*)keep->buf.ptr+keep->n, src, chunk_len*sizeof(uint));
+      keep->n += chunk_len;
+    }
+    else {
+      reqs.push_back(MPI_REQUEST_NULL);
+      (void)VALGRIND_CHECK_MEM_IS_DEFINED( src, chunk_len*sizeof(uint) );
+      MPI_Issend((void*)src, chunk_len*sizeof(uint), MPI_UNSIGNED_CHAR,
+          src[0], mtag, _comm, &reqs.back());
+    }
+    src += chunk_len;
+  }
+
+  /* a synchronous send completes only when it has been matched, so once all
+     our sends are done we enter the barrier; when the barrier completes every
+     proc has had all its messages received */
+  bool in_barrier = false;
+  while (!done)
+  {
+    MPI_Iprobe(MPI_ANY_SOURCE, mtag, _comm, &flag, &status);
+    if (flag) {
+      MPI_Get_count(&status, MPI_UNSIGNED_CHAR, &count);
+      keep->buf.buffer_reserve(keep->n*sizeof(uint) + count);
+      MPI_Recv((uint*)keep->buf.ptr+keep->n, count, MPI_UNSIGNED_CHAR,
+          status.MPI_SOURCE, mtag, _comm, MPI_STATUS_IGNORE);
+      keep->n += count/sizeof(uint);
+    }
+    if (in_barrier)
+      MPI_Test(&barrier, &done, MPI_STATUS_IGNORE);
+    else {
+      int sent = 1;
+      if (!reqs.empty())
+        MPI_Testall(reqs.size(), &reqs[0], &sent, MPI_STATUSES_IGNORE);
+      if (sent) {
+        MPI_Ibarrier(_comm, &barrier);
+        in_barrier = true;
+      }
+    }
+  }
+
+  crystal_buf *t = all;
+  all = keep;
+  keep = t;
+}
+#else
+void gs_data::crystal_data::sparse_exchange()
+{
+  crystal_router();
+}
+#endif
+
 #define UINT_PER_X(X) ((sizeof(X)+sizeof(uint)-1)/sizeof(uint))
 #define UINT_PER_REAL UINT_PER_X(realType)
 #define UINT_PER_LONG UINT_PER_X(slong)
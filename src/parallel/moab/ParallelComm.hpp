@@ -55,6 +55,7 @@ namespace moab {
   public:
 
     friend class ParallelMergeMesh;
+    friend class TagExchangePlan;
   
     // ==================================
     // \section CONSTRUCTORS/DESTRUCTORS/PCOMM MANAGEMENT
@@ -248,6 +249,27 @@ namespace moab {
                                    bool wait_all = true,
                                    EntityHandle *file_set = NULL);
 
+    /** \brief Start a split-phase ghost exchange
+     * Posts receives, then packs and sends the entities to be ghosted,
+     * returning without waiting for any incoming messages.  This allows
+     * the application to do other work, e.g. computation on interior
+     * entities, while the ghost messages are in transit.  The exchange
+     * is completed by end_exchange_ghost_cells, which must be called
+     * before any other communication through this instance.  Arguments
+     * are as for exchange_ghost_cells.
+     */
+    ErrorCode begin_exchange_ghost_cells(int ghost_dim, int bridge_dim,
+                                         int num_layers, int addl_ents,
+                                         bool store_remote_handles,
+                                         bool wait_all = true,
+                                         EntityHandle *file_set = NULL);
+
+    /** \brief Complete a ghost exchange started with begin_exchange_ghost_cells
+     * Unpacks the remaining entity messages in the order in which they
+     * arrive, then exchanges remote handles with the sending procs.
+     */
+    ErrorCode end_exchange_ghost_cells();
+
     /** \brief Static version of exchange_ghost_cells, exchanging info through
      * buffers rather than messages
      */
@@ -331,6 +353,34 @@ namespace moab {
      */
     ErrorCode exchange_tags( Tag tagh,
                              const Range &entities);
+
+    /** \brief Start a split-phase tag exchange
+     * Posts receives, then packs and sends the tag values, returning
+     * without waiting for any incoming messages.  The tags on ghosted/shared
+     * entities should not be modified until end_exchange_tags is called,
+     * which must be done before any other communication through this
+     * instance.  Arguments are as for exchange_tags.
+     */
+    ErrorCode begin_exchange_tags( const std::vector<Tag> &src_tags,
+                                   const std::vector<Tag> &dst_tags,
+                                   const Range &entities );
+
+    //! Complete a tag exchange started with begin_exchange_tags
+    ErrorCode end_exchange_tags();
+
+    /** \brief Process messages of a pending split-phase exchange
+     * Unpacks any messages of an exchange started with
+     * begin_exchange_ghost_cells or begin_exchange_tags that have arrived,
+     * without blocking.  May be called periodically during work overlapped
+     * with the exchange, such that large messages (which require a handshake
+     * with the sender) progress before the exchange is completed.
+     * \param done Set to true if all incoming messages of the first phase
+     *        of the exchange have been received and unpacked
+     */
+    ErrorCode progress_exchange( bool* done = NULL );
+
+    //! Return true if a split-phase exchange has been started and not completed
+    bool exchange_pending() const { return NULL != pendingExchange; }
   
     /** \brief Perform data reduction operation for all shared and ghosted entities
      * This function should be called collectively over the communicator for this ParallelComm.
@@ -444,6 +494,26 @@ namespace moab {
                                          EntityHandle this_set,
                                          const int to_dim);
 
+    /** \brief Use a two-level algorithm for resolving shared vertices
+     *
+     * By default, resolve_shared_ents sends the global ids of all skin
+     * vertices through the crystal router to find the sharing procs.  With
+     * hierarchical resolution, the skin vertices are first resolved among
+     * the procs on the same node.  Then only vertices on skin faces that are
+     * not shared with a proc on the same node are resolved between nodes.
+     * The result is the same.  Resolution of structured meshes and of
+     * meshes with 1D partitions is not affected.
+     *
+     * \param enable Use hierarchical resolution in resolve_shared_ents
+     * \param ranks_per_node If zero, procs are grouped by shared-memory node
+     *        (requires MPI-3; otherwise each proc is its own node); else
+     *        consecutive blocks of this many ranks form a node
+     */
+    void set_hierarchical_resolve(bool enable, int ranks_per_node = 0)
+      { hierResolve = enable; hierRanksPerNode = ranks_per_node; }
+
+    bool hierarchical_resolve() const { return hierResolve; }
+
     /** Remove shared sets.
      *
      * Generates list of candidate sets using from those (directly)
@@ -1263,6 +1333,19 @@ namespace moab {
                              Range *skin_ents,
                              std::map<std::vector<int>, std::vector<EntityHandle> > &proc_nvecs);
 
+    //! Find sharing procs and handles of skin vertices with the flat
+    //! (one-level) algorithm; shared_verts is (index, proc; handle)
+    ErrorCode get_shared_verts(Range *skin_ents,
+                               std::vector<long> &lgid_data,
+                               TupleList &shared_verts);
+
+    //! Same as get_shared_verts, but resolving within each node first;
+    //! see set_hierarchical_resolve
+    ErrorCode get_shared_verts_hierarchical(Range *skin_ents,
+                                            int skin_dim,
+                                            std::vector<long> &lgid_data,
+                                            TupleList &shared_verts);
+
     // after verifying shared entities, now parent/child links between sets can be established
     ErrorCode create_iface_pc_links();
   
@@ -1435,6 +1518,20 @@ namespace moab {
   
     //! Data about shared sets
     SharedSetData* sharedSetData;
+
+    //! Use hierarchical algorithm in resolve_shared_ents
+    bool hierResolve;
+    int hierRanksPerNode;
+
+    //! State of split-phase ghost or tag exchange, NULL if none pending
+    struct PendingExchange;
+    PendingExchange* pendingExchange;
+
+    //! Receive/unpack one message of a pending ghost exchange
+    ErrorCode recv_ghost_message(int ind, MPI_Status& status);
+
+    //! Receive/unpack one message of a pending tag exchange
+    ErrorCode recv_tag_message(int ind, MPI_Status& status);
   
   };
 
@@ -0,0 +1,120 @@
+/**
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#ifndef MOAB_TAG_EXCHANGE_PLAN_HPP
+#define MOAB_TAG_EXCHANGE_PLAN_HPP
+
+#include "moab/Types.hpp"
+#include "moab/Range.hpp"
+#include "moab_mpi.h"
+#include <vector>
+
+namespace moab {
+
+class ParallelComm;
+
+/**\brief Precomputed communication plan for repeated tag exchange/reduction
+ *
+ * ParallelComm::exchange_tags and ParallelComm::reduce_tags find the shared
+ * entities for each neighboring proc, pack the entity handles together with
+ * the tag values, and allocate message buffers in each call.  For applications
+ * that exchange the same tags on the same entities many times, this class
+ * does that work once: setup determines, for each neighbor, the list of
+ * entities for which values are sent and the (matching) list for which values
+ * are received, allocates the message buffers, and creates MPI persistent
+ * requests for them.  Each exchange is then only a gather of the tag values
+ * into the send buffers and a scatter of the received values.
+ *
+ * The plan is invalidated by any change of the shared or ghosted entities,
+ * e.g. a new ghost exchange, after which setup must be called again.  The
+ * tags must have a fixed size and all entities in the plan must have a value
+ * for each tag (or the tag must have a default value).  Tags of handle type
+ * are not supported.
+ */
+class TagExchangePlan
+{
+public:
+
+  TagExchangePlan( ParallelComm* pcomm );
+
+  ~TagExchangePlan();
+
+  /**\brief Build the plan
+   *
+   * Collective over the communicator of the ParallelComm.
+   * \param tags Tags to be exchanged or reduced
+   * \param entities Entities for which tags are exchanged; if empty, all
+   *        shared entities (as for ParallelComm::exchange_tags)
+   */
+  ErrorCode setup( const std::vector<Tag>& tags, const Range& entities );
+
+  /**\brief Send tag values from owned entities to copies on other procs
+   *
+   * Equivalent to ParallelComm::exchange_tags for the tags and entities
+   * passed to setup.  Collective.
+   */
+  ErrorCode exchange_tags();
+
+  /**\brief Reduce tag values over all procs sharing each entity
+   *
+   * Equivalent to ParallelComm::reduce_tags with the same source and
+   * destination tags.  Tags must have integer, double or bit data type.
+   * Collective.
+   */
+  ErrorCode reduce_tags( MPI_Op mpi_op );
+
+  //! Release all buffers and requests
+  void clear();
+
+  //! Number of neighboring procs with which messages are exchanged
+  size_t num_neighbors() const { return neighborProcs.size(); }
+
+private:
+
+    // Messages in one direction (for exchange or reduce) with all neighbors
+  struct Messages
+  {
+    std::vector< std::vector<EntityHandle> > sendEnts, recvEnts;
+    std::vector< std::vector<unsigned char> > sendBuffs, recvBuffs;
+    std::vector<MPI_Request> sendReqs, recvReqs;
+    std::vector<int> recvIndex; //!< neighbor index for each recv request
+  };
+
+  ErrorCode get_send_lists( const Range& entities, bool owned_only,
+                            std::vector< std::vector<EntityHandle> >& local,
+                            std::vector< std::vector<EntityHandle> >& remote );
+  ErrorCode exchange_handles( std::vector< std::vector<EntityHandle> >& remote,
+                              std::vector< std::vector<EntityHandle> >& recv_ents );
+  ErrorCode init_requests( Messages& msgs, int mesg_tag );
+  ErrorCode gather( Messages& msgs );
+  ErrorCode communicate( Messages& msgs, const MPI_Op* mpi_op );
+  ErrorCode scatter( const std::vector<EntityHandle>& ents,
+                     std::vector<unsigned char>& buff,
+                     const MPI_Op* mpi_op );
+  static void free_requests( std::vector<MPI_Request>& reqs );
+
+  ParallelComm* myPcomm;
+  std::vector<Tag> tagList;
+  std::vector<int> tagBytes, tagLengths;
+  std::vector<DataType> tagTypes;
+  size_t bytesPerEntity;
+  std::vector<unsigned int> neighborProcs;
+  Messages exchangeMsgs, reduceMsgs;
+  std::vector<unsigned char> scratch;
+};
+
+} // namespace moab
+
+#endif
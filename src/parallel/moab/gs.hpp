@@ -100,6 +100,18 @@ namespace moab {
 
       crystal.reset(); // release acquired memory
 
+      Sparse exchange
+
+      The crystal router forwards each message up to log P times.  When each
+      proc only talks to a few others, it can be cheaper to send each message
+      directly to its target.  With set_transfer_method(SPARSE_EXCHANGE),
+      crystal_router() and gs_transfer() send the messages with synchronous
+      sends and detect termination with a non-blocking barrier (the "NBX"
+      algorithm), so no proc needs to know in advance whom it receives from.
+      This requires MPI-3; otherwise the crystal router is always used.
+      The initial method is taken from the environment variable
+      MOAB_GS_TRANSFER ("crystal" or "sparse") if it is set.
+
       ---------------------------------------------------------------------------*/
 
     class crystal_data
@@ -113,6 +125,9 @@ namespace moab {
       MPI_Comm _comm;
       uint _num, _id;
 
+      //Algorithms used to route messages
+      enum transfer_method { CRYSTAL_ROUTER, SPARSE_EXCHANGE };
+
       /**Default constructor (Note:  moab_crystal_data must be initialized
        * before use!)
        */
@@ -152,12 +167,24 @@ namespace moab {
       ErrorCode gs_transfer(int dynamic, moab::TupleList &tl,
 			      unsigned pf);
 
+      /**Set the algorithm used by crystal_router and gs_transfer; see
+       * class description.  Collective: all procs must use the same method.
+       */
+      void set_transfer_method(transfer_method method) { _method = method; }
+
+      transfer_method get_transfer_method() const { return _method; }
+
     private:
       //Used by moab_crystal_router:  see .cpp for more details
       void partition(uint cutoff, crystal_buf *lo, crystal_buf *hi);
 
       void send_(uint target, int recvn);
 
+      //Sparse (NBX) alternative to the crystal router
+      void sparse_exchange();
+
+      transfer_method _method;
+
     };
 #else
     //If mpi is not used, moab_crystal_data cannot be used
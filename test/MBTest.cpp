@@ -961,6 +961,80 @@ ErrorCode mb_upward_adjacencies_test()
   return MB_SUCCESS;
 }
 
+static ErrorCode compare_all_adjacencies( Interface* mb1, Interface* mb2 )
+{
+  ErrorCode rval;
+  Range ents1, ents2;
+  rval = mb1->get_entities_by_handle( 0, ents1 );
+  CHKERR(rval);
+  rval = mb2->get_entities_by_handle( 0, ents2 );
+  CHKERR(rval);
+  CHECK( ents1 == ents2 );
+  for (Range::iterator i = ents1.begin(); i != ents1.end(); ++i) {
+    if (mb1->type_from_handle(*i) == MBENTITYSET)
+      continue;
+    for (int dim = 0; dim <= 3; ++dim) {
+      std::vector<EntityHandle> adj1, adj2;
+      rval = mb1->get_adjacencies( &*i, 1, dim, false, adj1 );
+      CHKERR(rval);
+      rval = mb2->get_adjacencies( &*i, 1, dim, false, adj2 );
+      CHKERR(rval);
+      std::sort( adj1.begin(), adj1.end() );
+      std::sort( adj2.begin(), adj2.end() );
+      CHECK( adj1 == adj2 );
+    }
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_compact_adjacencies_test()
+{
+  ErrorCode rval;
+  Core moab1, moab2;
+  Interface *mb1 = &moab1, *mb2 = &moab2;
+  
+    // create identical meshes, and compact adjacencies in only one of them
+  EntityHandle verts[12], hexes[2], hex1_faces[6], hex2_faces[6], hex1_edges[12], hex2_edges[12];
+  rval = create_two_hex_full_mesh( mb1, verts, hexes, hex1_faces, hex2_faces, hex1_edges, hex2_edges );
+  CHKERR(rval);
+  rval = create_two_hex_full_mesh( mb2, verts, hexes, hex1_faces, hex2_faces, hex1_edges, hex2_edges );
+  CHKERR(rval);
+  rval = moab1.compact_adjacencies();
+  CHKERR(rval);
+  rval = compare_all_adjacencies( mb1, mb2 );
+  CHKERR(rval);
+  
+    // compact storage should use less memory than per-entity vectors
+  unsigned long long adj1, amortized_adj1, adj2, amortized_adj2;
+  mb1->estimated_memory_use( 0, 0, 0, 0, 0, 0, &adj1, &amortized_adj1 );
+  mb2->estimated_memory_use( 0, 0, 0, 0, 0, 0, &adj2, &amortized_adj2 );
+  CHECK( adj1 < adj2 );
+  CHECK( amortized_adj1 < amortized_adj2 );
+  
+    // modify both meshes after compacting one
+  const EntityHandle tri_conn[3] = { verts[0], verts[1], verts[2] };
+  EntityHandle tri1, tri2;
+  rval = mb1->create_element( MBTRI, tri_conn, 3, tri1 );
+  CHKERR(rval);
+  rval = mb2->create_element( MBTRI, tri_conn, 3, tri2 );
+  CHKERR(rval);
+  CHECK_EQUAL( tri1, tri2 );
+  rval = mb1->delete_entities( hexes, 1 );
+  CHKERR(rval);
+  rval = mb2->delete_entities( hexes, 1 );
+  CHKERR(rval);
+  rval = compare_all_adjacencies( mb1, mb2 );
+  CHKERR(rval);
+  
+    // compacting a second time should fold the modified lists back in
+  rval = moab1.compact_adjacencies();
+  CHKERR(rval);
+  rval = compare_all_adjacencies( mb1, mb2 );
+  CHKERR(rval);
+  
+  return MB_SUCCESS;
+}
+
 ErrorCode mb_adjacent_create_test() 
 {
   Core moab;
@@ -7723,6 +7797,142 @@ ErrorCode mb_skin_regions_full_test()
 ErrorCode mb_skin_adj_regions_full_test()
   { return mb_skin_full_common( 3, true ); }
         
+// Create a grid of n^dim quads or hexes with explicit entities for
+// some element sides, some of which are reversed.  Pass back the
+// elements in one half of the grid.
+static ErrorCode make_skin_threaded_mesh( Interface& mb, int dim, Range& half )
+{
+  const int n = 6, nv = n + 1;
+  const int nk = (3 == dim) ? nv : 1;
+  const EntityType type = (3 == dim) ? MBHEX : MBQUAD;
+  std::vector<double> coords;
+  for (int k = 0; k < nk; ++k)
+    for (int j = 0; j < nv; ++j)
+      for (int i = 0; i < nv; ++i) {
+        coords.push_back( i );
+        coords.push_back( j );
+        coords.push_back( k );
+      }
+  Range verts;
+  ErrorCode rval = mb.create_vertices( &coords[0], nv*nv*nk, verts );
+  if (MB_SUCCESS != rval) return rval;
+  std::vector<EntityHandle> vlist( verts.begin(), verts.end() );
+  
+  int idx = 0;
+  for (int k = 0; k < (3 == dim ? n : 1); ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i, ++idx) {
+        const int v = i + nv*(j + nv*k);
+        EntityHandle conn[8] = { vlist[v], vlist[v+1], vlist[v+nv+1], vlist[v+nv], 0, 0, 0, 0 };
+        if (3 == dim)
+          for (int c = 0; c < 4; ++c)
+            conn[c+4] = conn[c] + nv*nv;
+        EntityHandle h;
+        rval = mb.create_element( type, conn, CN::VerticesPerEntity(type), h );
+        if (MB_SUCCESS != rval) return rval;
+        if (2*i < n)
+          half.insert( h );
+        
+          // sides 0 and 1 do not coincide with those of other elements
+        for (int f = 0; f < 2; ++f) {
+          if ((0 == f && idx % 3) || (1 == f && idx % 5))
+            continue;
+          EntityType side_type;
+          int len;
+          const short* indices = CN::SubEntityVertexIndices( type, dim-1, f, side_type, len );
+          EntityHandle side_conn[4];
+          for (int c = 0; c < len; ++c)
+            side_conn[c] = conn[indices[1 == f ? len-1-c : c]];
+          rval = mb.create_element( side_type, side_conn, len, h );
+          if (MB_SUCCESS != rval) return rval;
+        }
+      }
+  return MB_SUCCESS;
+}
+
+// Get sorted connectivity of each entity, as a sorted list
+static ErrorCode get_sorted_conn( Interface& mb, const Range& ents, 
+                                  std::vector< std::vector<EntityHandle> >& list )
+{
+  for (Range::const_iterator i = ents.begin(); i != ents.end(); ++i) {
+    std::vector<EntityHandle> conn;
+    ErrorCode rval = mb.get_connectivity( &*i, 1, conn );
+    if (MB_SUCCESS != rval) return rval;
+    std::sort( conn.begin(), conn.end() );
+    list.push_back( conn );
+  }
+  std::sort( list.begin(), list.end() );
+  return MB_SUCCESS;
+}
+
+// Check that threaded skinning gives the same result as the
+// default algorithm.
+ErrorCode mb_skin_threaded_common( int dim )
+{
+  ErrorCode rval;
+  Core moab1, moab2;
+  Range half1, half2;
+  rval = make_skin_threaded_mesh( moab1, dim, half1 );
+  if (MB_SUCCESS != rval) return rval;
+  rval = make_skin_threaded_mesh( moab2, dim, half2 );
+  if (MB_SUCCESS != rval) return rval;
+  
+  Skinner tool1( &moab1 ), tool2( &moab2 );
+  tool2.set_num_threads( 3 );
+  
+  Range verts1, verts2;
+  rval = tool1.find_skin( 0, half1, true, verts1 );
+  if (MB_SUCCESS != rval) return rval;
+  rval = tool2.find_skin( 0, half2, true, verts2 );
+  if (MB_SUCCESS != rval) return rval;
+  if (verts1.empty() || verts1 != verts2) {
+    std::cout << "Threaded skinner returned different skin vertices" << std::endl;
+    return MB_FAILURE;
+  }
+  
+  Range fwd1, rev1, fwd2, rev2;
+  rval = tool1.find_skin( 0, half1, false, fwd1, &rev1, false, true );
+  if (MB_SUCCESS != rval) return rval;
+  rval = tool2.find_skin( 0, half2, false, fwd2, &rev2, false, true );
+  if (MB_SUCCESS != rval) return rval;
+  if (rev1.empty() || rev1 != rev2 || fwd1 != fwd2) {
+    std::cout << "Threaded skinner returned different skin entities" << std::endl;
+    return MB_FAILURE;
+  }
+  
+    // new skin entities may have been created in a different order
+  std::vector< std::vector<EntityHandle> > conn1, conn2;
+  rval = get_sorted_conn( moab1, fwd1, conn1 );
+  if (MB_SUCCESS != rval) return rval;
+  rval = get_sorted_conn( moab2, fwd2, conn2 );
+  if (MB_SUCCESS != rval) return rval;
+  if (conn1 != conn2) {
+    std::cout << "Threaded skinner created different skin entities" << std::endl;
+    return MB_FAILURE;
+  }
+  
+    // no more entities should be created the second time
+  int count1, count2;
+  rval = moab2.get_number_entities_by_dimension( 0, dim-1, count1 );
+  if (MB_SUCCESS != rval) return rval;
+  fwd2.clear(); rev2.clear();
+  rval = tool2.find_skin( 0, half2, false, fwd2, &rev2, false, true );
+  if (MB_SUCCESS != rval) return rval;
+  rval = moab2.get_number_entities_by_dimension( 0, dim-1, count2 );
+  if (MB_SUCCESS != rval) return rval;
+  if (count1 != count2 || fwd1 != fwd2 || rev1 != rev2) {
+    std::cout << "Threaded skinner did not find existing skin entities" << std::endl;
+    return MB_FAILURE;
+  }
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_skin_faces_threaded_test()
+  { return mb_skin_threaded_common( 2 ); }
+ErrorCode mb_skin_regions_threaded_test()
+  { return mb_skin_threaded_common( 3 ); }
+        
 ErrorCode mb_skin_adjacent_surf_patches()
 {
   Core moab;
@@ -8492,6 +8702,7 @@ int main(int argc, char* argv[])
   RUN_TEST( mb_adjacent_vertex_test );
   RUN_TEST( mb_adjacencies_create_delete_test );
   RUN_TEST( mb_upward_adjacencies_test );
+  RUN_TEST( mb_compact_adjacencies_test );
   RUN_TEST( mb_adjacent_create_test );
   RUN_TEST( mb_vertex_coordinate_test );
   RUN_TEST( mb_vertex_tag_test );
@@ -8555,6 +8766,8 @@ int main(int argc, char* argv[])
   RUN_TEST( mb_skin_adj_faces_full_test );
   RUN_TEST( mb_skin_regions_full_test );
   RUN_TEST( mb_skin_adj_regions_full_test );
+  RUN_TEST( mb_skin_faces_threaded_test );
+  RUN_TEST( mb_skin_regions_threaded_test );
   RUN_TEST( mb_skin_adjacent_surf_patches );
   RUN_TEST(mb_skin_scd_test);
   RUN_TEST(mb_skin_fileset_test);
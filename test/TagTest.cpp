@@ -2,7 +2,11 @@
 #include "moab/Range.hpp"
 #include "TestUtil.hpp"
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <iomanip>
 #include <algorithm>
+#include <map>
 
 using namespace moab;
 
@@ -42,12 +46,22 @@ void test_tag_iterate_dense();
 void test_tag_iterate_sparse_default();
 void test_tag_iterate_dense_default();
 void test_tag_iterate_invalid();
+void test_sparse_tag_many_entities();
 
 void regression_one_entity_by_var_tag();
 void regression_tag_on_nonexistent_entity();
 
-int main()
+void sparse_tag_perf( int num_ents );
+
+int main( int argc, char* argv[] )
 {
+    // "tag_test -perf [num_ents]" times sparse tag operations
+    // instead of running the tests
+  if (argc > 1 && !strcmp(argv[1], "-perf")) {
+    sparse_tag_perf( argc > 2 ? atoi(argv[2]) : 1000000 );
+    return 0;
+  }
+
   int failures = 0;
   
   failures += RUN_TEST( test_create_tag );
@@ -88,6 +102,7 @@ int main()
   failures += RUN_TEST( test_tag_iterate_sparse_default );
   failures += RUN_TEST( test_tag_iterate_dense_default );
   failures += RUN_TEST( test_tag_iterate_invalid );
+  failures += RUN_TEST( test_sparse_tag_many_entities );
   
   if (failures) 
     std::cerr << "<<<< " << failures << " TESTS FAILED >>>>" << std::endl;
@@ -2278,6 +2293,231 @@ void test_tag_iterate_invalid()
   rval = mb.tag_iterate( tag, verts.begin(), verts.end(), count, ptr );
   CHECK_EQUAL( MB_VARIABLE_DATA_LENGTH, rval );
 }
-  
-    
 
+  // Create vertices in two sequences
+static void create_vertices( Interface& mb, int num_verts, std::vector<EntityHandle>& verts )
+{
+  std::vector<double> coords( 3*num_verts, 0.0 );
+  Range r1, r2;
+  ErrorCode rval = mb.create_vertices( &coords[0], num_verts/2, r1 );
+  CHECK_ERR(rval);
+  rval = mb.create_vertices( &coords[0], num_verts - num_verts/2, r2 );
+  CHECK_ERR(rval);
+  verts.clear();
+  std::copy( r1.begin(), r1.end(), std::back_inserter(verts) );
+  std::copy( r2.begin(), r2.end(), std::back_inserter(verts) );
+}
+
+  // Shuffle with a fixed seed such that results are reproducible
+static void shuffle_handles( std::vector<EntityHandle>& list )
+{
+  unsigned long seed = 12345;
+  for (size_t i = list.size(); i > 1; --i) {
+    seed = seed * 1103515245 + 12345;
+    std::swap( list[i-1], list[(seed / 65536) % i] );
+  }
+}
+
+  // Set, overwrite and remove values for many entities in random
+  // order, forcing the sparse tag storage to grow and shrink, and
+  // compare everything against values kept in a std::map.
+void test_sparse_tag_many_entities()
+{
+  Core moab;
+  Interface& mb = moab;
+  ErrorCode rval;
+
+  const int num_verts = 20000;
+  std::vector<EntityHandle> verts;
+  create_vertices( mb, num_verts, verts );
+  EntityHandle set;
+  rval = mb.create_meshset( MESHSET_SET, set );
+  CHECK_ERR(rval);
+
+  Tag tag;
+  rval = mb.tag_get_handle( "many", 2, MB_TYPE_INTEGER, tag, MB_TAG_SPARSE|MB_TAG_EXCL );
+  CHECK_ERR(rval);
+
+  std::vector<EntityHandle> order( verts );
+  shuffle_handles( order );
+  std::map<EntityHandle,int> expected;
+
+    // set values in random order, including the root set
+  const int root_val[2] = { -1, -2 };
+  const EntityHandle root = 0;
+  rval = mb.tag_set_data( tag, &root, 1, root_val );
+  CHECK_ERR(rval);
+  const int* first_ptr = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const int val[2] = { (int)i, -(int)i };
+    rval = mb.tag_set_data( tag, &order[i], 1, val );
+    CHECK_ERR(rval);
+    expected[order[i]] = i;
+    if (!i) {
+      const void* ptr;
+      rval = mb.tag_get_by_ptr( tag, &order[i], 1, &ptr );
+      CHECK_ERR(rval);
+      first_ptr = reinterpret_cast<const int*>(ptr);
+    }
+  }
+  const int set_val[2] = { 7, 8 };
+  rval = mb.tag_set_data( tag, &set, 1, set_val );
+  CHECK_ERR(rval);
+
+    // pointer to tag value must remain valid as storage grows
+  const void* ptr;
+  rval = mb.tag_get_by_ptr( tag, &order[0], 1, &ptr );
+  CHECK_ERR(rval);
+  CHECK( ptr == first_ptr );
+  CHECK_EQUAL( 0, first_ptr[0] );
+
+    // remove every third value and overwrite every fifth one
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (i % 3 == 1) {
+      rval = mb.tag_delete_data( tag, &order[i], 1 );
+      CHECK_ERR(rval);
+      expected.erase( order[i] );
+    }
+    else if (i % 5 == 2) {
+      const int val[2] = { (int)(i + num_verts), -(int)(i + num_verts) };
+      rval = mb.tag_set_data( tag, &order[i], 1, val );
+      CHECK_ERR(rval);
+      expected[order[i]] = i + num_verts;
+    }
+  }
+  rval = mb.tag_delete_data( tag, &order[1], 1 );
+  CHECK( MB_SUCCESS != rval );
+
+    // check values
+  for (size_t i = 0; i < verts.size(); ++i) {
+    int val[2];
+    rval = mb.tag_get_data( tag, &verts[i], 1, val );
+    std::map<EntityHandle,int>::iterator j = expected.find( verts[i] );
+    if (j == expected.end()) {
+      CHECK_EQUAL( MB_TAG_NOT_FOUND, rval );
+    }
+    else {
+      CHECK_ERR(rval);
+      CHECK_EQUAL( j->second, val[0] );
+      CHECK_EQUAL( -j->second, val[1] );
+    }
+  }
+  int val[2];
+  rval = mb.tag_get_data( tag, &root, 1, val );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( root_val[0], val[0] );
+  rval = mb.tag_get_data( tag, &set, 1, val );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( set_val[1], val[1] );
+
+    // check tagged entities
+  Range tagged;
+  rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, 0, 1, tagged );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected.size(), (size_t)tagged.size() );
+  Range::iterator r = tagged.begin();
+  for (std::map<EntityHandle,int>::iterator j = expected.begin(); j != expected.end(); ++j, ++r)
+    CHECK_EQUAL( j->first, *r );
+  tagged.clear();
+  rval = mb.get_entities_by_type_and_tag( 0, MBENTITYSET, &tag, 0, 1, tagged );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, (size_t)tagged.size() );
+  CHECK_EQUAL( set, tagged.front() );
+
+    // find entities by value
+  const int* find_val[] = { set_val };
+  tagged.clear();
+  rval = mb.get_entities_by_type_and_tag( 0, MBMAXTYPE, &tag, (const void**)find_val, 1, tagged );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, (size_t)tagged.size() );
+  CHECK_EQUAL( set, tagged.front() );
+  const int vert_val[2] = { 3, -3 };
+  find_val[0] = vert_val;
+  tagged.clear();
+  rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, (const void**)find_val, 1, tagged );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, (size_t)tagged.size() );
+  CHECK_EQUAL( order[3], tagged.front() );
+
+    // remove everything and start over
+  rval = mb.tag_delete( tag );
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle( "many", 2, MB_TYPE_INTEGER, tag, MB_TAG_SPARSE|MB_TAG_EXCL );
+  CHECK_ERR(rval);
+  tagged.clear();
+  rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, 0, 1, tagged );
+  CHECK_ERR(rval);
+  CHECK( tagged.empty() );
+}
+
+static double elapsed( clock_t& t )
+{
+  clock_t prev = t;
+  t = clock();
+  return (double)(t - prev) / CLOCKS_PER_SEC;
+}
+
+  // Time sparse tag operations through the Interface only, such that
+  // the same code may be built against other revisions of MOAB to
+  // compare sparse tag implementations.
+void sparse_tag_perf( int num_ents )
+{
+  Core moab;
+  Interface& mb = moab;
+  ErrorCode rval;
+
+  std::vector<EntityHandle> verts;
+  create_vertices( mb, num_ents, verts );
+  std::vector<EntityHandle> order( verts );
+  shuffle_handles( order );
+  Range vert_range;
+  std::copy( verts.begin(), verts.end(), range_inserter(vert_range) );
+
+  Tag tag;
+  rval = mb.tag_get_handle( "perf", 1, MB_TYPE_DOUBLE, tag, MB_TAG_SPARSE|MB_TAG_EXCL );
+  CHECK_ERR(rval);
+
+  std::cout << "Sparse tag on " << num_ents << " vertices, times in seconds" << std::endl;
+  double sum = 0;
+  clock_t t = clock();
+
+    // set values one entity at a time in random order
+  for (size_t i = 0; i < order.size(); ++i) {
+    const double val = i;
+    mb.tag_set_data( tag, &order[i], 1, &val );
+  }
+  std::cout << "set random   " << std::setw(10) << elapsed( t ) << std::endl;
+
+    // set values in bulk for all entities
+  std::vector<double> vals( verts.size(), 1.0 );
+  mb.tag_set_data( tag, vert_range, &vals[0] );
+  std::cout << "set bulk     " << std::setw(10) << elapsed( t ) << std::endl;
+
+    // get values one entity at a time in random order
+  for (size_t i = 0; i < order.size(); ++i) {
+    double val;
+    mb.tag_get_data( tag, &order[i], 1, &val );
+    sum += val;
+  }
+  std::cout << "get random   " << std::setw(10) << elapsed( t ) << std::endl;
+
+    // get values in bulk
+  mb.tag_get_data( tag, vert_range, &vals[0] );
+  std::cout << "get bulk     " << std::setw(10) << elapsed( t ) << std::endl;
+
+    // iterate over all tagged entities
+  Range tagged;
+  mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, 0, 1, tagged );
+  vals.resize( tagged.size() );
+  mb.tag_get_data( tag, tagged, &vals[0] );
+  for (size_t i = 0; i < vals.size(); ++i)
+    sum += vals[i];
+  std::cout << "iterate      " << std::setw(10) << elapsed( t ) << std::endl;
+
+    // remove values in random order
+  mb.tag_delete_data( tag, &order[0], order.size() );
+  std::cout << "remove       " << std::setw(10) << elapsed( t ) << std::endl;
+
+  if (sum != 2.0*num_ents)
+    std::cout << "Inconsistent results: " << sum << " != " << 2.0*num_ents << std::endl;
+}
@@ -3,6 +3,8 @@
 #include "SequenceData.hpp"
 #include "TestUtil.hpp"
 #include "moab/Error.hpp"
+#include <time.h>
+#include <algorithm>
 
 using namespace moab;
 
@@ -10,6 +12,8 @@ void test_basic();
 void test_lower_bound();
 void test_upper_bound();
 void test_find();
+void test_find_many();
+void test_find_resized();
 void test_get_entities();
 void test_insert_sequence_merge();
 void test_insert_sequence_nomerge();
@@ -52,8 +56,17 @@ ErrorCode insert_seq( TypeSequenceManager& seqman,
                         SequenceData* data,
                         bool del_data = false );
 
-int main( )
+void find_perf( int num_seq );
+
+int main( int argc, char* argv[] )
 {
+    // "TestTypeSequenceManager -perf [num_sequences]" times lookups
+    // instead of running the tests
+  if (argc > 1 && !strcmp( argv[1], "-perf" )) {
+    find_perf( argc > 2 ? atoi( argv[2] ) : 100000 );
+    return 0;
+  }
+
   if (RUN_TEST( test_basic )) {
     printf( "BASIC USE TEST FAILED\nCANNOT TEST FURTHER\n" );
     return 1;
@@ -63,6 +76,8 @@ int main( )
   error_count += RUN_TEST( test_lower_bound );
   error_count += RUN_TEST( test_upper_bound );
   error_count += RUN_TEST( test_find );
+  error_count += RUN_TEST( test_find_many );
+  error_count += RUN_TEST( test_find_resized );
   error_count += RUN_TEST( test_get_entities );
   error_count += RUN_TEST( test_insert_sequence_merge );
   error_count += RUN_TEST( test_insert_sequence_nomerge );
@@ -112,6 +127,9 @@ class DumSeq : public EntitySequence {
     
     int values_per_entity() const
       { return valsPerEnt; }
+    
+    ErrorCode prepend( EntityID count )
+      { return prepend_entities( count ); }
 };
   
 void make_basic_sequence( TypeSequenceManager& seqman )
@@ -309,6 +327,167 @@ void test_find()
   CHECK_EQUAL( NULL, seq );
 }
 
+/* Create num_seq sequences of seq_size handles each, every one
+ * in the middle of its own SequenceData with room for 2*seq_size
+ * handles such that the sequences are not merged.
+ */
+static void make_many_sequences( TypeSequenceManager& seqman,
+                                 int num_seq, int seq_size,
+                                 std::vector<EntitySequence*>& seqs )
+{
+  seqs.clear();
+  for (int i = 0; i < num_seq; ++i) {
+    const EntityHandle start = 1 + 2*i*seq_size;
+    SequenceData* data = new SequenceData( 0, start, start + 2*seq_size - 1 );
+    EntitySequence* seq = new DumSeq( start + seq_size/2, seq_size, data );
+    CHECK_ERR( seqman.insert_sequence( seq ) );
+    seqs.push_back( seq );
+  }
+}
+
+  // Shuffle with a fixed seed such that results are reproducible
+static void shuffle_handles( std::vector<EntityHandle>& list )
+{
+  unsigned long seed = 12345;
+  for (size_t i = list.size(); i > 1; --i) {
+    seed = seed * 1103515245 + 12345;
+    std::swap( list[i-1], list[(seed / 65536) % i] );
+  }
+}
+
+void test_find_many()
+{
+  TypeSequenceManager seqman;
+  std::vector<EntitySequence*> seqs;
+  const int num_seq = 500, seq_size = 4;
+  make_many_sequences( seqman, num_seq, seq_size, seqs );
+
+    // look up every handle, including those in the gaps
+    // between sequences, in random order
+  std::vector<EntityHandle> handles;
+  for (EntityHandle h = 0; h <= (EntityHandle)(2*num_seq*seq_size + 1); ++h)
+    handles.push_back( h );
+  shuffle_handles( handles );
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < handles.size(); ++i) {
+      const EntityHandle h = handles[i];
+      const size_t j = (h - 1) / (2*seq_size);
+      EntitySequence* expected = 0;
+      if (h && j < seqs.size() && h >= seqs[j]->start_handle() && h <= seqs[j]->end_handle())
+        expected = seqs[j];
+      CHECK_EQUAL( expected, seqman.find( h ) );
+    }
+    
+      // results should be the same when frozen
+    seqman.freeze( true );
+  }
+  seqman.freeze( false );
+}
+
+void test_find_resized()
+{
+  TypeSequenceManager seqman;
+  std::vector<EntitySequence*> seqs;
+  make_many_sequences( seqman, 10, 10, seqs );
+  
+    // do enough lookups to build index
+  for (int pass = 0; pass < 2; ++pass)
+    for (size_t i = 0; i < seqs.size(); ++i)
+      CHECK_EQUAL( seqs[i], seqman.find( seqs[i]->start_handle() ) );
+  
+    // resize sequences without adding or removing any sequences
+  CHECK_ERR( static_cast<DumSeq*>(seqs[2])->prepend( 5 ) ); // [41,55]
+  CHECK_ERR( seqman.notify_prepended( seqman.lower_bound( 41 ) ) );
+  CHECK_ERR( seqs[4]->pop_front( 3 ) );  // [89,95]
+  CHECK_ERR( seqs[6]->pop_back( 3 ) );   // [126,132]
+  
+  CHECK_EQUAL( seqs[2], seqman.find( 41 ) );
+  CHECK_EQUAL( (EntitySequence*)0, seqman.find( 40 ) );
+  CHECK_EQUAL( seqs[3], seqman.find( 66 ) );
+  CHECK_EQUAL( (EntitySequence*)0, seqman.find( 86 ) );
+  CHECK_EQUAL( (EntitySequence*)0, seqman.find( 88 ) );
+  CHECK_EQUAL( seqs[4], seqman.find( 89 ) );
+  CHECK_EQUAL( seqs[6], seqman.find( 132 ) );
+  CHECK_EQUAL( (EntitySequence*)0, seqman.find( 133 ) );
+  
+    // remove a sequence
+  bool last;
+  CHECK_ERR( seqman.remove_sequence( seqs[5], last ) );
+  CHECK( last );
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < seqs.size(); ++i) {
+      EntitySequence* expected = (i == 5) ? 0 : seqs[i];
+      CHECK_EQUAL( expected, seqman.find( seqs[i]->end_handle() ) );
+    }
+  }
+  delete seqs[5]->data();
+  delete seqs[5];
+}
+
+static double elapsed( clock_t& t )
+{
+  clock_t prev = t;
+  t = clock();
+  return (double)(t - prev) / CLOCKS_PER_SEC;
+}
+
+  // How TypeSequenceManager::find worked before lookups were done 
+  // with a sorted array: check last referenced sequence and fall
+  // back to a std::set lookup.
+static const EntitySequence* set_find( const TypeSequenceManager& seqman,
+                                       EntityHandle h,
+                                       const EntitySequence*& last )
+{
+  if (h >= last->start_handle() && h <= last->end_handle())
+    return last;
+  TypeSequenceManager::const_iterator i = seqman.lower_bound( h );
+  if (i == seqman.end() || (*i)->start_handle() > h)
+    return 0;
+  return last = *i;
+}
+
+void find_perf( int num_seq )
+{
+  TypeSequenceManager seqman;
+  std::vector<EntitySequence*> seqs;
+  const int seq_size = 64;
+  make_many_sequences( seqman, num_seq, seq_size, seqs );
+  
+  std::vector<EntityHandle> handles;
+  for (size_t i = 0; i < seqs.size(); ++i)
+    for (EntityHandle h = seqs[i]->start_handle(); h <= seqs[i]->end_handle(); ++h)
+      handles.push_back( h );
+  std::vector<EntityHandle> random( handles );
+  shuffle_handles( random );
+  
+  printf( "Lookup of %lu handles in %d sequences, times in seconds\n",
+          (unsigned long)handles.size(), num_seq );
+  printf( "                find    std::set\n" );
+  
+  const EntitySequence* last = seqs.front();
+  size_t count1 = 0, count2 = 0;
+  double t1, t2;
+  clock_t t = clock();
+  for (size_t i = 0; i < handles.size(); ++i)
+    count1 += (0 != seqman.find( handles[i] ));
+  t1 = elapsed( t );
+  for (size_t i = 0; i < handles.size(); ++i)
+    count2 += (0 != set_find( seqman, handles[i], last ));
+  t2 = elapsed( t );
+  printf( "sequential %10f  %10f\n", t1, t2 );
+  
+  for (size_t i = 0; i < random.size(); ++i)
+    count1 += (0 != seqman.find( random[i] ));
+  t1 = elapsed( t );
+  for (size_t i = 0; i < random.size(); ++i)
+    count2 += (0 != set_find( seqman, random[i], last ));
+  t2 = elapsed( t );
+  printf( "random     %10f  %10f\n", t1, t2 );
+  
+  if (count1 != 2*handles.size() || count2 != 2*handles.size())
+    printf( "Lookup failed: %lu %lu\n", (unsigned long)count1, (unsigned long)count2 );
+}
+
 bool seqman_equal( const EntityHandle pair_array[][2],
                      unsigned num_pairs,
                      const TypeSequenceManager& seqman )
@@ -10,6 +10,7 @@
 void test_coords_connect_iterate();
 void test_scd_invalid();
 void test_iterates();
+void test_element_coords();
 
 using namespace moab;
 
@@ -20,6 +21,7 @@ int main()
   failures += RUN_TEST(test_coords_connect_iterate);
   failures += RUN_TEST(test_scd_invalid);
   failures += RUN_TEST(test_iterates);
+  failures += RUN_TEST(test_element_coords);
   
   if (failures) 
     std::cerr << "<<<< " << failures << " TESTS FAILED >>>>" << std::endl;
@@ -285,3 +287,114 @@ void test_iterates()
       hit += count;
     }
 }
+
+  // compare output of get_element_coords with that of get_connectivity
+  // and get_coords for each element
+static void check_element_coords( Interface& mb, const Range& elems, int n )
+{
+  const size_t num = elems.size();
+  std::vector<double> x(n*num), y(n*num), z(n*num);
+  std::vector<EntityHandle> conn(n*num);
+  ErrorCode rval = mb.get_element_coords( elems, n, &x[0], &y[0], &z[0], &conn[0] );
+  CHECK_ERR(rval);
+  
+  size_t j = 0;
+  for (Range::const_iterator i = elems.begin(); i != elems.end(); ++i, ++j) {
+    const EntityHandle* exp_conn;
+    int len;
+    std::vector<EntityHandle> storage;
+    rval = mb.get_connectivity( *i, exp_conn, len, false, &storage );
+    CHECK_ERR(rval);
+    std::vector<double> xyz(3*n);
+    rval = mb.get_coords( exp_conn, n, &xyz[0] );
+    CHECK_ERR(rval);
+    for (int k = 0; k < n; ++k) {
+      CHECK_EQUAL( exp_conn[k], conn[k*num + j] );
+      CHECK_REAL_EQUAL( xyz[3*k  ], x[k*num + j], 1e-12 );
+      CHECK_REAL_EQUAL( xyz[3*k+1], y[k*num + j], 1e-12 );
+      CHECK_REAL_EQUAL( xyz[3*k+2], z[k*num + j], 1e-12 );
+    }
+  }
+  
+    // connectivity is optional
+  std::vector<double> x2(n*num), y2(n*num), z2(n*num);
+  rval = mb.get_element_coords( elems, n, &x2[0], &y2[0], &z2[0] );
+  CHECK_ERR(rval);
+  CHECK( x == x2 && y == y2 && z == z2 );
+}
+
+void test_element_coords()
+{
+  Core moab;
+  Interface& mb = moab;
+  
+    // create vertices in two sequences
+  const int NUM_VTX = 400;
+  std::vector<double> coords(3*NUM_VTX);
+  for (int i = 0; i < NUM_VTX; i++) {
+    coords[3*i] = i;
+    coords[3*i+1] = 10*i;
+    coords[3*i+2] = 100*i;
+  }
+  Range verts1, verts2;
+  ErrorCode rval = mb.create_vertices( &coords[0], NUM_VTX/2, verts1 );
+  CHECK_ERR(rval);
+  rval = mb.create_vertices( &coords[3*NUM_VTX/2], NUM_VTX/2, verts2 );
+  CHECK_ERR(rval);
+  std::vector<EntityHandle> verts;
+  std::copy( verts1.begin(), verts1.end(), std::back_inserter(verts) );
+  std::copy( verts2.begin(), verts2.end(), std::back_inserter(verts) );
+  
+    // hexes with vertices from the first sequence, and hexes with
+    // vertices from both sequences
+  ReadUtilIface *rui;
+  rval = mb.query_interface(rui);
+  CHECK_ERR(rval);
+  Range hexes;
+  EntityHandle start_hex, *connect;
+  rval = rui->get_element_connect(20, 8, MBHEX, 1, start_hex, connect);
+  CHECK_ERR(rval);
+  for (int i = 0; i < 20*8; ++i)
+    connect[i] = verts[(7*i) % (NUM_VTX/2)];
+  hexes.insert( start_hex, start_hex + 19 );
+  rval = rui->get_element_connect(20, 8, MBHEX, 1, start_hex, connect);
+  CHECK_ERR(rval);
+  for (int i = 0; i < 20*8; ++i)
+    connect[i] = verts[(7*i) % NUM_VTX];
+  hexes.insert( start_hex, start_hex + 19 );
+  
+    // leave a gap in the range
+  EntityHandle dead = *(hexes.begin() + 5);
+  rval = mb.delete_entities( &dead, 1 );
+  CHECK_ERR(rval);
+  hexes.erase( dead );
+  
+  check_element_coords( mb, hexes, 8 );
+  
+    // mixed element types, first four vertices of each hex
+  Range elems( hexes );
+  for (int i = 0; i < 10; ++i) {
+    EntityHandle quad, quad_conn[] = { verts[i], verts[i+100], verts[i+200], verts[i+300] };
+    rval = mb.create_element( MBQUAD, quad_conn, 4, quad );
+    CHECK_ERR(rval);
+    elems.insert( quad );
+  }
+  check_element_coords( mb, elems, 4 );
+  
+    // invalid input
+  std::vector<double> x(9*hexes.size()), y(x), z(x);
+  rval = mb.get_element_coords( hexes, 9, &x[0], &y[0], &z[0] );
+  CHECK_EQUAL( MB_INDEX_OUT_OF_RANGE, rval );
+  rval = mb.get_element_coords( verts1, 1, &x[0], &y[0], &z[0] );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, rval );
+  
+    // structured mesh, for which connectivity is not stored explicitly
+  ScdInterface *scdi;
+  rval = mb.query_interface(scdi);
+  CHECK_ERR(rval);
+  ScdBox *box = NULL;
+  rval = scdi->construct_box(HomCoord(0, 0, 0), HomCoord(4, 4, 4), NULL, 0, box);
+  CHECK_ERR(rval);
+  Range scd_hexes( box->start_element(), box->start_element() + 63 );
+  check_element_coords( mb, scd_hexes, 8 );
+}
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <math.h>
+#include <stdlib.h>
 #include "moab/Interface.hpp"
 #ifndef IS_BUILDING_MB
 #define IS_BUILDING_MB
@@ -162,6 +164,100 @@ void dagmc_outside_face_rayfire_history()
   CHECK_EQUAL(ZERO, next_surf);
 }
 
+// fire random rays through every volume, tracking each ray through several
+// surfaces with a history, and check that the flat trees give the same
+// surfaces and distances, and point_in_volume results, as the OBB trees
+void dagmc_flat_tree_rayfire()
+{
+  CHECK( DAG->use_flat_trees() );
+  srand(42);
+  for (int v = 1; v <= DAG->num_entities(3); ++v) {
+    EntityHandle vol_h = DAG->entity_by_index(3, v);
+    for (int i = 0; i < 200; ++i) {
+      double dir[3], xyz[3];
+      for (int j = 0; j < 3; ++j) {
+        dir[j] = 2.0 * rand() / RAND_MAX - 1.0;
+        xyz[j] = 10.0 * rand() / RAND_MAX - 5.0;
+      }
+      double len = sqrt(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+      for (int j = 0; j < 3; ++j)
+        dir[j] /= len;
+
+      EntityHandle surf[2];
+      double dist[2];
+      int inside[2];
+      DagMC::RayHistory history[2];
+      for (int k = 0; k < 3; ++k) {
+        for (int f = 0; f < 2; ++f) {
+          DAG->set_use_flat_trees(f == 0);
+          ErrorCode rval = DAG->ray_fire(vol_h, xyz, dir, surf[f], dist[f], &history[f]);
+          CHECK_ERR(rval);
+          rval = DAG->point_in_volume(vol_h, xyz, inside[f], dir, &history[f]);
+          CHECK_ERR(rval);
+        }
+        CHECK_EQUAL(surf[1], surf[0]);
+        CHECK_EQUAL(inside[1], inside[0]);
+        CHECK_EQUAL(history[1].size(), history[0].size());
+        if (!surf[0])
+          break;
+        CHECK_REAL_EQUAL(dist[1], dist[0], 0.0);
+        for (int j = 0; j < 3; ++j)
+          xyz[j] += dist[0] * dir[j];
+      }
+    }
+  }
+  DAG->set_use_flat_trees(true);
+}
+
+// fire batches of random rays through every volume, tracking each ray
+// through several surfaces with a history, and check that ray_fire_batch
+// gives the same surfaces and distances as ray_fire
+void dagmc_batch_rayfire()
+{
+  const int n = 150;
+  srand(7);
+  for (int v = 1; v <= DAG->num_entities(3); ++v) {
+    EntityHandle vol_h = DAG->entity_by_index(3, v);
+    for (int orient = -1; orient <= 1; orient += 2) {
+      std::vector<double> xyz(3*n), dir(3*n);
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          dir[3*i+j] = 2.0 * rand() / RAND_MAX - 1.0;
+            // half the rays start at the same point
+          xyz[3*i+j] = i % 2 ? 10.0 * rand() / RAND_MAX - 5.0 : 0.5;
+        }
+        double len = sqrt(dir[3*i]*dir[3*i] + dir[3*i+1]*dir[3*i+1] + dir[3*i+2]*dir[3*i+2]);
+        for (int j = 0; j < 3; ++j)
+          dir[3*i+j] /= len;
+      }
+      const double limit = orient > 0 ? 0.0 : 4.0;
+
+      std::vector<EntityHandle> surfs(n);
+      std::vector<double> dists(n);
+      std::vector<DagMC::RayHistory> histories(n), single_histories(n);
+      for (int k = 0; k < 3; ++k) {
+        ErrorCode rval = DAG->ray_fire_batch(vol_h, n, &xyz[0], &dir[0], &surfs[0], &dists[0],
+                                             &histories[0], limit, orient);
+        CHECK_ERR(rval);
+        for (int i = 0; i < n; ++i) {
+          EntityHandle surf;
+          double dist;
+          rval = DAG->ray_fire(vol_h, &xyz[3*i], &dir[3*i], surf, dist,
+                               &single_histories[i], limit, orient);
+          CHECK_ERR(rval);
+          CHECK_EQUAL(surf, surfs[i]);
+          CHECK_EQUAL(single_histories[i].size(), histories[i].size());
+          if (!surf)
+            continue;
+          CHECK_REAL_EQUAL(dist, dists[i], 0.0);
+          for (int j = 0; j < 3; ++j)
+            xyz[3*i+j] += dist * dir[3*i+j];
+        }
+      }
+    }
+  }
+}
+
 int main(int /* argc */, char** /* argv */)
 {
   int result = 0;
@@ -173,6 +269,8 @@ int main(int /* argc */, char** /* argv */)
   result += RUN_TEST(dagmc_outside_face_rayfire_orient_entrance); // fire ray from point outside volume looking for entrance intersection
   result += RUN_TEST(dagmc_outside_face_rayfire_history_fail); // fire ray from point outside geometry using ray history
   result += RUN_TEST(dagmc_outside_face_rayfire_history); // fire ray from point outside geometry using ray history
+  result += RUN_TEST(dagmc_flat_tree_rayfire); // compare flat and OBB tree ray fires
+  result += RUN_TEST(dagmc_batch_rayfire); // compare batch and single ray fires
 
   DagMC::destroy();
 
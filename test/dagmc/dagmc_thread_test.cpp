@@ -0,0 +1,191 @@
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "moab/Interface.hpp"
+#ifndef IS_BUILDING_MB
+#define IS_BUILDING_MB
+#endif
+#include "TestUtil.hpp"
+#include "Internals.hpp"
+#include "moab/Core.hpp"
+
+#include "DagMC.hpp"
+
+using namespace moab;
+
+using moab::DagMC;
+
+#define DAG DagMC::instance()
+
+static const char input_file[] = STRINGIFY(MESHDIR) "/dagmc/test_geom.h5m";
+
+  // number of queries of each kind per thread
+const int NUM_QUERIES = 200;
+const int NUM_THREADS = 4;
+
+void dagmc_setup_test()
+{
+  ErrorCode rval = DAG->load_file(input_file); // open the Dag file
+  CHECK_ERR(rval);
+  rval = DAG->init_OBBTree();
+  CHECK_ERR(rval);
+}
+
+  // Closest point on the flat trees is the same as on the OBB trees
+void dagmc_flat_tree_closest()
+{
+  srand(3);
+  for (int v = 1; v <= DAG->num_entities(3); ++v) {
+    EntityHandle vol_h = DAG->entity_by_index(3, v);
+    for (int i = 0; i < 100; ++i) {
+      double xyz[3];
+      for (int j = 0; j < 3; ++j)
+        xyz[j] = 12.0 * rand() / RAND_MAX - 6.0;
+      double flat_dist, obb_dist;
+      DAG->set_use_flat_trees(true);
+      ErrorCode rval = DAG->closest_to_location(vol_h, xyz, flat_dist);
+      CHECK_ERR(rval);
+      DAG->set_use_flat_trees(false);
+      rval = DAG->closest_to_location(vol_h, xyz, obb_dist);
+      CHECK_ERR(rval);
+      CHECK_REAL_EQUAL(obb_dist, flat_dist, 0.0);
+    }
+  }
+  DAG->set_use_flat_trees(true);
+}
+
+  // Results of the queries done by one thread
+struct QueryResults {
+  std::vector<EntityHandle> surfs, next_vols;
+  std::vector<double> dists, closest;
+  std::vector<int> inside;
+  ErrorCode rval;
+};
+
+  // Fire rays from random points across all surfaces of each volume, with
+  // histories, and test random points for containment with random directions
+  // from the context's generator.
+static ErrorCode run_queries( DagMC::QueryContext& ctx, int seed, QueryResults& res )
+{
+  unsigned int state = seed;
+  for (int v = 1; v <= DAG->num_entities(3); ++v) {
+    EntityHandle vol_h = DAG->entity_by_index(3, v);
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+      double xyz[3], dir[3], len = 0.0;
+      for (int j = 0; j < 3; ++j) {
+        xyz[j] = 10.0 * rand_r(&state) / RAND_MAX - 5.0;
+        dir[j] = 2.0 * rand_r(&state) / RAND_MAX - 1.0;
+        len += dir[j] * dir[j];
+      }
+      for (int j = 0; j < 3; ++j)
+        dir[j] /= sqrt(len);
+
+      int inside;
+      ErrorCode rval = DAG->point_in_volume(ctx, vol_h, xyz, inside);
+      if (MB_SUCCESS != rval) return rval;
+      res.inside.push_back(inside);
+
+      double closest;
+      rval = DAG->closest_to_location(ctx, vol_h, xyz, closest);
+      if (MB_SUCCESS != rval) return rval;
+      res.closest.push_back(closest);
+
+      DagMC::RayHistory history;
+      EntityHandle surf, vol = vol_h;
+      double dist;
+      do {
+        rval = DAG->ray_fire(ctx, vol, xyz, dir, surf, dist, &history);
+        if (MB_SUCCESS != rval) return rval;
+        res.surfs.push_back(surf);
+        if (!surf)
+          break;
+        res.dists.push_back(dist);
+        for (int j = 0; j < 3; ++j)
+          xyz[j] += dist * dir[j];
+        rval = DAG->next_vol(ctx, surf, vol, vol);
+        if (MB_SUCCESS != rval) return rval;
+        res.next_vols.push_back(vol);
+      } while (!DAG->is_implicit_complement(vol) && history.size() < 10);
+    }
+  }
+  return MB_SUCCESS;
+}
+
+struct ThreadData {
+  pthread_t thread;
+  int seed;
+  QueryResults results;
+};
+
+static void* query_thread( void* ptr )
+{
+  ThreadData* data = reinterpret_cast<ThreadData*>(ptr);
+  DagMC::QueryContext ctx(data->seed);
+  data->results.rval = run_queries(ctx, data->seed, data->results);
+  return 0;
+}
+
+  // Queries with a context per thread give the same results as in one thread
+void dagmc_threaded_queries()
+{
+  std::vector<QueryResults> expected(NUM_THREADS);
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    DagMC::QueryContext ctx(i + 1);
+    ErrorCode rval = run_queries(ctx, i + 1, expected[i]);
+    CHECK_ERR(rval);
+    CHECK(!expected[i].dists.empty());
+  }
+
+  ErrorCode rval = DAG->freeze();
+  CHECK_ERR(rval);
+  std::vector<ThreadData> threads(NUM_THREADS);
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    threads[i].seed = i + 1;
+    CHECK_EQUAL(0, pthread_create(&threads[i].thread, 0, query_thread, &threads[i]));
+  }
+  for (int i = 0; i < NUM_THREADS; ++i)
+    pthread_join(threads[i].thread, 0);
+  rval = DAG->unfreeze();
+  CHECK_ERR(rval);
+
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    const QueryResults& res = threads[i].results;
+    CHECK_ERR(res.rval);
+    CHECK(expected[i].surfs == res.surfs);
+    CHECK(expected[i].next_vols == res.next_vols);
+    CHECK(expected[i].dists == res.dists);
+    CHECK(expected[i].closest == res.closest);
+    CHECK(expected[i].inside == res.inside);
+  }
+}
+
+  // A seeded context gives the same random directions each time
+void dagmc_context_seed()
+{
+  EntityHandle vol_h = DAG->entity_by_index(3, 1);
+  const double xyz[3] = { 0.5, 0.5, 0.5 };
+  DagMC::QueryContext ctx1(7), ctx2(7);
+  for (int i = 0; i < 10; ++i) {
+    int inside1, inside2;
+    ErrorCode rval = DAG->point_in_volume(ctx1, vol_h, xyz, inside1);
+    CHECK_ERR(rval);
+    rval = DAG->point_in_volume(ctx2, vol_h, xyz, inside2);
+    CHECK_ERR(rval);
+    CHECK_EQUAL(1, inside1);
+    CHECK_EQUAL(inside1, inside2);
+  }
+}
+
+int main(int /* argc */, char** /* argv */)
+{
+  int result = 0;
+  result += RUN_TEST(dagmc_setup_test); // setup problem
+  result += RUN_TEST(dagmc_flat_tree_closest); // compare flat and OBB tree closest points
+  result += RUN_TEST(dagmc_threaded_queries); // compare threaded and serial queries
+  result += RUN_TEST(dagmc_context_seed);
+
+  DagMC::destroy();
+
+  return result;
+}
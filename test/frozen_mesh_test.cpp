@@ -0,0 +1,426 @@
+/** Test read-only (frozen) mode of moab::Core
+ *
+ * To check for data races, build MOAB and this test with -fsanitize=thread.
+ * If MOAB is configured with OpenMP, the OpenMP runtime must also be built
+ * with ThreadSanitizer support or it will report false positives.
+ */
+
+#include "moab/Core.hpp"
+#include "moab/Range.hpp"
+#include "moab/ReadUtilIface.hpp"
+#include "TestUtil.hpp"
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+
+using namespace moab;
+
+void test_freeze_modify();
+void test_freeze_compact();
+void test_freeze_modify_sets();
+void test_freeze_reuse_set_handle();
+void test_concurrent_queries();
+
+int main()
+{
+  int failures = 0;
+
+  failures += RUN_TEST(test_freeze_modify);
+  failures += RUN_TEST(test_freeze_compact);
+  failures += RUN_TEST(test_freeze_modify_sets);
+  failures += RUN_TEST(test_freeze_reuse_set_handle);
+  failures += RUN_TEST(test_concurrent_queries);
+
+  if (failures)
+    std::cerr << "<<<< " << failures << " TESTS FAILED >>>>" << std::endl;
+
+  return failures;
+}
+
+  // Create a structured grid of n^3 hexes.  Vertices and hexes
+  // are created in two blocks each, such that queries must look
+  // up more than one entity sequence.
+static void make_hex_mesh( Interface& mb, int n, Range& verts, Range& hexes )
+{
+  const int nv = n + 1;
+  std::vector<double> coords;
+  for (int k = 0; k < nv; ++k)
+    for (int j = 0; j < nv; ++j)
+      for (int i = 0; i < nv; ++i) {
+        coords.push_back( i );
+        coords.push_back( j );
+        coords.push_back( k );
+      }
+
+  const int half = nv*nv*nv / 2;
+  Range r1, r2;
+  ErrorCode rval = mb.create_vertices( &coords[0], half, r1 );
+  CHECK_ERR(rval);
+  rval = mb.create_vertices( &coords[3*half], nv*nv*nv - half, r2 );
+  CHECK_ERR(rval);
+  std::vector<EntityHandle> vert_list;
+  std::copy( r1.begin(), r1.end(), std::back_inserter(vert_list) );
+  std::copy( r2.begin(), r2.end(), std::back_inserter(vert_list) );
+  verts.merge( r1 );
+  verts.merge( r2 );
+
+  for (int k = 0; k < n; ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i) {
+        const int v = i + nv*(j + nv*k);
+        const EntityHandle conn[8] = {
+          vert_list[v],          vert_list[v+1],
+          vert_list[v+nv+1],     vert_list[v+nv],
+          vert_list[v+nv*nv],    vert_list[v+nv*nv+1],
+          vert_list[v+nv*nv+nv+1], vert_list[v+nv*nv+nv] };
+        EntityHandle h;
+        rval = mb.create_element( MBHEX, conn, 8, h );
+        CHECK_ERR(rval);
+        hexes.insert( h );
+      }
+}
+
+void test_freeze_modify()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  make_hex_mesh( mb, 2, verts, hexes );
+
+  CHECK( !moab.is_frozen() );
+  ErrorCode rval = moab.freeze();
+  CHECK_ERR(rval);
+  CHECK( moab.is_frozen() );
+
+    // queries should work
+  std::vector<EntityHandle> adj;
+  rval = mb.get_adjacencies( &verts.front(), 1, 3, false, adj );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, adj.size() );
+
+    // modifications should fail
+  const double coords[3] = { 0, 0, 0 };
+  EntityHandle h;
+  rval = mb.create_vertex( coords, h );
+  CHECK( MB_SUCCESS != rval );
+  rval = mb.set_coords( &verts.front(), 1, coords );
+  CHECK( MB_SUCCESS != rval );
+  ReadUtilIface* iface;
+  rval = mb.query_interface( iface );
+  CHECK_ERR(rval);
+  std::vector<double*> arrays;
+  rval = iface->get_node_coords( 3, 1, 0, h, arrays );
+  CHECK( MB_SUCCESS != rval );
+  EntityHandle* conn;
+  rval = iface->get_element_connect( 1, 8, MBHEX, 0, h, conn );
+  CHECK( MB_SUCCESS != rval );
+  mb.release_interface( iface );
+  rval = mb.delete_entities( &hexes.front(), 1 );
+  CHECK( MB_SUCCESS != rval );
+  adj.clear();
+  rval = mb.get_adjacencies( &hexes.front(), 1, 2, true, adj );
+  CHECK( MB_SUCCESS != rval );
+
+    // and work again after unfreezing
+  moab.unfreeze();
+  CHECK( !moab.is_frozen() );
+  rval = mb.create_vertex( coords, h );
+  CHECK_ERR(rval);
+  adj.clear();
+  rval = mb.get_adjacencies( &hexes.front(), 1, 2, true, adj );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)6, adj.size() );
+  rval = mb.delete_entities( &hexes.front(), 1 );
+  CHECK_ERR(rval);
+}
+
+void test_freeze_compact()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  make_hex_mesh( mb, 3, verts, hexes );
+
+  ErrorCode rval = moab.compact_adjacencies();
+  CHECK_ERR(rval);
+  rval = moab.freeze();
+  CHECK_ERR(rval);
+
+  std::vector<EntityHandle> adj;
+  rval = mb.get_adjacencies( &verts.back(), 1, 3, false, adj );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  CHECK_EQUAL( hexes.back(), adj.front() );
+
+    // compact lists cannot be exposed as vectors without modification
+  const std::vector<EntityHandle>** adj_ptr;
+  int count;
+  rval = moab.adjacencies_iterate( verts.begin(), verts.end(), adj_ptr, count );
+  CHECK( MB_SUCCESS != rval );
+  moab.unfreeze();
+  rval = moab.adjacencies_iterate( verts.begin(), verts.end(), adj_ptr, count );
+  CHECK_ERR(rval);
+}
+
+void test_freeze_modify_sets()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  make_hex_mesh( mb, 2, verts, hexes );
+  EntityHandle parent;
+  ErrorCode rval = mb.create_meshset( MESHSET_SET, parent );
+  CHECK_ERR(rval);
+  rval = moab.freeze();
+  CHECK_ERR(rval);
+
+    // sets may be created and modified
+  EntityHandle set;
+  rval = mb.create_meshset( MESHSET_ORDERED, set );
+  CHECK_ERR(rval);
+  ReadUtilIface* iface;
+  rval = mb.query_interface( iface );
+  CHECK_ERR(rval);
+  const unsigned flags[2] = { MESHSET_SET, MESHSET_SET };
+  EntityHandle more_sets;
+  rval = iface->create_entity_sets( 2, flags, 0, more_sets );
+  CHECK_ERR(rval);
+  mb.release_interface( iface );
+  rval = mb.add_entities( set, hexes );
+  CHECK_ERR(rval);
+  rval = mb.remove_entities( set, &hexes.front(), 1 );
+  CHECK_ERR(rval);
+  rval = mb.add_parent_child( parent, set );
+  CHECK_ERR(rval);
+  rval = mb.add_child_meshset( parent, more_sets );
+  CHECK_ERR(rval);
+  Tag tag;
+  int zero = 0, val = 2;
+  rval = mb.tag_get_handle( "val", 1, MB_TYPE_INTEGER, tag, 
+                            MB_TAG_SPARSE|MB_TAG_EXCL, &zero );
+  CHECK_ERR(rval);
+  rval = mb.tag_set_data( tag, &set, 1, &val );
+  CHECK_ERR(rval);
+
+  int count;
+  rval = mb.get_number_entities_by_handle( set, count );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (int)hexes.size() - 1, count );
+  rval = mb.num_child_meshsets( parent, &count );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( 2, count );
+  rval = mb.clear_meshset( &set, 1 );
+  CHECK_ERR(rval);
+  rval = mb.get_number_entities_by_handle( set, count );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( 0, count );
+
+    // but not deleted
+  rval = mb.delete_entities( &set, 1 );
+  CHECK( MB_SUCCESS != rval );
+  moab.unfreeze();
+  rval = mb.delete_entities( &set, 1 );
+  CHECK_ERR(rval);
+}
+
+  // Creating a set while frozen may reuse the handle of a deleted set,
+  // growing a sequence after the lookup index was built by freeze().
+void test_freeze_reuse_set_handle()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  make_hex_mesh( mb, 2, verts, hexes );
+
+  EntityHandle sets[3];
+  for (int i = 0; i < 3; ++i) {
+    ErrorCode rval = mb.create_meshset( MESHSET_SET, sets[i] );
+    CHECK_ERR(rval);
+  }
+    // another set in a separate sequence
+  ReadUtilIface* iface;
+  ErrorCode rval = mb.query_interface( iface );
+  CHECK_ERR(rval);
+  const unsigned flags = MESHSET_SET;
+  EntityHandle other;
+  rval = iface->create_entity_sets( 1, &flags, 1000, other );
+  CHECK_ERR(rval);
+  mb.release_interface( iface );
+
+  rval = mb.delete_entities( sets, 1 );
+  CHECK_ERR(rval);
+    // look up the other set last, such that lookups of the reused
+    // handle while frozen cannot use the last accessed sequence
+  unsigned opts;
+  rval = mb.get_meshset_options( other, opts );
+  CHECK_ERR(rval);
+
+  rval = moab.freeze();
+  CHECK_ERR(rval);
+  EntityHandle set;
+  rval = mb.create_meshset( MESHSET_SET, set );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( sets[0], set );
+  rval = mb.get_meshset_options( set, opts );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (unsigned)MESHSET_SET, opts );
+  rval = mb.add_entities( set, hexes );
+  CHECK_ERR(rval);
+  Range contents;
+  rval = mb.get_entities_by_handle( set, contents );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( hexes, contents );
+  moab.unfreeze();
+
+  contents.clear();
+  rval = mb.get_entities_by_handle( set, contents );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( hexes, contents );
+}
+
+  // Data shared by all query threads
+struct QueryData {
+  Interface* mb;
+  int n;
+  Tag dense, sparse;
+  EntityHandle set;
+  std::vector<EntityHandle> vert_list, hex_list;
+  std::vector< std::vector<EntityHandle> > vert_hexes;
+};
+
+  // Per-thread arguments and result
+struct QueryThread {
+  const QueryData* data;
+  int thread_num;
+  long errors;
+};
+
+static void query_vertex( const QueryData& d, long vi, long& errors )
+{
+  const EntityHandle vtx = d.vert_list[vi];
+  double xyz[3];
+  if (MB_SUCCESS != d.mb->get_coords( &vtx, 1, xyz ))
+    ++errors;
+  else if (xyz[0] + (d.n+1)*(xyz[1] + (d.n+1)*xyz[2]) != vi)
+    ++errors;
+  int id;
+  if (MB_SUCCESS != d.mb->tag_get_data( d.dense, &vtx, 1, &id ) || id != vi)
+    ++errors;
+  std::vector<EntityHandle> adj;
+  if (MB_SUCCESS != d.mb->get_adjacencies( &vtx, 1, 3, false, adj ) || adj != d.vert_hexes[vi])
+    ++errors;
+}
+
+static void query_hex( const QueryData& d, long hi, long& errors )
+{
+  const EntityHandle hex = d.hex_list[hi];
+  const EntityHandle* conn;
+  int len;
+  if (MB_SUCCESS != d.mb->get_connectivity( hex, conn, len ) || len != 8)
+    ++errors;
+  else {
+    const long vi = std::lower_bound( d.vert_list.begin(), d.vert_list.end(), conn[0] ) - d.vert_list.begin();
+    if (std::find( d.vert_hexes[vi].begin(), d.vert_hexes[vi].end(), hex ) == d.vert_hexes[vi].end())
+      ++errors;
+  }
+  double centroid[3];
+  if (MB_SUCCESS != d.mb->get_coords( &hex, 1, centroid ))
+    ++errors;
+  int id;
+  if (!(hi % 2) && (MB_SUCCESS != d.mb->tag_get_data( d.sparse, &hex, 1, &id ) || id != hi/2))
+    ++errors;
+  std::vector<EntityHandle> adj;
+  if (MB_SUCCESS != d.mb->get_adjacencies( &hex, 1, 0, false, adj ) || adj.size() != 8)
+    ++errors;
+  if (d.mb->contains_entities( d.set, &hex, 1 ) != !(hi % 2))
+    ++errors;
+}
+
+  // Visit entities in an order that alternates between sequences,
+  // and between vertices and elements, starting at a different
+  // entity in each thread
+static void* query_thread( void* ptr )
+{
+  QueryThread* t = reinterpret_cast<QueryThread*>(ptr);
+  const QueryData& d = *t->data;
+  const long num_vert = d.vert_list.size();
+  const long num_visit = num_vert + d.hex_list.size();
+  const int num_passes = 10;
+  for (int pass = 0; pass < num_passes; ++pass) {
+    for (long v = 0; v < num_visit; ++v) {
+      const long idx = (v * 7919 + 101 * t->thread_num + pass) % num_visit;
+      if (idx >= num_vert)
+        query_hex( d, idx - num_vert, t->errors );
+      else if (idx % 2)
+        query_vertex( d, idx/2, t->errors );
+      else
+        query_vertex( d, num_vert - 1 - idx/2, t->errors );
+    }
+  }
+  return 0;
+}
+
+void test_concurrent_queries()
+{
+  Core moab;
+  QueryData d;
+  d.mb = &moab;
+  d.n = 12;
+  Range verts, hexes;
+  make_hex_mesh( moab, d.n, verts, hexes );
+
+    // dense tag on vertices, sparse tag on every other hex
+  int zero = 0;
+  ErrorCode rval = moab.tag_get_handle( "dense", 1, MB_TYPE_INTEGER, d.dense,
+                                        MB_TAG_DENSE|MB_TAG_EXCL, &zero );
+  CHECK_ERR(rval);
+  rval = moab.tag_get_handle( "sparse", 1, MB_TYPE_INTEGER, d.sparse,
+                              MB_TAG_SPARSE|MB_TAG_EXCL );
+  CHECK_ERR(rval);
+  std::vector<int> ids( verts.size() );
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = i;
+  rval = moab.tag_set_data( d.dense, verts, &ids[0] );
+  CHECK_ERR(rval);
+  Range tagged_hexes;
+  for (Range::iterator i = hexes.begin(); i != hexes.end(); i += 2)
+    tagged_hexes.insert( *i );
+  rval = moab.tag_set_data( d.sparse, tagged_hexes, &ids[0] );
+  CHECK_ERR(rval);
+
+    // a set containing the tagged hexes
+  rval = moab.create_meshset( MESHSET_SET, d.set );
+  CHECK_ERR(rval);
+  rval = moab.add_entities( d.set, tagged_hexes );
+  CHECK_ERR(rval);
+
+  rval = moab.freeze();
+  CHECK_ERR(rval);
+
+    // serially computed expected results
+  d.vert_list.assign( verts.begin(), verts.end() );
+  d.hex_list.assign( hexes.begin(), hexes.end() );
+  d.vert_hexes.resize( d.vert_list.size() );
+  for (size_t i = 0; i < d.vert_list.size(); ++i) {
+    rval = moab.get_adjacencies( &d.vert_list[i], 1, 3, false, d.vert_hexes[i] );
+    CHECK_ERR(rval);
+  }
+
+  const int num_threads = 4;
+  QueryThread threads[num_threads];
+  pthread_t ids_out[num_threads];
+  for (int i = 0; i < num_threads; ++i) {
+    threads[i].data = &d;
+    threads[i].thread_num = i;
+    threads[i].errors = 0;
+    CHECK_EQUAL( 0, pthread_create( ids_out + i, 0, &query_thread, threads + i ) );
+  }
+  long errors = 0;
+  for (int i = 0; i < num_threads; ++i) {
+    CHECK_EQUAL( 0, pthread_join( ids_out[i], 0 ) );
+    errors += threads[i].errors;
+  }
+  CHECK_EQUAL( 0L, errors );
+
+  moab.unfreeze();
+}
@@ -0,0 +1,275 @@
+#include "moab/Core.hpp"
+#include "moab/BackgroundWriter.hpp"
+#include "TestUtil.hpp"
+#include "moab/Range.hpp"
+
+#ifdef MOAB_HAVE_MPI
+#include "moab_mpi.h"
+#endif
+
+#include <vector>
+#include <stdio.h>
+
+using namespace moab;
+
+const char filename1[] = "background1.h5m";
+const char filename2[] = "background2.h5m";
+const char TAG_NAME[] = "vertex_id";
+const int N = 8;
+
+void test_background_write();
+void test_background_write_sequence();
+void test_background_write_sets();
+void test_background_write_create();
+void test_background_write_error();
+void test_background_write_parallel();
+
+int main(int argc, char* argv[])
+{
+#ifdef MOAB_HAVE_MPI
+  int fail = MPI_Init(&argc, &argv);
+  if (fail) return fail;
+#else
+  argv[0]=argv[argc-argc];// warning in serial
+#endif
+
+  int exitval = 0;
+  exitval += RUN_TEST( test_background_write );
+  exitval += RUN_TEST( test_background_write_sequence );
+  exitval += RUN_TEST( test_background_write_sets );
+  exitval += RUN_TEST( test_background_write_create );
+  exitval += RUN_TEST( test_background_write_error );
+  exitval += RUN_TEST( test_background_write_parallel );
+
+#ifdef MOAB_HAVE_MPI
+  fail = MPI_Finalize();
+  if (fail) return fail;
+#endif
+
+  return exitval;
+}
+
+  // Create a structured grid of N^3 hexes with vertex coordinates
+  // offset by the passed value, and tag vertices with their index.
+static void create_mesh( Interface& mb, double offset, Range& verts, Range& hexes )
+{
+  const int nv = N + 1;
+  std::vector<double> coords;
+  for (int k = 0; k < nv; ++k)
+    for (int j = 0; j < nv; ++j)
+      for (int i = 0; i < nv; ++i) {
+        coords.push_back( i + offset );
+        coords.push_back( j );
+        coords.push_back( k );
+      }
+  ErrorCode rval = mb.create_vertices( &coords[0], nv*nv*nv, verts );
+  CHECK_ERR(rval);
+
+  Tag tag;
+  rval = mb.tag_get_handle( TAG_NAME, 1, MB_TYPE_INTEGER, tag, MB_TAG_DENSE|MB_TAG_CREAT );
+  CHECK_ERR(rval);
+  std::vector<int> ids( verts.size() );
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = i;
+  rval = mb.tag_set_data( tag, verts, &ids[0] );
+  CHECK_ERR(rval);
+
+  std::vector<EntityHandle> vert_list( verts.begin(), verts.end() );
+  for (int k = 0; k < N; ++k)
+    for (int j = 0; j < N; ++j)
+      for (int i = 0; i < N; ++i) {
+        const int v = i + nv*(j + nv*k);
+        const EntityHandle conn[8] = {
+          vert_list[v],             vert_list[v+1],
+          vert_list[v+nv+1],        vert_list[v+nv],
+          vert_list[v+nv*nv],       vert_list[v+nv*nv+1],
+          vert_list[v+nv*nv+nv+1],  vert_list[v+nv*nv+nv] };
+        EntityHandle h;
+        rval = mb.create_element( MBHEX, conn, 8, h );
+        CHECK_ERR(rval);
+        hexes.insert( h );
+      }
+}
+
+  // Read file and check that it contains the mesh created by
+  // create_mesh with the passed offset
+static void check_file( const char* name, double offset )
+{
+  Core moab;
+  Interface& mb = moab;
+  ErrorCode rval = mb.load_file( name );
+  CHECK_ERR(rval);
+
+  Range verts, hexes;
+  rval = mb.get_entities_by_type( 0, MBVERTEX, verts );
+  CHECK_ERR(rval);
+  rval = mb.get_entities_by_type( 0, MBHEX, hexes );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)((N+1)*(N+1)*(N+1)), verts.size() );
+  CHECK_EQUAL( (size_t)(N*N*N), hexes.size() );
+
+  Tag tag;
+  rval = mb.tag_get_handle( TAG_NAME, 1, MB_TYPE_INTEGER, tag );
+  CHECK_ERR(rval);
+  std::vector<int> ids( verts.size() );
+  rval = mb.tag_get_data( tag, verts, &ids[0] );
+  CHECK_ERR(rval);
+  std::vector<double> coords( 3*verts.size() );
+  rval = mb.get_coords( verts, &coords[0] );
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < verts.size(); ++i) {
+    const int id = ids[i];
+    CHECK_REAL_EQUAL( id % (N+1) + offset, coords[3*i], 1e-12 );
+    CHECK_REAL_EQUAL( (double)(id / (N+1) % (N+1)), coords[3*i+1], 1e-12 );
+    CHECK_REAL_EQUAL( (double)(id / ((N+1)*(N+1))), coords[3*i+2], 1e-12 );
+  }
+}
+
+  // Check that the written file contains the mesh as it was
+  // when write_file was called, not as modified afterwards
+void test_background_write()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  create_mesh( mb, 0.0, verts, hexes );
+
+  BackgroundWriter writer( &mb );
+  CHECK( writer.is_done() );
+  ErrorCode rval = writer.write_file( filename1 );
+  CHECK_ERR(rval);
+
+    // modify the mesh while the file is being written
+  std::vector<double> zero( 3*verts.size(), 0.0 );
+  rval = mb.set_coords( verts, &zero[0] );
+  CHECK_ERR(rval);
+  rval = mb.delete_entities( hexes );
+  CHECK_ERR(rval);
+
+  rval = writer.wait();
+  CHECK_ERR(rval);
+  CHECK( writer.is_done() );
+  check_file( filename1, 0.0 );
+  remove( filename1 );
+}
+
+  // Start a second write before waiting for the first
+void test_background_write_sequence()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  create_mesh( mb, 0.0, verts, hexes );
+
+  BackgroundWriter writer( &mb );
+  ErrorCode rval = writer.write_file( filename1 );
+  CHECK_ERR(rval);
+
+  std::vector<double> coords( 3*verts.size() );
+  rval = mb.get_coords( verts, &coords[0] );
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < coords.size(); i += 3)
+    coords[i] += 0.5;
+  rval = mb.set_coords( verts, &coords[0] );
+  CHECK_ERR(rval);
+
+  rval = writer.write_file( filename2 );
+  CHECK_ERR(rval);
+  rval = writer.wait();
+  CHECK_ERR(rval);
+
+  check_file( filename1, 0.0 );
+  check_file( filename2, 0.5 );
+  remove( filename1 );
+  remove( filename2 );
+}
+
+  // Write only the contents of a set, with a subset of tags
+void test_background_write_sets()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts1, hexes1, verts2, hexes2;
+  create_mesh( mb, 0.0, verts1, hexes1 );
+  create_mesh( mb, 100.0, verts2, hexes2 );
+
+  EntityHandle set;
+  ErrorCode rval = mb.create_meshset( MESHSET_SET, set );
+  CHECK_ERR(rval);
+  rval = mb.add_entities( set, hexes2 );
+  CHECK_ERR(rval);
+  Tag tag;
+  rval = mb.tag_get_handle( TAG_NAME, 1, MB_TYPE_INTEGER, tag );
+  CHECK_ERR(rval);
+
+  BackgroundWriter writer( &mb );
+  rval = writer.write_file( filename1, 0, &set, 1, &tag, 1 );
+  CHECK_ERR(rval);
+  rval = mb.delete_mesh();
+  CHECK_ERR(rval);
+  rval = writer.wait();
+  CHECK_ERR(rval);
+
+  check_file( filename1, 100.0 );
+  remove( filename1 );
+}
+
+  // CREATE option should fail if file exists
+void test_background_write_create()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  create_mesh( mb, 0.0, verts, hexes );
+
+  BackgroundWriter writer( &mb );
+  ErrorCode rval = writer.write_file( filename1, "CREATE" );
+  CHECK_ERR(rval);
+  rval = writer.wait();
+  CHECK_ERR(rval);
+
+  rval = writer.write_file( filename1, "CREATE" );
+  if (MB_SUCCESS == rval)
+    rval = writer.wait();
+  CHECK( MB_SUCCESS != rval );
+  check_file( filename1, 0.0 );
+  remove( filename1 );
+}
+
+  // Errors writing the file should be reported by wait()
+void test_background_write_error()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  create_mesh( mb, 0.0, verts, hexes );
+
+  BackgroundWriter writer( &mb );
+  writer.write_file( "no_such_directory/background.h5m" );
+  ErrorCode rval = writer.wait();
+  CHECK( MB_SUCCESS != rval );
+
+    // error should not persist to next write
+  rval = writer.write_file( filename1 );
+  CHECK_ERR(rval);
+  rval = writer.wait();
+  CHECK_ERR(rval);
+  remove( filename1 );
+}
+
+  // Parallel writes should be rejected rather than written synchronously
+void test_background_write_parallel()
+{
+  Core moab;
+  Interface& mb = moab;
+  Range verts, hexes;
+  create_mesh( mb, 0.0, verts, hexes );
+
+  BackgroundWriter writer( &mb );
+  ErrorCode rval = writer.write_file( filename1, "PARALLEL=WRITE_PART" );
+  CHECK_EQUAL( MB_NOT_IMPLEMENTED, rval );
+  FILE* file = fopen( filename1, "r" );
+  CHECK( !file );
+  if (file)
+    fclose( file );
+}
@@ -4,6 +4,10 @@
 #include "ReadHDF5.hpp"
 #include "MBTagConventions.hpp"
 #include "moab/FileOptions.hpp"
+#include <H5Fpublic.h>
+#include <H5Dpublic.h>
+#include <H5Ppublic.h>
+#include <H5Lpublic.h>
 
 #ifdef MOAB_HAVE_MPI
 #include "moab_mpi.h"
@@ -19,12 +23,14 @@ using namespace moab;
 
 const char TEST_FILE[] = "partial.h5m";
 #define READ_OPTS "BUFFER_SIZE=256"
+  // Use small chunks so that partial reads do not align with chunks
+#define COMPRESS_OPTS "COMPRESS;SHUFFLE;CHUNK_SIZE=100"
 const char ID_TAG_NAME[] = "test_id_tag";
 
 
 static void test_read_nothing_common( bool non_existant );
 static void test_read_nodes_common( int num_read_sets, bool blocked_coordinate_io );
-static void test_read_handle_tag_common( bool var_len );
+static void test_read_handle_tag_common( bool var_len, const char* write_opts = 0 );
 
 const int MBQUAD_INT = 20; 
 const int NUM_SETS = 10;
@@ -41,7 +47,8 @@ void create_mesh( bool create_element_sets,
                   bool tag_elements_with_id,
                   bool tag_vertices_with_id,
                   const char* adj_elem_tag_name = 0,
-                  bool var_len_adj_elems = false );
+                  bool var_len_adj_elems = false,
+                  const char* write_opts = 0 );
 // Given a list of vertices adjacent to a quad strip, identify it as one of the 
 // NUM_SETS strips of quads written by create_mesh.
 int identify_set( Interface& mb, const Range& verts );
@@ -142,6 +149,14 @@ void test_read_handle_tag()
 void test_var_len_tag()
   { test_read_handle_tag_common(true); }
 
+void test_read_compressed_elems();
+
+void test_read_compressed_var_len_tag()
+  { test_read_handle_tag_common(true, COMPRESS_OPTS); }
+
+//! Read sets using the partition index written with PARTITION_INDEX
+void test_read_partition_index();
+
 void test_read_tagged_elems();
 
 void test_read_tagged_nodes();
@@ -180,6 +195,9 @@ int main( int argc, char* argv[] )
   REGISTER_TEST(test_read_handle_tag);
   REGISTER_TEST(test_var_len_tag);
   REGISTER_TEST(test_read_adjacencies);
+  REGISTER_TEST(test_read_compressed_elems);
+  REGISTER_TEST(test_read_compressed_var_len_tag);
+  REGISTER_TEST(test_read_partition_index);
   REGISTER_TEST(test_read_tagged_elems);
   REGISTER_TEST(test_read_tagged_nodes);
   REGISTER_TEST(test_read_sides);
@@ -387,7 +405,8 @@ void create_mesh( bool create_element_sets,
                   bool tag_elements_with_id,
                   bool tag_vertices_with_id,
                   const char* adj_elem_tag_name,
-                  bool var_len_adj_elems )
+                  bool var_len_adj_elems,
+                  const char* write_opts )
 {
   Core moab;
   Interface& mb = moab;
@@ -502,7 +521,7 @@ void create_mesh( bool create_element_sets,
     }
   }
   
-  rval = mb.write_file( TEST_FILE, "MOAB" );
+  rval = mb.write_file( TEST_FILE, "MOAB", write_opts );
   CHECK_ERR(rval);
 }
 
@@ -713,14 +732,14 @@ void test_read_opaque_tag()
   }
 }
 
-static void test_read_handle_tag_common( bool var_len )
+static void test_read_handle_tag_common( bool var_len, const char* write_opts )
 {
   ErrorCode rval;
   Core moab;
   Interface& mb = moab;
   
   const char tag_name[] = "VTX_ADJ";
-  create_mesh( true, false, false, false, tag_name, var_len );
+  create_mesh( true, false, false, false, tag_name, var_len, write_opts );
   int ids[2] = { 7, 10 };
   rval = mb.load_file( TEST_FILE, 0, READ_OPTS, ID_TAG_NAME, ids, 2 );
   CHECK_ERR(rval);
@@ -764,6 +783,51 @@ static void test_read_handle_tag_common( bool var_len )
 }
 
 
+//! Read in the elems contained in a set from a file written with
+//! chunked, compressed node, connectivity and tag tables
+void test_read_compressed_elems()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface& mb = moab;
+  
+  create_mesh( true, false, false, false, 0, false, COMPRESS_OPTS );
+
+    // check that the file was written with the requested layout
+  hid_t file = H5Fopen( TEST_FILE, H5F_ACC_RDONLY, H5P_DEFAULT );
+  CHECK( file >= 0 );
+  hid_t table = H5Dopen2( file, "/tstt/nodes/coordinates", H5P_DEFAULT );
+  CHECK( table >= 0 );
+  hid_t prop = H5Dget_create_plist( table );
+  CHECK_EQUAL( H5D_CHUNKED, H5Pget_layout( prop ) );
+  CHECK_EQUAL( 2, H5Pget_nfilters( prop ) );
+  H5Pclose( prop );
+  H5Dclose( table );
+  H5Fclose( file );
+  
+  for (int id = 1; id <= NUM_SETS; ++id) {
+    rval = mb.delete_mesh();
+    CHECK_ERR(rval);
+    rval = mb.load_file( TEST_FILE, 0, READ_OPTS, ID_TAG_NAME, &id, 1 );
+    CHECK_ERR(rval);
+    Range verts;
+    rval = mb.get_entities_by_type( 0, MBVERTEX, verts );
+    int act_id = identify_set( mb, verts );
+    CHECK_EQUAL( id, act_id );
+
+    Tag tag = check_tag( mb, CENTROID_NAME, MB_TAG_DENSE, MB_TYPE_DOUBLE, 3 );
+    for (Range::iterator i = verts.begin(); i != verts.end(); ++i) {
+      double coords[3], data[3];
+      rval = mb.get_coords( &*i, 1, coords );
+      CHECK_ERR(rval);
+      rval = mb.tag_get_data( tag, &*i, 1, data );
+      CHECK_ERR(rval);
+      CHECK_REAL_EQUAL( coords[0], data[0], 1e-12 );
+      CHECK_REAL_EQUAL( coords[1], data[1], 1e-12 );
+    }
+  }
+}
+
 void test_read_tagged_elems()
 {
   ErrorCode rval;
@@ -811,6 +875,48 @@ void test_read_tagged_nodes()
 }
 
 
+//! Read sets using the partition index written with PARTITION_INDEX
+void test_read_partition_index()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface& mb = moab;
+  
+  std::string opts( "PARTITION_INDEX=" );
+  opts += ID_TAG_NAME;
+  create_mesh( true, false, false, false, 0, false, opts.c_str() );
+
+    // check that the file contains the index
+  hid_t file = H5Fopen( TEST_FILE, H5F_ACC_RDONLY, H5P_DEFAULT );
+  CHECK( file >= 0 );
+  CHECK( H5Lexists( file, "/tstt/sets/part_index", H5P_DEFAULT ) > 0 );
+  CHECK( H5Lexists( file, "/tstt/sets/part_ranges", H5P_DEFAULT ) > 0 );
+  H5Fclose( file );
+  
+    // read each set and pair of sets with and without the index
+  for (int id = 1; id < NUM_SETS; ++id) {
+    int ids[2] = { id, id + 1 };
+    Range ents[2];
+    for (int i = 0; i < 2; ++i) {
+      rval = mb.delete_mesh();
+      CHECK_ERR(rval);
+      rval = mb.load_file( TEST_FILE, 0, i ? READ_OPTS ";IGNORE_PARTITION_INDEX" : READ_OPTS,
+                           ID_TAG_NAME, ids, 1 + id % 2 );
+      CHECK_ERR(rval);
+      rval = mb.get_entities_by_handle( 0, ents[i] );
+      CHECK_ERR(rval);
+      Range verts = ents[i].subset_by_type( MBVERTEX );
+      Range quads = ents[i].subset_by_type( MBQUAD );
+      CHECK_EQUAL( (size_t)(SET_WIDTH * MBQUAD_INT * (1 + id % 2)), quads.size() );
+      CHECK_EQUAL( (size_t)((SET_WIDTH * (1 + id % 2) + 1) * (MBQUAD_INT + 1)), verts.size() );
+      if (id % 2 == 0) 
+        CHECK_EQUAL( id, identify_set( mb, verts ) );
+    }
+    CHECK_EQUAL( ents[1].size(), ents[0].size() );
+  }
+}
+
+
 //! Read in the polyhedra contained in a set
 void test_read_one_set_polyhedra()
 {
@@ -1,5 +1,6 @@
 #include "moab/Core.hpp"
 #include "moab/Range.hpp"
+#include "moab/MOABConfig.h"
 
 using namespace moab;
 
@@ -11,6 +12,7 @@ using namespace moab;
 #include <vector>
 #include <algorithm>
 #include <sstream>
+#include <time.h>
 
 #include "TestUtil.hpp"
 
@@ -131,8 +133,31 @@ DECLARE_TEST(write_free_nodes)
 
 DECLARE_TEST(unstructured_field)
 
+DECLARE_TEST(binary_attrib_bit)
+DECLARE_TEST(binary_attrib_int)
+DECLARE_TEST(binary_attrib_double)
+DECLARE_TEST(vtu_appended)
+DECLARE_TEST(vtu_big_endian)
+DECLARE_TEST(write_binary_bit)
+DECLARE_TEST(write_binary_double)
+DECLARE_TEST(write_vtu_appended)
+DECLARE_TEST(write_vtu_base64)
+DECLARE_TEST(write_vtu_compressed)
+DECLARE_TEST(write_pvtu)
+
+void read_perf( int num_intervals );
+void write_perf( int num_intervals );
+
 int main( int argc, char* argv[] )
 {
+    // "vtk_test -perf [n]" compares the time to read and write a
+    // mesh of n^3 hexes as ASCII, binary and VTK XML files
+  if (argc > 1 && !strcmp(argv[1], "-perf")) {
+    read_perf( argc > 2 ? atoi(argv[2]) : 50 );
+    write_perf( argc > 2 ? atoi(argv[2]) : 50 );
+    return 0;
+  }
+
   int *test_indices = (int*)malloc(sizeof(int) * num_tests);
   int test_count;
     // if no arguments, do all tests
@@ -1661,3 +1686,448 @@ bool test_unstructured_field()
   
   return true;
 }
+
+static bool native_big_endian()
+{
+  const unsigned one = 1;
+  return !*reinterpret_cast<const char*>(&one);
+}
+
+// Append binary values to a string in the specified byte order
+template <typename T>
+static void append_values( std::string& str, const T* vals, size_t count, bool big_endian )
+{
+  for (size_t i = 0; i < count; ++i) {
+    const char* bytes = reinterpret_cast<const char*>(vals + i);
+    if (big_endian == native_big_endian())
+      str.append( bytes, sizeof(T) );
+    else for (size_t j = sizeof(T); j > 0; --j)
+      str += bytes[j-1];
+  }
+}
+
+bool read_binary_file( Interface* iface, const std::string& data, const char* fname )
+{
+  FILE* fptr = fopen( fname, "wb" );
+  fwrite( data.data(), 1, data.size(), fptr );
+  fclose( fptr );
+  
+  ErrorCode rval = iface->load_mesh( fname );
+  remove( fname );
+  CHECK(rval);
+  return true;
+}
+
+  // Append attribute values in legacy binary format
+static void append_attrib( std::string& file, DataType type, unsigned count, const int* vals )
+{
+  std::vector<unsigned char> bits;
+  std::vector<double> dvals;
+  switch (type) {
+    case MB_TYPE_BIT:
+      bits.resize( (count + 7) / 8, 0 );
+      for (unsigned i = 0; i < count; ++i)
+        if (abs(vals[i]) % 2)
+          bits[i/8] |= (unsigned char)(0x80 >> (i % 8));
+      append_values( file, &bits[0], bits.size(), true );
+      break;
+    case MB_TYPE_INTEGER:
+      append_values( file, vals, count, true );
+      break;
+    case MB_TYPE_DOUBLE:
+      dvals.assign( vals, vals + count );
+      append_values( file, &dvals[0], count, true );
+      break;
+    default:
+      assert(false);
+  }
+}
+
+  // Write 'two_quad_mesh' as a binary legacy file, with attributes named "data"
+static std::string binary_two_quad_mesh( const char* vtk_type, DataType type, int count )
+{
+  std::string file = 
+   "# vtk DataFile Version 3.0\n"
+   "MOAB Version 1.00\n"
+   "BINARY\n"
+   "DATASET UNSTRUCTURED_GRID\n"
+   "POINTS 6 float\n";
+  float coords[18];
+  std::copy( two_quad_mesh_coords, two_quad_mesh_coords + 18, coords );
+  append_values( file, coords, 18, true );
+  file += "\nCELLS 2 10\n";
+  const int cells[] = { 4, 0, 1, 4, 3, 4, 1, 2, 5, 4 };
+  append_values( file, cells, 10, true );
+  file += "\nCELL_TYPES 2\n";
+  const int types[] = { 9, 9 };
+  append_values( file, types, 2, true );
+
+  char line[128];
+  sprintf( line, "\nPOINT_DATA 6\nSCALARS data %s %d\nLOOKUP_TABLE default\n", vtk_type, count );
+  file += line;
+  append_attrib( file, type, 6*count, vertex_values );
+  sprintf( line, "\nCELL_DATA 2\nSCALARS data %s %d\nLOOKUP_TABLE default\n", vtk_type, count );
+  file += line;
+  append_attrib( file, type, 2*count, element_values );
+  file += "\n";
+  return file;
+}
+
+bool test_binary_attrib( const char* vtk_type, DataType type, int count )
+{
+  Core instance;
+  bool bval = read_binary_file( &instance, binary_two_quad_mesh( vtk_type, type, count ), "tmp_file.vtk" );
+  CHECK(bval);
+  bval = check_tag_values( &instance, type, count ); 
+  CHECK(bval);
+  return true;
+}
+
+bool test_binary_attrib_bit()
+  { return test_binary_attrib( "bit", MB_TYPE_BIT, 4 ); }
+
+bool test_binary_attrib_int()
+  { return test_binary_attrib( "int", MB_TYPE_INTEGER, 3 ); }
+
+bool test_binary_attrib_double()
+  { return test_binary_attrib( "double", MB_TYPE_DOUBLE, 1 ); }
+
+  // Append a block of raw appended data for a VTK XML file
+template <typename T>
+static void append_block( std::string& data, const T* vals, size_t count,
+                          bool big_endian, bool header64 )
+{
+  if (header64) {
+    const unsigned long long bytes = count * sizeof(T);
+    append_values( data, &bytes, 1, big_endian );
+  }
+  else {
+    const unsigned bytes = count * sizeof(T);
+    append_values( data, &bytes, 1, big_endian );
+  }
+  append_values( data, vals, count, big_endian );
+}
+
+static void data_array( std::ostream& xml, const char* type, const char* name,
+                        int num_comp, size_t offset )
+{
+  xml << "<DataArray type=\"" << type << "\" Name=\"" << name 
+      << "\" NumberOfComponents=\"" << num_comp 
+      << "\" format=\"appended\" offset=\"" << offset << "\"/>" << std::endl;
+}
+
+  // Write 'two_quad_mesh' as a VTK XML file with raw appended data and
+  // attributes named "data".  For the little-endian file the attributes are
+  // integers and sizes are 32-bit.  For the big-endian file the attributes are
+  // doubles, sizes are 64-bit, and the cell types are written inline as ASCII.
+static std::string vtu_two_quad_mesh( bool big_endian, int count )
+{
+  const bool header64 = big_endian;
+  std::ostringstream xml;
+  std::string data;
+  xml << "<?xml version=\"1.0\"?>" << std::endl
+      << "<!-- two quads -->" << std::endl
+      << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" 
+      << (big_endian ? "BigEndian" : "LittleEndian") << "\" header_type=\""
+      << (header64 ? "UInt64" : "UInt32") << "\">" << std::endl
+      << "<UnstructuredGrid>" << std::endl
+      << "<Piece NumberOfPoints=\"6\" NumberOfCells=\"2\">" << std::endl;
+
+  xml << "<PointData Scalars=\"data\">" << std::endl;
+  if (big_endian) {
+    std::vector<float> vals( vertex_values, vertex_values + 6*count );
+    data_array( xml, "Float32", "data", count, data.size() );
+    append_block( data, &vals[0], vals.size(), big_endian, header64 );
+  }
+  else {
+    data_array( xml, "Int32", "data", count, data.size() );
+    append_block( data, vertex_values, 6*count, big_endian, header64 );
+  }
+  xml << "</PointData>" << std::endl;
+
+  xml << "<CellData>" << std::endl;
+  if (big_endian) {
+    std::vector<double> vals( element_values, element_values + 2*count );
+    data_array( xml, "Float64", "data", count, data.size() );
+    append_block( data, &vals[0], vals.size(), big_endian, header64 );
+  }
+  else {
+    std::vector<short> vals( element_values, element_values + 2*count );
+    data_array( xml, "Int16", "data", count, data.size() );
+    append_block( data, &vals[0], vals.size(), big_endian, header64 );
+  }
+  xml << "</CellData>" << std::endl;
+
+  xml << "<Points>" << std::endl;
+  if (big_endian) {
+    std::vector<float> coords( two_quad_mesh_coords, two_quad_mesh_coords + 18 );
+    data_array( xml, "Float32", "Points", 3, data.size() );
+    append_block( data, &coords[0], 18, big_endian, header64 );
+  }
+  else {
+    data_array( xml, "Float64", "Points", 3, data.size() );
+    append_block( data, two_quad_mesh_coords, 18, big_endian, header64 );
+  }
+  xml << "</Points>" << std::endl;
+
+  xml << "<Cells>" << std::endl;
+  const long long conn[] = { 0, 1, 4, 3, 1, 2, 5, 4 };
+  data_array( xml, "Int64", "connectivity", 1, data.size() );
+  append_block( data, conn, 8, big_endian, header64 );
+  const int offsets[] = { 4, 8 };
+  data_array( xml, "Int32", "offsets", 1, data.size() );
+  append_block( data, offsets, 2, big_endian, header64 );
+  if (big_endian) {
+    xml << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">" << std::endl
+        << "9 9" << std::endl << "</DataArray>" << std::endl;
+  }
+  else {
+    const unsigned char types[] = { 9, 9 };
+    data_array( xml, "UInt8", "types", 1, data.size() );
+    append_block( data, types, 2, big_endian, header64 );
+  }
+  xml << "</Cells>" << std::endl;
+
+  xml << "</Piece>" << std::endl
+      << "</UnstructuredGrid>" << std::endl
+      << "<AppendedData encoding=\"raw\">" << std::endl
+      << "   _";
+  std::string file = xml.str();
+  file += data;
+  file += "\n</AppendedData>\n</VTKFile>\n";
+  return file;
+}
+
+bool test_vtu_appended()
+{
+  Core instance;
+  bool bval = read_binary_file( &instance, vtu_two_quad_mesh( false, 1 ), "tmp_file.vtu" );
+  CHECK(bval);
+  bval = check_tag_values( &instance, MB_TYPE_INTEGER, 1 ); 
+  CHECK(bval);
+  return true;
+}
+
+bool test_vtu_big_endian()
+{
+  Core instance;
+  bool bval = read_binary_file( &instance, vtu_two_quad_mesh( true, 2 ), "tmp_file.vtu" );
+  CHECK(bval);
+  bval = check_tag_values( &instance, MB_TYPE_DOUBLE, 2 ); 
+  CHECK(bval);
+  return true;
+}
+
+  // Read 'two_quad_mesh' with attributes named "data", write it using
+  // the passed file name and options, and check the mesh read back in
+bool test_write_read( const char* fname, const char* options, DataType type, int count )
+{
+  const char* vtk_type = MB_TYPE_BIT == type ? "bit" : MB_TYPE_DOUBLE == type ? "double" : "int";
+  Core instance1;
+  bool bval = read_binary_file( &instance1, binary_two_quad_mesh( vtk_type, type, count ), "tmp_file.vtk" );
+  CHECK(bval);
+  ErrorCode rval = instance1.write_file( fname, 0, options );
+  CHECK(rval);
+
+  Core instance2;
+  rval = instance2.load_file( fname );
+  remove( fname );
+  CHECK(rval);
+  bval = check_tag_values( &instance2, type, count );
+  CHECK(bval);
+  return true;
+}
+
+bool test_write_binary_bit()
+  { return test_write_read( "tmp_file2.vtk", "BINARY", MB_TYPE_BIT, 4 ); }
+
+bool test_write_binary_double()
+  { return test_write_read( "tmp_file2.vtk", "BINARY", MB_TYPE_DOUBLE, 3 ); }
+
+bool test_write_vtu_appended()
+  { return test_write_read( "tmp_file2.vtu", "", MB_TYPE_INTEGER, 3 ); }
+
+bool test_write_vtu_base64()
+  { return test_write_read( "tmp_file2.vtu", "BASE64", MB_TYPE_DOUBLE, 2 ); }
+
+bool test_write_vtu_compressed()
+{
+#ifdef MOAB_HAVE_ZLIB
+  bool bval = test_write_read( "tmp_file2.vtu", "COMPRESS", MB_TYPE_INTEGER, 4 );
+  CHECK(bval);
+  bval = test_write_read( "tmp_file2.vtu", "COMPRESS=9;BASE64", MB_TYPE_DOUBLE, 1 );
+  CHECK(bval);
+#endif
+  return true;
+}
+
+bool test_write_pvtu()
+{
+  bool bval = test_write_read( "tmp_file2.pvtu", "", MB_TYPE_DOUBLE, 1 );
+  remove( "tmp_file2_0.vtu" );
+  CHECK(bval);
+  return true;
+}
+
+  // Write a mesh of n^3 hexes as an ASCII legacy file, a binary
+  // legacy file, and a VTK XML file with raw appended data.
+static void perf_files( int n, std::string& ascii, std::string& binary, std::string& vtu )
+{
+  const int nv = n + 1;
+  const long num_verts = (long)nv*nv*nv, num_hexes = (long)n*n*n;
+  std::vector<double> coords( 3*num_verts );
+  for (long i = 0; i < num_verts; ++i) {
+    coords[3*i]   = 0.1 * (i % nv);
+    coords[3*i+1] = 0.1 * ((i / nv) % nv);
+    coords[3*i+2] = 0.1 * (i / nv / nv);
+  }
+  std::vector<int> cells, conn, offsets;
+  for (int k = 0; k < n; ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i) {
+        const int v = i + nv*(j + nv*k);
+        const int hex[8] = { v, v+1, v+nv+1, v+nv, 
+                             v+nv*nv, v+nv*nv+1, v+nv*nv+nv+1, v+nv*nv+nv };
+        cells.push_back( 8 );
+        cells.insert( cells.end(), hex, hex + 8 );
+        conn.insert( conn.end(), hex, hex + 8 );
+        offsets.push_back( conn.size() );
+      }
+  std::vector<int> types( num_hexes, 12 );
+  std::vector<unsigned char> vtu_types( num_hexes, 12 );
+
+  char buffer[256];
+  const char header[] = "# vtk DataFile Version 3.0\nMOAB Version 1.00\n";
+  ascii = header;
+  ascii += "ASCII\nDATASET UNSTRUCTURED_GRID\n";
+  binary = header;
+  binary += "BINARY\nDATASET UNSTRUCTURED_GRID\n";
+  sprintf( buffer, "POINTS %ld double\n", num_verts );
+  ascii += buffer;
+  binary += buffer;
+  for (long i = 0; i < num_verts; ++i) {
+    sprintf( buffer, "%.17g %.17g %.17g\n", coords[3*i], coords[3*i+1], coords[3*i+2] );
+    ascii += buffer;
+  }
+  append_values( binary, &coords[0], coords.size(), true );
+  sprintf( buffer, "CELLS %ld %lu\n", num_hexes, (unsigned long)cells.size() );
+  ascii += buffer;
+  binary += "\n";
+  binary += buffer;
+  for (size_t i = 0; i < cells.size(); i += 9) {
+    sprintf( buffer, "%d %d %d %d %d %d %d %d %d\n", cells[i], cells[i+1], cells[i+2],
+             cells[i+3], cells[i+4], cells[i+5], cells[i+6], cells[i+7], cells[i+8] );
+    ascii += buffer;
+  }
+  append_values( binary, &cells[0], cells.size(), true );
+  sprintf( buffer, "CELL_TYPES %ld\n", num_hexes );
+  ascii += buffer;
+  binary += "\n";
+  binary += buffer;
+  for (long i = 0; i < num_hexes; ++i)
+    ascii += "12\n";
+  append_values( binary, &types[0], types.size(), true );
+  binary += "\n";
+
+  std::ostringstream xml;
+  std::string data;
+  const bool big_endian = native_big_endian();
+  xml << "<?xml version=\"1.0\"?>" << std::endl
+      << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\""
+      << (big_endian ? "BigEndian" : "LittleEndian") << "\">" << std::endl
+      << "<UnstructuredGrid>" << std::endl
+      << "<Piece NumberOfPoints=\"" << num_verts << "\" NumberOfCells=\"" << num_hexes << "\">" << std::endl
+      << "<Points>" << std::endl;
+  data_array( xml, "Float64", "Points", 3, data.size() );
+  append_block( data, &coords[0], coords.size(), big_endian, false );
+  xml << "</Points>" << std::endl << "<Cells>" << std::endl;
+  data_array( xml, "Int32", "connectivity", 1, data.size() );
+  append_block( data, &conn[0], conn.size(), big_endian, false );
+  data_array( xml, "Int32", "offsets", 1, data.size() );
+  append_block( data, &offsets[0], offsets.size(), big_endian, false );
+  data_array( xml, "UInt8", "types", 1, data.size() );
+  append_block( data, &vtu_types[0], vtu_types.size(), big_endian, false );
+  xml << "</Cells>" << std::endl << "</Piece>" << std::endl
+      << "</UnstructuredGrid>" << std::endl
+      << "<AppendedData encoding=\"raw\">" << std::endl << "_";
+  vtu = xml.str();
+  vtu += data;
+  vtu += "\n</AppendedData>\n</VTKFile>\n";
+}
+
+static void time_read( const char* label, const std::string& data, const char* fname, long num_hexes )
+{
+  FILE* fptr = fopen( fname, "wb" );
+  fwrite( data.data(), 1, data.size(), fptr );
+  fclose( fptr );
+
+  Core moab;
+  clock_t t = clock();
+  ErrorCode rval = moab.load_file( fname );
+  const double secs = (double)(clock() - t) / CLOCKS_PER_SEC;
+  remove( fname );
+
+  int count = 0;
+  moab.get_number_entities_by_type( 0, MBHEX, count );
+  if (MB_SUCCESS != rval || count != num_hexes) {
+    printf( "%-8s read FAILED\n", label );
+    return;
+  }
+
+  const double mbytes = data.size() / 1048576.0;
+  printf( "%-8s %10.1f %10.3f %10.1f %12.0f\n", label, mbytes, secs, 
+          mbytes / secs, num_hexes / secs );
+}
+
+void read_perf( int n )
+{
+  std::string ascii, binary, vtu;
+  perf_files( n, ascii, binary, vtu );
+
+  const long num_hexes = (long)n*n*n;
+  printf( "Reading %ld hexes\n", num_hexes );
+  printf( "%-8s %10s %10s %10s %12s\n", "format", "MB", "seconds", "MB/s", "hexes/s" );
+  time_read( "ASCII", ascii, "tmp_perf.vtk", num_hexes );
+  time_read( "BINARY", binary, "tmp_perf.vtk", num_hexes );
+  time_read( "VTU", vtu, "tmp_perf.vtu", num_hexes );
+}
+
+static void time_write( const char* label, Interface& moab, const char* fname,
+                        const char* options, long num_hexes )
+{
+  clock_t t = clock();
+  ErrorCode rval = moab.write_file( fname, 0, options );
+  const double secs = (double)(clock() - t) / CLOCKS_PER_SEC;
+  if (MB_SUCCESS != rval) {
+    printf( "%-8s write FAILED\n", label );
+    return;
+  }
+
+  FILE* fptr = fopen( fname, "rb" );
+  fseek( fptr, 0, SEEK_END );
+  const double mbytes = ftell( fptr ) / 1048576.0;
+  fclose( fptr );
+  remove( fname );
+  printf( "%-8s %10.1f %10.3f %10.1f %12.0f\n", label, mbytes, secs,
+          mbytes / secs, num_hexes / secs );
+}
+
+void write_perf( int n )
+{
+  std::string ascii, binary, vtu;
+  perf_files( n, ascii, binary, vtu );
+  Core moab;
+  if (!read_binary_file( &moab, vtu, "tmp_perf.vtu" ))
+    return;
+
+  const long num_hexes = (long)n*n*n;
+  printf( "Writing %ld hexes\n", num_hexes );
+  printf( "%-8s %10s %10s %10s %12s\n", "format", "MB", "seconds", "MB/s", "hexes/s" );
+  time_write( "ASCII", moab, "tmp_perf.vtk", "", num_hexes );
+  time_write( "BINARY", moab, "tmp_perf.vtk", "BINARY", num_hexes );
+  time_write( "VTU", moab, "tmp_perf.vtu", "", num_hexes );
+  time_write( "BASE64", moab, "tmp_perf.vtu", "BASE64", num_hexes );
+#ifdef MOAB_HAVE_ZLIB
+  time_write( "ZLIB", moab, "tmp_perf.vtu", "COMPRESS", num_hexes );
+#endif
+}
@@ -1,12 +1,19 @@
 #include "moab/Core.hpp"
 #include "moab/Range.hpp"
 #include "moab/MergeMesh.hpp"
+#include "moab/CpuTimer.hpp"
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
 #include "TestUtil.hpp"
 
 #ifdef MOAB_HAVE_MPI
 #include "moab_mpi.h"
 #endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifndef MESHDIR
 #error Specify MESHDIR to compile test
@@ -19,24 +26,40 @@ const char* meshfile2 = STRINGIFY(MESHDIR) "/merge_with_tag.h5m";
 const char* meshfile3 = STRINGIFY(MESHDIR) "/triangles.h5m";
 const char *outfile = "mm_out.h5m";
 
+// number of hexes along each side of the mesh used by merge_perf_test
+int perf_intervals = 10;
+
 void mergesimple_test();
 void merge_with_tag_test();
 void merge_all_test();
+void mergesimple_grid_test();
+void merge_all_grid_test();
+void merge_perf_test();
 
-#ifdef MOAB_HAVE_MPI
 int main(int argc, char** argv)
-#else
-int main()
-#endif
 {
 #ifdef MOAB_HAVE_MPI
   MPI_Init(&argc, &argv);
 #endif
+    // "mergemesh_test -perf n" times the kd-tree and grid methods
+    // for a mesh of n^3 unmerged hexes
+  if (argc > 1 && !strcmp(argv[1], "-perf")) {
+    if (argc > 2)
+      perf_intervals = atoi(argv[2]);
+    int result = RUN_TEST(merge_perf_test);
+#ifdef MOAB_HAVE_MPI
+    MPI_Finalize();
+#endif
+    return result;
+  }
+
   int result = 0;
 
   result += RUN_TEST(mergesimple_test);
   result += RUN_TEST(merge_with_tag_test);
   result += RUN_TEST(merge_all_test);
+  result += RUN_TEST(mergesimple_grid_test);
+  result += RUN_TEST(merge_all_grid_test);
 
 #ifdef MOAB_HAVE_MPI
   MPI_Finalize();
@@ -120,3 +143,127 @@ void merge_all_test()
   return;
 }
 
+
+// merge a file using either search method, returning the number of vertices left
+static int merge_file_vertices(const char* file, bool all, MergeMesh::SearchMethod method)
+{
+  ErrorCode rval;
+  Core mb;
+  Interface* iface = &mb;
+  rval = iface->load_mesh(file);
+  CHECK_ERR(rval);
+
+  MergeMesh mm(iface);
+  mm.set_search_method(method);
+  mm.set_num_threads(3);
+  double merge_tol = 1e-3;
+  if (all)
+    rval = mm.merge_all(0, merge_tol);
+  else {
+    moab::Range ents;
+    rval = iface->get_entities_by_dimension(0, 3, ents);
+    CHECK_ERR(rval);
+    rval = mm.merge_entities(ents, merge_tol);
+  }
+  CHECK_ERR(rval);
+
+  int count;
+  rval = iface->get_number_entities_by_dimension(0, 0, count);
+  CHECK_ERR(rval);
+  return count;
+}
+
+void mergesimple_grid_test()
+{
+  int kd_count = merge_file_vertices(meshfile, false, MergeMesh::KD_TREE);
+  int grid_count = merge_file_vertices(meshfile, false, MergeMesh::GRID);
+  CHECK_EQUAL(kd_count, grid_count);
+}
+
+void merge_all_grid_test()
+{
+  int kd_count = merge_file_vertices(meshfile3, true, MergeMesh::KD_TREE);
+  int grid_count = merge_file_vertices(meshfile3, true, MergeMesh::GRID);
+  CHECK_EQUAL(kd_count, grid_count);
+}
+
+// create n^3 hexes that each have their own vertices, perturbed by
+// less than the merge tolerance
+static void make_unmerged_hexes(Interface& mb, int n, double tol)
+{
+  const int corners[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+                              {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+  std::vector<double> coords(24 * n * n * n);
+  std::vector<double>::iterator c = coords.begin();
+  srand(1);
+  for (int k = 0; k < n; ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i)
+        for (int v = 0; v < 8; ++v) {
+          *c++ = i + corners[v][0] + 0.1 * tol * rand() / RAND_MAX;
+          *c++ = j + corners[v][1] + 0.1 * tol * rand() / RAND_MAX;
+          *c++ = k + corners[v][2] + 0.1 * tol * rand() / RAND_MAX;
+        }
+  Range verts;
+  ErrorCode rval = mb.create_vertices(&coords[0], 8 * n * n * n, verts);
+  CHECK_ERR(rval);
+  Range::iterator v = verts.begin();
+  for (int h = 0; h < n * n * n; ++h) {
+    EntityHandle conn[8], hex;
+    for (int i = 0; i < 8; ++i, ++v)
+      conn[i] = *v;
+    rval = mb.create_element(MBHEX, conn, 8, hex);
+    CHECK_ERR(rval);
+  }
+}
+
+void merge_perf_test()
+{
+  const int n = perf_intervals;
+  const double merge_tol = 1e-3;
+  int max_threads = 1;
+#ifdef _OPENMP
+  max_threads = omp_get_max_threads();
+#endif
+
+  std::cout << std::endl << "Finding coincident vertices of " << n * n * n
+            << " unmerged hexes" << std::endl;
+  for (int m = 0; m <= max_threads; ++m) {
+    Core mb;
+    make_unmerged_hexes(mb, n, merge_tol);
+    Range hexes;
+    ErrorCode rval = mb.get_entities_by_type(0, MBHEX, hexes);
+    CHECK_ERR(rval);
+    Tag merge_tag;
+    EntityHandle def_val = 0;
+    rval = mb.tag_get_handle("merged_to", 1, MB_TYPE_HANDLE, merge_tag,
+                             MB_TAG_DENSE | MB_TAG_EXCL, &def_val);
+    CHECK_ERR(rval);
+
+    MergeMesh mm(&mb, false);
+    if (m) {
+      mm.set_search_method(MergeMesh::GRID);
+      mm.set_num_threads(m);
+    }
+
+      // time the search only (including skinning), without merging
+    double t = CpuTimer::wall_time();
+    rval = mm.merge_entities(hexes, merge_tol, false, false, merge_tag, false);
+    CHECK_ERR(rval);
+    t = CpuTimer::wall_time() - t;
+    if (m)
+      std::cout << "grid, " << m << " thread(s): " << t << " seconds" << std::endl;
+    else
+      std::cout << "kd-tree: " << t << " seconds" << std::endl;
+
+      // all but one vertex at each grid point should be marked
+    Range verts;
+    rval = mb.get_entities_by_type(0, MBVERTEX, verts);
+    CHECK_ERR(rval);
+    std::vector<EntityHandle> merged_to(verts.size());
+    rval = mb.tag_get_data(merge_tag, verts, &merged_to[0]);
+    CHECK_ERR(rval);
+    int num_kept = std::count(merged_to.begin(), merged_to.end(), (EntityHandle)0);
+    CHECK_EQUAL((n + 1) * (n + 1) * (n + 1), num_kept);
+  }
+}
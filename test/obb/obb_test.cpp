@@ -61,6 +61,7 @@ static void usage( const char* error, const char* opt )
         << " -l <int>  specify max tree levels" << std::endl
         << " -r <real> specify worst cell split ratio" << std::endl
         << " -R <real> specify best cell split ratio" << std::endl
+        << " -b <int>  split with a surface area heuristic with this many bins" << std::endl
         << " -s force construction of surface tree" << std::endl
         << " -S do not build surface tree." << std::endl
         << "    (Default: surface tree if file contains multiple surfaces" << std::endl
@@ -163,6 +164,9 @@ int main( int argc, char* argv[] )
         case 'R':
           settings.best_split_ratio = get_double_option( i, argc, argv );
           break;
+        case 'b':
+          settings.sah_bins = get_int_option( i, argc, argv );
+          break;
         case 't':
           tolerance = get_double_option( i, argc, argv );
           break;
@@ -186,6 +190,7 @@ int main( int argc, char* argv[] )
                 << "max_depth:              " << settings.max_depth              << std::endl
                 << "worst_split_ratio:      " << settings.worst_split_ratio      << std::endl
                 << "best_split_ratio:       " << settings.best_split_ratio       << std::endl
+                << "sah_bins:               " << settings.sah_bins               << std::endl
                 << "tolerance:              " << tolerance                       << std::endl
                 << "set type:               " << ((settings.set_options&MESHSET_ORDERED) ? "ordered" : "set") << std::endl
                 << std::endl;
@@ -0,0 +1,265 @@
+#include "moab/Core.hpp"
+#include "moab/ParallelComm.hpp"
+#include "moab/TagExchangePlan.hpp"
+#include "MBParallelConventions.h"
+#include "moab/ScdInterface.hpp"
+#include "moab/HomXform.hpp"
+#include "moab/ProgOptions.hpp"
+#include "MBTagConventions.hpp"
+#include "TestUtil.hpp"
+#include <vector>
+#include <iostream>
+
+using namespace moab;
+
+/* Test and benchmark TagExchangePlan.  Creates a box that is NCxNCxNC
+ * in global dimension, partitioned among processors using ScdInterface's
+ * SQIJK algorithm, with one layer of ghost cells.  Checks that exchanging
+ * and reducing tags with an exchange plan gives the same result as
+ * ParallelComm::exchange_tags and ParallelComm::reduce_tags, then times
+ * repeated exchanges with both.
+ */
+
+  // Number of cells in each direction
+int NC;
+  // Number of exchanges timed
+int ITERS;
+
+void test_plan_exchange();
+void test_plan_reduce();
+void test_plan_timing();
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  ProgOptions po;
+  po.addOpt<int>( "int,i", "Number of intervals on a side" );
+  po.addOpt<int>( "iters,n", "Number of exchanges to time" );
+  po.parseCommandLine( argc, argv );
+  if (!po.getOpt( "int", &NC )) NC = 8;
+  if (!po.getOpt( "iters", &ITERS )) ITERS = 100;
+
+  int err = 0;
+  err += RUN_TEST(test_plan_exchange);
+  err += RUN_TEST(test_plan_reduce);
+  err += RUN_TEST(test_plan_timing);
+
+  MPI_Finalize();
+  return err;
+}
+
+  // Create the partitioned box, resolve shared entities and exchange ghosts
+static void create_parallel_mesh( Interface& mb, ParallelComm& pc )
+{
+  ScdInterface *scdi;
+  ErrorCode rval = mb.query_interface(scdi);
+  CHECK_ERR(rval);
+
+  ScdBox *new_box;
+  ScdParData par_data;
+  par_data.pComm = &pc;
+  par_data.gDims[0] = par_data.gDims[1] = par_data.gDims[2] = 0;
+  par_data.gDims[3] = par_data.gDims[4] = par_data.gDims[5] = NC;
+  par_data.partMethod = ScdParData::SQIJK;
+  CHECK( NC*NC*NC >= (int)pc.size() );
+  rval = scdi->construct_box(HomCoord(), HomCoord(), NULL, 0,
+                             new_box, NULL, &par_data, true, false);
+  CHECK_ERR(rval);
+
+  Tag gid;
+  rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  rval = pc.resolve_shared_ents(new_box->box_set(), -1, 0, &gid);
+  CHECK_ERR(rval);
+  rval = pc.exchange_ghost_cells(-1, -1, 0, 0, true, true);
+  CHECK_ERR(rval);
+  rval = pc.exchange_ghost_cells(-1, 0, 1, 0, true);
+  CHECK_ERR(rval);
+    // Ghost vertices don't get global ids, used for checking below
+  rval = pc.exchange_tags(gid, Range());
+  CHECK_ERR(rval);
+}
+
+  // Get shared (including ghosted) vertices and hexes and their global ids
+static void get_shared( Interface& mb, ParallelComm& pc, Range& ents, std::vector<int>& ids )
+{
+  ErrorCode rval = mb.get_entities_by_type(0, MBVERTEX, ents);
+  CHECK_ERR(rval);
+  rval = mb.get_entities_by_type(0, MBHEX, ents);
+  CHECK_ERR(rval);
+  rval = pc.filter_pstatus(ents, PSTATUS_SHARED, PSTATUS_AND);
+  CHECK_ERR(rval);
+
+  Tag gid;
+  rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  ids.resize(ents.size());
+  if (!ids.empty()) {
+    rval = mb.tag_get_data(gid, ents, &ids[0]);
+    CHECK_ERR(rval);
+  }
+}
+
+void test_plan_exchange()
+{
+  Core moab;
+  Interface& mb = moab;
+  ParallelComm pc(&mb, MPI_COMM_WORLD);
+  create_parallel_mesh(mb, pc);
+
+  Range ents, owned;
+  std::vector<int> ids;
+  get_shared(mb, pc, ents, ids);
+  if (pc.size() > 1)
+    CHECK( !ents.empty() );
+
+    // A double tag and an integer tag with 3 values per entity
+  Tag dtag, itag;
+  double ddef = -1.0;
+  int idef[3] = { -1, -1, -1 };
+  ErrorCode rval = mb.tag_get_handle("plan_dbl", 1, MB_TYPE_DOUBLE, dtag, MB_TAG_DENSE|MB_TAG_EXCL, &ddef);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("plan_int", 3, MB_TYPE_INTEGER, itag, MB_TAG_SPARSE|MB_TAG_EXCL, idef);
+  CHECK_ERR(rval);
+
+    // Set values on owned entities only
+  owned = ents;
+  rval = pc.filter_pstatus(owned, PSTATUS_NOT_OWNED, PSTATUS_NOT);
+  CHECK_ERR(rval);
+  Tag gid;
+  rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  for (Range::iterator i = owned.begin(); i != owned.end(); ++i) {
+    int id;
+    rval = mb.tag_get_data(gid, &*i, 1, &id);
+    CHECK_ERR(rval);
+    double dval = 0.5 * id;
+    int ivals[3] = { id, (int)mb.type_from_handle(*i), -id };
+    rval = mb.tag_set_data(dtag, &*i, 1, &dval);
+    CHECK_ERR(rval);
+    rval = mb.tag_set_data(itag, &*i, 1, ivals);
+    CHECK_ERR(rval);
+  }
+
+  std::vector<Tag> tags;
+  tags.push_back(dtag);
+  tags.push_back(itag);
+  TagExchangePlan plan(&pc);
+  rval = plan.setup(tags, Range());
+  CHECK_ERR(rval);
+    // Exchange twice to check that the plan can be reused
+  for (int k = 0; k < 2; ++k) {
+    rval = plan.exchange_tags();
+    CHECK_ERR(rval);
+  }
+
+    // All shared entities should now have the owner's values
+  std::vector<double> dvals(ents.size());
+  std::vector<int> ivals(3*ents.size());
+  rval = mb.tag_get_data(dtag, ents, &dvals[0]);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_data(itag, ents, &ivals[0]);
+  CHECK_ERR(rval);
+  size_t j = 0;
+  for (Range::iterator i = ents.begin(); i != ents.end(); ++i, ++j) {
+    CHECK_REAL_EQUAL( 0.5*ids[j], dvals[j], 1e-12 );
+    CHECK_EQUAL( ids[j], ivals[3*j] );
+    CHECK_EQUAL( (int)mb.type_from_handle(*i), ivals[3*j+1] );
+    CHECK_EQUAL( -ids[j], ivals[3*j+2] );
+  }
+}
+
+void test_plan_reduce()
+{
+  Core moab;
+  Interface& mb = moab;
+  ParallelComm pc(&mb, MPI_COMM_WORLD);
+  create_parallel_mesh(mb, pc);
+
+  Range ents;
+  std::vector<int> ids;
+  get_shared(mb, pc, ents, ids);
+
+    // Reduce same values with plan and with reduce_tags
+  Tag tag1, tag2;
+  double def = 0.0;
+  ErrorCode rval = mb.tag_get_handle("plan_sum1", 1, MB_TYPE_DOUBLE, tag1, MB_TAG_DENSE|MB_TAG_EXCL, &def);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("plan_sum2", 1, MB_TYPE_DOUBLE, tag2, MB_TAG_DENSE|MB_TAG_EXCL, &def);
+  CHECK_ERR(rval);
+  std::vector<double> vals(ents.size());
+  for (size_t i = 0; i < vals.size(); ++i)
+    vals[i] = pc.rank() + 1 + 0.001 * ids[i];
+  if (!ents.empty()) {
+    rval = mb.tag_set_data(tag1, ents, &vals[0]);
+    CHECK_ERR(rval);
+    rval = mb.tag_set_data(tag2, ents, &vals[0]);
+    CHECK_ERR(rval);
+  }
+
+  TagExchangePlan plan(&pc);
+  rval = plan.setup(std::vector<Tag>(1, tag1), Range());
+  CHECK_ERR(rval);
+  rval = plan.reduce_tags(MPI_SUM);
+  CHECK_ERR(rval);
+  std::vector<Tag> tags2(1, tag2);
+  rval = pc.reduce_tags(tags2, tags2, MPI_SUM, Range());
+  CHECK_ERR(rval);
+
+  std::vector<double> vals1(ents.size()), vals2(ents.size());
+  if (!ents.empty()) {
+    rval = mb.tag_get_data(tag1, ents, &vals1[0]);
+    CHECK_ERR(rval);
+    rval = mb.tag_get_data(tag2, ents, &vals2[0]);
+    CHECK_ERR(rval);
+  }
+  size_t num_changed = 0;
+  for (size_t i = 0; i < vals.size(); ++i) {
+    CHECK_REAL_EQUAL( vals2[i], vals1[i], 1e-10 );
+    if (vals1[i] > vals[i])
+      ++num_changed;
+  }
+  if (pc.size() > 1)
+    CHECK( num_changed > 0 );
+}
+
+void test_plan_timing()
+{
+  Core moab;
+  Interface& mb = moab;
+  ParallelComm pc(&mb, MPI_COMM_WORLD);
+  create_parallel_mesh(mb, pc);
+
+  Tag tag;
+  double def[3] = { 1.0, 2.0, 3.0 };
+  ErrorCode rval = mb.tag_get_handle("plan_timing", 3, MB_TYPE_DOUBLE, tag, MB_TAG_DENSE|MB_TAG_EXCL, def);
+  CHECK_ERR(rval);
+  std::vector<Tag> tags(1, tag);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t0 = MPI_Wtime();
+  for (int i = 0; i < ITERS; ++i) {
+    rval = pc.exchange_tags(tags, tags, Range());
+    CHECK_ERR(rval);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t1 = MPI_Wtime();
+
+  TagExchangePlan plan(&pc);
+  rval = plan.setup(tags, Range());
+  CHECK_ERR(rval);
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t2 = MPI_Wtime();
+  for (int i = 0; i < ITERS; ++i) {
+    rval = plan.exchange_tags();
+    CHECK_ERR(rval);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t3 = MPI_Wtime();
+
+  if (!pc.rank())
+    std::cout << "exchange_tags:         " << t1 - t0 << std::endl
+              << "plan setup:            " << t2 - t1 << std::endl
+              << "plan exchange_tags:    " << t3 - t2 << std::endl;
+}
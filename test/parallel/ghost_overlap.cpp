@@ -0,0 +1,271 @@
+#include "moab/Core.hpp"
+#include "moab/ParallelComm.hpp"
+#include "MBParallelConventions.h"
+#include "moab/ScdInterface.hpp"
+#include "moab/HomXform.hpp"
+#include "moab/ProgOptions.hpp"
+#include "MBTagConventions.hpp"
+#include "TestUtil.hpp"
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+using namespace moab;
+
+/* Mini-app for the split-phase ghost and tag exchange.  Creates a box
+ * that is NCxNCxNC in global dimension, partitioned among processors using
+ * ScdInterface's SQIJK algorithm, and checks that begin/end_exchange_ghost_cells
+ * and begin/end_exchange_tags give the same result as the blocking versions.
+ * Then times a loop of "compute on owned cells, then exchange the result" with
+ * the blocking exchange against the same loop with the computation
+ * overlapped with the exchange.
+ */
+
+  // Number of cells in each direction
+int NC;
+  // Number of times the work is repeated in each compute step
+int WORK;
+const int ITERS = 20;
+
+void test_split_ghost_exchange();
+void test_split_tag_exchange();
+void test_overlap_timing();
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  ProgOptions po;
+  po.addOpt<int>( "int,i", "Number of intervals on a side" );
+  po.addOpt<int>( "work,w", "Amount of work per compute step" );
+  po.parseCommandLine( argc, argv );
+  if (!po.getOpt( "int", &NC )) NC = 8;
+  if (!po.getOpt( "work", &WORK )) WORK = 20;
+
+  int err = 0;
+  err += RUN_TEST(test_split_ghost_exchange);
+  err += RUN_TEST(test_split_tag_exchange);
+  err += RUN_TEST(test_overlap_timing);
+
+  MPI_Finalize();
+  return err;
+}
+
+  // Create the partitioned box and resolve shared entities
+static void create_parallel_mesh( Interface& mb, ParallelComm& pc )
+{
+  ScdInterface *scdi;
+  ErrorCode rval = mb.query_interface(scdi);
+  CHECK_ERR(rval);
+
+  ScdBox *new_box;
+  ScdParData par_data;
+  par_data.pComm = &pc;
+  par_data.gDims[0] = par_data.gDims[1] = par_data.gDims[2] = 0;
+  par_data.gDims[3] = par_data.gDims[4] = par_data.gDims[5] = NC;
+  par_data.partMethod = ScdParData::SQIJK;
+  CHECK( NC*NC*NC >= (int)pc.size() );
+  rval = scdi->construct_box(HomCoord(), HomCoord(), NULL, 0,
+                             new_box, NULL, &par_data, true, false);
+  CHECK_ERR(rval);
+
+  Tag gid;
+  rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  rval = pc.resolve_shared_ents(new_box->box_set(), -1, 0, &gid);
+  CHECK_ERR(rval);
+  rval = pc.exchange_ghost_cells(-1, -1, 0, 0, true, true);
+  CHECK_ERR(rval);
+}
+
+  // Get ghost entities and the global ids of them
+static void get_ghosts( Interface& mb, ParallelComm& pc, std::vector<int>& ids )
+{
+  Range ghosts;
+  ErrorCode rval = mb.get_entities_by_dimension(0, 3, ghosts);
+  CHECK_ERR(rval);
+  rval = pc.filter_pstatus(ghosts, PSTATUS_GHOST, PSTATUS_AND);
+  CHECK_ERR(rval);
+
+  Tag gid;
+  rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  ids.resize(ghosts.size());
+  if (!ids.empty()) {
+    rval = mb.tag_get_data(gid, ghosts, &ids[0]);
+    CHECK_ERR(rval);
+  }
+  std::sort(ids.begin(), ids.end());
+}
+
+  // Some computation on owned hexes, result is stored in tag
+static void compute( Interface& mb, ParallelComm* pc, const Range& owned, Tag tag, int step )
+{
+  std::vector<double> vals(owned.size());
+  std::vector<EntityHandle> conn;
+  double coords[3*8];
+  size_t j = 0;
+  for (Range::const_iterator i = owned.begin(); i != owned.end(); ++i, ++j) {
+    ErrorCode rval = mb.get_connectivity(&*i, 1, conn);
+    CHECK_ERR(rval);
+    rval = mb.get_coords(&conn[0], conn.size(), coords);
+    CHECK_ERR(rval);
+    double sum = 0.0;
+    for (int w = 0; w < WORK; ++w)
+      for (size_t k = 0; k < 3*conn.size(); ++k)
+        sum += coords[k] * (step + 1) / (w + 1.0);
+    vals[j] = sum;
+
+      // Let the pending exchange progress once in a while
+    if (pc && 0 == j % 64) {
+      rval = pc->progress_exchange();
+      CHECK_ERR(rval);
+    }
+  }
+  if (!owned.empty()) {
+    ErrorCode rval = mb.tag_set_data(tag, owned, &vals[0]);
+    CHECK_ERR(rval);
+  }
+}
+
+static void get_owned_hexes( Interface& mb, ParallelComm& pc, Range& owned )
+{
+  ErrorCode rval = mb.get_entities_by_dimension(0, 3, owned);
+  CHECK_ERR(rval);
+  rval = pc.filter_pstatus(owned, PSTATUS_NOT_OWNED, PSTATUS_NOT);
+  CHECK_ERR(rval);
+}
+
+void test_split_ghost_exchange()
+{
+  Core mb1, mb2;
+  ParallelComm pc1(&mb1, MPI_COMM_WORLD), pc2(&mb2, MPI_COMM_WORLD);
+  create_parallel_mesh(mb1, pc1);
+  create_parallel_mesh(mb2, pc2);
+
+  ErrorCode rval = pc1.exchange_ghost_cells(-1, 0, 1, 0, true);
+  CHECK_ERR(rval);
+
+  rval = pc2.begin_exchange_ghost_cells(-1, 0, 1, 0, true);
+  CHECK_ERR(rval);
+  CHECK( pc2.exchange_pending() );
+  rval = pc2.progress_exchange();
+  CHECK_ERR(rval);
+  rval = pc2.end_exchange_ghost_cells();
+  CHECK_ERR(rval);
+  CHECK( !pc2.exchange_pending() );
+
+  std::vector<int> ids1, ids2;
+  get_ghosts(mb1, pc1, ids1);
+  get_ghosts(mb2, pc2, ids2);
+  if (pc1.size() > 1)
+    CHECK( !ids1.empty() );
+  CHECK( ids1 == ids2 );
+}
+
+void test_split_tag_exchange()
+{
+  Core moab;
+  Interface& mb = moab;
+  ParallelComm pc(&mb, MPI_COMM_WORLD);
+  create_parallel_mesh(mb, pc);
+  ErrorCode rval = pc.exchange_ghost_cells(-1, 0, 1, 0, true);
+  CHECK_ERR(rval);
+
+  Tag gid, tag;
+  rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  double def_val = -1.0;
+  rval = mb.tag_get_handle("overlap_tag", 1, MB_TYPE_DOUBLE, tag, MB_TAG_DENSE|MB_TAG_EXCL, &def_val);
+  CHECK_ERR(rval);
+
+    // Set tag on owned entities from global id
+  Range owned, all;
+  get_owned_hexes(mb, pc, owned);
+  rval = mb.get_entities_by_dimension(0, 3, all);
+  CHECK_ERR(rval);
+  std::vector<int> ids(all.size());
+  std::vector<double> vals(all.size());
+  rval = mb.tag_get_data(gid, all, &ids[0]);
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < ids.size(); ++i)
+    vals[i] = 2.0 * ids[i];
+  if (!owned.empty()) {
+    std::vector<double> owned_vals(owned.size());
+    rval = mb.tag_get_data(gid, owned, &ids[0]);
+    CHECK_ERR(rval);
+    for (size_t i = 0; i < owned.size(); ++i)
+      owned_vals[i] = 2.0 * ids[i];
+    rval = mb.tag_set_data(tag, owned, &owned_vals[0]);
+    CHECK_ERR(rval);
+  }
+
+  std::vector<Tag> tags(1, tag);
+  rval = pc.begin_exchange_tags(tags, tags, Range());
+  CHECK_ERR(rval);
+  bool done = false;
+  while (!done) {
+    rval = pc.progress_exchange(&done);
+    CHECK_ERR(rval);
+  }
+  rval = pc.end_exchange_tags();
+  CHECK_ERR(rval);
+
+    // All entities, including ghosts, should now have the owner's value
+  std::vector<double> result(all.size());
+  rval = mb.tag_get_data(tag, all, &result[0]);
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < result.size(); ++i)
+    CHECK_REAL_EQUAL( vals[i], result[i], 1e-12 );
+}
+
+void test_overlap_timing()
+{
+  Core moab;
+  Interface& mb = moab;
+  ParallelComm pc(&mb, MPI_COMM_WORLD);
+  create_parallel_mesh(mb, pc);
+  ErrorCode rval = pc.exchange_ghost_cells(-1, 0, 1, 0, true);
+  CHECK_ERR(rval);
+
+  Tag tag1, tag2;
+  rval = mb.tag_get_handle("result1", 1, MB_TYPE_DOUBLE, tag1, MB_TAG_DENSE|MB_TAG_CREAT);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("result2", 1, MB_TYPE_DOUBLE, tag2, MB_TAG_DENSE|MB_TAG_CREAT);
+  CHECK_ERR(rval);
+  Range owned;
+  get_owned_hexes(mb, pc, owned);
+  std::vector<Tag> tags1(1, tag1), tags2(1, tag2);
+
+    // Blocking: compute then exchange
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t0 = MPI_Wtime();
+  for (int i = 0; i < ITERS; ++i) {
+    compute(mb, 0, owned, tag1, i);
+    compute(mb, 0, owned, tag2, i);
+    rval = pc.exchange_tags(tags1, tags1, Range());
+    CHECK_ERR(rval);
+    rval = pc.exchange_tags(tags2, tags2, Range());
+    CHECK_ERR(rval);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t1 = MPI_Wtime();
+
+    // Split-phase: exchange the first result while computing the second
+  for (int i = 0; i < ITERS; ++i) {
+    compute(mb, 0, owned, tag1, i);
+    rval = pc.begin_exchange_tags(tags1, tags1, Range());
+    CHECK_ERR(rval);
+    compute(mb, &pc, owned, tag2, i);
+    rval = pc.end_exchange_tags();
+    CHECK_ERR(rval);
+    rval = pc.exchange_tags(tags2, tags2, Range());
+    CHECK_ERR(rval);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t2 = MPI_Wtime();
+
+  if (!pc.rank())
+    std::cout << "Blocking exchange:    " << t1 - t0 << std::endl
+              << "Overlapped exchange:  " << t2 - t1 << std::endl;
+}
@@ -0,0 +1,202 @@
+#include "moab/gs.hpp"
+#include "moab/TupleList.hpp"
+#include "moab/ProgOptions.hpp"
+#include "TestUtil.hpp"
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+using namespace moab;
+
+/* Test and benchmark the transfer methods of gs_data::crystal_data.  Each
+ * proc sends NT tuples to each of a few other procs (its neighbors in a ring
+ * and some procs further away) and to itself.  Checks that the crystal
+ * router and the sparse exchange deliver the same tuples, then times
+ * repeated transfers with both.
+ */
+
+  // Number of tuples sent to each target
+int NT;
+  // Number of transfers timed
+int ITERS;
+
+void test_transfer_crystal();
+void test_transfer_sparse();
+void test_transfer_sparse_shared_comm();
+void test_transfer_timing();
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  ProgOptions po;
+  po.addOpt<int>( "tuples,t", "Number of tuples sent to each proc" );
+  po.addOpt<int>( "iters,n", "Number of transfers to time" );
+  po.parseCommandLine( argc, argv );
+  if (!po.getOpt( "tuples", &NT )) NT = 100;
+  if (!po.getOpt( "iters", &ITERS )) ITERS = 20;
+
+  int err = 0;
+  err += RUN_TEST(test_transfer_crystal);
+  err += RUN_TEST(test_transfer_sparse);
+  err += RUN_TEST(test_transfer_sparse_shared_comm);
+  err += RUN_TEST(test_transfer_timing);
+
+  MPI_Finalize();
+  return err;
+}
+
+  // Get the procs to which this proc sends
+static void get_targets( int rank, int size, std::vector<int>& targets )
+{
+  targets.clear();
+  targets.push_back(rank);
+  targets.push_back((rank + 1) % size);
+  targets.push_back((rank + size - 1) % size);
+  targets.push_back((rank + size/2) % size);
+  targets.push_back((7*rank + 3) % size);
+  std::sort(targets.begin(), targets.end());
+  targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+}
+
+  // Fill tuple list with (target, source, index; source*index; 0.5*index)
+static void fill_tuples( int rank, int size, TupleList& tl )
+{
+  std::vector<int> targets;
+  get_targets(rank, size, targets);
+  tl.reset();
+  tl.initialize(3, 1, 0, 1, targets.size() * NT);
+  tl.enableWriteAccess();
+  for (size_t i = 0; i < targets.size(); ++i) {
+    for (int j = 0; j < NT; ++j) {
+      unsigned n = tl.get_n();
+      tl.vi_wr[3*n] = targets[i];
+      tl.vi_wr[3*n+1] = rank;
+      tl.vi_wr[3*n+2] = j;
+      tl.vl_wr[n] = (long)rank * j;
+      tl.vr_wr[n] = 0.5 * j;
+      tl.inc_n();
+    }
+  }
+}
+
+  // Get the procs that send to this proc
+static void get_sources( int rank, int size, std::vector<int>& sources )
+{
+  std::vector<int> targets;
+  sources.clear();
+  for (int p = 0; p < size; ++p) {
+    get_targets(p, size, targets);
+    if (std::binary_search(targets.begin(), targets.end(), rank))
+      sources.push_back(p);
+  }
+}
+
+  // Do one transfer with cd and check the received tuples
+static void check_one_transfer( gs_data::crystal_data& cd,
+                                const std::vector<int>& sources )
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  TupleList tl;
+  fill_tuples(rank, size, tl);
+  ErrorCode rval = cd.gs_transfer(1, tl, 0);
+  CHECK_ERR(rval);
+  CHECK_EQUAL( sources.size() * NT, (size_t)tl.get_n() );
+
+    // First member now holds the source
+  std::vector<int> count(size, 0);
+  for (unsigned i = 0; i < tl.get_n(); ++i) {
+    int src = tl.vi_rd[3*i];
+    CHECK_EQUAL( src, tl.vi_rd[3*i+1] );
+    CHECK( std::binary_search(sources.begin(), sources.end(), src) );
+    int j = tl.vi_rd[3*i+2];
+    CHECK_EQUAL( (long)src * j, tl.vl_rd[i] );
+    CHECK_REAL_EQUAL( 0.5 * j, tl.vr_rd[i], 1e-12 );
+    ++count[src];
+  }
+  for (size_t i = 0; i < sources.size(); ++i)
+    CHECK_EQUAL( NT, count[sources[i]] );
+}
+
+static void check_transfer( gs_data::crystal_data::transfer_method method )
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  gs_data::crystal_data cd(MPI_COMM_WORLD);
+  cd.set_transfer_method(method);
+  CHECK_EQUAL( method, cd.get_transfer_method() );
+
+  std::vector<int> sources;
+  get_sources(rank, size, sources);
+
+    // Repeat to check that consecutive transfers don't get mixed up
+  for (int k = 0; k < 3; ++k)
+    check_one_transfer(cd, sources);
+}
+
+void test_transfer_crystal()
+{
+  check_transfer(gs_data::crystal_data::CRYSTAL_ROUTER);
+}
+
+void test_transfer_sparse()
+{
+  check_transfer(gs_data::crystal_data::SPARSE_EXCHANGE);
+}
+
+  // Consecutive sparse exchanges must not get mixed up if they are done
+  // by different instances on the same communicator
+void test_transfer_sparse_shared_comm()
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  gs_data::crystal_data cd1(MPI_COMM_WORLD), cd2(MPI_COMM_WORLD);
+  cd1.set_transfer_method(gs_data::crystal_data::SPARSE_EXCHANGE);
+  cd2.set_transfer_method(gs_data::crystal_data::SPARSE_EXCHANGE);
+
+  std::vector<int> sources;
+  get_sources(rank, size, sources);
+
+    // Use cd1, cd2, cd2, cd1, cd1, ...: with a separate count in each
+    // instance, consecutive exchanges would use the same tag
+  for (int k = 0; k < 8; ++k)
+    check_one_transfer((k + 1) & 2 ? cd2 : cd1, sources);
+}
+
+static double time_transfer( gs_data::crystal_data::transfer_method method )
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  gs_data::crystal_data cd(MPI_COMM_WORLD);
+  cd.set_transfer_method(method);
+  TupleList tl;
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t0 = MPI_Wtime();
+  for (int i = 0; i < ITERS; ++i) {
+    fill_tuples(rank, size, tl);
+    ErrorCode rval = cd.gs_transfer(1, tl, 0);
+    CHECK_ERR(rval);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  return MPI_Wtime() - t0;
+}
+
+void test_transfer_timing()
+{
+  double t_crystal = time_transfer(gs_data::crystal_data::CRYSTAL_ROUTER);
+  double t_sparse = time_transfer(gs_data::crystal_data::SPARSE_EXCHANGE);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (!rank)
+    std::cout << "crystal router:   " << t_crystal << std::endl
+              << "sparse exchange:  " << t_sparse << std::endl;
+}
@@ -0,0 +1,211 @@
+#include "moab/Core.hpp"
+#include "moab/ParallelComm.hpp"
+#include "MBParallelConventions.h"
+#include "moab/ProgOptions.hpp"
+#include "MBTagConventions.hpp"
+#include "TestUtil.hpp"
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+using namespace moab;
+
+/* Test and benchmark hierarchical shared-entity resolution.  Creates an
+ * unstructured hex mesh of a box that is NCxNCxNC in global dimension,
+ * with each processor holding a block of it.  Checks that resolving shared
+ * entities with ParallelComm::set_hierarchical_resolve gives the same
+ * sharing procs and remote handles as the flat algorithm, with several
+ * numbers of ranks per node, then times both.
+ */
+
+  // Number of cells in each direction
+int NC;
+  // Ranks per node for the timing; zero for shared-memory nodes
+int RPN;
+
+void test_hier_resolve_1();
+void test_hier_resolve_2();
+void test_hier_resolve_3();
+void test_hier_resolve_node();
+void test_hier_resolve_timing();
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  ProgOptions po;
+  po.addOpt<int>( "int,i", "Number of intervals on a side" );
+  po.addOpt<int>( "ranks,r", "Ranks per node for timing (default: shared-memory nodes)" );
+  po.parseCommandLine( argc, argv );
+  if (!po.getOpt( "int", &NC )) NC = 12;
+  if (!po.getOpt( "ranks", &RPN )) RPN = 0;
+
+  int err = 0;
+  err += RUN_TEST(test_hier_resolve_1);
+  err += RUN_TEST(test_hier_resolve_2);
+  err += RUN_TEST(test_hier_resolve_3);
+  err += RUN_TEST(test_hier_resolve_node);
+  err += RUN_TEST(test_hier_resolve_timing);
+
+  MPI_Finalize();
+  return err;
+}
+
+  // Create this proc's block of the box, with vertex global ids, and put
+  // the hexes in a set
+static EntityHandle create_block( Interface& mb, int rank, int size )
+{
+  int dims[3] = { 0, 0, 0 };
+  MPI_Dims_create(size, 3, dims);
+  int ijk[3] = { rank % dims[0], (rank / dims[0]) % dims[1], rank / (dims[0]*dims[1]) };
+  int lo[3], hi[3];
+  for (int d = 0; d < 3; ++d) {
+    CHECK( NC >= dims[d] );
+    lo[d] = ijk[d] * NC / dims[d];
+    hi[d] = (ijk[d] + 1) * NC / dims[d];
+  }
+  const int ni = hi[0] - lo[0] + 1, nj = hi[1] - lo[1] + 1, nk = hi[2] - lo[2] + 1;
+
+  Tag gid;
+  ErrorCode rval = mb.tag_get_handle(GLOBAL_ID_TAG_NAME, gid);
+  CHECK_ERR(rval);
+  EntityHandle set;
+  rval = mb.create_meshset(MESHSET_SET, set);
+  CHECK_ERR(rval);
+  std::vector<EntityHandle> verts(ni*nj*nk);
+  for (int k = 0; k < nk; ++k)
+    for (int j = 0; j < nj; ++j)
+      for (int i = 0; i < ni; ++i) {
+        double coords[3] = { (double)(lo[0] + i), (double)(lo[1] + j), (double)(lo[2] + k) };
+        EntityHandle& v = verts[(k*nj + j)*ni + i];
+        rval = mb.create_vertex(coords, v);
+        CHECK_ERR(rval);
+        int id = ((lo[2] + k)*(NC + 1) + lo[1] + j)*(NC + 1) + lo[0] + i + 1;
+        rval = mb.tag_set_data(gid, &v, 1, &id);
+        CHECK_ERR(rval);
+      }
+
+  for (int k = 0; k < nk - 1; ++k)
+    for (int j = 0; j < nj - 1; ++j)
+      for (int i = 0; i < ni - 1; ++i) {
+        const int v0 = (k*nj + j)*ni + i;
+        EntityHandle conn[8] = { verts[v0], verts[v0 + 1], verts[v0 + ni + 1], verts[v0 + ni],
+                                 verts[v0 + ni*nj], verts[v0 + ni*nj + 1],
+                                 verts[v0 + ni*nj + ni + 1], verts[v0 + ni*nj + ni] };
+        EntityHandle hex;
+        rval = mb.create_element(MBHEX, conn, 8, hex);
+        CHECK_ERR(rval);
+        rval = mb.add_entities(set, &hex, 1);
+        CHECK_ERR(rval);
+      }
+  return set;
+}
+
+  // Sharing data of all shared entities of a dimension, in handle order:
+  // for each entity, its number of sharing procs, then the procs and
+  // handles sorted by proc
+static void get_sharing( Interface& mb, ParallelComm& pc, int dim,
+                         std::vector<EntityHandle>& data )
+{
+  Range ents;
+  ErrorCode rval = mb.get_entities_by_dimension(0, dim, ents);
+  CHECK_ERR(rval);
+  rval = pc.filter_pstatus(ents, PSTATUS_SHARED, PSTATUS_AND);
+  CHECK_ERR(rval);
+
+  data.clear();
+  int procs[MAX_SHARING_PROCS];
+  EntityHandle handles[MAX_SHARING_PROCS];
+  unsigned char pstat;
+  int num_ps;
+  for (Range::iterator i = ents.begin(); i != ents.end(); ++i) {
+    rval = pc.get_sharing_data(*i, procs, handles, pstat, num_ps);
+    CHECK_ERR(rval);
+    std::vector< std::pair<int, EntityHandle> > sharing;
+    for (int j = 0; j < num_ps; ++j)
+      sharing.push_back(std::make_pair(procs[j], handles[j]));
+    std::sort(sharing.begin(), sharing.end());
+    data.push_back(*i);
+    data.push_back(num_ps);
+    data.push_back(pstat);
+    for (int j = 0; j < num_ps; ++j) {
+      data.push_back(sharing[j].first);
+      data.push_back(sharing[j].second);
+    }
+  }
+}
+
+  // Resolve shared entities of the block, returning the time taken
+static double resolve( Interface& mb, ParallelComm& pc )
+{
+  EntityHandle set = create_block(mb, pc.rank(), pc.size());
+  MPI_Barrier(MPI_COMM_WORLD);
+  double t0 = MPI_Wtime();
+  ErrorCode rval = pc.resolve_shared_ents(set, 3, 2);
+  CHECK_ERR(rval);
+  MPI_Barrier(MPI_COMM_WORLD);
+  return MPI_Wtime() - t0;
+}
+
+static void check_hier_resolve( int ranks_per_node )
+{
+  Core moab1, moab2;
+  Interface &mb1 = moab1, &mb2 = moab2;
+  ParallelComm pc1(&mb1, MPI_COMM_WORLD), pc2(&mb2, MPI_COMM_WORLD);
+  pc2.set_hierarchical_resolve(true, ranks_per_node);
+  CHECK( pc2.hierarchical_resolve() );
+  resolve(mb1, pc1);
+  resolve(mb2, pc2);
+
+    // Both meshes are created the same way, so have the same handles
+  for (int dim = 0; dim < 3; ++dim) {
+    std::vector<EntityHandle> data1, data2;
+    get_sharing(mb1, pc1, dim, data1);
+    get_sharing(mb2, pc2, dim, data2);
+    if (pc1.size() > 1)
+      CHECK( !data1.empty() );
+    CHECK_EQUAL( data1.size(), data2.size() );
+    CHECK( data1 == data2 );
+  }
+}
+
+void test_hier_resolve_1()
+{
+  check_hier_resolve(1);
+}
+
+void test_hier_resolve_2()
+{
+  check_hier_resolve(2);
+}
+
+void test_hier_resolve_3()
+{
+  check_hier_resolve(3);
+}
+
+void test_hier_resolve_node()
+{
+  check_hier_resolve(0);
+}
+
+void test_hier_resolve_timing()
+{
+  double t_flat, t_hier;
+  {
+    Core moab;
+    ParallelComm pc(&moab, MPI_COMM_WORLD);
+    t_flat = resolve(moab, pc);
+  }
+  {
+    Core moab;
+    ParallelComm pc(&moab, MPI_COMM_WORLD);
+    pc.set_hierarchical_resolve(true, RPN);
+    t_hier = resolve(moab, pc);
+  }
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (!rank)
+    std::cout << "flat resolve_shared_ents:          " << t_flat << std::endl
+              << "hierarchical resolve_shared_ents:  " << t_hier << std::endl;
+}
@@ -35,9 +35,9 @@ const char* DEFAULT_FILE_NAME = "parallel_write_test.h5m";
 // along each edge.  Otherwise processor blocks will be arranged
 // within the subset of the grid that is the ceiling of the cubic
 // root of the comm size such that there are no disjoint regions.
-ErrorCode generate_mesh( Interface& moab, int intervals );
+ErrorCode generate_mesh( Interface& moab, int intervals, MPI_Comm comm );
 
-const char args[] = "[-i <intervals>] [-o <filename>] [-L <filename>] [-g <n>]";
+const char args[] = "[-i <intervals>] [-o <filename>] [-L <filename>] [-g <n>] [-R] [-p <n>] [-A <n>] [-N <n>] [-C]";
 void help() {
   std::cout << "parallel_write_test " << args << std::endl
             << "  -i <N>    Each processor owns an NxNxN cube of hex elements (default: " << DEFAULT_INTERVALS << ")" << std::endl
@@ -45,6 +45,10 @@ void help() {
             << "  -L <name> Write local mesh to file name prefixed with MPI rank" << std::endl
             << "  -g <n>    Specify writer debug output level" << std::endl
             << "  -R        Skip resolve of shared entities (interface ents will be duplicated in file)" << std::endl
+            << "  -p <n>    Use only the first n processes (default: all)" << std::endl
+            << "  -A <n>    Write with n I/O aggregator processes" << std::endl
+            << "  -N <n>    Write with n I/O aggregator processes per node" << std::endl
+            << "  -C        Compare: write without and then with aggregation (implies -A or -N, default -N 1)" << std::endl
             << std::endl
             << "This program creates a (non-strict) subset of a regular hex mesh "
                "such that the mesh is already partitioned, and then attempts to "
@@ -67,6 +71,14 @@ void help() {
                "the number of intervals along each edge of its block of mesh.  "
                "If each block has N intervals, than each processor will have "
                "N^3 hex elements." << std::endl
+            << std::endl
+            << "To measure the scaling of the write, run with increasing "
+               "process counts, either by varying the process count passed "
+               "to mpiexec or, on a single machine, by launching once with "
+               "the maximum count and varying the '-p' flag.  Use the '-A' "
+               "or '-N' flag to write using aggregated (two-phase) I/O, "
+               "where only a subset of the processes access the file, or '-C' "
+               "to time the write both with and without aggregation." << std::endl
             << std::endl;
 }
  
@@ -94,12 +106,15 @@ int main( int argc, char* argv[] )
   const char* output_file_name = 0;
   const char* indiv_file_name = 0;
   int intervals = 0, debug_level = 0;
+  int num_procs = 0, num_aggregators = 0, aggregators_per_node = 0;
+  bool compare = false;
     // state for CL flag processing
   bool expect_intervals = false;
   bool expect_file_name = false;
   bool expect_indiv_file = false;
   bool skip_resolve_shared = false;
   bool expect_debug_level = false;
+  int* expect_int = 0;
     // process CL args
   for (int i = 1; i < argc; ++i) {
     if (expect_intervals) {
@@ -119,6 +134,15 @@ int main( int argc, char* argv[] )
       output_file_name = argv[i];
       expect_file_name = false;
     }
+    else if (expect_int) {
+      char* endptr = 0;
+      *expect_int = (int)strtol( argv[i], &endptr, 0 );
+      if (*endptr || *expect_int < 1) {
+        std::cerr << "Invalid argument following " << argv[i-1] << " flag: \"" << argv[i] << '"' << std::endl;
+        return 1;
+      }
+      expect_int = 0;
+    }
     else if (expect_debug_level) {
       debug_level = atoi(argv[i]);
       if (debug_level < 1) {
@@ -137,6 +161,14 @@ int main( int argc, char* argv[] )
       skip_resolve_shared = true;
     else if (!strcmp( "-g", argv[i]))
       expect_debug_level = true;
+    else if (!strcmp( "-p", argv[i]))
+      expect_int = &num_procs;
+    else if (!strcmp( "-A", argv[i]))
+      expect_int = &num_aggregators;
+    else if (!strcmp( "-N", argv[i]))
+      expect_int = &aggregators_per_node;
+    else if (!strcmp( "-C", argv[i]))
+      compare = true;
     else if (!strcmp( "-h", argv[i])) {
       help();
       return 0;
@@ -150,7 +182,7 @@ int main( int argc, char* argv[] )
     }
   }
     // Check for missing argument after last CL flag
-  if (expect_file_name || expect_intervals || expect_indiv_file) {
+  if (expect_file_name || expect_intervals || expect_indiv_file || expect_int) {
     std::cerr << "Missing argument for '" << argv[argc-1] << "'" << std::endl;
     return 1;
   }
@@ -166,13 +198,40 @@ int main( int argc, char* argv[] )
     output_file_name = DEFAULT_FILE_NAME;
     keep_output_file = false;
   }
+  if (compare && !num_aggregators && !aggregators_per_node)
+    aggregators_per_node = 1;
+
+    // Restrict test to the first num_procs processes
+  if (num_procs > size) {
+    if (0 == rank)
+      std::cerr << "Cannot use " << num_procs << " of " << size << " processes" << std::endl;
+    return 1;
+  }
+  MPI_Comm comm;
+  if (num_procs && num_procs < size) {
+    ierr = MPI_Comm_split( MPI_COMM_WORLD, rank < num_procs ? 0 : MPI_UNDEFINED, rank, &comm );
+    if (ierr) {
+      std::cerr << "MPI_Comm_split failed with error code: " << ierr << std::endl;
+      return ierr;
+    }
+    if (MPI_COMM_NULL == comm)
+      return MPI_Finalize();
+    size = num_procs;
+  }
+  else {
+    ierr = MPI_Comm_dup( MPI_COMM_WORLD, &comm );
+    if (ierr) {
+      std::cerr << "MPI_Comm_dup failed with error code: " << ierr << std::endl;
+      return ierr;
+    }
+  }
   
     // Create mesh
 TPRINT("Generating mesh");
   double gen_time = MPI_Wtime();
   Core mb;
   Interface& moab = mb;
-  ErrorCode rval = generate_mesh( moab, intervals );
+  ErrorCode rval = generate_mesh( moab, intervals, comm );
   if (MB_SUCCESS != rval) {
     std::cerr << "Mesh creation failed with error code: " << rval << std::endl;
     return (int)rval;
@@ -197,10 +256,11 @@ TPRINT("Writing individual file");
   double res_time = MPI_Wtime();
   Range hexes;
   moab.get_entities_by_type( 0, MBHEX, hexes );
+    // The writer uses the first ParallelComm instance
+  ParallelComm* pcomm = new ParallelComm( &moab, comm );
   if (!skip_resolve_shared) {
 TPRINT("Resolving shared entities");
       // Negotiate shared entities using vertex global IDs
-    ParallelComm* pcomm = new ParallelComm( &moab, MPI_COMM_WORLD );
     rval = pcomm->resolve_shared_ents( 0, hexes, 3, 0 );
     if (MB_SUCCESS != rval) {
       std::cerr << "ParallelComm::resolve_shared_ents failed" << std::endl;
@@ -210,13 +270,31 @@ TPRINT("Resolving shared entities");
   res_time = MPI_Wtime() - res_time;
   
 TPRINT("Beginning parallel write");
-  double write_time = MPI_Wtime();
-    // Do parallel write
-  clock_t t = clock();
-  std::ostringstream opts;
+  std::ostringstream opts, aggr_opts;
   opts << "PARALLEL=WRITE_PART";
   if (debug_level > 0)
     opts << ";DEBUG_IO=" << debug_level;
+  if (num_aggregators)
+    aggr_opts << ";AGGREGATORS=" << num_aggregators;
+  if (aggregators_per_node)
+    aggr_opts << ";AGGREGATORS_PER_NODE=" << aggregators_per_node;
+
+    // When comparing, first write without aggregation
+  double plain_time = 0.0;
+  if (compare) {
+    plain_time = MPI_Wtime();
+    rval = moab.write_file( output_file_name, "MOAB", opts.str().c_str() );
+    if (MB_SUCCESS != rval) {
+      std::cerr << "File creation failed with error code: " << moab.get_error_string( rval ) << std::endl;
+      return (int)rval;
+    }
+    plain_time = MPI_Wtime() - plain_time;
+  }
+  opts << aggr_opts.str();
+
+  double write_time = MPI_Wtime();
+    // Do parallel write
+  clock_t t = clock();
   rval = moab.write_file( output_file_name, "MOAB", opts.str().c_str() );
   t = clock() - t;
   if (MB_SUCCESS != rval) {
@@ -228,9 +306,9 @@ TPRINT("Beginning parallel write");
   }
   write_time = MPI_Wtime() - write_time;
   
-  double times[3] = { gen_time, res_time, write_time };
-  double max[3] = { 0, 0, 0 };
-  MPI_Reduce( times, max, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD );
+  double times[4] = { gen_time, res_time, write_time, plain_time };
+  double max[4] = { 0, 0, 0, 0 };
+  MPI_Reduce( times, max, 4, MPI_DOUBLE, MPI_MAX, 0, comm );
   
     // Clean up and summarize
   if (0 == rank) {
@@ -245,19 +323,27 @@ TPRINT("Removing written file");
     std::cout << "Wall time: generate: " << max[0] 
               << ", resovle shared: " << max[1]
               << ", write_file: " << max[2] << std::endl;
+    if (compare)
+      std::cout << size << " procs, " << hexes.size() << " hexes/proc: "
+                << "write without aggregation: " << max[3]
+                << ", with aggregation (" << aggr_opts.str().substr(1) << "): "
+                << max[2] << std::endl;
   }
   
+  delete pcomm;
+  MPI_Comm_free( &comm );
+  
 TPRINT("Finalizing MPI");
   return MPI_Finalize();
 }
 
 #define IDX(i,j,k) ((num_interval+1)*((num_interval+1)*(k) + (j)) + (i))
 
-ErrorCode generate_mesh( Interface& moab, int num_interval )
+ErrorCode generate_mesh( Interface& moab, int num_interval, MPI_Comm comm )
 {
   int rank, size;
-  MPI_Comm_rank( MPI_COMM_WORLD, &rank );
-  MPI_Comm_size( MPI_COMM_WORLD, &size );
+  MPI_Comm_rank( comm, &rank );
+  MPI_Comm_size( comm, &size );
   
   ErrorCode rval;
   Tag global_id;
@@ -30,6 +30,8 @@ void test_pack_elements();
 void test_pack_higher_order();
 /** Test pack/unpack of polygons & polyhedra */
 void test_pack_poly();
+/** Test pack/unpack of sequences larger than the packing chunk size */
+void test_pack_large_sequence();
 /** Test pack/unpack of entity sets */
 void test_pack_sets_simple();
 /** Test pack/unpack of entity sets including implicit packing of set contents */
@@ -68,6 +70,7 @@ int main( int argc, char* argv[] )
   num_err += RUN_TEST( test_pack_elements );
   num_err += RUN_TEST( test_pack_higher_order );
   num_err += RUN_TEST( test_pack_poly );
+  num_err += RUN_TEST( test_pack_large_sequence );
   num_err += RUN_TEST( test_pack_sets_simple );
   num_err += RUN_TEST( test_pack_set_contents );
   num_err += RUN_TEST( test_pack_sets_of_sets );
@@ -875,6 +878,47 @@ void test_pack_poly()
   }
 }
 
+void test_pack_large_sequence()
+{
+  Core moab;
+  ErrorCode rval;
+  const unsigned n = 20;
+  create_simple_grid( moab, n );
+
+    // delete some hexes so the elements are in several subranges
+  Range hexes;
+  rval = moab.get_entities_by_type( 0, MBHEX, hexes );
+  CHECK_ERR(rval);
+  Range del;
+  for (size_t i = 0; i < hexes.size(); i += 1000)
+    del.insert( hexes[i] );
+  rval = moab.delete_entities( del );
+  CHECK_ERR(rval);
+  const int num_hex = (n-1)*(n-1)*(n-1) - del.size();
+
+  pack_unpack_noremoteh( moab );
+  check_sizes( moab, n*n*n, 0, 0, 0, 0, 0, 0, 0, 0, num_hex, 0 );
+
+    // check that each hex is a unit cube with the expected corner order
+  hexes.clear();
+  rval = moab.get_entities_by_type( 0, MBHEX, hexes );
+  CHECK_ERR(rval);
+  const double offsets[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+                                 {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+  std::vector<EntityHandle> conn;
+  for (Range::iterator i = hexes.begin(); i != hexes.end(); ++i) {
+    rval = moab.get_connectivity( &*i, 1, conn );
+    CHECK_ERR(rval);
+    CHECK_EQUAL( (size_t)8, conn.size() );
+    double coords[24];
+    rval = moab.get_coords( &conn[0], 8, coords );
+    CHECK_ERR(rval);
+    for (int j = 0; j < 8; ++j)
+      for (int d = 0; d < 3; ++d)
+        CHECK_REAL_EQUAL( coords[d] + offsets[j][d], coords[3*j+d], 1e-12 );
+  }
+}
+
 void test_pack_sets_simple()
 {
   Core moab;
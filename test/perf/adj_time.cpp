@@ -1,9 +1,17 @@
 #include "moab/Core.hpp"
 #include "moab/Range.hpp"
+#include "moab/ReadUtilIface.hpp"
+#include "AEntityFactory.hpp"
+#include "moab/CpuTimer.hpp"
 #include "TestUtil.hpp"
 #include <iostream>
+#include <algorithm>
+#include <stdlib.h>
 #include <assert.h>
 #include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace moab;
 
@@ -13,8 +21,112 @@ static const char default_input_file[] = STRINGIFY(MESHDIR) "/64bricks_512hex.h5
 #error MESHDIR needs to be defined for running unit tests
 #endif
 
-int main()
+  // Create a structured grid of n^3 cubes, each split into six tetrahedra
+static ErrorCode make_tet_mesh( Interface& mb, int n, EntityHandle& first_vert )
+{
+  ReadUtilIface* iface;
+  ErrorCode rval = mb.query_interface( iface );
+  if (MB_SUCCESS != rval)
+    return rval;
+  
+  const int nv = n + 1;
+  std::vector<double*> coords;
+  rval = iface->get_node_coords( 3, nv*nv*nv, 0, first_vert, coords );
+  if (MB_SUCCESS != rval)
+    return rval;
+  for (int k = 0; k < nv; ++k)
+    for (int j = 0; j < nv; ++j)
+      for (int i = 0; i < nv; ++i) {
+        const int idx = (k*nv + j)*nv + i;
+        coords[0][idx] = i;
+        coords[1][idx] = j;
+        coords[2][idx] = k;
+      }
+  
+    // Kuhn subdivision: each tet is the path 0 -> 7 through the cube corners
+  const int paths[6][2] = { {1,3}, {1,5}, {2,3}, {2,6}, {4,5}, {4,6} };
+  EntityHandle first_tet, *conn;
+  rval = iface->get_element_connect( 6*n*n*n, 4, MBTET, 0, first_tet, conn );
+  if (MB_SUCCESS != rval)
+    return rval;
+  for (int k = 0; k < n; ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i) {
+        EntityHandle corner[8];
+        for (int c = 0; c < 8; ++c)
+          corner[c] = first_vert + ((k + (c>>2))*nv + j + ((c>>1)&1))*nv + i + (c&1);
+        for (int t = 0; t < 6; ++t) {
+          *conn++ = corner[0];
+          *conn++ = corner[paths[t][0]];
+          *conn++ = corner[paths[t][1]];
+          *conn++ = corner[7];
+        }
+      }
+  
+  return iface->update_adjacencies( first_tet, 6*n*n*n, 4, conn - 24*n*n*n );
+}
+
+  // Time AEntityFactory::create_vert_elem_adjacencies for 1..max_threads
+  // threads, checking each result against the single-threaded one.
+static int time_vert_elem_build( int n )
 {
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+#else
+  const int max_threads = 1;
+#endif
+  std::vector< std::vector<EntityHandle> > expected;
+  
+  std::cout << "Building vertex-to-element adjacencies for " 
+            << 6*n*n*n << " tets:" << std::endl;
+  for (int nthreads = 1; nthreads <= max_threads; ++nthreads) {
+#ifdef _OPENMP
+    omp_set_num_threads( nthreads );
+#endif
+    Core moab;
+    EntityHandle first_vert;
+    ErrorCode rval = make_tet_mesh( moab, n, first_vert );
+    if (MB_SUCCESS != rval)
+      return 2;
+    
+    double t_0 = CpuTimer::wall_time();
+    rval = moab.a_entity_factory()->create_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return 2;
+    double t_build = CpuTimer::wall_time() - t_0;
+    std::cout << "  " << nthreads << " thread(s): " << t_build << " seconds" << std::endl;
+    
+    const size_t num_verts = (n+1)*(n+1)*(n+1);
+    std::vector<EntityHandle> adj;
+    for (size_t i = 0; i < num_verts; ++i) {
+      rval = moab.a_entity_factory()->get_adjacencies( first_vert + i, adj );
+      if (MB_SUCCESS != rval)
+        return 2;
+      if (1 == nthreads)
+        expected.push_back( adj );
+      else if (adj != expected[i]) {
+        std::cerr << "Adjacencies built with " << nthreads 
+                  << " threads differ from single-threaded result" << std::endl;
+        return 1;
+      }
+    }
+  }
+  
+  return 0;
+}
+
+int main( int argc, char* argv[] )
+{
+    // optional argument: grid intervals for the adjacency build benchmark
+  int intervals = 40;
+  if (argc > 1) {
+    intervals = atoi( argv[1] );
+    if (intervals < 1) {
+      std::cerr << "Usage: " << argv[0] << " [intervals]" << std::endl;
+      return 1;
+    }
+  }
+
   ErrorCode rval;
   Core moab;
   Interface& mb = moab;
@@ -68,7 +180,6 @@ int main()
   std::cout << "Querying of faces for " << vols.size() << " volumes: "
             << t_down/(double)CLOCKS_PER_SEC << " seconds" << std::endl;
   
-  
-  return 0;
+  return time_vert_elem_build( intervals );
 }
 
@@ -22,9 +22,12 @@
 #include <time.h>
 #include <assert.h>
 #include <list>
+#include <sstream>
+#include <stdio.h>
 #include "moab/Core.hpp"
 #include "moab/Skinner.hpp"
 #include "moab/ReadUtilIface.hpp"
+#include "moab/CpuTimer.hpp"
 
 using namespace moab;
 
@@ -52,6 +55,8 @@ void direct_tag( int intervals, int dim, int blocks )
   { std::cout << "Direct Tag Time:"; 
     tag_time( MB_TAG_DENSE, true, intervals, dim, blocks ); }
 
+void h5m_layout( int intervals, int dim, int level );
+
 typedef void (*test_func_t)( int, int, int );
 const struct {
   std::string testName;
@@ -63,6 +68,7 @@ const struct {
  { "sparse",    &sparse_tag,"Sparse tag data manipulation" },
  { "dense",     &dense_tag, "Dense tag data manipulation" },
  { "direct",    &direct_tag,"Dense tag data manipulation using direct data access" },
+ { "h5m",       &h5m_layout,"Native file size and write/read time for contiguous and compressed layouts" },
 };
 const int TestListSize = sizeof(TestList)/sizeof(TestList[0]); 
 
@@ -456,3 +462,78 @@ void tag_time( TagType storage, bool direct, int intervals, int dim, int blocks
   double secs = (clock() - t) / (double)CLOCKS_PER_SEC;
   std::cout << " " << iter_count << " iterations in " << secs << " seconds" << std::endl;
 }
+
+static void time_h5m( Interface& mb, const char* label, const char* options, long num_elem )
+{
+  const char filename[] = "perftool.h5m";
+  double t = CpuTimer::wall_time();
+  ErrorCode rval = mb.write_file( filename, "MOAB", options );
+  const double write_time = CpuTimer::wall_time() - t;
+  if (MB_SUCCESS != rval) {
+    std::cerr << label << ": write failed" << std::endl;
+    return;
+  }
+
+  FILE* fptr = fopen( filename, "rb" );
+  fseek( fptr, 0, SEEK_END );
+  const double mbytes = ftell( fptr ) / 1048576.0;
+  fclose( fptr );
+
+  Core moab2;
+  t = CpuTimer::wall_time();
+  rval = moab2.load_file( filename );
+  const double read_time = CpuTimer::wall_time() - t;
+  remove( filename );
+  if (MB_SUCCESS != rval) {
+    std::cerr << label << ": read failed" << std::endl;
+    return;
+  }
+
+  std::cout << std::setw(16) << std::left << label << std::right 
+            << std::setw(10) << std::fixed << std::setprecision(2) << mbytes 
+            << std::setw(10) << std::setprecision(3) << write_time 
+            << std::setw(10) << read_time 
+            << std::setw(12) << std::setprecision(0) << num_elem / write_time
+            << std::endl;
+}
+
+void h5m_layout( int intervals, int dim, int level )
+{
+  Core moab;
+  Interface& mb = moab;
+  create_regular_mesh( &mb, intervals, dim );
+
+    // A dense tag on vertices and a sparse tag on every other element
+  Range verts, elems;
+  mb.get_entities_by_type( 0, MBVERTEX, verts );
+  mb.get_entities_by_dimension( 0, dim, elems );
+  Tag dense, sparse;
+  mb.tag_get_handle( "dense", 1, MB_TYPE_DOUBLE, dense, MB_TAG_DENSE|MB_TAG_CREAT );
+  mb.tag_get_handle( "sparse", 1, MB_TYPE_INTEGER, sparse, MB_TAG_SPARSE|MB_TAG_CREAT );
+  std::vector<double> dvals( verts.size() );
+  for (size_t i = 0; i < dvals.size(); ++i)
+    dvals[i] = sin( 0.01 * i );
+  mb.tag_set_data( dense, verts, &dvals[0] );
+  Range tagged;
+  for (Range::iterator i = elems.begin(); i != elems.end(); i += 2)
+    tagged.insert( *i );
+  std::vector<int> ivals( tagged.size() );
+  for (size_t i = 0; i < ivals.size(); ++i)
+    ivals[i] = i;
+  mb.tag_set_data( sparse, tagged, &ivals[0] );
+
+  if (level < 1 || level > 9)
+    level = 6;
+  std::ostringstream compress, shuffle;
+  compress << "COMPRESS=" << level;
+  shuffle << compress.str() << ";SHUFFLE";
+
+  std::cout << std::setw(16) << std::left << "Layout" << std::right
+            << std::setw(10) << "MB" << std::setw(10) << "Write(s)" 
+            << std::setw(10) << "Read(s)" << std::setw(12) << "Elem/s" << std::endl;
+  const long num_elem = elems.size();
+  time_h5m( mb, "contiguous", "", num_elem );
+  time_h5m( mb, "chunked", "CHUNK_SIZE=524288", num_elem );
+  time_h5m( mb, "deflate", compress.str().c_str(), num_elem );
+  time_h5m( mb, "shuffle+deflate", shuffle.str().c_str(), num_elem );
+}
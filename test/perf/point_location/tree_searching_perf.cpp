@@ -20,6 +20,7 @@ using namespace moab;
 
 ErrorCode test_locator(SpatialLocator &sl, int npoints, double &cpu_time, double &percent_outside);
 ErrorCode create_hex_mesh(Interface &mb, Range &elems, int n, int dim);
+Tree *create_tree(Interface &mb, int tree_tp, const std::string &opts, int nthreads);
 
 int main(int argc, char **argv)
 {
@@ -32,7 +33,7 @@ int main(int argc, char **argv)
 #endif
 
   int npoints = 100, dim = 3;
-  int dints = 1, dleafs = 1, ddeps = 1, csints = 0;
+  int dints = 1, dleafs = 1, ddeps = 1, csints = 0, nthreads = 1;
   
   ProgOptions po;
   po.addOpt<int>( "candidateplaneset,c", "Candidate plane set (0=SUBDIVISION,1=SUBDIV_SNAP,2=VERTEX_MEDIAN,3=VERTEX_SAMPLE", &csints);
@@ -40,6 +41,7 @@ int main(int argc, char **argv)
   po.addOpt<int>( "leaf,l", "Number of doublings of maximum number of elements per leaf", &dleafs);
   po.addOpt<int>( "max_depth,m", "Number of 5-intervals on maximum depth of tree", &ddeps);
   po.addOpt<int>( "npoints,n", "Number of query points", &npoints);
+  po.addOpt<int>( "threads,t", "Number of threads for a second, parallel tree construction", &nthreads);
 //  po.addOpt<void>( "print,p", "Print tree details", &print_tree);
   po.parseCommandLine(argc, argv);
 
@@ -59,6 +61,8 @@ int main(int argc, char **argv)
             << "N_elements" << " "
             << "search_time" << " "
             << "perc_outside" << " "
+            << "build_time" << " "
+            << "par_build_time" << " "
             << "initTime" << " "
             << "nodesVisited" << " "
             << "leavesVisited" << " "
@@ -79,25 +83,32 @@ int main(int argc, char **argv)
       for (std::vector<int>::iterator leafs_it = leafs.begin(); leafs_it != leafs.end(); ++leafs_it) {
   
           // iteration: tree type
-        for (int tree_tp = 1; tree_tp < 2; tree_tp++) {
+        for (int tree_tp = 0; tree_tp < 2; tree_tp++) {
             // create tree
-          Tree *tree;
-          if (0 == tree_tp)
-            tree = new BVHTree(&mb);
-          else
-            tree = new AdaptiveKDTree(&mb);
-
           std::ostringstream opts;
           opts << "MAX_DEPTH=" << *dep_it << ";MAX_PER_LEAF=" << *leafs_it;
-          if (csints) {
+          if (csints && tree_tp) {
             if (opts.str().length() > 0) 
               opts << ";";
             opts << "PLANE_SET=" << csints;
           }
-          FileOptions fo(opts.str().c_str());
-          rval = tree->parse_options(fo);
-          if (MB_SUCCESS != rval) return rval;
+          Tree *tree = create_tree(mb, tree_tp, opts.str(), 1);
+          if (!tree) return MB_FAILURE;
+          double build_time = CpuTimer::wall_time();
           SpatialLocator sl(&mb, elems, tree);
+          build_time = CpuTimer::wall_time() - build_time;
+
+            // time building the same tree with several threads
+          double par_build_time = build_time;
+          if (nthreads > 1) {
+            Tree *par_tree = create_tree(mb, tree_tp, opts.str(), nthreads);
+            if (!par_tree) return MB_FAILURE;
+            par_build_time = CpuTimer::wall_time();
+            rval = par_tree->build_tree(elems);
+            par_build_time = CpuTimer::wall_time() - par_build_time;
+            delete par_tree;
+            if (MB_SUCCESS != rval) return rval;
+          }
 
             // call evaluation
           double cpu_time, perc_outside;
@@ -110,7 +121,9 @@ int main(int argc, char **argv)
                     << *int_it << " "
                     << (*int_it)*(*int_it)*(dim == 3 ? *int_it : 1) << " "
                     << cpu_time << " "
-                    << perc_outside << " ";
+                    << perc_outside << " "
+                    << build_time << " "
+                    << par_build_time << " ";
 
           tree->tree_stats().output_all_stats();
 
@@ -131,6 +144,24 @@ int main(int argc, char **argv)
   return 0;
 }
 
+Tree *create_tree(Interface &mb, int tree_tp, const std::string &opts, int nthreads)
+{
+  Tree *tree;
+  if (0 == tree_tp)
+    tree = new BVHTree(&mb);
+  else
+    tree = new AdaptiveKDTree(&mb);
+
+  FileOptions fo(opts.c_str());
+  ErrorCode rval = tree->parse_options(fo);
+  if (MB_SUCCESS != rval) {
+    delete tree;
+    return NULL;
+  }
+  tree->set_num_threads(nthreads);
+  return tree;
+}
+
 ErrorCode test_locator(SpatialLocator &sl, int npoints, double &cpu_time, double &percent_outside) 
 {
   BoundBox box = sl.local_box();
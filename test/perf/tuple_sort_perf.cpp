@@ -0,0 +1,100 @@
+#include "moab/TupleList.hpp"
+#include "moab/CpuTimer.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace moab;
+
+/* Time TupleList::sort for a range of tuple counts and key widths, with
+ * 1 to the given number of threads.  Tuples are (int, int; long; ulong; real)
+ * and are sorted by the second int (32-bit key), the long (64-bit key with
+ * the given number of random bits) or the ulong (64-bit key with a constant
+ * high half, like entity handles of one type).  The result of each threaded
+ * sort is compared with the single-threaded one.
+ *
+ * Usage: tuple_sort_perf [max_tuples [max_threads]]
+ */
+
+static unsigned long random_bits( int bits )
+{
+  unsigned long r = 0;
+  for (int i = 0; i < 4; ++i)
+    r = (r << 16) ^ (unsigned long)(rand() & 0xFFFF);
+  if (bits < (int)(8*sizeof(unsigned long)))
+    r &= (1ul << bits) - 1;
+  return r;
+}
+
+static void fill( TupleList& tl, unsigned n, int key_bits )
+{
+  srand(n);
+  tl.reset();
+  tl.initialize(2, 1, 1, 1, n);
+  tl.enableWriteAccess();
+  for (unsigned i = 0; i < n; ++i) {
+    unsigned long r = random_bits(key_bits);
+    int iv[2] = { (int)i, (int)(r & 0x7FFFFFFF) };
+    long lv = (long)(r >> 1);
+    Ulong ulv = ((Ulong)0xAB << 56) | (r & 0xFFFFFFFF);
+    double rv = i;
+    tl.push_back(iv, &lv, &ulv, &rv);
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  unsigned max_n = 10000000;
+  unsigned max_threads = 4;
+  if (argc > 1)
+    max_n = atoi(argv[1]);
+  if (argc > 2)
+    max_threads = atoi(argv[2]);
+#ifndef _OPENMP
+  max_threads = 1;
+#endif
+
+  const struct { const char* name; unsigned key; int bits; } keys[] = {
+    { "int32", 1, 31 },
+    { "long/16", 2, 17 },
+    { "long/64", 2, 64 },
+    { "handle", 3, 32 } };
+
+  std::cout << std::setw(10) << "tuples" << std::setw(10) << "key";
+  for (unsigned t = 1; t <= max_threads; t *= 2)
+    std::cout << std::setw(9) << t << "T";
+  std::cout << std::endl;
+
+  bool ok = true;
+  TupleList::buffer buf;
+  for (unsigned n = 10000; n <= max_n; n *= 10) {
+    for (unsigned k = 0; k < sizeof(keys)/sizeof(keys[0]); ++k) {
+      std::cout << std::setw(10) << n << std::setw(10) << keys[k].name;
+      std::vector<int> ref;
+      for (unsigned t = 1; t <= max_threads; t *= 2) {
+        TupleList tl;
+        fill(tl, n, keys[k].bits);
+        tl.set_num_threads(t);
+        double t0 = CpuTimer::wall_time();
+        tl.sort(keys[k].key, &buf);
+        double t1 = CpuTimer::wall_time();
+        std::cout << std::setw(10) << std::setprecision(3) << t1 - t0;
+
+          // compare order of original indices
+        if (t == 1)
+          ref.assign(tl.vi_rd, tl.vi_rd + 2*n);
+        else if (memcmp(&ref[0], tl.vi_rd, 2*n*sizeof(int)))
+          ok = false;
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  if (!ok) {
+    std::cerr << "Threaded sort differs from single-threaded sort" << std::endl;
+    return 1;
+  }
+  return 0;
+}
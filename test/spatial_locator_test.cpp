@@ -23,6 +23,8 @@ using namespace moab;
 
 void test_kd_tree();
 void test_bvh_tree();
+void test_kd_tree_threads();
+void test_bvh_tree_threads();
 void test_locator(SpatialLocator *sl);
 
 ErrorCode create_hex_mesh(Interface &mb, Range &elems, int n, int dim);
@@ -53,6 +55,8 @@ int main(int argc, char **argv)
 
   RUN_TEST(test_kd_tree);
   RUN_TEST(test_bvh_tree);
+  RUN_TEST(test_kd_tree_threads);
+  RUN_TEST(test_bvh_tree_threads);
   
 #ifdef MOAB_HAVE_MPI
   fail = MPI_Finalize();
@@ -117,6 +121,132 @@ void test_bvh_tree()
   delete sl;
 }
 
+  // Check that two instances, in which the same tree was built, have the same sets,
+  // with the same contents, children and (for kd trees) split planes
+static void compare_trees(Interface &mb1, Interface &mb2,
+                          AdaptiveKDTree *kd1 = NULL, AdaptiveKDTree *kd2 = NULL)
+{
+  Range sets1, sets2;
+  ErrorCode rval = mb1.get_entities_by_type(0, MBENTITYSET, sets1); CHECK_ERR(rval);
+  rval = mb2.get_entities_by_type(0, MBENTITYSET, sets2); CHECK_ERR(rval);
+  CHECK(sets1.size() > 1);
+  CHECK_EQUAL(sets1, sets2);
+
+  for (Range::iterator it = sets1.begin(); it != sets1.end(); ++it) {
+    std::vector<EntityHandle> ents1, ents2, children1, children2;
+    rval = mb1.get_entities_by_handle(*it, ents1); CHECK_ERR(rval);
+    rval = mb2.get_entities_by_handle(*it, ents2); CHECK_ERR(rval);
+    CHECK(ents1 == ents2);
+    rval = mb1.get_child_meshsets(*it, children1); CHECK_ERR(rval);
+    rval = mb2.get_child_meshsets(*it, children2); CHECK_ERR(rval);
+    CHECK(children1 == children2);
+    if (kd1 && !children1.empty()) {
+      AdaptiveKDTree::Plane plane1, plane2;
+      rval = kd1->get_split_plane(*it, plane1); CHECK_ERR(rval);
+      rval = kd2->get_split_plane(*it, plane2); CHECK_ERR(rval);
+      CHECK_EQUAL(plane1.norm, plane2.norm);
+      CHECK_REAL_EQUAL(plane1.coord, plane2.coord, 0.0);
+    }
+  }
+}
+
+  // Check that the located points are the same with two locators, which have evaluators
+static void compare_locators(SpatialLocator *sl1, SpatialLocator *sl2)
+{
+  BoundBox box = sl1->local_box();
+  CartVect box_del = box.bMax - box.bMin;
+  std::vector<CartVect> pts(npoints), params1(npoints), params2(npoints);
+  std::vector<EntityHandle> ents1(npoints), ents2(npoints);
+  std::vector<int> is_in1(npoints), is_in2(npoints);
+  double denom = 1.0 / (double)RAND_MAX;
+  for (int i = 0; i < npoints; i++) {    
+    double rx = (double)rand() * denom, ry = (double)rand() * denom, rz = (double)rand() * denom;
+    pts[i] = box.bMin + CartVect(rx*box_del[0], ry*box_del[1], rz*box_del[2]);
+  }
+  ErrorCode rval = sl1->locate_points(pts[0].array(), npoints, &ents1[0], params1[0].array(), &is_in1[0]);
+  CHECK_ERR(rval);
+  rval = sl2->locate_points(pts[0].array(), npoints, &ents2[0], params2[0].array(), &is_in2[0]);
+  CHECK_ERR(rval);
+  CHECK(ents1 == ents2);
+  CHECK(is_in1 == is_in2);
+  for (int i = 0; i < npoints; i++)
+    if (is_in1[i])
+      CHECK_REAL_EQUAL(0.0, (params1[i] - params2[i]).length(), 0.0);
+}
+
+void test_kd_tree_threads() 
+{
+    // build the same tree with one and with four threads, for each plane set
+    // that is built in parallel
+  for (int plane_set = AdaptiveKDTree::SUBDIVISION; plane_set <= AdaptiveKDTree::VERTEX_MEDIAN; ++plane_set) {
+    Core mb1, mb2;
+    Range elems1, elems2;
+    ErrorCode rval = create_hex_mesh(mb1, elems1, ints, 3); CHECK_ERR(rval);
+    rval = create_hex_mesh(mb2, elems2, ints, 3); CHECK_ERR(rval);
+
+    AdaptiveKDTree kd1(&mb1), kd2(&mb2);
+    std::ostringstream opts;
+    opts << "MAX_DEPTH=" << max_depth << ";MAX_PER_LEAF=" << leaf << ";PLANE_SET=" << plane_set;
+    FileOptions fo1(opts.str().c_str());
+    rval = kd1.parse_options(fo1); CHECK_ERR(rval);
+    opts << ";NUM_THREADS=4";
+    FileOptions fo2(opts.str().c_str());
+    rval = kd2.parse_options(fo2); CHECK_ERR(rval);
+
+    SpatialLocator sl1(&mb1, elems1, &kd1), sl2(&mb2, elems2, &kd2);
+    CHECK(!mb2.is_frozen());
+    compare_trees(mb1, mb2, &kd1, &kd2);
+    CHECK_EQUAL(kd1.tree_stats().numNodes, kd2.tree_stats().numNodes);
+    CHECK_EQUAL(kd1.tree_stats().constructLeafObjectTests, kd2.tree_stats().constructLeafObjectTests);
+    ElemEvaluator eval1(&mb1), eval2(&mb2);
+    kd1.set_eval(&eval1);
+    kd2.set_eval(&eval2);
+    compare_locators(&sl1, &sl2);
+  }
+
+    // an instance frozen by the caller is built serially and left frozen
+  Core mb1, mb2;
+  Range elems1, elems2;
+  ErrorCode rval = create_hex_mesh(mb1, elems1, ints, 3); CHECK_ERR(rval);
+  rval = create_hex_mesh(mb2, elems2, ints, 3); CHECK_ERR(rval);
+  rval = mb2.freeze(); CHECK_ERR(rval);
+  AdaptiveKDTree kd1(&mb1), kd2(&mb2);
+  std::ostringstream opts;
+  opts << "MAX_DEPTH=" << max_depth << ";MAX_PER_LEAF=" << leaf;
+  FileOptions fo1(opts.str().c_str());
+  rval = kd1.parse_options(fo1); CHECK_ERR(rval);
+  opts << ";NUM_THREADS=4";
+  FileOptions fo2(opts.str().c_str());
+  rval = kd2.parse_options(fo2); CHECK_ERR(rval);
+  SpatialLocator sl1(&mb1, elems1, &kd1), sl2(&mb2, elems2, &kd2);
+  CHECK(mb2.is_frozen());
+  mb2.unfreeze();
+  compare_trees(mb1, mb2, &kd1, &kd2);
+}
+
+void test_bvh_tree_threads() 
+{
+  Core mb1, mb2;
+  Range elems1, elems2;
+  ErrorCode rval = create_hex_mesh(mb1, elems1, ints, 3); CHECK_ERR(rval);
+  rval = create_hex_mesh(mb2, elems2, ints, 3); CHECK_ERR(rval);
+
+  BVHTree bvh1(&mb1), bvh2(&mb2);
+  std::ostringstream opts;
+  opts << "MAX_DEPTH=" << max_depth << ";MAX_PER_LEAF=" << leaf;
+  FileOptions fo1(opts.str().c_str());
+  rval = bvh1.parse_options(fo1); CHECK_ERR(rval);
+  rval = bvh2.parse_options(fo1); CHECK_ERR(rval);
+  bvh2.set_num_threads(4);
+
+  SpatialLocator sl1(&mb1, elems1, &bvh1), sl2(&mb2, elems2, &bvh2);
+  compare_trees(mb1, mb2);
+  ElemEvaluator eval1(&mb1), eval2(&mb2);
+  bvh1.set_eval(&eval1);
+  bvh2.set_eval(&eval2);
+  compare_locators(&sl1, &sl2);
+}
+
 void test_locator(SpatialLocator *sl) 
 {
   CartVect box_del, test_pt, test_res;
@@ -0,0 +1,172 @@
+#include "moab/TupleList.hpp"
+#include "TestUtil.hpp"
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace moab;
+
+void test_sort_int_key();
+void test_sort_long_key();
+void test_sort_ulong_key();
+void test_sort_constant_digits();
+void test_sort_key_only();
+
+int main()
+{
+  int err = 0;
+  err += RUN_TEST(test_sort_int_key);
+  err += RUN_TEST(test_sort_long_key);
+  err += RUN_TEST(test_sort_ulong_key);
+  err += RUN_TEST(test_sort_constant_digits);
+  err += RUN_TEST(test_sort_key_only);
+  return err;
+}
+
+  // Pseudo-random non-negative value with at most the given number of bits
+static unsigned long random_bits( int bits )
+{
+  unsigned long r = 0;
+  for (int i = 0; i < 4; ++i)
+    r = (r << 16) ^ (unsigned long)(rand() & 0xFFFF);
+  if (bits < (int)(8*sizeof(unsigned long)))
+    r &= (1ul << bits) - 1;
+  return r;
+}
+
+  // Order of tuple indices after a stable sort by key
+template <typename T>
+static void reference_order( const std::vector<T>& keys, std::vector<unsigned>& order )
+{
+  std::vector< std::pair<T,unsigned> > pairs(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    pairs[i] = std::make_pair(keys[i], (unsigned)i);
+  std::stable_sort(pairs.begin(), pairs.end());
+  order.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    order[i] = pairs[i].second;
+}
+
+  // Tuples are (index, key) in vi/vl/vul depending on key_type, plus a real.
+  // Sort by key with the given number of threads and check against a stable
+  // sort of the keys.
+static void check_sort( int key_type, unsigned n, int bits, unsigned long high_bits, unsigned num_threads )
+{
+  srand(n + bits);
+  std::vector<unsigned long> keys(n);
+  for (unsigned i = 0; i < n; ++i)
+    keys[i] = high_bits | random_bits(bits);
+
+  TupleList tl;
+  tl.initialize(2 - (key_type != 0), key_type == 1, key_type == 2, 1, n);
+  tl.enableWriteAccess();
+  for (unsigned i = 0; i < n; ++i) {
+    int iv[2] = { (int)i, (int)keys[i] };
+    long lv = (long)keys[i];
+    Ulong ulv = (Ulong)keys[i];
+    double rv = 0.5*i;
+    tl.push_back(iv, &lv, &ulv, &rv);
+  }
+  tl.set_num_threads(num_threads);
+  CHECK_EQUAL( num_threads, tl.get_num_threads() );
+
+  TupleList::buffer buf;
+  ErrorCode rval = tl.sort(1, &buf);
+  CHECK_ERR(rval);
+  CHECK_EQUAL( n, tl.get_n() );
+
+  std::vector<unsigned> order;
+  if (key_type == 0) {
+    std::vector<unsigned> ikeys(keys.begin(), keys.end());
+    reference_order(ikeys, order);
+  }
+  else
+    reference_order(keys, order);
+
+  for (unsigned i = 0; i < n; ++i) {
+    unsigned j = order[i];
+    if (key_type == 0) {
+      CHECK_EQUAL( (int)j, tl.vi_rd[2*i] );
+      CHECK_EQUAL( (int)keys[j], tl.vi_rd[2*i+1] );
+    }
+    else {
+      CHECK_EQUAL( (int)j, tl.vi_rd[i] );
+      if (key_type == 1)
+        CHECK_EQUAL( (long)keys[j], tl.vl_rd[i] );
+      else
+        CHECK_EQUAL( (Ulong)keys[j], tl.vul_rd[i] );
+    }
+    CHECK_REAL_EQUAL( 0.5*j, tl.vr_rd[i], 0.0 );
+  }
+}
+
+static void check_sizes( int key_type, int bits, unsigned long high_bits = 0 )
+{
+  const unsigned sizes[] = { 0, 1, 2, 3, 100, 255, 256, 1000, 70000, 100003 };
+  const unsigned num_sizes = sizeof(sizes)/sizeof(sizes[0]);
+  for (unsigned i = 0; i < num_sizes; ++i) {
+    check_sort( key_type, sizes[i], bits, high_bits, 1 );
+    check_sort( key_type, sizes[i], bits, high_bits, 3 );
+  }
+}
+
+void test_sort_int_key()
+{
+  check_sizes( 0, 31 );
+  check_sizes( 0, 10 );
+}
+
+void test_sort_long_key()
+{
+  check_sizes( 1, 8*sizeof(long) - 1 );
+  check_sizes( 1, 20 );
+}
+
+void test_sort_ulong_key()
+{
+  check_sizes( 2, 8*sizeof(Ulong) );
+  check_sizes( 2, 12 );
+}
+
+  // Keys that differ only in a middle digit, such as handles of one type
+void test_sort_constant_digits()
+{
+  const unsigned long high = 0xAB00000000000000ul;
+  check_sizes( 2, 16, high );
+  check_sizes( 1, 0, 7 );
+  check_sizes( 0, 0 );
+}
+
+  // Tuples with only an integer or only a long, sorted without permutation
+void test_sort_key_only()
+{
+  const unsigned n = 100000;
+  for (unsigned num_threads = 1; num_threads < 5; num_threads += 3) {
+    TupleList ti(1, 0, 0, 0, n), tl(0, 1, 0, 0, n);
+    ti.enableWriteAccess();
+    tl.enableWriteAccess();
+    std::vector<int> ivals(n);
+    std::vector<long> lvals(n);
+    srand(1);
+    for (unsigned i = 0; i < n; ++i) {
+      ivals[i] = (int)random_bits(30);
+      lvals[i] = (long)random_bits(40);
+      ti.push_back(&ivals[i], NULL, NULL, NULL);
+      tl.push_back(NULL, &lvals[i], NULL, NULL);
+    }
+    ti.set_num_threads(num_threads);
+    tl.set_num_threads(num_threads);
+    TupleList::buffer buf;
+    ErrorCode rval = ti.sort(0, &buf);
+    CHECK_ERR(rval);
+    rval = tl.sort(0, &buf);
+    CHECK_ERR(rval);
+
+    std::sort(ivals.begin(), ivals.end());
+    std::sort(lvals.begin(), lvals.end());
+    for (unsigned i = 0; i < n; ++i) {
+      CHECK_EQUAL( ivals[i], ti.vi_rd[i] );
+      CHECK_EQUAL( lvals[i], tl.vl_rd[i] );
+    }
+  }
+}
@@ -107,14 +107,14 @@ unsigned int DagMC::interface_revision()
 }
 
 DagMC::DagMC(Interface *mb_impl)
-  : mbImpl(mb_impl), obbTree(mb_impl), have_cgm_geom(false),
-    n_pt_in_vol_calls(0), n_ray_fire_calls(0)
+  : mbImpl(mb_impl), obbTree(mb_impl), have_cgm_geom(false)
 {
     // This is the correct place to uniquely define default values for the dagmc settings
   overlapThickness = 0; // must be nonnegative
   defaultFacetingTolerance = .001;
   numericalPrecision = .001;
   useCAD = false;
+  useFlatTrees = true;
 
   memset( implComplName, 0, NAME_TAG_SIZE );
   strcpy( implComplName , "impl_complement" );
@@ -345,6 +345,22 @@ ErrorCode DagMC::init_OBBTree()
   // setup indices
   rval = setup_indices();MB_CHK_SET_ERR(rval, "Failed to setup problem indices");
 
+  // flatten the volume trees for ray queries
+  rval = build_flat_trees();MB_CHK_SET_ERR(rval, "Failed to build flat OBB trees");
+
+  return MB_SUCCESS;
+}
+
+// compile the obb tree of each volume into a flat tree
+ErrorCode DagMC::build_flat_trees()
+{
+  flatTrees.clear();
+  flatTrees.resize(rootSets.size());
+  for (unsigned i = 1; i < vol_handles().size(); ++i) {
+    const unsigned index = vol_handles()[i] - setOffset;
+    ErrorCode rval = flatTrees[index].build(&obbTree, rootSets[index], &senseTag);
+    MB_CHK_SET_ERR(rval, "Failed to build flat OBB tree");
+  }
   return MB_SUCCESS;
 }
 
@@ -428,7 +444,7 @@ ErrorCode DagMC::build_obbs(Range &surfs, Range &vols)
       return rval;
     if (tris.empty())
       std::cerr << "WARNING: Surface " << get_entity_id(*i) << " has no facets." << std::endl;
-    rval = obbTree.build( tris, root );
+    rval = obbTree.build( tris, root, &obbSettings );
     if (MB_SUCCESS != rval)
       return rval;
     rval = MBI->add_entities( root, &*i, 1 );
@@ -468,7 +484,7 @@ ErrorCode DagMC::build_obbs(Range &surfs, Range &vols)
     }
 
       // build OBB tree for volume
-    rval = obbTree.join_trees( trees, root );
+    rval = obbTree.join_trees( trees, root, &obbSettings );
     if (MB_SUCCESS != rval)
       return rval;
 
@@ -563,7 +579,7 @@ ErrorCode DagMC::build_obb_impl_compl(Range &surfs)
   }
 
     // join surface trees to make OBB tree for implicit complement
-  rval = obbTree.join_trees( comp_tree, comp_root );
+  rval = obbTree.join_trees( comp_tree, comp_root, &obbSettings );
   if (MB_SUCCESS != rval)
     return rval;
 
@@ -608,19 +624,63 @@ void DagMC::RayHistory::rollback_last_intersection() {
     prev_facets.pop_back();
 }
 
+DagMC::QueryContext::QueryContext( unsigned long seed )
+  : n_pt_in_vol_calls(0), n_ray_fire_calls(0)
+{
+  set_seed( seed );
+}
+
+void DagMC::QueryContext::set_seed( unsigned long seed ) {
+  randState = seed;
+}
+
+double DagMC::QueryContext::random() {
+  if (!randState)
+    return rand();
+  // 64-bit linear congruential generator (Knuth's MMIX constants),
+  // returning the high 31 bits like rand()
+  randState = randState * 6364136223846793005ull + 1442695040888963407ull;
+  return (double)(randState >> 33);
+}
+
+ErrorCode DagMC::freeze() {
+  Core* core = dynamic_cast<Core*>(mbImpl);
+  if (!core)
+    return MB_NOT_IMPLEMENTED;
+  return core->freeze();
+}
+
+ErrorCode DagMC::unfreeze() {
+  Core* core = dynamic_cast<Core*>(mbImpl);
+  if (!core)
+    return MB_NOT_IMPLEMENTED;
+  core->unfreeze();
+  return MB_SUCCESS;
+}
+
 ErrorCode DagMC::ray_fire(const EntityHandle vol,
                           const double point[3], const double dir[3],
                           EntityHandle& next_surf, double& next_surf_dist,
                           RayHistory* history, double user_dist_limit,
 			  int ray_orientation,
                           OrientedBoxTreeTool::TrvStats* stats ) {
+  return ray_fire( defaultContext, vol, point, dir, next_surf, next_surf_dist,
+                   history, user_dist_limit, ray_orientation, stats );
+}
+
+ErrorCode DagMC::ray_fire(QueryContext& context, const EntityHandle vol,
+                          const double point[3], const double dir[3],
+                          EntityHandle& next_surf, double& next_surf_dist,
+                          RayHistory* history, double user_dist_limit,
+                          int ray_orientation,
+                          OrientedBoxTreeTool::TrvStats* stats ) {
 
   // take some stats that are independent of nps
   if(counting) {
-    ++n_ray_fire_calls;
-    if(0==n_ray_fire_calls%10000000) {
-      std::cout << "n_ray_fires="   << n_ray_fire_calls
-                << " n_pt_in_vols=" << n_pt_in_vol_calls << std::endl;
+    ++context.n_ray_fire_calls;
+    if(0==context.n_ray_fire_calls%10000000) {
+      std::cout << "n_ray_fires="   << context.n_ray_fire_calls
+                << " n_pt_in_vols=" << context.n_pt_in_vol_calls << std::endl;
     }
   }
 
@@ -637,9 +697,9 @@ ErrorCode DagMC::ray_fire(const EntityHandle vol,
     dist_limit = user_dist_limit;
 
   // don't recreate these every call
-  std::vector<double>       &dists       = distList;
-  std::vector<EntityHandle> &surfs       = surfList;
-  std::vector<EntityHandle> &facets      = facetList;
+  std::vector<double>       &dists       = context.distList;
+  std::vector<EntityHandle> &surfs       = context.surfList;
+  std::vector<EntityHandle> &facets      = context.facetList;
   dists.clear();
   surfs.clear();
   facets.clear();
@@ -670,13 +730,23 @@ ErrorCode DagMC::ray_fire(const EntityHandle vol,
 
   // numericalPrecision is used for box.intersect_ray and find triangles in the
   // neighborhood of edge/node intersections.
-  rval = obbTree.ray_intersect_sets( dists, surfs, facets,
-                                     root, numericalPrecision,
+  const FlatOBBTree* flat = flat_tree(vol);
+  if (flat)
+    rval = flat->ray_intersect_sets( dists, surfs, facets,
+                                     numericalPrecision,
                                      min_tolerance_intersections,
                                      point, dir, &nonneg_ray_len,
-                                     stats, &neg_ray_len, &vol, &senseTag,
+                                     stats, &neg_ray_len, &vol,
                                      &ray_orientation,
                                      history ? &(history->prev_facets) : NULL );
+  else
+    rval = obbTree.ray_intersect_sets( dists, surfs, facets,
+                                       root, numericalPrecision,
+                                       min_tolerance_intersections,
+                                       point, dir, &nonneg_ray_len,
+                                       stats, &neg_ray_len, &vol, &senseTag,
+                                       &ray_orientation,
+                                       history ? &(history->prev_facets) : NULL );
   assert( MB_SUCCESS == rval );
   if(MB_SUCCESS != rval) return rval;
 
@@ -686,6 +756,105 @@ ErrorCode DagMC::ray_fire(const EntityHandle vol,
     if (MB_SUCCESS != rval) return rval;
   }
 
+  return ray_fire_exit( context, vol, point, dir, dists, surfs, facets,
+                        next_surf, next_surf_dist, history );
+}
+
+ErrorCode DagMC::ray_fire_batch(const EntityHandle vol, int num_rays,
+                                const double* points, const double* dirs,
+                                EntityHandle* next_surfs, double* next_surf_dists,
+                                RayHistory* histories, double user_dist_limit,
+                                int ray_orientation) {
+  return ray_fire_batch( defaultContext, vol, num_rays, points, dirs,
+                         next_surfs, next_surf_dists, histories,
+                         user_dist_limit, ray_orientation );
+}
+
+ErrorCode DagMC::ray_fire_batch(QueryContext& context, const EntityHandle vol,
+                                int num_rays,
+                                const double* points, const double* dirs,
+                                EntityHandle* next_surfs, double* next_surf_dists,
+                                RayHistory* histories, double user_dist_limit,
+                                int ray_orientation) {
+
+  if (num_rays <= 0)
+    return MB_SUCCESS;
+
+  const FlatOBBTree* flat = flat_tree(vol);
+  if (useCAD || debug || !flat) {
+    for (int i = 0; i < num_rays; ++i) {
+      ErrorCode rval = ray_fire( context, vol, points + 3*i, dirs + 3*i,
+                                 next_surfs[i], next_surf_dists[i],
+                                 histories ? histories + i : NULL,
+                                 user_dist_limit, ray_orientation );
+      if (MB_SUCCESS != rval) return rval;
+    }
+    return MB_SUCCESS;
+  }
+
+  if(counting) context.n_ray_fire_calls += num_rays;
+
+  // same limits as in ray_fire
+  const double huge_val = std::numeric_limits<double>::max();
+  double dist_limit = huge_val;
+  if( user_dist_limit > 0 )
+    dist_limit = user_dist_limit;
+  double neg_ray_len;
+  if(0 == overlapThickness) {
+    neg_ray_len = -numericalPrecision;
+  } else {
+    neg_ray_len = -overlapThickness;
+  }
+  double nonneg_ray_len = dist_limit;
+  if(nonneg_ray_len < -neg_ray_len) nonneg_ray_len = -neg_ray_len;
+  const std::vector<double> nonneg_lens( num_rays, nonneg_ray_len );
+  const std::vector<double> neg_lens( num_rays, neg_ray_len );
+
+  // don't recreate these every call
+  std::vector< std::vector<double> > &batchDists = context.batchDists;
+  std::vector< std::vector<EntityHandle> > &batchSurfs = context.batchSurfs;
+  std::vector< std::vector<EntityHandle> > &batchFacets = context.batchFacets;
+  std::vector<const std::vector<EntityHandle>*> &batchPrevFacets = context.batchPrevFacets;
+  if (batchDists.size() < (size_t)num_rays) {
+    batchDists.resize( num_rays );
+    batchSurfs.resize( num_rays );
+    batchFacets.resize( num_rays );
+  }
+  batchPrevFacets.resize( num_rays );
+  for (int i = 0; i < num_rays; ++i) {
+    batchDists[i].clear();
+    batchSurfs[i].clear();
+    batchFacets[i].clear();
+    batchPrevFacets[i] = histories ? &(histories[i].prev_facets) : NULL;
+  }
+
+  const int min_tolerance_intersections = 0;
+  ErrorCode rval = flat->ray_intersect_sets( num_rays, &batchDists[0], &batchSurfs[0],
+                                             &batchFacets[0], numericalPrecision,
+                                             min_tolerance_intersections,
+                                             points, dirs, &nonneg_lens[0], &neg_lens[0],
+                                             &vol, &ray_orientation, &batchPrevFacets[0] );
+  assert( MB_SUCCESS == rval );
+  if(MB_SUCCESS != rval) return rval;
+
+  for (int i = 0; i < num_rays; ++i) {
+    rval = ray_fire_exit( context, vol, points + 3*i, dirs + 3*i,
+                          batchDists[i], batchSurfs[i], batchFacets[i],
+                          next_surfs[i], next_surf_dists[i],
+                          histories ? histories + i : NULL );
+    if(MB_SUCCESS != rval) return rval;
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode DagMC::ray_fire_exit(QueryContext& context, const EntityHandle vol,
+                               const double point[3], const double dir[3],
+                               const std::vector<double>& dists,
+                               const std::vector<EntityHandle>& surfs,
+                               const std::vector<EntityHandle>& facets,
+                               EntityHandle& next_surf, double& next_surf_dist,
+                               RayHistory* history) {
+
   // If no distances are returned, the particle is lost unless the physics limit
   // is being used. If the physics limit is being used, there is no way to tell
   // if the particle is lost. To avoid ambiguity, DO NOT use the distance limit
@@ -716,9 +885,11 @@ ErrorCode DagMC::ray_fire(const EntityHandle vol,
   // particle is inside an overlap.
   int exit_idx = -1;
   if(0!=facets[0]) {
+    ErrorCode rval;
     // get the next volume
-    std::vector<EntityHandle> vols;
+    std::vector<EntityHandle> &vols = context.parentList;
     EntityHandle nx_vol;
+    vols.clear();
     rval = MBI->get_parent_meshsets( surfs[0], vols );
     if(MB_SUCCESS != rval) return rval;
     assert(2 == vols.size());
@@ -732,7 +903,7 @@ ErrorCode DagMC::ray_fire(const EntityHandle vol,
     // "on_boundary" result of the PMT. This avoids a test that uses proximity
     // (a tolerance).
     int result;
-    rval = point_in_volume( nx_vol, point, result, dir, history );
+    rval = point_in_volume( context, nx_vol, point, result, dir, history );
     if(MB_SUCCESS != rval) return rval;
     if(1==result) exit_idx = 0;
 
@@ -778,8 +949,16 @@ ErrorCode DagMC::point_in_volume(const EntityHandle volume,
                                  int& result,
                                  const double *uvw,
                                  const RayHistory *history) {
+  return point_in_volume( defaultContext, volume, xyz, result, uvw, history );
+}
+
+ErrorCode DagMC::point_in_volume(QueryContext& context, const EntityHandle volume,
+                                 const double xyz[3],
+                                 int& result,
+                                 const double *uvw,
+                                 const RayHistory *history) {
   // take some stats that are independent of nps
-  if(counting) ++n_pt_in_vol_calls;
+  if(counting) ++context.n_pt_in_vol_calls;
 
   // get OBB Tree for volume
   assert(volume - setOffset < rootSets.size());
@@ -787,10 +966,10 @@ ErrorCode DagMC::point_in_volume(const EntityHandle volume,
 
   // Don't recreate these every call. These cannot be the same as the ray_fire
   // vectors because both are used simultaneously.
-  std::vector<double>       &dists = disList;
-  std::vector<EntityHandle> &surfs = surList;
-  std::vector<EntityHandle> &facets= facList;
-  std::vector<int>          &dirs  = dirList;
+  std::vector<double>       &dists = context.disList;
+  std::vector<EntityHandle> &surfs = context.surList;
+  std::vector<EntityHandle> &facets= context.facList;
+  std::vector<int>          &dirs  = context.dirList;
   dists.clear();
   surfs.clear();
   facets.clear();
@@ -805,9 +984,9 @@ ErrorCode DagMC::point_in_volume(const EntityHandle volume,
 
   if( u == 0 && v == 0 && w == 0 )
   {
-    u = rand();
-    v = rand();
-    w = rand();
+    u = context.random();
+    v = context.random();
+    w = context.random();
     const double magnitude = sqrt( u*u + v*v + w*w );
     u /= magnitude;
     v /= magnitude;
@@ -833,13 +1012,23 @@ ErrorCode DagMC::point_in_volume(const EntityHandle volume,
 
   // Get intersection(s) of forward and reverse orientation. Do not return
   // glancing intersections or previous facets.
-  ErrorCode rval = obbTree.ray_intersect_sets( dists, surfs, facets, root,
-                                               numericalPrecision,
-                                               min_tolerance_intersections,
-                                               xyz, ray_direction,
-                                               &ray_length, NULL, NULL, &volume,
-                                               &senseTag, NULL,
-                                               history ? &(history->prev_facets) : NULL );
+  ErrorCode rval;
+  const FlatOBBTree* flat = flat_tree(volume);
+  if (flat)
+    rval = flat->ray_intersect_sets( dists, surfs, facets,
+                                     numericalPrecision,
+                                     min_tolerance_intersections,
+                                     xyz, ray_direction,
+                                     &ray_length, NULL, NULL, &volume, NULL,
+                                     history ? &(history->prev_facets) : NULL );
+  else
+    rval = obbTree.ray_intersect_sets( dists, surfs, facets, root,
+                                       numericalPrecision,
+                                       min_tolerance_intersections,
+                                       xyz, ray_direction,
+                                       &ray_length, NULL, NULL, &volume,
+                                       &senseTag, NULL,
+                                       history ? &(history->prev_facets) : NULL );
   if(MB_SUCCESS != rval) return rval;
 
   // determine orientation of all intersections
@@ -923,7 +1112,11 @@ ErrorCode DagMC::test_volume_boundary( const EntityHandle volume, const EntityHa
     const CartVect point(xyz);
     CartVect nearest;
     EntityHandle facet_out;
-    rval = obbTree.closest_to_location( point.array(), root, nearest.array(), facet_out );
+    const FlatOBBTree* flat = flat_tree(volume);
+    if (flat)
+      rval = flat->closest_to_location( point.array(), nearest.array(), facet_out );
+    else
+      rval = obbTree.closest_to_location( point.array(), root, nearest.array(), facet_out );
     if (MB_SUCCESS != rval) return rval;
 
     rval = boundary_case( volume, dir, uvw[0], uvw[1], uvw[2], facet_out, surface );
@@ -985,6 +1178,12 @@ ErrorCode DagMC::point_in_volume_slow( EntityHandle volume, const double xyz[3],
 
 // detemine distance to nearest surface
 ErrorCode DagMC::closest_to_location( EntityHandle volume, const double coords[3], double& result)
+{
+  return closest_to_location( defaultContext, volume, coords, result );
+}
+
+ErrorCode DagMC::closest_to_location( QueryContext&, EntityHandle volume,
+                                      const double coords[3], double& result)
 {
     // Get OBB Tree for volume
   assert(volume - setOffset < rootSets.size());
@@ -994,7 +1193,12 @@ ErrorCode DagMC::closest_to_location( EntityHandle volume, const double coords[3
   const CartVect point(coords);
   CartVect nearest;
   EntityHandle facet_out;
-  ErrorCode rval = obbTree.closest_to_location( point.array(), root, nearest.array(), facet_out );
+  ErrorCode rval;
+  const FlatOBBTree* flat = flat_tree(volume);
+  if (flat)
+    rval = flat->closest_to_location( point.array(), nearest.array(), facet_out );
+  else
+    rval = obbTree.closest_to_location( point.array(), root, nearest.array(), facet_out );
   if (MB_SUCCESS != rval) return rval;
 
   // calculate distance between point and nearest facet
@@ -1215,7 +1419,14 @@ ErrorCode DagMC::get_angle(EntityHandle surf, const double in_pt[3], double angl
 ErrorCode DagMC::next_vol( EntityHandle surface, EntityHandle old_volume,
                            EntityHandle& new_volume )
 {
-  std::vector<EntityHandle> parents;
+  return next_vol( defaultContext, surface, old_volume, new_volume );
+}
+
+ErrorCode DagMC::next_vol( QueryContext& context, EntityHandle surface,
+                           EntityHandle old_volume, EntityHandle& new_volume )
+{
+  std::vector<EntityHandle> &parents = context.parentList;
+  parents.clear();
   ErrorCode rval = MBI->get_parent_meshsets( surface, parents );
 
   if (MB_SUCCESS == rval) {
@@ -10,6 +10,7 @@
 #include <assert.h>
 
 #include "moab/OrientedBoxTreeTool.hpp"
+#include "moab/FlatOBBTree.hpp"
 
 class RefEntity;
 
@@ -130,6 +131,29 @@ public:
    */
   ErrorCode setup_indices();
 
+  /**\brief build flat copies of the volume OBB trees
+   *
+   * Compiles the OBB tree of each volume, including the implicit complement,
+   * into a FlatOBBTree, which ray_fire and point_in_volume then traverse
+   * instead of the tree's entity sets.  Called by init_OBBTree; must be
+   * called again after setup_indices if the trees are rebuilt.
+   */
+  ErrorCode build_flat_trees();
+
+  /** Use the flat OBB trees, if built, in ray_fire and point_in_volume (default true) */
+  void set_use_flat_trees( bool use_flat ) { useFlatTrees = use_flat; }
+  bool use_flat_trees() const { return useFlatTrees; }
+
+  /**\brief settings for building the surface OBB trees
+   *
+   * Used by setup_obbs (and init_OBBTree) when the trees are built,
+   * e.g. to build them with a surface area heuristic by setting
+   * OrientedBoxTreeTool::Settings::sah_bins.  Has no effect on trees
+   * loaded from a file.
+   */
+  void set_obb_settings( const OrientedBoxTreeTool::Settings& settings ) { obbSettings = settings; }
+  const OrientedBoxTreeTool::Settings& obb_settings() const { return obbSettings; }
+
 
 private:
   /** loading code shared by load_file and load_existing_contents */
@@ -196,6 +220,77 @@ public:
 
   };
 
+  /**\brief Per-thread state for geometry queries
+   *
+   * Scratch storage, call counters and the random number state used by
+   * the geometry queries.  The queries that take a QueryContext do not
+   * modify the DagMC instance, so several threads may call them at once,
+   * each with its own context, once the geometry has been set up and
+   * freeze() has been called.  The queries without a context argument use
+   * a context owned by the DagMC instance and must not be called from more
+   * than one thread at a time.
+   *
+   * CAD-based ray firing (set_use_CAD) is not thread-safe.
+   */
+  class QueryContext {
+
+  public:
+    /**\param seed Seed for the random directions used by point_in_volume
+     *        when no direction is given.  If zero, the C library rand() is
+     *        used instead, as for the queries without a context.
+     */
+    QueryContext( unsigned long seed = 0 );
+
+    /** Reset the random direction generator */
+    void set_seed( unsigned long seed );
+
+    /** Number of rays fired with this context, if counting is enabled */
+    long long int num_ray_fire_calls() const { return n_ray_fire_calls; }
+    /** Number of point_in_volume calls with this context, if counting is enabled */
+    long long int num_point_in_volume_calls() const { return n_pt_in_vol_calls; }
+
+  private:
+    /** next value for a random direction component */
+    double random();
+
+    // temporary storage so queries don't have to reallocate vectors
+    // for ray_fire:
+    std::vector<double> distList;
+    std::vector<EntityHandle> surfList, facetList;
+    // for ray_fire_batch:
+    std::vector< std::vector<double> > batchDists;
+    std::vector< std::vector<EntityHandle> > batchSurfs, batchFacets;
+    std::vector<const std::vector<EntityHandle>*> batchPrevFacets;
+    // for point_in_volume:
+    std::vector<double> disList;
+    std::vector<int>    dirList;
+    std::vector<EntityHandle> surList, facList;
+    // for next_vol:
+    std::vector<EntityHandle> parentList;
+
+    // random direction state; zero to use rand()
+    unsigned long long randState;
+
+    // for (optional) counting
+    long long int n_pt_in_vol_calls, n_ray_fire_calls;
+
+    friend class DagMC;
+
+  };
+
+  /**\brief Make the geometry queries safe to call from several threads
+   *
+   * Freezes the MOAB instance (see Core::freeze), so that the mesh
+   * queries done by ray_fire, point_in_volume, closest_to_location,
+   * test_volume_boundary and next_vol may run concurrently.  Call after
+   * the geometry and OBB trees are set up; the mesh must not be modified
+   * until unfreeze() is called.  Fails if the MOAB instance is not a Core.
+   */
+  ErrorCode freeze();
+
+  /** Allow the mesh to be modified again after freeze() */
+  ErrorCode unfreeze();
+
   /**\brief find the next surface crossing from a given point in a given direction
    *
    * This is the primary method of DagMC, enabling ray tracing through a geometry.
@@ -240,6 +335,47 @@ public:
 		     int ray_orientation = 1,
                      OrientedBoxTreeTool::TrvStats* stats = NULL );
 
+  /** ray_fire using the given per-thread context */
+  ErrorCode ray_fire(QueryContext& context, const EntityHandle volume,
+                     const double ray_start[3], const double ray_dir[3],
+                     EntityHandle& next_surf, double& next_surf_dist,
+                     RayHistory* history = NULL, double dist_limit = 0,
+                     int ray_orientation = 1,
+                     OrientedBoxTreeTool::TrvStats* stats = NULL );
+
+  /**\brief Find the next surface crossings for a batch of rays in one volume
+   *
+   * Same as calling ray_fire for each ray, with the same results, but the
+   * rays are traced together through the flat OBB tree of the volume in
+   * packets (see FlatOBBTree).  This saves work on large models when many
+   * rays have similar directions, such as rays from a common source.
+   * Falls back to ray_fire for each ray if the volume has no flat tree or
+   * CAD-based ray firing is enabled.
+   *
+   * @param volume The volume to fire the rays at.
+   * @param num_rays The number of rays.
+   * @param ray_starts 3*num_rays coordinates of the ray starting points.
+   * @param ray_dirs 3*num_rays components of the unit ray directions.
+   * @param next_surfs Output array of num_rays next surfaces, 0 for no intersection.
+   * @param next_surf_dists Output array of num_rays distances to next_surfs.
+   * @param histories Optional array of num_rays RayHistory objects, used and
+   *                updated as by ray_fire.
+   * @param dist_limit Optional distance limit for all rays, as for ray_fire.
+   * @param ray_orientation Optional ray orientation for all rays, as for ray_fire.
+   */
+  ErrorCode ray_fire_batch(const EntityHandle volume, int num_rays,
+                           const double* ray_starts, const double* ray_dirs,
+                           EntityHandle* next_surfs, double* next_surf_dists,
+                           RayHistory* histories = NULL, double dist_limit = 0,
+                           int ray_orientation = 1 );
+
+  /** ray_fire_batch using the given per-thread context */
+  ErrorCode ray_fire_batch(QueryContext& context, const EntityHandle volume, int num_rays,
+                           const double* ray_starts, const double* ray_dirs,
+                           EntityHandle* next_surfs, double* next_surf_dists,
+                           RayHistory* histories = NULL, double dist_limit = 0,
+                           int ray_orientation = 1 );
+
   /**\brief Test if a point is inside or outside a volume
    *
    * This method finds the point on the boundary of the volume that is nearest
@@ -261,6 +397,13 @@ public:
                             const double* uvw = NULL,
                             const RayHistory* history = NULL );
 
+  /** point_in_volume using the given per-thread context */
+  ErrorCode point_in_volume(QueryContext& context, const EntityHandle volume,
+                            const double xyz[3],
+                            int& result,
+                            const double* uvw = NULL,
+                            const RayHistory* history = NULL );
+
   /**\brief Robust test if a point is inside or outside a volume using unit sphere area method
    *
    * This test may be more robust that the standard point_in_volume, but is much slower.
@@ -300,6 +443,10 @@ public:
    */
   ErrorCode closest_to_location( EntityHandle volume, const double point[3], double& result);
 
+  /** closest_to_location using the given per-thread context */
+  ErrorCode closest_to_location( QueryContext& context, EntityHandle volume,
+                                 const double point[3], double& result);
+
   /** Calculate the volume contained in a 'volume' */
   ErrorCode measure_volume( EntityHandle volume, double& result );
 
@@ -341,7 +488,25 @@ public:
   ErrorCode next_vol( EntityHandle surface, EntityHandle old_volume,
                       EntityHandle& new_volume );
 
+  /** next_vol using the given per-thread context */
+  ErrorCode next_vol( QueryContext& context, EntityHandle surface,
+                      EntityHandle old_volume, EntityHandle& new_volume );
+
 private:
+  /**\brief choose the exit intersection from the results of ray_intersect_sets
+   *
+   * The last part of ray_fire, shared with ray_fire_batch: checks a
+   * negative-distance intersection for an overlap, and sets the next
+   * surface and distance, and the history.
+   */
+  ErrorCode ray_fire_exit(QueryContext& context, const EntityHandle vol,
+                          const double point[3], const double dir[3],
+                          const std::vector<double>& dists,
+                          const std::vector<EntityHandle>& surfs,
+                          const std::vector<EntityHandle>& facets,
+                          EntityHandle& next_surf, double& next_surf_dist,
+                          RayHistory* history);
+
   /**\brief pass the ray_intersection test to the solid modeling engine
    *
    * The user has the options to specify that ray tracing should ultimately occur on the
@@ -569,6 +734,8 @@ private:
 
   DagMC(Interface *mb_impl);
 
+  const FlatOBBTree* flat_tree(EntityHandle vol) const;
+
   static void create_instance(Interface *mb_impl = NULL);
 
   /* PRIVATE MEMBER DATA */
@@ -578,6 +745,7 @@ private:
   Interface *mbImpl;
 
   OrientedBoxTreeTool obbTree;
+  OrientedBoxTreeTool::Settings obbSettings;
   EntityHandle impl_compl_handle;
   Tag obbTag, geomTag, idTag, nameTag, senseTag, facetingTolTag;
 
@@ -589,6 +757,9 @@ private:
     // list of obbTree root sets for surfaces and volumes,
     // indexed by [surf_or_vol_handle - setOffset]
   std::vector<EntityHandle> rootSets;
+    // flat copies of the volume trees, indexed like rootSets (empty for surfaces)
+  std::vector<FlatOBBTree> flatTrees;
+  bool useFlatTrees;
     // entity index (contiguous 1-N indices) indexed like rootSets are
   std::vector<int> entIndices;
 
@@ -609,17 +780,8 @@ private:
   bool useCAD;         /// true if user requested CAD-based ray firing
   bool have_cgm_geom;  /// true if CGM contains problem geometry; required for CAD-based ray firing.
 
-  // temporary storage so functions don't have to reallocate vectors
-  // for ray_fire:
-  std::vector<double> distList;
-  std::vector<EntityHandle> prevFacetList, surfList, facetList;
-  // for point_in_volume:
-  std::vector<double> disList;
-  std::vector<int>    dirList;
-  std::vector<EntityHandle> surList, facList;
-
-  // for (optional) counting
-  long long int n_pt_in_vol_calls, n_ray_fire_calls;
+  // query state for the calls without a context
+  QueryContext defaultContext;
 
 };
 
@@ -670,6 +832,15 @@ inline ErrorCode DagMC::get_root(EntityHandle vol_or_surf, EntityHandle &root)
   return (root ? MB_SUCCESS : MB_INDEX_OUT_OF_RANGE);
 }
 
+    // get the flat tree for a volume, or NULL if not built or not used
+inline const FlatOBBTree* DagMC::flat_tree(EntityHandle vol) const
+{
+  unsigned int index = vol - setOffset;
+  if (!useFlatTrees || index >= flatTrees.size() || flatTrees[index].empty())
+    return NULL;
+  return &flatTrees[index];
+}
+
 } // namespace moab
 
 #endif
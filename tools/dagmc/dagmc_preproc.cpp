@@ -298,6 +298,7 @@ int main( int argc, char* argv[] ){
   std::string input_file;
   std::string output_file = "dagmc_preproc_out.h5m";
   int grid = 50;
+  int sah_bins = 0, compare_rays = 10000;
 
   po.addOpt<void>( ",v", "Verbose output", &verbose );
   po.addOpt<std::string>( "outmesh,o", "Specify output file name (default "+output_file+")", &output_file );
@@ -306,7 +307,10 @@ int main( int argc, char* argv[] ){
   po.addOpt<std::string>( "obb-vis,O", "Specify obb visualization output file (default none)" );
   po.addOpt<int>( "obb-vis-divs", "Resolution of obb visualization grid (default 50)", &grid );
   po.addOpt<void>( "obb-stats,S", "Print obb statistics.  With -v, print verbose statistics." );
-  po.addOpt<std::vector<int> >( "vols,V", "Specify a set of volumes (applies to --obb_vis and --obb_stats, default all)" );
+  po.addOpt<int>( "obb-sah", "Build obb trees with a binned surface area heuristic with this many bins (default 0: split at box centers)", &sah_bins );
+  po.addOpt<void>( "obb-compare,C", "Compare build and query times of obb trees split at box centers and with a surface area heuristic" );
+  po.addOpt<int>( "obb-compare-rays", "Number of rays per volume for --obb-compare (default 10000)", &compare_rays );
+  po.addOpt<std::vector<int> >( "vols,V", "Specify a set of volumes (applies to --obb_vis, --obb_stats and --obb-compare, default all)" );
   po.addOpt<void>( "mcnp5-props", "Update MCNP5 property names" );
   po.addOptionHelpHeading("Options for loading CAD files");
   po.addOpt<double>( "ftol,f", "Faceting distance tolerance", po.add_cancel_opt );
@@ -321,7 +325,11 @@ int main( int argc, char* argv[] ){
   po.parseCommandLine( argc, argv );
 
   /* Check that user has asked for at least one useful thing to be done */
-  bool obb_task = po.numOptSet( "obb-vis" ) || po.numOptSet( "obb-stats" );
+  bool obb_task = po.numOptSet( "obb-vis" ) || po.numOptSet( "obb-stats" ) ||
+                  po.numOptSet( "obb-compare" );
+  if( sah_bins < 0 || sah_bins == 1 ){
+    po.error( "--obb-sah must be zero or at least 2" );
+  }
 
   if( po.numOptSet("no-outmesh") && !obb_task ){
     po.error( "Nothing to do.  Please specify an OBB-related option, or remove --no_outmesh." );
@@ -455,6 +463,9 @@ int main( int argc, char* argv[] ){
    DagMC* dag = DagMC::instance(&mbi);
    ret = dag->load_existing_contents();
    CHECKERR( *dag, ret );
+   OrientedBoxTreeTool::Settings obb_settings;
+   obb_settings.sah_bins = sah_bins;
+   dag->set_obb_settings( obb_settings );
    ret = dag->init_OBBTree();
    CHECKERR( *dag, ret );
 
@@ -508,6 +519,13 @@ int main( int argc, char* argv[] ){
      CHECKERR(mbi, ret);
    }
 
+   if( po.numOptSet( "obb-compare" ) ){
+     if( verbose ){ std::cout << "Comparing OBB trees" << std::endl; }
+
+     ret = obbcompare_write( *dag, vols, compare_rays, sah_bins ? sah_bins : 16, std::cout );
+     CHECKERR(mbi, ret);
+   }
+
   }
 
   
@@ -25,6 +25,8 @@ void chkerr( DagMC& dag, ErrorCode code, int line, const char* file );
 ErrorCode obbvis_create( DagMC& dag, std::vector<int> &volumes, int grid, std::string& filename );
 ErrorCode obbstat_write( DagMC& dag, std::vector<int> &volumes, 
                          std::vector<std::string> &properties, std::ostream& out );
+ErrorCode obbcompare_write( DagMC& dag, std::vector<int> &volumes, int num_rays,
+                            int sah_bins, std::ostream& out );
 
 
 #endif /* DAGMC_PREPROC_H */
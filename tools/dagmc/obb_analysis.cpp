@@ -1,6 +1,10 @@
 #include <iostream>
+#include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <stdlib.h>
+#include <time.h>
 
 #include "dagmc_preproc.hpp"
 #include "DagMC.hpp"
@@ -385,3 +389,168 @@ ErrorCode obbstat_write( DagMC& dag, std::vector<int> &volumes,
 
   return ret;
 }
+
+// Build an OBB tree for a volume from trees over its surfaces, as
+// DagMC::build_obbs does, with the given settings for the surface trees.
+static ErrorCode build_volume_tree( DagMC& dag, OrientedBoxTreeTool& tool, EntityHandle vol,
+                                    const OrientedBoxTreeTool::Settings& settings,
+                                    EntityHandle& root )
+{
+  Interface* mbi = dag.moab_instance();
+  Range surfs, trees;
+  ErrorCode rval = mbi->get_child_meshsets( vol, surfs );
+  if( MB_SUCCESS != rval ) return rval;
+
+  for( Range::iterator i = surfs.begin(); i != surfs.end(); ++i ){
+    int sense;
+    rval = dag.surface_sense( vol, *i, sense );
+    if( MB_SUCCESS != rval ) return rval;
+    if( !sense ) continue;
+
+    Range tris;
+    rval = mbi->get_entities_by_dimension( *i, 2, tris );
+    if( MB_SUCCESS != rval ) return rval;
+    EntityHandle surf_root;
+    rval = tool.build( tris, surf_root, &settings );
+    if( MB_SUCCESS != rval ) return rval;
+    rval = mbi->add_entities( surf_root, &*i, 1 );
+    if( MB_SUCCESS != rval ) return rval;
+    trees.insert( surf_root );
+  }
+
+  return tool.join_trees( trees, root, &settings );
+}
+
+// Results of one tree for obbcompare_write
+struct TreeTiming {
+  double build_time, ray_time, flat_ray_time, closest_time;
+  unsigned long nodes, tri_tests;
+  std::vector<double> ray_dists, closest_dists;
+};
+
+static ErrorCode time_volume_tree( DagMC& dag, EntityHandle vol,
+                                   const OrientedBoxTreeTool::Settings& settings,
+                                   const std::vector<CartVect>& points,
+                                   const std::vector<CartVect>& dirs,
+                                   TreeTiming& result )
+{
+  OrientedBoxTreeTool tool( dag.moab_instance(), "OBB_COMPARE", true );
+  Tag sense_tag = dag.sense_tag();
+  EntityHandle root;
+
+  clock_t t0 = clock();
+  ErrorCode rval = build_volume_tree( dag, tool, vol, settings, root );
+  if( MB_SUCCESS != rval ) return rval;
+  result.build_time = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  // rays as fired by point_in_volume
+  const double ray_length = 1e15;
+  const double tol = dag.numerical_precision();
+  std::vector<double> dists;
+  std::vector<EntityHandle> sets, facets;
+  OrientedBoxTreeTool::TrvStats stats;
+  result.ray_dists.resize( points.size() );
+  t0 = clock();
+  for( size_t i = 0; i < points.size(); ++i ){
+    dists.clear(); sets.clear(); facets.clear();
+    rval = tool.ray_intersect_sets( dists, sets, facets, root, tol, 1,
+                                    points[i].array(), dirs[i].array(), &ray_length,
+                                    &stats, NULL, &vol, &sense_tag );
+    if( MB_SUCCESS != rval ) return rval;
+    result.ray_dists[i] = dists.empty() ? -1.0 : *std::min_element( dists.begin(), dists.end() );
+  }
+  result.ray_time = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  result.nodes = 0;
+  for( size_t i = 0; i < stats.nodes_visited().size(); ++i )
+    result.nodes += stats.nodes_visited()[i];
+  result.tri_tests = stats.ray_tri_tests();
+
+  // the same rays on the flat copy of the tree, as DagMC uses
+  FlatOBBTree flat;
+  rval = flat.build( &tool, root, &sense_tag );
+  if( MB_SUCCESS != rval ) return rval;
+  t0 = clock();
+  for( size_t i = 0; i < points.size(); ++i ){
+    dists.clear(); sets.clear(); facets.clear();
+    rval = flat.ray_intersect_sets( dists, sets, facets, tol, 1,
+                                    points[i].array(), dirs[i].array(), &ray_length,
+                                    NULL, NULL, &vol );
+    if( MB_SUCCESS != rval ) return rval;
+  }
+  result.flat_ray_time = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  result.closest_dists.resize( points.size() );
+  t0 = clock();
+  for( size_t i = 0; i < points.size(); ++i ){
+    CartVect closest;
+    EntityHandle facet;
+    rval = tool.closest_to_location( points[i].array(), root, closest.array(), facet );
+    if( MB_SUCCESS != rval ) return rval;
+    result.closest_dists[i] = (closest - points[i]).length();
+  }
+  result.closest_time = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  return MB_SUCCESS;
+}
+
+ErrorCode obbcompare_write( DagMC& dag, std::vector<int> &volumes, int num_rays,
+                            int sah_bins, std::ostream& out ){
+
+  OrientedBoxTreeTool::Settings median_settings, sah_settings;
+  sah_settings.sah_bins = sah_bins;
+
+  out << "Comparing OBB trees split at the box center (median) and with a "
+      << sah_bins << "-bin surface area heuristic (SAH), "
+      << num_rays << " random rays and closest points per volume" << std::endl;
+
+  ErrorCode ret = MB_SUCCESS;
+  srand( 12345 );
+  for( std::vector<int>::iterator i = volumes.begin(); i!=volumes.end(); ++i){
+    EntityHandle vol = dag.entity_by_id(3,*i);
+    if( vol == 0 || dag.is_implicit_complement(vol) ) continue;
+
+    // random points in the volume's bounding box, with random directions
+    CartVect min, max;
+    ret = dag.getobb( vol, min.array(), max.array() );
+    CHECKERR(dag,ret);
+    std::vector<CartVect> points( num_rays ), dirs( num_rays );
+    for( int j = 0; j < num_rays; ++j ){
+      for( int d = 0; d < 3; ++d ){
+        points[j][d] = min[d] + (max[d] - min[d]) * rand() / RAND_MAX;
+        dirs[j][d] = 2.0 * rand() / RAND_MAX - 1.0;
+      }
+      dirs[j].normalize();
+    }
+
+    TreeTiming median, sah;
+    ret = time_volume_tree( dag, vol, median_settings, points, dirs, median );
+    CHECKERR(dag,ret);
+    ret = time_volume_tree( dag, vol, sah_settings, points, dirs, sah );
+    CHECKERR(dag,ret);
+
+    int mismatches = 0;
+    for( int j = 0; j < num_rays; ++j ){
+      if( median.ray_dists[j] != sah.ray_dists[j] ) ++mismatches;
+      if( median.closest_dists[j] != sah.closest_dists[j] ) ++mismatches;
+    }
+
+    out << "\nVolume " << *i << std::endl;
+    out << std::setw(8) << "tree" << std::setw(12) << "build (s)" << std::setw(12) << "rays (s)"
+        << std::setw(12) << "flat (s)" << std::setw(12) << "closest (s)"
+        << std::setw(12) << "nodes/ray" << std::setw(12) << "tris/ray" << std::endl;
+    const TreeTiming* t[2] = { &median, &sah };
+    const char* names[2] = { "median", "SAH" };
+    for( int j = 0; j < 2; ++j ){
+      out << std::setw(8) << names[j] << std::setw(12) << t[j]->build_time
+          << std::setw(12) << t[j]->ray_time << std::setw(12) << t[j]->flat_ray_time
+          << std::setw(12) << t[j]->closest_time
+          << std::setw(12) << (double)t[j]->nodes / num_rays
+          << std::setw(12) << (double)t[j]->tri_tests / num_rays << std::endl;
+    }
+    if( mismatches )
+      out << "Warning: " << mismatches << " queries differ between the trees" << std::endl;
+  }
+
+  return ret;
+}
@@ -310,6 +310,8 @@ int main( int argc, char* argv[] )
   get_time_mem(ttime1, utime1, stime1, tmem1);
 
   srand( randseed );
+  std::vector<EntityHandle> flat_surfs( num_random_rays > 0 ? num_random_rays : 0 );
+  std::vector<double> flat_dists( flat_surfs.size() );
 
 #ifdef DEBUG
   double uavg = 0.0, vavg = 0.0, wavg = 0.0;
@@ -332,7 +334,8 @@ int main( int argc, char* argv[] )
     dagmc.ray_fire(vol, xyz.array(), uvw.array(), surf, dist, NULL, 0, 1, trv_stats );
 
     if( surf == 0){ random_rays_missed++; }
-
+    flat_surfs[j] = surf;
+    flat_dists[j] = dist;
   }
   get_time_mem(ttime2, utime2, stime2, tmem1);
   double timewith = ttime2 - ttime1;
@@ -352,8 +355,69 @@ int main( int argc, char* argv[] )
   get_time_mem(ttime1, utime1, stime1, tmem2);
   double timewithout = ttime1 - ttime2;
 
+    // fire the same rays again, traversing the OBB tree's entity sets
+    // instead of the flat tree, and compare the results
+  int obb_mismatches = 0;
+  dagmc.set_use_flat_trees( false );
+  srand(randseed);
+  for (int j = 0; j < num_random_rays; j++) {
+    RNDVEC(uvw, location_az);
+
+    xyz = uvw * source_rad + ray_source;
+    if (source_rad >= 0.0) {
+      RNDVEC(uvw, direction_az);
+    }
+
+    dagmc.ray_fire(vol, xyz.array(), uvw.array(), surf, dist, NULL, 0, 1 );
+
+    if( surf != flat_surfs[j] || (surf && dist != flat_dists[j]) ){ obb_mismatches++; }
+  }
+  dagmc.set_use_flat_trees( true );
+
+  get_time_mem(ttime2, utime2, stime2, tmem1);
+  double timeobb = ttime2 - ttime1;
+
+    // fire the same rays again as one batch, and compare the results
+  int batch_mismatches = 0;
+  double timebatch = 0.0;
+  if( num_random_rays > 0 ){
+    std::vector<double> points( 3*num_random_rays ), dirs( 3*num_random_rays );
+    srand(randseed);
+    for (int j = 0; j < num_random_rays; j++) {
+      RNDVEC(uvw, location_az);
+
+      xyz = uvw * source_rad + ray_source;
+      if (source_rad >= 0.0) {
+        RNDVEC(uvw, direction_az);
+      }
+      xyz.get( &points[3*j] );
+      uvw.get( &dirs[3*j] );
+    }
+
+    std::vector<EntityHandle> batch_surfs( num_random_rays );
+    std::vector<double> batch_dists( num_random_rays );
+    get_time_mem(ttime1, utime1, stime1, tmem1);
+    dagmc.ray_fire_batch( vol, num_random_rays, &points[0], &dirs[0],
+                          &batch_surfs[0], &batch_dists[0] );
+    get_time_mem(ttime2, utime2, stime2, tmem1);
+    timebatch = ttime2 - ttime1;
+
+    for (int j = 0; j < num_random_rays; j++) {
+      if( batch_surfs[j] != flat_surfs[j] ||
+          (batch_surfs[j] && batch_dists[j] != flat_dists[j]) ){ batch_mismatches++; }
+    }
+  }
+
   std::cout << " done." << std::endl;
 
+  if( obb_mismatches ){
+    std::cout << "Warning: " << obb_mismatches << " random rays gave different results with the flat tree" << std::endl;
+  }
+
+  if( batch_mismatches ){
+    std::cout << "Warning: " << batch_mismatches << " random rays gave different results in a batch" << std::endl;
+  }
+
   if( random_rays_missed ){
     std::cout << "Warning: " << random_rays_missed << " random rays did not hit the target volume" << std::endl;
   }
@@ -363,6 +427,14 @@ int main( int argc, char* argv[] )
 	      << " sec" << std::endl;
     std::cout << "Estimated time per call (excluding ray generation): " 
 	      << (timewith - timewithout) / num_random_rays << " sec" << std::endl;
+    if( timewith > timewithout && timeobb > timewithout ){
+      std::cout << "Rays/sec (excluding ray generation), flat tree: "
+                << num_random_rays / (timewith - timewithout)
+                << ", OBB tree sets: " << num_random_rays / (timeobb - timewithout) << std::endl;
+    }
+    if( timebatch > 0 ){
+      std::cout << "Rays/sec in a batch (flat tree): " << num_random_rays / timebatch << std::endl;
+    }
   }
   std::cout << "Program memory used: " 
             << tmem2 << " bytes (" << tmem2/(1024*1024) << " MB)" << std::endl;
@@ -0,0 +1,290 @@
+#include "moab/Interface.hpp"
+#include "moab/Core.hpp"
+#include "moab/CartVect.hpp"
+#include "moab/ProgOptions.hpp"
+#include "moab/CpuTimer.hpp"
+#include "DagMC.hpp"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+using namespace moab;
+
+/* Multi-threaded throughput test for the DagMC geometry queries.  Tracks
+ * a number of particle histories through the geometry: each history starts
+ * at a source point in a volume with a random direction, and alternates
+ * ray_fire to the next surface with next_vol at surface crossings, and
+ * exponentially distributed collisions at which it changes direction and
+ * checks point_in_volume and closest_to_location.  A history ends when it
+ * leaves the geometry (enters the implicit complement), is lost, or after a
+ * maximum number of steps.  Each history has its own random number
+ * sequence, so the same histories are run with 1 to the given number of
+ * threads, each thread with its own DagMC::QueryContext, and the results
+ * are compared with the single-threaded run.
+ *
+ * Usage: ray_thread_test [options] filename
+ */
+
+static DagMC* dag;
+static EntityHandle source_vol;
+static CartVect source;
+static double mfp;
+static int num_histories = 10000;
+static int max_steps = 100;
+
+struct HistoryResult {
+  int steps, crossings, collisions;
+  EntityHandle last_vol;
+  bool lost;
+  int pt_in_vol_errors;
+  double track_length, closest_sum;
+};
+
+  // Random number generator of one history
+class HistoryRandom {
+  public:
+    HistoryRandom( int history ) : state( 2*(unsigned long long)history + 1 )
+      { for (int i = 0; i < 4; ++i) uniform(); }
+
+      // uniform in (0,1)
+    double uniform() {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      return ((state >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+    void direction( CartVect& dir ) {
+      const double theta = 2.0 * M_PI * uniform();
+      const double u = 2.0 * uniform() - 1.0;
+      dir[0] = sqrt(1 - u*u) * cos(theta);
+      dir[1] = sqrt(1 - u*u) * sin(theta);
+      dir[2] = u;
+    }
+
+  private:
+    unsigned long long state;
+};
+
+static ErrorCode run_history( DagMC::QueryContext& context, int history, HistoryResult& result )
+{
+  HistoryRandom rng( history );
+  CartVect pos = source, dir;
+  rng.direction( dir );
+  EntityHandle vol = source_vol;
+  DagMC::RayHistory ray_history;
+
+  result.steps = result.crossings = result.collisions = 0;
+  result.lost = false;
+  result.pt_in_vol_errors = 0;
+  result.track_length = result.closest_sum = 0.0;
+
+  ErrorCode rval = MB_SUCCESS;
+  for (; result.steps < max_steps; ++result.steps) {
+    const double collision = -mfp * log( rng.uniform() );
+    EntityHandle surf;
+    double dist;
+    rval = dag->ray_fire( context, vol, pos.array(), dir.array(), surf, dist, &ray_history );
+    if (MB_SUCCESS != rval) break;
+    if (!surf) {
+      result.lost = true;
+      break;
+    }
+
+    if (dist > collision) {
+        // collide in this volume, and change direction
+      pos += collision * dir;
+      result.track_length += collision;
+      ++result.collisions;
+      rng.direction( dir );
+      ray_history.reset();
+
+      int inside;
+      rval = dag->point_in_volume( context, vol, pos.array(), inside, dir.array() );
+      if (MB_SUCCESS != rval) break;
+      if (1 != inside)
+        ++result.pt_in_vol_errors;
+
+      double closest;
+      rval = dag->closest_to_location( context, vol, pos.array(), closest );
+      if (MB_SUCCESS != rval) break;
+      result.closest_sum += closest;
+    }
+    else {
+        // cross the surface into the next volume
+      pos += dist * dir;
+      result.track_length += dist;
+      ++result.crossings;
+      rval = dag->next_vol( context, surf, vol, vol );
+      if (MB_SUCCESS != rval) break;
+      if (dag->is_implicit_complement( vol )) {
+        ++result.steps;
+        break;
+      }
+    }
+  }
+
+  result.last_vol = vol;
+  return rval;
+}
+
+struct ThreadData {
+  pthread_t thread;
+  int first, stride;
+  std::vector<HistoryResult>* results;
+  ErrorCode rval;
+};
+
+static void* run_thread( void* ptr )
+{
+  ThreadData* data = reinterpret_cast<ThreadData*>(ptr);
+  DagMC::QueryContext context( data->first + 1 );
+  data->rval = MB_SUCCESS;
+  for (int h = data->first; h < num_histories; h += data->stride) {
+    ErrorCode rval = run_history( context, h, (*data->results)[h] );
+    if (MB_SUCCESS != rval)
+      data->rval = rval;
+  }
+  return 0;
+}
+
+  // Run all histories with the given number of threads, returning the time
+static double run_histories( int num_threads, std::vector<HistoryResult>& results )
+{
+  results.resize( num_histories );
+  std::vector<ThreadData> threads( num_threads );
+  double t0 = CpuTimer::wall_time();
+  for (int i = 0; i < num_threads; ++i) {
+    threads[i].first = i;
+    threads[i].stride = num_threads;
+    threads[i].results = &results;
+    if (pthread_create( &threads[i].thread, 0, run_thread, &threads[i] )) {
+      std::cerr << "Failed to create thread " << i << std::endl;
+      exit( 2 );
+    }
+  }
+  for (int i = 0; i < num_threads; ++i)
+    pthread_join( threads[i].thread, 0 );
+  double t1 = CpuTimer::wall_time();
+
+  for (int i = 0; i < num_threads; ++i)
+    if (MB_SUCCESS != threads[i].rval) {
+      std::cerr << "Query failed in thread " << i << std::endl;
+      exit( 2 );
+    }
+  return t1 - t0;
+}
+
+static bool same_results( const std::vector<HistoryResult>& a, const std::vector<HistoryResult>& b )
+{
+  for (size_t i = 0; i < a.size(); ++i)
+    if (a[i].steps != b[i].steps || a[i].crossings != b[i].crossings ||
+        a[i].collisions != b[i].collisions || a[i].last_vol != b[i].last_vol ||
+        a[i].lost != b[i].lost || a[i].pt_in_vol_errors != b[i].pt_in_vol_errors ||
+        a[i].track_length != b[i].track_length || a[i].closest_sum != b[i].closest_sum)
+      return false;
+  return true;
+}
+
+int main( int argc, char* argv[] )
+{
+  ProgOptions po( "Track particle histories through a DagMC geometry with several threads" );
+  std::string filename;
+  int vol_index = 1, max_threads = 4;
+  std::string center;
+  po.addRequiredArg<std::string>( "input_file", "Path to input file", &filename );
+  po.addOpt<int>( "histories,n", "Number of histories (default 10000)", &num_histories );
+  po.addOpt<int>( "threads,t", "Maximum number of threads (default 4)", &max_threads );
+  po.addOpt<int>( "steps,s", "Maximum number of steps in a history (default 100)", &max_steps );
+  po.addOpt<int>( "vol,i", "Index of the source volume (default 1)", &vol_index );
+  po.addOpt<std::string>( "center,c", "Source point x,y,z (default: center of the volume box)", &center );
+  po.addOpt<double>( "mfp,m", "Mean free path (default: 1/10 of the volume box diagonal)" );
+  po.parseCommandLine( argc, argv );
+
+  dag = DagMC::instance();
+  ErrorCode rval = dag->load_file( filename.c_str() );
+  if (MB_SUCCESS != rval) {
+    std::cerr << "Failed to load file: " << filename << std::endl;
+    return 2;
+  }
+  rval = dag->init_OBBTree();
+  if (MB_SUCCESS != rval) {
+    std::cerr << "Failed to initialize DagMC" << std::endl;
+    return 2;
+  }
+
+  if (vol_index < 1 || vol_index > dag->num_entities(3)) {
+    std::cerr << "Invalid volume index: " << vol_index << std::endl;
+    return 2;
+  }
+  source_vol = dag->entity_by_index( 3, vol_index );
+  CartVect box_min, box_max;
+  rval = dag->getobb( source_vol, box_min.array(), box_max.array() );
+  if (MB_SUCCESS != rval) {
+    std::cerr << "Failed to get volume box" << std::endl;
+    return 2;
+  }
+  if (!center.empty()) {
+    if (3 != sscanf( center.c_str(), "%lf,%lf,%lf", &source[0], &source[1], &source[2] )) {
+      std::cerr << "Invalid source point: " << center << std::endl;
+      return 2;
+    }
+  }
+  else
+    source = 0.5 * (box_min + box_max);
+  if (!po.getOpt( "mfp", &mfp ))
+    mfp = 0.1 * (box_max - box_min).length();
+
+  int inside;
+  rval = dag->point_in_volume( source_vol, source.array(), inside );
+  if (MB_SUCCESS != rval || 1 != inside) {
+    std::cerr << "Source point is not in volume " << vol_index << std::endl;
+    return 2;
+  }
+
+    // the queries done by the histories do not modify the mesh
+  rval = dag->freeze();
+  if (MB_SUCCESS != rval) {
+    std::cerr << "Failed to freeze the MOAB instance" << std::endl;
+    return 2;
+  }
+
+  std::vector<HistoryResult> ref, results;
+  double t_ref = run_histories( 1, ref );
+  long steps = 0, lost = 0, errors = 0;
+  for (int i = 0; i < num_histories; ++i) {
+    steps += ref[i].steps;
+    lost += ref[i].lost;
+    errors += ref[i].pt_in_vol_errors;
+  }
+  std::cout << num_histories << " histories, " << steps << " steps, "
+            << lost << " lost, " << errors << " point_in_volume errors" << std::endl;
+
+  std::cout << std::setw(8) << "threads" << std::setw(12) << "time"
+            << std::setw(14) << "steps/sec" << std::setw(10) << "speedup" << std::endl;
+  bool ok = true;
+  for (int t = 1; t <= max_threads; t *= 2) {
+    double time = t_ref;
+    if (t > 1) {
+      time = run_histories( t, results );
+      if (!same_results( ref, results ))
+        ok = false;
+    }
+    std::cout << std::setw(8) << t << std::setw(12) << std::setprecision(4) << time
+              << std::setw(14) << std::setprecision(6) << steps / time
+              << std::setw(10) << std::setprecision(3) << t_ref / time << std::endl;
+  }
+
+  dag->unfreeze();
+  DagMC::destroy();
+
+  if (!ok) {
+    std::cerr << "Threaded histories differ from single-threaded histories" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -18,7 +18,7 @@
 static void usage( const char* argv0, bool help = false )
 {
   std::ostream& str = help ? std::cout : std::cerr;
-  str << "Usage: " << argv0 << " [-H|-b|-k|-m] <filename> [<filename> ...]" << std::endl
+  str << "Usage: " << argv0 << " [-H|-b|-k|-m] [-a] <filename> [<filename> ...]" << std::endl
       << "       " << argv0 << " [-H|-b|-k|-m] -T" << std::endl;
   if (!help) {
     str << "       " << argv0 << " -h" << std::endl;
@@ -30,6 +30,7 @@ static void usage( const char* argv0, bool help = false )
             << "  -k : kilobytes (1 kB == 1024 bytes)" << std::endl
             << "  -m : megabytes (1 MB == 1024 kB)" << std::endl
             << "  -g : gigabytes (1 GB == 1024 MB)" << std::endl
+            << "  -a : also report memory use after compacting adjacencies" << std::endl
             << "  -T : test mode" << std::endl
             << std::endl;
   std::exit(0);
@@ -54,6 +55,7 @@ int main( int argc, char* argv[] )
   moab::ErrorCode rval;
   bool no_more_flags = false;
   bool test_mode = false;
+  bool compact_adj = false;
   std::vector<int> input_file_list;
 
     // load each file specified on command line
@@ -69,6 +71,8 @@ int main( int argc, char* argv[] )
         UNITS = MEGABYTES;
       else if(!strcmp(argv[i],"-g"))
         UNITS = GIGABYTES;
+      else if(!strcmp(argv[i],"-a"))
+        compact_adj = true;
       else if(!strcmp(argv[i],"-T"))
         test_mode = true;
       else if(!strcmp(argv[i],"-h"))
@@ -111,6 +115,25 @@ int main( int argc, char* argv[] )
   
     // print summary of MOAB's memory use
   print_memory_stats(mb);
+  
+    // build vertex-to-element adjacencies and compare per-entity
+    // storage with the compact (CSR) storage
+  if (compact_adj) {
+    moab::Range verts;
+    std::vector<moab::EntityHandle> adj_vec;
+    mb.get_entities_by_type( 0, moab::MBVERTEX, verts );
+    if (!verts.empty())
+      mb.get_adjacencies( &*verts.begin(), 1, 2, false, adj_vec );
+    std::cout << std::endl << "Created vertex-to-element adjacencies" << std::endl;
+    print_memory_stats( mb, true, false, true, true );
+    rval = mbcore.compact_adjacencies();
+    if (moab::MB_SUCCESS != rval) {
+      std::cerr << mb.get_error_string(rval) << ": Failed to compact adjacencies." << std::endl;
+      return 1;
+    }
+    std::cout << std::endl << "Compacted adjacencies" << std::endl;
+    print_memory_stats( mb, true, false, true, true );
+  }
   return 0;
 }
 
@@ -617,6 +640,11 @@ void do_test_mode()
   mb.get_adjacencies( &*handles.begin(), 1, 2, false, adj_vec );
   std::cout << std::endl << prefix << "Created vertex-to-element adjacencies" << std::endl;
   print_memory_stats( mb, true, false, true, true );
+  
+  // convert adjacency data to compact storage
+  mbcore.compact_adjacencies();
+  std::cout << std::endl << prefix << "Compacted adjacencies" << std::endl;
+  print_memory_stats( mb, true, false, true, true );
   std::cout << std::endl;
 }
 
@@ -28,6 +28,8 @@ int main( int argc, char* argv[] )
   std::string mtag = ""; // tag based merge
   std::string input_file, output_file;
   double merge_tol = 1.0e-4;
+  std::string method = "kdtree"; // coincident vertex search
+  int num_threads = 1;
 
   LONG_DESC << "mbmerge tool has the ability to merge nodes in a mesh. For skin-based merge with multiple"
                "files parallel options is also supported." << std::endl
@@ -42,6 +44,8 @@ int main( int argc, char* argv[] )
   opts.addOpt<std::string>( "mergetag name,t", "merge based on nodes that have a specific tag name assigned", &mtag);
   opts.addOpt<double>("mergetolerance,e", "merge tolerance, default is 1e-4", &merge_tol);
   opts.addOpt<void>("simple,s", "simple merge, merge based on skins provided as in the input mesh (Default)", &fsimple);
+  opts.addOpt<std::string>("method,m", "search for coincident nodes using a 'kdtree' (default) or a 'grid' of tolerance-sized cells", &method);
+  opts.addOpt<int>("threads,j", "number of threads used by the grid search, default is 1", &num_threads);
   opts.addRequiredArg<std::string>("input_file", "Input file to be merged", &input_file);
   opts.addRequiredArg<std::string>("output_file", "Output mesh file name with extension", &output_file);
 #ifdef MOAB_HAVE_MPI
@@ -50,6 +54,14 @@ int main( int argc, char* argv[] )
 #endif
   opts.parseCommandLine(argc, argv);
 
+  MergeMesh::SearchMethod search_method = MergeMesh::KD_TREE;
+  if (method == "grid")
+    search_method = MergeMesh::GRID;
+  else if (method != "kdtree") {
+    std::cerr << "Unknown search method: " << method << std::endl;
+    return 1;
+  }
+
   moab::Core *mb = new moab::Core();
   moab::ErrorCode rval;
 
@@ -102,6 +114,8 @@ int main( int argc, char* argv[] )
           std::cout << "Read input mesh file: " << input_file << std::endl;
         }
       MergeMesh mm(mb);
+      mm.set_search_method(search_method);
+      mm.set_num_threads(num_threads);
       rval = mm.merge_all(0, merge_tol); // root set
       if(rval != moab::MB_SUCCESS){
           std::cerr<< "error in merge_all routine" << std::endl;
@@ -222,6 +236,8 @@ int main( int argc, char* argv[] )
           return 1;
         }
       MergeMesh mm(mb);
+      mm.set_search_method(search_method);
+      mm.set_num_threads(num_threads);
       rval = mm.merge_entities(ents, merge_tol);
       if(rval != moab::MB_SUCCESS){
           std::cerr<< "error in merge entities routine" << std::endl;
@@ -19,6 +19,10 @@
 #include "moab/Skinner.hpp"
 #include "moab/AdaptiveKDTree.hpp"
 #include "moab/CN.hpp"
+#include "moab/CpuTimer.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace moab;
 
@@ -44,13 +48,14 @@ const int MIN_EDGE_LEN_DENOM = 4;
 
 static ErrorCode merge_duplicate_vertices( Interface&, double epsilon );
 static ErrorCode min_edge_length( Interface&, double& result );
+static int time_skin( Interface&, const Range& skin_ents, int max_threads );
 
 static void usage( const char* argv0, bool help = false ) 
 {
   std::ostream& str = help ? std::cout : std::cerr;
 
   str << "Usage: " << argv0 
-      << " [-b <block_num> [-b ...] ] [-l] [-m] [-M <n>] [-p] [-s <sideset_num>] [-S] [-t|-T <name>] [-w] [-v|-V <n>]"
+      << " [-b <block_num> [-b ...] ] [-j <n>] [-l] [-m] [-M <n>] [-p] [-P <n>] [-s <sideset_num>] [-S] [-t|-T <name>] [-w] [-v|-V <n>]"
       << " <input_file> [<output_file>]" << std::endl;
   str << "Help : " << argv0 << " -h" << std::endl;
   if (!help)
@@ -59,7 +64,9 @@ static void usage( const char* argv0, bool help = false )
   str << "Options: " << std::endl;
   str << "-a : Compute skin using vert-elem adjacencies (more memory, less time)." << std::endl;
   str << "-b <block_num> : Compute skin only for material set/block <block_num>." << std::endl;
+  str << "-j <n> : Skin by matching element sides using <n> threads (0 for all available.)" << std::endl;
   str << "-p : Print cpu & memory performance." << std::endl;
+  str << "-P <n> : Time skinning with the default algorithm and with 1 to <n> threads, then exit." << std::endl;
   str << "-s <sideset_num> : Put skin in neumann set/sideset <sideset_num>." << std::endl;
   str << "-S : Look for and use structured mesh information to speed up skinning." << std::endl;
   str << "-t : Set '" << DEFAULT_FIXED_TAG << "' tag on skin vertices." << std::endl;
@@ -85,6 +92,8 @@ int main( int argc, char* argv[] )
   double merge_epsilon = -1;
   bool list_skin = false;
   bool use_scd = false;
+  int num_threads = 0;
+  int time_threads = -1;
   const char* fixed_tag = DEFAULT_FIXED_TAG;
   const char *input_file = 0, *output_file = 0;
   
@@ -120,6 +129,26 @@ int main( int argc, char* argv[] )
             }
             ++i;
             break;
+          case 'j':
+            if (i == argc || 0 > (num_threads = strtol(argv[i],&endptr,0)) || *endptr) {
+              std::cerr << "Expected non-negative integer following '-j' flag" << std::endl;
+              usage(argv[0]);
+            }
+#ifdef _OPENMP
+            if (0 == num_threads)
+              num_threads = omp_get_max_threads();
+#else
+            num_threads = 1;
+#endif
+            ++i;
+            break;
+          case 'P':
+            if (i == argc || 0 >= (time_threads = strtol(argv[i],&endptr,0)) || *endptr) {
+              std::cerr << "Expected positive integer following '-P' flag" << std::endl;
+              usage(argv[0]);
+            }
+            ++i;
+            break;
           case 'T':
             if (i == argc || argv[i][0] == '-') {
               std::cerr << "Expected tag name following '-T' flag" << std::endl;
@@ -251,6 +280,9 @@ int main( int argc, char* argv[] )
     return 1;
   }
 
+  if (time_threads > 0)
+    return time_skin( *iface, skin_ents, time_threads );
+
   if (use_vert_elem_adjs) {
       // make a call which we know will generate vert-elem adjs
     Range dum_range;
@@ -270,10 +302,14 @@ int main( int argc, char* argv[] )
     // skin the mesh
   Range forward_lower, reverse_lower;
   Skinner tool( iface );
+  tool.set_num_threads( num_threads );
+  const double skin_start = CpuTimer::wall_time();
   if (use_scd) 
     result = tool.find_skin( 0, skin_ents, false, forward_lower, NULL, false, true, true);
   else
     result = tool.find_skin( 0, skin_ents, false, forward_lower, &reverse_lower );
+  if (print_perf)
+    std::cout << "Skinning wall time = " << CpuTimer::wall_time() - skin_start << " seconds." << std::endl;
   Range boundary;
   boundary.merge( forward_lower );
   boundary.merge( reverse_lower );
@@ -400,6 +436,38 @@ int main( int argc, char* argv[] )
   return 0;
 }
 
+  // Time finding the skin vertices of the mesh (so that repeated runs do the
+  // same work) with the default algorithm and with 1 to max_threads threads,
+  // checking each result against the default one.
+int time_skin( Interface& moab, const Range& skin_ents, int max_threads )
+{
+  Range expected;
+  Skinner tool( &moab );
+  double start = CpuTimer::wall_time();
+  ErrorCode rval = tool.find_skin( 0, skin_ents, true, expected );
+  CHKERROR(rval);
+  std::cout << "Skinning " << skin_ents.size() << " elements, " << expected.size()
+            << " skin vertices" << std::endl;
+  std::cout << "default     " << CpuTimer::wall_time() - start << " seconds" << std::endl;
+
+  int result = 0;
+  for (int n = 1; n <= max_threads; ++n) {
+    Range skin;
+    tool.set_num_threads( n );
+    start = CpuTimer::wall_time();
+    rval = tool.find_skin( 0, skin_ents, true, skin );
+    CHKERROR(rval);
+    const double secs = CpuTimer::wall_time() - start;
+    std::cout << n << " thread(s) " << secs << " seconds";
+    if (skin != expected) {
+      std::cout << " (DIFFERENT RESULT)";
+      result = 1;
+    }
+    std::cout << std::endl;
+  }
+  return result;
+}
+
 #if defined(_MSC_VER) || defined(__MINGW32__)
 void get_time_mem(double &tot_time, double &tot_mem) 
 {